@@ -39,6 +39,7 @@
 #include "cute_defer.h"
 #include "cute_doubly_list.h"
 #include "cute_draw.h"
+#include "cute_ecs.h"
 #include "cute_file_system.h"
 #include "cute_guid.h"
 #include "cute_graphics.h"
@@ -55,9 +56,11 @@
 #include "cute_model.h"
 #include "cute_networking.h"
 #include "cute_noise.h"
+#include "cute_pathfinding.h"
 #include "cute_physics.h"
 #include "cute_custom_sprite.h"
 #include "cute_rnd.h"
+#include "cute_spatial_hash.h"
 #include "cute_sprite.h"
 #include "cute_string.h"
 #include "cute_symbol.h"
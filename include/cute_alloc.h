@@ -9,6 +9,7 @@
 #define CF_ALLOC_H
 
 #include "cute_defines.h"
+#include "cute_defer.h"
 
 #define CK_ALLOC(sz) cf_alloc(sz)
 #define CK_REALLOC(p, sz) cf_realloc(p, sz)
@@ -44,6 +45,26 @@ typedef struct CF_Allocator
 } CF_Allocator;
 // @end
 
+/**
+ * @struct   CF_AlignedAllocator
+ * @category allocator
+ * @brief    Optional hooks serving `cf_aligned_alloc` and `cf_aligned_free` natively, see `cf_allocator_override_aligned`.
+ * @remarks  Without them `cf_aligned_alloc` over-allocates from the `CF_Allocator` and aligns within the block.
+ * @related  CF_AlignedAllocator cf_allocator_override_aligned cf_slab_aligned_allocator cf_aligned_alloc
+ */
+typedef struct CF_AlignedAllocator
+{
+	/* @member Can be `NULL`. An optional parameter handed back to you in the other function pointers below. */
+	void* udata;
+
+	/* @member Allocates memory aligned to `alignment`, a power of two up to 256. */
+	void* (*aligned_alloc_fn)(size_t size, int alignment, void* udata);
+
+	/* @member Frees memory from `aligned_alloc_fn`. */
+	void (*aligned_free_fn)(void* ptr, void* udata);
+} CF_AlignedAllocator;
+// @end
+
 /**
  * @function cf_allocator_override
  * @category allocator
@@ -56,10 +77,24 @@ typedef struct CF_Allocator
  *           `cf_sleep`, or otherwise perform a coroutine yield or fiber swap). The default allocator's functions
  *           are excluded from Emscripten's ASYNCIFY instrumentation on the assumption that allocation never
  *           suspends; a custom allocator that yields would corrupt the ASYNCIFY call stack instead of failing loudly.
- * @related  CF_Allocator cf_allocator_override cf_allocator_restore_default cf_alloc cf_free cf_calloc cf_realloc
+ *
+ *           Also removes any hooks installed by `cf_allocator_override_aligned`, since they usually belong to the allocator
+ *           being replaced. Install new ones afterwards if you have them.
+ * @related  CF_Allocator cf_allocator_override cf_allocator_override_aligned cf_allocator_restore_default cf_alloc cf_free cf_calloc cf_realloc
  */
 CF_API void CF_CALL cf_allocator_override(CF_Allocator allocator);
 
+/**
+ * @function cf_allocator_override_aligned
+ * @category allocator
+ * @brief    Serves `cf_aligned_alloc` and `cf_aligned_free` from custom hooks.
+ * @remarks  Optional. Without it, `cf_aligned_alloc` over-allocates from the allocator installed by `cf_allocator_override` and
+ *           aligns within the block. Call this after `cf_allocator_override`, which removes any previous hooks.
+ *           `cf_allocator_restore_default` removes them too.
+ * @related  CF_AlignedAllocator cf_allocator_override cf_slab_aligned_allocator cf_aligned_alloc cf_aligned_free
+ */
+CF_API void CF_CALL cf_allocator_override_aligned(CF_AlignedAllocator allocator);
+
 /**
  * @function cf_allocator_restore_default
  * @category allocator
@@ -71,6 +106,40 @@ CF_API void CF_CALL cf_allocator_override(CF_Allocator allocator);
  */
 CF_API void CF_CALL cf_allocator_restore_default(void);
 
+/**
+ * @function cf_slab_allocator
+ * @category allocator
+ * @brief    Returns CF's built-in size-class allocator, ready to install with `cf_allocator_override`.
+ * @remarks  Tuned for what CF allocates the most: small, short-lived blocks from dynamic arrays, strings and hash tables. Sizes up to 32KB
+ *           are rounded up to one of 40 size classes and carved out of 256KB slabs. Each thread keeps its own free list per size class, so
+ *           most allocations and frees never take a lock, and memory may be freed from any thread. Larger sizes are mapped straight from
+ *           the OS and handed back to it as soon as they're freed. Slab memory is kept for reuse rather than returned to the OS.
+ *
+ *           Install `cf_slab_aligned_allocator` along with it to serve `cf_aligned_alloc` natively from a suitably aligned size class,
+ *           without any over-allocation.
+ *
+ *           Install it first thing in `main`, before anything else is allocated. Memory allocated by one allocator must never be freed by another.
+ * @example > Switching CF over to the slab allocator.
+ *     int main(int argc, char* argv[])
+ *     {
+ *         cf_allocator_override(cf_slab_allocator());
+ *         cf_allocator_override_aligned(cf_slab_aligned_allocator());
+ *         CF_Result result = cf_make_app("Fancy Window Title", 0, 0, 0, 640, 480, CF_APP_OPTIONS_WINDOW_POS_CENTERED_BIT, argv[0]);
+ *         // ...
+ *     }
+ * @related  CF_Allocator cf_allocator_override cf_allocator_restore_default cf_slab_aligned_allocator cf_aligned_alloc
+ */
+CF_API CF_Allocator CF_CALL cf_slab_allocator(void);
+
+/**
+ * @function cf_slab_aligned_allocator
+ * @category allocator
+ * @brief    Returns the aligned hooks of `cf_slab_allocator`, ready to install with `cf_allocator_override_aligned`.
+ * @remarks  Only install these while `cf_slab_allocator` is the installed allocator.
+ * @related  cf_slab_allocator cf_allocator_override_aligned cf_aligned_alloc
+ */
+CF_API CF_AlignedAllocator CF_CALL cf_slab_aligned_allocator(void);
+
 /**
  * @function cf_alloc
  * @category allocator
@@ -155,8 +224,13 @@ CF_API void CF_CALL cf_aligned_free(void* ptr);
  * @struct   CF_Arena
  * @category allocator
  * @brief    A simple way to allocate memory without calling `malloc` too often.
- * @remarks  Individual allocations cannot be free'd, instead the entire allocator can reset.
- * @related  cf_arena_init cf_arena_alloc cf_arena_reset
+ * @remarks  Individual allocations cannot be free'd, instead the entire allocator can reset. Allocations never move, so
+ *           pointers stay valid until the arena is reset or destroyed.
+ *
+ *           There are two kinds of arenas. `cf_make_arena` chains separately allocated blocks together. `cf_make_virtual_arena`
+ *           reserves one large range of address space up front and commits physical memory within it on demand, so every
+ *           allocation lands in a single contiguous region.
+ * @related  cf_make_arena cf_make_virtual_arena cf_arena_alloc cf_arena_reset cf_arena_decommit
  */
 typedef struct CF_Arena
 {
@@ -166,6 +240,9 @@ typedef struct CF_Arena
 	char* end;
 	int block_index;
 	/* dyna */ char** blocks;
+	/* dyna */ int* block_sizes;
+	char* base;        // Virtual arenas only, start of the reserved range. NULL for block arenas.
+	char* reserve_end; // Virtual arenas only, end of the reserved range. `end` marks the committed pages.
 } CF_Arena;
 // @end
 
@@ -176,17 +253,35 @@ typedef struct CF_Arena
  * @param    arena         The arena to initialize.
  * @param    alignment     An alignment boundary, must be a power of two.
  * @param    block_size    The default size of each internal call to `malloc` to form pages to further allocate from.
- * @related  cf_arena_init cf_arena_alloc cf_arena_reset cf_arena_free
+ * @remarks  An allocation larger than `block_size` gets a block of its own, sized to fit.
+ * @related  cf_arena_init cf_arena_alloc cf_arena_reset cf_arena_free cf_make_virtual_arena
  */
 CF_API CF_Arena CF_CALL cf_make_arena(int alignment, int block_size);
 
+/**
+ * @function cf_make_virtual_arena
+ * @category allocator
+ * @brief    Creates an arena backed by one contiguous range of reserved virtual memory.
+ * @param    alignment     An alignment boundary, must be a power of two no larger than 4096.
+ * @param    reserve_size  Bytes of address space to reserve. This costs no physical memory, so reserving gigabytes is fine on 64-bit platforms.
+ * @return   Returns the arena, use it with the usual `cf_arena_*` functions.
+ * @remarks  Physical memory is committed in 64KB steps as the arena grows, and stays committed across `cf_arena_reset` so the
+ *           next frame pays nothing to reuse it. Call `cf_arena_decommit` to hand committed pages back to the OS, for example
+ *           after a rare spike. Allocations of any size work, up to `reserve_size` in total, and all of them are contiguous.
+ *
+ *           On platforms without virtual memory (web), or if the reservation fails, this returns an ordinary block arena from
+ *           `cf_make_arena` instead. Allocations still work and still never move, they are just not contiguous.
+ * @related  cf_make_arena cf_arena_alloc cf_arena_reset cf_arena_decommit cf_destroy_arena
+ */
+CF_API CF_Arena CF_CALL cf_make_virtual_arena(int alignment, size_t reserve_size);
+
 /**
  * @function cf_arena_alloc
  * @category allocator
  * @brief    Allocates a block of memory aligned along a byte boundary.
  * @param    arena         The arena to allocate from.
- * @param    size          The size of the allocation, it cannot be larger than `block_size` from `cf_arena_init`.
- * @return   Returns an aligned pointer of `size` bytes.
+ * @param    size          The size of the allocation.
+ * @return   Returns an aligned pointer of `size` bytes. Returns `NULL` if a virtual arena ran out of reserved address space.
  * @related  cf_arena_init cf_arena_alloc cf_arena_reset cf_arena_free
  */
 CF_API void* CF_CALL cf_arena_alloc(CF_Arena* arena, int size);
@@ -211,11 +306,22 @@ CF_API void CF_CALL cf_arena_free(CF_Arena* arena, int ptr);
  * @brief    Resets the allocator.
  * @param    arena         The arena to reset.
  * @remarks  This does not free up internal resources, and will reuse all previously allocated
- *           resources to fulfill subsequent `cf_arena_alloc` calls.
- * @related  cf_arena_init cf_arena_alloc cf_arena_reset cf_arena_free
+ *           resources to fulfill subsequent `cf_arena_alloc` calls. Call `cf_arena_decommit` afterwards to release them.
+ * @related  cf_arena_init cf_arena_alloc cf_arena_reset cf_arena_free cf_arena_decommit
  */
 CF_API void CF_CALL cf_arena_reset(CF_Arena* arena);
 
+/**
+ * @function cf_arena_decommit
+ * @category allocator
+ * @brief    Releases memory the arena holds beyond its current allocations.
+ * @param    arena         The arena to trim.
+ * @remarks  A virtual arena decommits its pages past the current allocation point, but keeps its address range reserved.
+ *           A block arena frees its unused blocks. Usually called right after `cf_arena_reset` to drop everything.
+ * @related  cf_arena_reset cf_make_virtual_arena cf_destroy_arena
+ */
+CF_API void CF_CALL cf_arena_decommit(CF_Arena* arena);
+
 /**
  * @function cf_destroy_arena
  * @category allocator
@@ -225,11 +331,78 @@ CF_API void CF_CALL cf_arena_reset(CF_Arena* arena);
  */
 CF_API void CF_CALL cf_destroy_arena(CF_Arena* arena);
 
+//--------------------------------------------------------------------------------------------------
+// Frame allocator.
+
+/**
+ * @function cf_frame_alloc
+ * @category allocator
+ * @brief    Allocates temporary memory that is automatically released at the start of the next frame.
+ * @param    size          The size of the allocation.
+ * @return   Returns a 16-byte aligned pointer of `size` bytes, valid until the next `cf_app_update`. The memory is not cleared.
+ * @remarks  Never free this memory -- it all goes away at once when the frame ends. This is the right place for scratch buffers
+ *           that only live inside one function call or one frame, and costs about as much as bumping a pointer.
+ *
+ *           Each thread allocates from its own arena, so this is safe and lock-free to call from any thread, including
+ *           job system tasks. Every thread's arena is released by the same `cf_app_update` call; a task that starts
+ *           before it and reads its memory after it is a use-after-free.
+ *
+ *           Each thread can hold up to 256 MB of frame memory at once. Going past that asserts rather than returning NULL,
+ *           which usually means the frame is never advanced -- see `cf_frame_alloc_advance`.
+ * @related  cf_frame_alloc cf_frame_alloc_double_buffered cf_frame_alloc_advance
+ */
+CF_API void* CF_CALL cf_frame_alloc(size_t size);
+
+/**
+ * @function cf_frame_alloc_double_buffered
+ * @category allocator
+ * @brief    Allocates temporary memory that stays valid until the end of the next frame.
+ * @param    size          The size of the allocation.
+ * @return   Returns a 16-byte aligned pointer of `size` bytes. The memory is not cleared.
+ * @remarks  Like `cf_frame_alloc`, but each thread keeps two arenas and alternates between them every frame. Memory allocated
+ *           during frame N is released at the start of frame N + 2, so it's safe to hand results from one frame to the next,
+ *           for example data produced by a job this frame and consumed next frame.
+ * @related  cf_frame_alloc cf_frame_alloc_double_buffered cf_frame_alloc_advance
+ */
+CF_API void* CF_CALL cf_frame_alloc_double_buffered(size_t size);
+
+/**
+ * @function cf_frame_alloc_advance
+ * @category allocator
+ * @brief    Begins a new frame for `cf_frame_alloc` and `cf_frame_alloc_double_buffered`.
+ * @remarks  `cf_app_update` calls this for you. Only call it yourself if you run without `cf_app_update`, such as in a headless
+ *           tool. Each thread lazily resets its own arena the next time it allocates, so this is just a counter increment.
+ * @related  cf_frame_alloc cf_frame_alloc_double_buffered cf_frame_alloc_advance
+ */
+CF_API void CF_CALL cf_frame_alloc_advance(void);
+
 //--------------------------------------------------------------------------------------------------
 // Memory pool allocator.
 
 typedef struct CF_MemoryPool CF_MemoryPool;
 
+/**
+ * @struct   CF_MemoryPoolStats
+ * @category allocator
+ * @brief    Usage counters for a memory pool, see `cf_memory_pool_stats`.
+ * @related  CF_MemoryPoolStats cf_memory_pool_stats cf_concurrent_pool_stats
+ */
+typedef struct CF_MemoryPoolStats
+{
+	/* @member Elements currently allocated and not yet freed. */
+	int live_elements;
+
+	/* @member The most elements that were ever live at once. */
+	int high_water_mark;
+
+	/* @member Number of blocks the pool has allocated, each holding `elements_per_block` elements. */
+	int block_count;
+
+	/* @member The `element_count` the pool was created with. */
+	int elements_per_block;
+} CF_MemoryPoolStats;
+// @end
+
 /**
  * @function cf_make_memory_pool
  * @category allocator
@@ -272,6 +445,171 @@ CF_API void* CF_CALL cf_memory_pool_alloc(CF_MemoryPool* pool);
  */
 CF_API void CF_CALL cf_memory_pool_free(CF_MemoryPool* pool, void* element);
 
+/**
+ * @function cf_memory_pool_stats
+ * @category allocator
+ * @brief    Returns usage counters for the pool.
+ * @param    pool           The pool.
+ * @related  CF_MemoryPoolStats cf_make_memory_pool cf_memory_pool_alloc cf_memory_pool_free
+ */
+CF_API CF_MemoryPoolStats CF_CALL cf_memory_pool_stats(CF_MemoryPool* pool);
+
+//--------------------------------------------------------------------------------------------------
+// Allocation tracking.
+
+/**
+ * @struct   CF_AllocTagStats
+ * @category allocator
+ * @brief    Memory usage of one allocation tag, see `cf_alloc_tag_push`.
+ * @remarks  Only allocations made through `cf_alloc`, `cf_calloc`, `cf_realloc` and `cf_aligned_alloc` while tracking is on are counted.
+ * @related  cf_alloc_tracking_enable cf_alloc_tag_push cf_alloc_tracking_tag_count cf_alloc_tracking_tag_stats cf_alloc_tracking_totals
+ */
+typedef struct CF_AllocTagStats
+{
+	/* @member The tag's name. Allocations made with no tag pushed are reported as "untagged". */
+	const char* name;
+
+	/* @member Bytes currently allocated under this tag. */
+	uint64_t live_bytes;
+
+	/* @member The highest `live_bytes` has been since tracking was enabled. */
+	uint64_t peak_bytes;
+
+	/* @member Number of allocations currently alive under this tag. */
+	int live_count;
+
+	/* @member Number of allocations made during the last completed frame, see `cf_alloc_tracking_advance_frame`. */
+	int frame_allocs;
+
+	/* @member Bytes allocated during the last completed frame. */
+	uint64_t frame_bytes;
+
+	/* @member Number of allocations made since tracking was enabled. */
+	uint64_t total_allocs;
+} CF_AllocTagStats;
+// @end
+
+/**
+ * @struct   CF_AllocCallsite
+ * @category allocator
+ * @brief    One entry of the allocation callsite histogram, see `cf_alloc_tracking_top_callsites`.
+ * @related  cf_alloc_tracking_enable cf_alloc_tracking_top_callsites
+ */
+typedef struct CF_AllocCallsite
+{
+	/* @member Return address of the call into the allocator. Resolve it to a file and line with your debugger, or a tool such as `addr2line` or `atos`. */
+	const void* address;
+
+	/* @member Total bytes allocated from this callsite since tracking was enabled. */
+	uint64_t bytes;
+
+	/* @member Number of allocations made from this callsite since tracking was enabled. */
+	uint64_t count;
+} CF_AllocCallsite;
+// @end
+
+/**
+ * @function cf_alloc_tracking_enable
+ * @category allocator
+ * @brief    Starts recording every allocation made through `cf_alloc` and friends.
+ * @param    track_callsites  Also build a histogram of which code allocates the most, see `cf_alloc_tracking_top_callsites`.
+ * @remarks  Tracking is off by default and costs a single branch per allocation while off. While on, every allocation and free
+ *           takes a global lock, so leave it off in shipping builds. Tracking can be switched on at any time -- memory allocated
+ *           before then is simply not counted, and freeing it is fine. All counters start from zero.
+ *
+ *           Memory is attributed to whichever tag is on top of the calling thread's tag stack, see `cf_alloc_tag_push`.
+ *           Frees are credited back to the tag of the original allocation, no matter which thread does the freeing.
+ * @related  cf_alloc_tracking_enable cf_alloc_tracking_disable cf_alloc_tag_push cf_alloc_tracking_tag_stats cf_alloc_tracking_to_json
+ */
+CF_API void CF_CALL cf_alloc_tracking_enable(bool track_callsites);
+
+/**
+ * @function cf_alloc_tracking_disable
+ * @category allocator
+ * @brief    Stops recording allocations and throws away all counters.
+ * @related  cf_alloc_tracking_enable cf_alloc_tracking_disable
+ */
+CF_API void CF_CALL cf_alloc_tracking_disable(void);
+
+/**
+ * @function cf_alloc_tag_push
+ * @category allocator
+ * @brief    Attributes this thread's allocations to `tag` until the matching `cf_alloc_tag_pop`.
+ * @param    tag        A name for the owner of the memory, such as "draw" or "audio". Must stay valid for the life of the program, string literals are ideal.
+ * @remarks  Tags nest, and each thread has its own tag stack. Up to 64 distinct tags may be used. In C++ prefer `CF_ALLOC_TAG_SCOPE`,
+ *           which pops the tag for you at the end of the scope. Pushing and popping tags works whether or not tracking is enabled.
+ * @related  cf_alloc_tag_push cf_alloc_tag_pop CF_ALLOC_TAG_SCOPE cf_alloc_tracking_tag_stats
+ */
+CF_API void CF_CALL cf_alloc_tag_push(const char* tag);
+
+/**
+ * @function cf_alloc_tag_pop
+ * @category allocator
+ * @brief    Pops the tag pushed by the last call to `cf_alloc_tag_push` on this thread.
+ * @related  cf_alloc_tag_push cf_alloc_tag_pop CF_ALLOC_TAG_SCOPE
+ */
+CF_API void CF_CALL cf_alloc_tag_pop(void);
+
+/**
+ * @function cf_alloc_tracking_advance_frame
+ * @category allocator
+ * @brief    Closes out the per-frame counters `frame_allocs` and `frame_bytes` of `CF_AllocTagStats`.
+ * @remarks  `cf_app_update` calls this for you. Only call it yourself if you run without `cf_app_update`.
+ * @related  CF_AllocTagStats cf_alloc_tracking_tag_stats
+ */
+CF_API void CF_CALL cf_alloc_tracking_advance_frame(void);
+
+/**
+ * @function cf_alloc_tracking_tag_count
+ * @category allocator
+ * @brief    Returns the number of tags seen so far, including "untagged" at index 0.
+ * @related  CF_AllocTagStats cf_alloc_tracking_tag_count cf_alloc_tracking_tag_stats
+ */
+CF_API int CF_CALL cf_alloc_tracking_tag_count(void);
+
+/**
+ * @function cf_alloc_tracking_tag_stats
+ * @category allocator
+ * @brief    Returns the usage counters of one tag.
+ * @param    index      Index of the tag, from 0 up to `cf_alloc_tracking_tag_count` - 1.
+ * @related  CF_AllocTagStats cf_alloc_tracking_tag_count cf_alloc_tracking_tag_stats cf_alloc_tracking_totals
+ */
+CF_API CF_AllocTagStats CF_CALL cf_alloc_tracking_tag_stats(int index);
+
+/**
+ * @function cf_alloc_tracking_totals
+ * @category allocator
+ * @brief    Returns usage counters summed over all tags, named "total".
+ * @remarks  `peak_bytes` is the true peak of all tracked memory together, which may be less than the sum of each tag's peak.
+ * @related  CF_AllocTagStats cf_alloc_tracking_tag_stats
+ */
+CF_API CF_AllocTagStats CF_CALL cf_alloc_tracking_totals(void);
+
+/**
+ * @function cf_alloc_tracking_top_callsites
+ * @category allocator
+ * @brief    Fills out the callsites that allocated the most bytes, biggest first.
+ * @param    callsites  An array of at least `max` entries to fill out.
+ * @param    max        The capacity of `callsites`.
+ * @return   Returns the number of entries written.
+ * @remarks  Requires `track_callsites` in `cf_alloc_tracking_enable`, otherwise returns 0. A callsite is the code calling into the allocator,
+ *           so memory from helpers like dynamic arrays or `sfmt` shows up under the helper -- use tags to tell owners apart. Up to 4096
+ *           distinct callsites are recorded.
+ * @related  CF_AllocCallsite cf_alloc_tracking_enable cf_alloc_tracking_to_json
+ */
+CF_API int CF_CALL cf_alloc_tracking_top_callsites(CF_AllocCallsite* callsites, int max);
+
+/**
+ * @function cf_alloc_tracking_to_json
+ * @category allocator
+ * @brief    Returns a JSON report of the totals, every tag, and the top callsites.
+ * @param    max_callsites  The most callsites to include.
+ * @return   Returns a dynamic string, free it with `sfree` when done.
+ * @remarks  Handy for writing to disk with `cf_fs_write_string_to_file`, or diffing memory usage between two points in a game.
+ * @related  cf_alloc_tracking_enable cf_alloc_tracking_tag_stats cf_alloc_tracking_top_callsites
+ */
+CF_API char* CF_CALL cf_alloc_tracking_to_json(int max_callsites);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -284,22 +622,66 @@ CF_API void CF_CALL cf_memory_pool_free(CF_MemoryPool* pool, void* element);
 namespace Cute
 {
 
+CF_INLINE CF_Allocator slab_allocator() { return cf_slab_allocator(); }
+CF_INLINE CF_AlignedAllocator slab_aligned_allocator() { return cf_slab_aligned_allocator(); }
+
 CF_INLINE void* aligned_alloc(size_t size, int alignment) { return cf_aligned_alloc(size, alignment); }
 CF_INLINE void aligned_free(void* ptr) { return cf_aligned_free(ptr); }
 
 CF_INLINE CF_Arena make_arena(int alignment, int block_size) { return cf_make_arena(alignment, block_size); }
+CF_INLINE CF_Arena make_virtual_arena(int alignment, size_t reserve_size) { return cf_make_virtual_arena(alignment, reserve_size); }
 CF_INLINE void* arena_alloc(CF_Arena* arena, int size) { return cf_arena_alloc(arena, size); }
 CF_INLINE void arena_free(CF_Arena* arena, int size) { cf_arena_free(arena, size); }
 CF_INLINE void arena_reset(CF_Arena* arena) { cf_arena_reset(arena); }
+CF_INLINE void arena_decommit(CF_Arena* arena) { cf_arena_decommit(arena); }
 CF_INLINE void destroy_arena(CF_Arena* arena) { cf_destroy_arena(arena); }
 
+CF_INLINE void* frame_alloc(size_t size) { return cf_frame_alloc(size); }
+CF_INLINE void* frame_alloc_double_buffered(size_t size) { return cf_frame_alloc_double_buffered(size); }
+CF_INLINE void frame_alloc_advance() { cf_frame_alloc_advance(); }
+
 CF_INLINE CF_MemoryPool* make_memory_pool(int element_size, int element_count, int alignment) { return cf_make_memory_pool(element_size, element_count, alignment); }
 CF_INLINE void destroy_memory_pool(CF_MemoryPool* pool) { cf_destroy_memory_pool(pool); }
 CF_INLINE void* memory_pool_alloc(CF_MemoryPool* pool) { return cf_memory_pool_alloc(pool); }
 CF_INLINE void memory_pool_free(CF_MemoryPool* pool, void* element) { return cf_memory_pool_free(pool, element); }
+CF_INLINE CF_MemoryPoolStats memory_pool_stats(CF_MemoryPool* pool) { return cf_memory_pool_stats(pool); }
+
+using AllocTagStats = CF_AllocTagStats;
+using AllocCallsite = CF_AllocCallsite;
+
+CF_INLINE void alloc_tracking_enable(bool track_callsites = false) { cf_alloc_tracking_enable(track_callsites); }
+CF_INLINE void alloc_tracking_disable() { cf_alloc_tracking_disable(); }
+CF_INLINE void alloc_tag_push(const char* tag) { cf_alloc_tag_push(tag); }
+CF_INLINE void alloc_tag_pop() { cf_alloc_tag_pop(); }
+CF_INLINE void alloc_tracking_advance_frame() { cf_alloc_tracking_advance_frame(); }
+CF_INLINE int alloc_tracking_tag_count() { return cf_alloc_tracking_tag_count(); }
+CF_INLINE AllocTagStats alloc_tracking_tag_stats(int index) { return cf_alloc_tracking_tag_stats(index); }
+CF_INLINE AllocTagStats alloc_tracking_totals() { return cf_alloc_tracking_totals(); }
+CF_INLINE int alloc_tracking_top_callsites(AllocCallsite* callsites, int max) { return cf_alloc_tracking_top_callsites(callsites, max); }
+CF_INLINE char* alloc_tracking_to_json(int max_callsites = 32) { return cf_alloc_tracking_to_json(max_callsites); }
+
+struct AllocTagScope
+{
+	CF_INLINE AllocTagScope(const char* tag) { cf_alloc_tag_push(tag); }
+	CF_INLINE ~AllocTagScope() { cf_alloc_tag_pop(); }
+};
 
 }
 
+/**
+ * @function CF_ALLOC_TAG_SCOPE
+ * @category allocator
+ * @brief    Attributes allocations to `tag` until the end of the enclosing scope.
+ * @example > Everything allocated while loading fonts counts as "fonts".
+ *     void load_fonts()
+ *     {
+ *         CF_ALLOC_TAG_SCOPE("fonts");
+ *         cf_make_font("calibri.ttf", "calibri");
+ *     }
+ * @related  cf_alloc_tag_push cf_alloc_tag_pop cf_alloc_tracking_tag_stats
+ */
+#define CF_ALLOC_TAG_SCOPE(tag) Cute::AllocTagScope CF_TOKEN_PASTE(cf_alloc_tag_scope_, __LINE__)(tag)
+
 #endif // CF_CPP
 
 #endif // CF_ALLOC_H
@@ -180,11 +180,11 @@
 /**
  * @function cf_array_hash
  * @category array
- * @brief    Returns a hash of all the bytes in the array using FNV1a.
+ * @brief    Returns a hash of all the bytes in the array.
  * @param    a             The array.
  * @return   Returns a `uint64_t` hash.
- * @remarks  Shortform: `ahash(a)`.
- * @related  cf_array_size
+ * @remarks  Shortform: `ahash(a)`. Same as `cf_hash_bytes` over the array's bytes.
+ * @related  cf_array_size cf_hash_bytes
  */
 #define cf_array_hash(a) ahash(a)
 
@@ -542,6 +542,62 @@ CF_API void CF_CALL cf_draw_list(CF_DrawList list);
  */
 CF_API void CF_CALL cf_destroy_draw_list(CF_DrawList list);
 
+/**
+ * @struct   CF_DrawRecorder
+ * @category draw
+ * @brief    Records 2d draw calls on another thread, to be rendered along with the main thread's.
+ * @remarks  Normally only the main thread can call `cf_draw_*` functions. A recorder gives a worker thread its own draw state
+ *           -- color, layer, camera and every other push/pop stack -- and its own list of recorded commands, so many threads
+ *           can record at once without locking anything. Make one recorder per job, record into them from a `CF_Threadpool`,
+ *           wait for the jobs, then render as usual: `cf_render_to` merges them in.
+ * @related  CF_DrawRecorder cf_make_draw_recorder cf_draw_recorder_begin cf_draw_recorder_end cf_destroy_draw_recorder
+ */
+typedef struct CF_DrawRecorder { uint64_t id; } CF_DrawRecorder;
+// @end
+
+/**
+ * @function cf_make_draw_recorder
+ * @category draw
+ * @brief    Creates a draw recorder. Call from the main thread.
+ * @remarks  Recorders merge into rendering in the order they were made, see `cf_draw_recorder_begin`.
+ * @related  CF_DrawRecorder cf_make_draw_recorder cf_draw_recorder_begin cf_draw_recorder_end cf_destroy_draw_recorder
+ */
+CF_API CF_DrawRecorder CF_CALL cf_make_draw_recorder(void);
+
+/**
+ * @function cf_draw_recorder_begin
+ * @category draw
+ * @brief    Sends the calling thread's `cf_draw_*` calls into a recorder, until `cf_draw_recorder_end`.
+ * @remarks  Any thread may record, but only one at a time per recorder. Every recording starts from default draw state, the same
+ *           as the start of a frame, with the app's default projection. Recordings pile up until the next `cf_render_to` (or
+ *           `cf_render_layers_to`), which must run after all recording threads have called `cf_draw_recorder_end`. It merges
+ *           recorded commands into the layer sort: within a layer, the main thread's draws come first, then each recorder's
+ *           in the order the recorders were made, each in the order its draws were recorded. The result is the same every
+ *           frame no matter how the threads were scheduled.
+ *
+ *           Recorders cover the 2d shape, sprite, and state functions, along with `cf_draw_path`, `cf_draw_custom_shape`,
+ *           `cf_draw_list` replays of 2d lists, and uniforms. Text and `cf_draw3d_*` still need the main thread, as do
+ *           functions that make or destroy things, like `cf_make_draw_list` or `cf_draw_path_end`.
+ * @related  CF_DrawRecorder cf_make_draw_recorder cf_draw_recorder_begin cf_draw_recorder_end cf_destroy_draw_recorder
+ */
+CF_API void CF_CALL cf_draw_recorder_begin(CF_DrawRecorder recorder);
+
+/**
+ * @function cf_draw_recorder_end
+ * @category draw
+ * @brief    Stops recording on the calling thread, returning its `cf_draw_*` calls to where they went before `cf_draw_recorder_begin`.
+ * @related  CF_DrawRecorder cf_make_draw_recorder cf_draw_recorder_begin cf_draw_recorder_end cf_destroy_draw_recorder
+ */
+CF_API void CF_CALL cf_draw_recorder_end(void);
+
+/**
+ * @function cf_destroy_draw_recorder
+ * @category draw
+ * @brief    Frees a draw recorder, dropping anything recorded but not yet rendered. Call from the main thread.
+ * @related  CF_DrawRecorder cf_make_draw_recorder cf_draw_recorder_begin cf_draw_recorder_end cf_destroy_draw_recorder
+ */
+CF_API void CF_CALL cf_destroy_draw_recorder(CF_DrawRecorder recorder);
+
 /**
  * @function cf_draw_arrow
  * @category draw
@@ -2463,6 +2519,10 @@ CF_INLINE void draw_list_begin(CF_DrawList list) { cf_draw_list_begin(list); }
 CF_INLINE void draw_list_end() { cf_draw_list_end(); }
 CF_INLINE void draw_list(CF_DrawList list) { cf_draw_list(list); }
 CF_INLINE void destroy_draw_list(CF_DrawList list) { cf_destroy_draw_list(list); }
+CF_INLINE CF_DrawRecorder make_draw_recorder() { return cf_make_draw_recorder(); }
+CF_INLINE void draw_recorder_begin(CF_DrawRecorder recorder) { cf_draw_recorder_begin(recorder); }
+CF_INLINE void draw_recorder_end() { cf_draw_recorder_end(); }
+CF_INLINE void destroy_draw_recorder(CF_DrawRecorder recorder) { cf_destroy_draw_recorder(recorder); }
 CF_INLINE void draw_polygon_fill(const v2* points, int count, float chubbiness) { cf_draw_polygon_fill(points, count, chubbiness); }
 CF_INLINE void draw_polygon_fill_simple(const v2* points, int count) { cf_draw_polygon_fill_simple(points, count); }
 CF_INLINE void draw_bezier_line(v2 a, v2 c0, v2 b, int iters, float thickness) { cf_draw_bezier_line(a, c0, b, iters, thickness); }
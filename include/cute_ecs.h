@@ -0,0 +1,491 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_ECS_H
+#define CF_ECS_H
+
+#include "cute_defines.h"
+#include "cute_c_runtime.h"
+#include "cute_multithreading.h"
+
+//--------------------------------------------------------------------------------------------------
+// C API
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @struct   CF_Entity
+ * @category ecs
+ * @brief    An opaque handle to an entity.
+ * @remarks  Handles are generational. Once an entity is destroyed its handle goes stale -- `cf_entity_is_valid` returns false for it
+ *           even after the underlying slot has been reused by a newer entity.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_entity_is_valid cf_entity_get_component CF_INVALID_ENTITY
+ */
+typedef struct CF_Entity
+{
+	/* @member The generation in the upper 32 bits, the slot index in the lower 32 bits. Zero is never a valid entity. */
+	uint64_t id;
+} CF_Entity;
+// @end
+
+/**
+ * @function CF_INVALID_ENTITY
+ * @category ecs
+ * @brief    An entity handle that is never valid.
+ * @related  CF_Entity cf_make_entity cf_entity_is_valid
+ */
+#define CF_INVALID_ENTITY (cf_invalid_entity())
+
+/**
+ * @function cf_invalid_entity
+ * @category ecs
+ * @brief    Returns an entity handle that is never valid.
+ * @related  CF_Entity CF_INVALID_ENTITY cf_entity_is_valid
+ */
+CF_INLINE CF_Entity cf_invalid_entity(void) { CF_Entity e; e.id = 0; return e; }
+
+/**
+ * @function cf_entity_equal
+ * @category ecs
+ * @brief    Returns true if two entity handles refer to the same entity.
+ * @related  CF_Entity cf_entity_is_valid
+ */
+CF_INLINE bool cf_entity_equal(CF_Entity a, CF_Entity b) { return a.id == b.id; }
+
+/**
+ * @struct   CF_ComponentList
+ * @category ecs
+ * @brief    A batch of entities that all share the same set of components, handed to a system's update function.
+ * @remarks  Components are stored as structure-of-arrays: fetch the array for each component type with `CF_GET_COMPONENTS` or
+ *           `cf_get_components`, and index all arrays with the same `i` to visit one entity.
+ * @related  CF_ComponentList CF_GET_COMPONENTS cf_get_components cf_get_entities CF_SystemUpdateFn
+ */
+typedef struct CF_ComponentList
+{
+	/* @member For internal use only. */
+	uint64_t id;
+} CF_ComponentList;
+// @end
+
+/**
+ * @function CF_ComponentFn
+ * @category ecs
+ * @brief    An optional callback to initialize or clean up a component.
+ * @param    entity     The entity owning the component.
+ * @param    component  A pointer to the component's memory.
+ * @param    udata      The `udata` passed along with the callback when it was registered.
+ * @remarks  Component memory is always zeroed before the initializer runs. Use the cleanup to release anything the component owns, such
+ *           as calling the destructor of a C++ type.
+ * @related  cf_component_set_optional_initializer cf_component_set_optional_cleanup
+ */
+typedef void (CF_CALL CF_ComponentFn)(CF_Entity entity, void* component, void* udata);
+
+/**
+ * @function cf_component_begin
+ * @category ecs
+ * @brief    Begins registering a new component type.
+ * @remarks  Finish with `cf_component_end`. Components are moved around in memory with `memcpy` as entities are added and removed, so
+ *           they must not store pointers to themselves. At most 256 component types can be registered.
+ * @example > Registering a component.
+ *     typedef struct Position { float x, y; } Position;
+ *     cf_component_begin();
+ *     cf_component_set_name("Position");
+ *     cf_component_set_size(sizeof(Position));
+ *     cf_component_end();
+ * @related  cf_component_begin cf_component_set_name cf_component_set_size cf_component_set_optional_initializer cf_component_set_optional_cleanup cf_component_end
+ */
+CF_API void CF_CALL cf_component_begin(void);
+
+/**
+ * @function cf_component_set_name
+ * @category ecs
+ * @brief    Sets the name of the component type being registered.
+ * @param    name       The name, used to refer to this component everywhere else in the ECS.
+ * @remarks  A common convention is to use the name of the struct, e.g. `CF_STRINGIZE(C_HitPoints)`, which pairs with `CF_GET_COMPONENTS`.
+ * @related  cf_component_begin cf_component_set_name cf_component_set_size cf_component_end
+ */
+CF_API void CF_CALL cf_component_set_name(const char* name);
+
+/**
+ * @function cf_component_set_size
+ * @category ecs
+ * @brief    Sets the size in bytes of the component type being registered.
+ * @param    size       The size, usually `sizeof` your struct.
+ * @related  cf_component_begin cf_component_set_name cf_component_set_size cf_component_end
+ */
+CF_API void CF_CALL cf_component_set_size(int size);
+
+/**
+ * @function cf_component_set_optional_initializer
+ * @category ecs
+ * @brief    Sets a function called on each new instance of this component, after its memory has been zeroed.
+ * @param    initializer  Called once per new component.
+ * @param    udata        Can be `NULL`. Handed back to `initializer`.
+ * @related  CF_ComponentFn cf_component_begin cf_component_set_optional_cleanup cf_component_end
+ */
+CF_API void CF_CALL cf_component_set_optional_initializer(CF_ComponentFn* initializer, void* udata);
+
+/**
+ * @function cf_component_set_optional_cleanup
+ * @category ecs
+ * @brief    Sets a function called on each instance of this component right before it is destroyed.
+ * @param    cleanup    Called once per destroyed component.
+ * @param    udata      Can be `NULL`. Handed back to `cleanup`.
+ * @related  CF_ComponentFn cf_component_begin cf_component_set_optional_initializer cf_component_end
+ */
+CF_API void CF_CALL cf_component_set_optional_cleanup(CF_ComponentFn* cleanup, void* udata);
+
+/**
+ * @function cf_component_end
+ * @category ecs
+ * @brief    Finishes registering a component type started with `cf_component_begin`.
+ * @remarks  Registering a name a second time updates its callbacks. The size of a component can't change once entities use it.
+ * @related  cf_component_begin cf_component_set_name cf_component_set_size cf_component_end
+ */
+CF_API void CF_CALL cf_component_end(void);
+
+/**
+ * @function cf_entity_begin
+ * @category ecs
+ * @brief    Begins registering a new entity type, a named list of components used by `cf_make_entity`.
+ * @remarks  Finish with `cf_entity_end`. All components must already be registered.
+ * @related  cf_entity_begin cf_entity_set_name cf_entity_add_component cf_entity_end cf_make_entity
+ */
+CF_API void CF_CALL cf_entity_begin(void);
+
+/**
+ * @function cf_entity_set_name
+ * @category ecs
+ * @brief    Sets the name of the entity type being registered.
+ * @param    entity_type  The name, later passed to `cf_make_entity`.
+ * @related  cf_entity_begin cf_entity_set_name cf_entity_add_component cf_entity_end
+ */
+CF_API void CF_CALL cf_entity_set_name(const char* entity_type);
+
+/**
+ * @function cf_entity_add_component
+ * @category ecs
+ * @brief    Adds a component type to the entity type being registered.
+ * @param    component_name  The name of a registered component.
+ * @related  cf_entity_begin cf_entity_set_name cf_entity_add_component cf_entity_end
+ */
+CF_API void CF_CALL cf_entity_add_component(const char* component_name);
+
+/**
+ * @function cf_entity_end
+ * @category ecs
+ * @brief    Finishes registering an entity type started with `cf_entity_begin`.
+ * @related  cf_entity_begin cf_entity_set_name cf_entity_add_component cf_entity_end
+ */
+CF_API void CF_CALL cf_entity_end(void);
+
+/**
+ * @function cf_make_entity
+ * @category ecs
+ * @brief    Returns a new entity of a registered entity type.
+ * @param    entity_type  The name of an entity type registered with `cf_entity_begin`.
+ * @remarks  Each component is zeroed and then handed to its initializer, if any. Entities live in tables grouped by their exact set of
+ *           components (archetypes), each table split into 16KB chunks of structure-of-arrays data, so systems iterate tightly packed
+ *           memory. Returns `CF_INVALID_ENTITY` if the entity type doesn't exist.
+ *
+ *           Called while systems are running (see `cf_run_systems`) the handle is returned right away, but the entity is only created
+ *           once all systems have finished. Until then `cf_entity_is_valid` returns false for it.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_entity_is_valid cf_entity_get_component cf_run_systems
+ */
+CF_API CF_Entity CF_CALL cf_make_entity(const char* entity_type);
+
+/**
+ * @function cf_destroy_entity
+ * @category ecs
+ * @brief    Destroys an entity, calling the cleanup function of each of its components.
+ * @param    entity     The entity to destroy. Stale handles are ignored.
+ * @remarks  Called while systems are running the entity is destroyed once all systems have finished.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_entity_is_valid cf_destroy_all_entities
+ */
+CF_API void CF_CALL cf_destroy_entity(CF_Entity entity);
+
+/**
+ * @function cf_entity_is_valid
+ * @category ecs
+ * @brief    Returns true if `entity` refers to a live entity.
+ * @param    entity     The entity.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_entity_is_valid
+ */
+CF_API bool CF_CALL cf_entity_is_valid(CF_Entity entity);
+
+/**
+ * @function cf_entity_get_component
+ * @category ecs
+ * @brief    Returns a pointer to one of an entity's components, or `NULL` if the entity is stale or doesn't have the component.
+ * @param    entity          The entity.
+ * @param    component_name  The name of the component.
+ * @remarks  The pointer is only good until the next structural change (making, destroying, attaching or detaching) to any entity sharing
+ *           this entity's archetype. Don't hold onto it.
+ * @related  CF_Entity cf_entity_get_component cf_entity_has_component cf_entity_attach_component cf_entity_detach_component
+ */
+CF_API void* CF_CALL cf_entity_get_component(CF_Entity entity, const char* component_name);
+
+/**
+ * @function cf_entity_has_component
+ * @category ecs
+ * @brief    Returns true if the entity is live and has the component.
+ * @param    entity          The entity.
+ * @param    component_name  The name of the component.
+ * @related  CF_Entity cf_entity_get_component cf_entity_has_component cf_entity_attach_component cf_entity_detach_component
+ */
+CF_API bool CF_CALL cf_entity_has_component(CF_Entity entity, const char* component_name);
+
+/**
+ * @function cf_entity_attach_component
+ * @category ecs
+ * @brief    Adds a component to a live entity, moving the entity to the archetype for its new set of components.
+ * @param    entity          The entity.
+ * @param    component_name  The name of a registered component. Does nothing if the entity already has it.
+ * @remarks  The new component is zeroed and handed to its initializer, if any. Called while systems are running the component is
+ *           attached once all systems have finished.
+ * @related  CF_Entity cf_entity_get_component cf_entity_has_component cf_entity_attach_component cf_entity_detach_component
+ */
+CF_API void CF_CALL cf_entity_attach_component(CF_Entity entity, const char* component_name);
+
+/**
+ * @function cf_entity_detach_component
+ * @category ecs
+ * @brief    Removes a component from a live entity, calling the component's cleanup function.
+ * @param    entity          The entity.
+ * @param    component_name  The name of the component. Does nothing if the entity doesn't have it.
+ * @remarks  Called while systems are running the component is detached once all systems have finished.
+ * @related  CF_Entity cf_entity_get_component cf_entity_has_component cf_entity_attach_component cf_entity_detach_component
+ */
+CF_API void CF_CALL cf_entity_detach_component(CF_Entity entity, const char* component_name);
+
+/**
+ * @function cf_entity_count
+ * @category ecs
+ * @brief    Returns the number of live entities.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_destroy_all_entities
+ */
+CF_API int CF_CALL cf_entity_count(void);
+
+/**
+ * @function cf_destroy_all_entities
+ * @category ecs
+ * @brief    Destroys every entity, calling the cleanup functions of all their components.
+ * @remarks  Registered components, entity types and systems are kept. Must not be called while systems are running.
+ * @related  CF_Entity cf_make_entity cf_destroy_entity cf_destroy_all_entities
+ */
+CF_API void CF_CALL cf_destroy_all_entities(void);
+
+/**
+ * @function CF_SystemUpdateFn
+ * @category ecs
+ * @brief    A system's update function, called once per batch of matching entities.
+ * @param    component_list  The batch. Fetch component arrays with `CF_GET_COMPONENTS`.
+ * @param    entity_count    The number of entities in the batch.
+ * @param    udata           The `udata` from `cf_system_set_optional_update_udata`.
+ * @related  CF_SystemUpdateFn cf_system_set_update CF_ComponentList CF_GET_COMPONENTS
+ */
+typedef void (CF_CALL CF_SystemUpdateFn)(CF_ComponentList component_list, int entity_count, void* udata);
+
+/**
+ * @function CF_SystemFn
+ * @category ecs
+ * @brief    An optional function run once before or after a system updates its batches.
+ * @param    udata      The `udata` from `cf_system_set_optional_update_udata`.
+ * @related  CF_SystemFn cf_system_set_optional_pre_update cf_system_set_optional_post_update
+ */
+typedef void (CF_CALL CF_SystemFn)(void* udata);
+
+/**
+ * @function cf_system_begin
+ * @category ecs
+ * @brief    Begins registering a new system.
+ * @remarks  Finish with `cf_system_end`. A system runs its update function on every entity that has all of its required components.
+ *           Systems run in the order they were registered.
+ * @related  cf_system_begin cf_system_set_name cf_system_set_update cf_system_require_component cf_system_require_component_read_only cf_system_end cf_run_systems
+ */
+CF_API void CF_CALL cf_system_begin(void);
+
+/**
+ * @function cf_system_set_name
+ * @category ecs
+ * @brief    Sets the name of the system being registered. Useful for debugging.
+ * @param    name       The name.
+ * @related  cf_system_begin cf_system_set_name cf_system_end
+ */
+CF_API void CF_CALL cf_system_set_name(const char* name);
+
+/**
+ * @function cf_system_set_update
+ * @category ecs
+ * @brief    Sets the update function of the system being registered.
+ * @param    update     Called once per batch of matching entities, see `CF_SystemUpdateFn`.
+ * @related  CF_SystemUpdateFn cf_system_begin cf_system_set_update cf_system_set_optional_update_udata cf_system_end
+ */
+CF_API void CF_CALL cf_system_set_update(CF_SystemUpdateFn* update);
+
+/**
+ * @function cf_system_set_optional_update_udata
+ * @category ecs
+ * @brief    Sets the `udata` handed to the system's update, pre-update and post-update functions.
+ * @param    udata      Can be `NULL`.
+ * @related  cf_system_begin cf_system_set_update cf_system_set_optional_update_udata cf_system_end
+ */
+CF_API void CF_CALL cf_system_set_optional_update_udata(void* udata);
+
+/**
+ * @function cf_system_set_optional_pre_update
+ * @category ecs
+ * @brief    Sets a function run once right before the system updates its batches.
+ * @param    pre_update  Called once per run of the system.
+ * @related  CF_SystemFn cf_system_begin cf_system_set_optional_pre_update cf_system_set_optional_post_update cf_system_end
+ */
+CF_API void CF_CALL cf_system_set_optional_pre_update(CF_SystemFn* pre_update);
+
+/**
+ * @function cf_system_set_optional_post_update
+ * @category ecs
+ * @brief    Sets a function run once right after the system updates its batches.
+ * @param    post_update  Called once per run of the system.
+ * @related  CF_SystemFn cf_system_begin cf_system_set_optional_pre_update cf_system_set_optional_post_update cf_system_end
+ */
+CF_API void CF_CALL cf_system_set_optional_post_update(CF_SystemFn* post_update);
+
+/**
+ * @function cf_system_require_component
+ * @category ecs
+ * @brief    Requires a component for the system being registered, which the system reads and writes.
+ * @param    component_name  The name of a registered component.
+ * @remarks  The system only visits entities with all of its required components. The read/write declarations drive
+ *           `cf_run_systems_parallel`: a system writing a component never runs at the same time as another system touching it.
+ * @related  cf_system_begin cf_system_require_component cf_system_require_component_read_only cf_system_end cf_run_systems_parallel
+ */
+CF_API void CF_CALL cf_system_require_component(const char* component_name);
+
+/**
+ * @function cf_system_require_component_read_only
+ * @category ecs
+ * @brief    Requires a component for the system being registered, which the system only reads.
+ * @param    component_name  The name of a registered component.
+ * @remarks  Systems that only read a component may run at the same time in `cf_run_systems_parallel`.
+ * @related  cf_system_begin cf_system_require_component cf_system_require_component_read_only cf_system_end cf_run_systems_parallel
+ */
+CF_API void CF_CALL cf_system_require_component_read_only(const char* component_name);
+
+/**
+ * @function cf_system_end
+ * @category ecs
+ * @brief    Finishes registering a system started with `cf_system_begin`.
+ * @related  cf_system_begin cf_system_set_name cf_system_set_update cf_system_require_component cf_system_end
+ */
+CF_API void CF_CALL cf_system_end(void);
+
+/**
+ * @function cf_clear_systems
+ * @category ecs
+ * @brief    Unregisters all systems.
+ * @related  cf_system_begin cf_system_end cf_run_systems cf_clear_systems
+ */
+CF_API void CF_CALL cf_clear_systems(void);
+
+/**
+ * @function cf_run_systems
+ * @category ecs
+ * @brief    Runs every system once, in registration order, on the calling thread.
+ * @remarks  Each system keeps a cached list of the archetypes it matches, refreshed only when new archetypes appear, so running systems
+ *           doesn't search over entities. Making, destroying, attaching or detaching from within a system is deferred until all systems
+ *           have finished, so the batches a system iterates never change underneath it.
+ * @related  cf_system_begin cf_run_systems cf_run_systems_parallel cf_clear_systems
+ */
+CF_API void CF_CALL cf_run_systems(void);
+
+/**
+ * @function cf_run_systems_parallel
+ * @category ecs
+ * @brief    Runs every system once, running systems that don't conflict at the same time on a threadpool.
+ * @param    pool       The pool. Can be `NULL`, in which case this is the same as `cf_run_systems`.
+ * @remarks  Two systems conflict if either one writes a component the other one reads or writes (see `cf_system_require_component` and
+ *           `cf_system_require_component_read_only`). Systems are split into stages: a system runs in the stage after the last earlier
+ *           system it conflicts with, so the result matches `cf_run_systems` as long as the read/write declarations are accurate.
+ *           Systems without any required components conflict with everything. Pre and post update functions run on the same thread as
+ *           their system, and `udata` shared between systems isn't protected. Deferred changes are recorded per system and applied in
+ *           registration order, and the handles of entities made during the run only depend on which system made them, so they come
+ *           out the same no matter how the threads interleave. Changes made from other threads during the run, such as jobs a system
+ *           adds to a threadpool, are applied last. Returns once all systems have finished.
+ * @related  cf_system_begin cf_run_systems cf_run_systems_parallel CF_Threadpool
+ */
+CF_API void CF_CALL cf_run_systems_parallel(CF_Threadpool* pool);
+
+/**
+ * @function cf_get_components
+ * @category ecs
+ * @brief    Returns the array of one component type in a batch of entities, or `NULL` if the batch doesn't have that component.
+ * @param    component_list  The batch handed to a `CF_SystemUpdateFn`.
+ * @param    component_name  The name of the component.
+ * @related  CF_ComponentList CF_GET_COMPONENTS cf_get_components cf_get_entities
+ */
+CF_API void* CF_CALL cf_get_components(CF_ComponentList component_list, const char* component_name);
+
+/**
+ * @function CF_GET_COMPONENTS
+ * @category ecs
+ * @brief    Returns a typed array of one component type in a batch, for components registered under the name of their struct.
+ * @param    component_list  The batch handed to a `CF_SystemUpdateFn`.
+ * @param    T               The component struct, also used as its name.
+ * @related  CF_ComponentList CF_GET_COMPONENTS cf_get_components cf_get_entities
+ */
+#define CF_GET_COMPONENTS(component_list, T) ((T*)cf_get_components(component_list, #T))
+
+/**
+ * @function cf_get_entities
+ * @category ecs
+ * @brief    Returns the array of entity handles in a batch, parallel to its component arrays.
+ * @param    component_list  The batch handed to a `CF_SystemUpdateFn`.
+ * @related  CF_ComponentList CF_GET_COMPONENTS cf_get_components cf_get_entities
+ */
+CF_API CF_Entity* CF_CALL cf_get_entities(CF_ComponentList component_list);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+//--------------------------------------------------------------------------------------------------
+// C++ API
+
+#ifdef CF_CPP
+
+CF_INLINE bool operator==(CF_Entity a, CF_Entity b) { return cf_entity_equal(a, b); }
+CF_INLINE bool operator!=(CF_Entity a, CF_Entity b) { return !cf_entity_equal(a, b); }
+
+namespace Cute
+{
+
+using Entity = CF_Entity;
+using ComponentList = CF_ComponentList;
+
+CF_INLINE Entity make_entity(const char* entity_type) { return cf_make_entity(entity_type); }
+CF_INLINE void destroy_entity(Entity entity) { cf_destroy_entity(entity); }
+CF_INLINE bool entity_is_valid(Entity entity) { return cf_entity_is_valid(entity); }
+CF_INLINE void* entity_get_component(Entity entity, const char* component_name) { return cf_entity_get_component(entity, component_name); }
+template <typename T> T* entity_get_component(Entity entity, const char* component_name) { return (T*)cf_entity_get_component(entity, component_name); }
+CF_INLINE bool entity_has_component(Entity entity, const char* component_name) { return cf_entity_has_component(entity, component_name); }
+CF_INLINE void entity_attach_component(Entity entity, const char* component_name) { cf_entity_attach_component(entity, component_name); }
+CF_INLINE void entity_detach_component(Entity entity, const char* component_name) { cf_entity_detach_component(entity, component_name); }
+CF_INLINE int entity_count() { return cf_entity_count(); }
+CF_INLINE void destroy_all_entities() { cf_destroy_all_entities(); }
+CF_INLINE void run_systems() { cf_run_systems(); }
+CF_INLINE void run_systems_parallel(CF_Threadpool* pool) { cf_run_systems_parallel(pool); }
+CF_INLINE void clear_systems() { cf_clear_systems(); }
+CF_INLINE void* get_components(ComponentList component_list, const char* component_name) { return cf_get_components(component_list, component_name); }
+CF_INLINE Entity* get_entities(ComponentList component_list) { return cf_get_entities(component_list); }
+
+}
+
+#endif // CF_CPP
+
+#endif // CF_ECS_H
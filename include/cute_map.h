@@ -95,6 +95,25 @@
  */
 #define cf_map_get(m, k) map_get(m, k)
 
+/**
+ * @function cf_map_get_or
+ * @category map
+ * @brief    Fetches the item that `k` maps to, or a default value.
+ * @param    m            The map. Can be `NULL`. Must be declared with `CF_MAP(T)`.
+ * @param    k            The key for lookups. Keys are always typecast to `uint64_t`.
+ * @param    d            The item to return if `k` isn't in the map.
+ * @return   Returns the item by value. If the key doesn't exist, returns `d`.
+ * @example > Looking up a setting with a fallback.
+ *           CF_MAP(int) settings = NULL;
+ *           map_set(settings, sintern("volume"), 80);
+ *           CF_ASSERT(map_get_or(settings, sintern("volume"), 100) == 80);
+ *           CF_ASSERT(map_get_or(settings, sintern("brightness"), 100) == 100);
+ *           map_free(settings);
+ * @remarks  Like `map_get` this only performs a single hash lookup.
+ * @related  CF_MAP cf_map_set cf_map_get cf_map_get_or cf_map_get_ptr cf_map_has
+ */
+#define cf_map_get_or(m, k, d) map_get_or(m, k, d)
+
 /**
  * @function cf_map_get_ptr
  * @category map
@@ -412,9 +431,7 @@ T* Map<T>::insert(uint64_t key)
 	// Reserve space first, then placement new.
 	T dummy;
 	CF_MEMSET(&dummy, 0, sizeof(T));
-	ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
-	T* result = (T*)ck_map_get_ptr_impl(CK_MHDR(m_map), key);
-	CF_ASSERT(result);
+	T* result = (T*)ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
 	CF_PLACEMENT_NEW(result) T();
 	return result;
 }
@@ -424,9 +441,7 @@ T* Map<T>::insert(uint64_t key, const T& val)
 {
 	T dummy;
 	CF_MEMSET(&dummy, 0, sizeof(T));
-	ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
-	T* result = (T*)ck_map_get_ptr_impl(CK_MHDR(m_map), key);
-	CF_ASSERT(result);
+	T* result = (T*)ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
 	CF_PLACEMENT_NEW(result) T(val);
 	return result;
 }
@@ -436,9 +451,7 @@ T* Map<T>::insert(uint64_t key, T&& val)
 {
 	T dummy;
 	CF_MEMSET(&dummy, 0, sizeof(T));
-	ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
-	T* result = (T*)ck_map_get_ptr_impl(CK_MHDR(m_map), key);
-	CF_ASSERT(result);
+	T* result = (T*)ck_map_set_stretchy((void**)&m_map, key, &dummy, (int)sizeof(T));
 	CF_PLACEMENT_NEW(result) T(cf_move(val));
 	return result;
 }
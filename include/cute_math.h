@@ -3291,6 +3291,114 @@ CF_API CF_Raycast CF_CALL cf_ray_to_capsule(CF_Ray A, CF_Capsule B);
  */
 CF_API CF_Raycast CF_CALL cf_ray_to_poly(CF_Ray A, const CF_Poly* B);
 
+// Batched collision detection functions.
+// These test one shape against many shapes stored as separate arrays of floats (structure of arrays),
+// several at a time with SIMD instructions where available. Results match the one-pair versions above.
+
+/**
+ * @struct   CF_CircleSoA
+ * @category collision
+ * @brief    Many circles stored as a structure of arrays, for the batched collision functions.
+ * @remarks  Each array holds `count` floats, one per circle. Keeping your circles in this layout lets the batched functions load several
+ *           at once.
+ * @related  CF_CircleSoA cf_circle_to_circles cf_ray_to_circles
+ */
+typedef struct CF_CircleSoA
+{
+	/* @member Center x-coordinates. */
+	const float* x;
+
+	/* @member Center y-coordinates. */
+	const float* y;
+
+	/* @member Radii. */
+	const float* r;
+
+	/* @member Number of circles. */
+	int count;
+} CF_CircleSoA;
+// @end
+
+/**
+ * @struct   CF_AabbSoA
+ * @category collision
+ * @brief    Many Aabb's stored as a structure of arrays, for the batched collision functions.
+ * @remarks  Each array holds `count` floats, one per box.
+ * @related  CF_AabbSoA cf_circle_to_aabbs cf_aabb_to_aabbs
+ */
+typedef struct CF_AabbSoA
+{
+	/* @member Minimum x-coordinates. */
+	const float* min_x;
+
+	/* @member Minimum y-coordinates. */
+	const float* min_y;
+
+	/* @member Maximum x-coordinates. */
+	const float* max_x;
+
+	/* @member Maximum y-coordinates. */
+	const float* max_y;
+
+	/* @member Number of boxes. */
+	int count;
+} CF_AabbSoA;
+// @end
+
+/**
+ * @function cf_circle_to_circles
+ * @category collision
+ * @brief    Tests one circle against many circles.
+ * @param    A          The circle.
+ * @param    B          The circles to test against.
+ * @param    hits       Written with the indices of intersecting circles in `B`, in increasing order. Must hold `B.count` elements.
+ * @return   Returns the number of indices written to `hits`.
+ * @remarks  Gives the same answer as calling `cf_circle_to_circle` once per circle in `B`, but tests several at a time with SIMD.
+ * @related  CF_CircleSoA cf_circle_to_circle cf_circle_to_circles cf_circle_to_aabbs cf_aabb_to_aabbs cf_ray_to_circles
+ */
+CF_API int CF_CALL cf_circle_to_circles(CF_Circle A, CF_CircleSoA B, int* hits);
+
+/**
+ * @function cf_circle_to_aabbs
+ * @category collision
+ * @brief    Tests one circle against many Aabb's.
+ * @param    A          The circle.
+ * @param    B          The boxes to test against.
+ * @param    hits       Written with the indices of intersecting boxes in `B`, in increasing order. Must hold `B.count` elements.
+ * @return   Returns the number of indices written to `hits`.
+ * @remarks  Gives the same answer as calling `cf_circle_to_aabb` once per box in `B`, but tests several at a time with SIMD.
+ * @related  CF_AabbSoA cf_circle_to_aabb cf_circle_to_circles cf_circle_to_aabbs cf_aabb_to_aabbs cf_ray_to_circles
+ */
+CF_API int CF_CALL cf_circle_to_aabbs(CF_Circle A, CF_AabbSoA B, int* hits);
+
+/**
+ * @function cf_aabb_to_aabbs
+ * @category collision
+ * @brief    Tests one Aabb against many Aabb's.
+ * @param    A          The box.
+ * @param    B          The boxes to test against.
+ * @param    hits       Written with the indices of intersecting boxes in `B`, in increasing order. Must hold `B.count` elements.
+ * @return   Returns the number of indices written to `hits`.
+ * @remarks  Gives the same answer as calling `cf_aabb_to_aabb` once per box in `B`, but tests several at a time with SIMD.
+ * @related  CF_AabbSoA cf_aabb_to_aabb cf_circle_to_circles cf_circle_to_aabbs cf_aabb_to_aabbs cf_ray_to_circles
+ */
+CF_API int CF_CALL cf_aabb_to_aabbs(CF_Aabb A, CF_AabbSoA B, int* hits);
+
+/**
+ * @function cf_ray_to_circles
+ * @category collision
+ * @brief    Raycasts against many circles.
+ * @param    A          The ray.
+ * @param    B          The circles to test against.
+ * @param    hits       Written with the indices of circles in `B` hit by the ray, in increasing order. Must hold `B.count` elements.
+ * @param    hit_t      Can be `NULL`. Otherwise written with the time of impact of each hit, matching `hits`. Must hold `B.count` elements.
+ * @return   Returns the number of indices written to `hits`.
+ * @remarks  Finds the same hits as calling `cf_ray_to_circle` once per circle in `B`, but tests several at a time with SIMD. Surface normals
+ *           aren't computed; call `cf_ray_to_circle` on the hit you end up using if you need one.
+ * @related  CF_CircleSoA cf_ray_to_circle cf_circle_to_circles cf_circle_to_aabbs cf_aabb_to_aabbs cf_ray_to_circles
+ */
+CF_API int CF_CALL cf_ray_to_circles(CF_Ray A, CF_CircleSoA B, int* hits, float* hit_t);
+
 /**
  * @function cf_circle_to_circle_manifold
  * @category collision
@@ -3557,10 +3665,256 @@ CF_API void CF_CALL cf_collide(const void* A, CF_ShapeType typeA, const void* B,
  * @param    typeB       The `CF_ShapeType` of the shape `B`.
  * @param    out         Can be `NULL`. `CF_Raycast` results are placed here (contains normal + time of impact).
  * @return   Returns true if the ray hit the shape.
- * @related  CF_Ray CF_Raycast CF_ShapeType cf_cast_ray
+ * @related  CF_Ray CF_Raycast CF_ShapeType cf_cast_ray cf_cast_rays
  */
 CF_API bool CF_CALL cf_cast_ray(CF_Ray A, const void* B, CF_ShapeType typeB, CF_Raycast* out);
 
+//--------------------------------------------------------------------------------------------------
+// AABB tree.
+
+/**
+ * @struct   CF_AabbTree
+ * @category collision
+ * @brief    A dynamic bounding volume hierarchy of `CF_Aabb`'s, for broadphase queries over many objects.
+ * @remarks  Pairwise tests like `cf_aabb_to_aabb` are O(n) per query, and O(n^2) to find all overlapping pairs. The tree answers "what's
+ *           near this box", "what does this ray pass through" and "which boxes overlap" in roughly O(log n) per result, so it's a good
+ *           fit for gameplay queries over thousands of objects that aren't physics bodies. This is Box2D's dynamic tree, the same one
+ *           that runs the physics broadphase.
+ *
+ *           Each leaf stores a fattened copy of its box, grown by the tree's margin. Moving a leaf only touches the tree once its box
+ *           leaves the fattened one, so objects jittering in place are nearly free. Queries test against the fattened boxes, so results
+ *           are conservative -- follow up with an exact test such as `cf_aabb_to_aabb` or `cf_circle_to_poly` when needed.
+ * @related  CF_AabbTree cf_make_aabb_tree cf_destroy_aabb_tree cf_aabb_tree_insert cf_aabb_tree_remove cf_aabb_tree_move cf_aabb_tree_query_aabb cf_aabb_tree_raycast cf_aabb_tree_find_pairs
+ */
+typedef struct CF_AabbTree CF_AabbTree;
+// @end
+
+/**
+ * @function cf_make_aabb_tree
+ * @category collision
+ * @brief    Returns a new, empty `CF_AabbTree`.
+ * @param    margin     How far to fatten each leaf's box on every side. Use something around the distance objects travel in a frame or
+ *                      two, or zero for no fattening.
+ * @related  CF_AabbTree cf_make_aabb_tree cf_destroy_aabb_tree
+ */
+CF_API CF_AabbTree* CF_CALL cf_make_aabb_tree(float margin);
+
+/**
+ * @function cf_destroy_aabb_tree
+ * @category collision
+ * @brief    Destroys a `CF_AabbTree` made by `cf_make_aabb_tree`.
+ * @related  CF_AabbTree cf_make_aabb_tree cf_destroy_aabb_tree
+ */
+CF_API void CF_CALL cf_destroy_aabb_tree(CF_AabbTree* tree);
+
+/**
+ * @function cf_aabb_tree_insert
+ * @category collision
+ * @brief    Inserts a box into the tree and returns the id of its new leaf.
+ * @param    tree       The tree.
+ * @param    aabb       The box.
+ * @param    udata      Any value you like, such as an index or a pointer, handed back by queries.
+ * @remarks  Leaf ids are non-negative and stay the same until the leaf is removed, after which they may be reused.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_remove cf_aabb_tree_move cf_aabb_tree_get_udata
+ */
+CF_API int CF_CALL cf_aabb_tree_insert(CF_AabbTree* tree, CF_Aabb aabb, uint64_t udata);
+
+/**
+ * @function cf_aabb_tree_remove
+ * @category collision
+ * @brief    Removes a leaf from the tree.
+ * @param    tree       The tree.
+ * @param    leaf       A leaf id from `cf_aabb_tree_insert`.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_remove cf_aabb_tree_move
+ */
+CF_API void CF_CALL cf_aabb_tree_remove(CF_AabbTree* tree, int leaf);
+
+/**
+ * @function cf_aabb_tree_move
+ * @category collision
+ * @brief    Updates the box of a leaf.
+ * @param    tree       The tree.
+ * @param    leaf       A leaf id from `cf_aabb_tree_insert`.
+ * @param    aabb       The new box.
+ * @return   Returns true if the leaf was re-inserted, false if `aabb` still fit within the leaf's fattened box and nothing changed.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_remove cf_aabb_tree_move cf_aabb_tree_get_fat_aabb
+ */
+CF_API bool CF_CALL cf_aabb_tree_move(CF_AabbTree* tree, int leaf, CF_Aabb aabb);
+
+/**
+ * @function cf_aabb_tree_get_fat_aabb
+ * @category collision
+ * @brief    Returns the fattened box stored for a leaf.
+ * @param    tree       The tree.
+ * @param    leaf       A leaf id from `cf_aabb_tree_insert`.
+ * @related  CF_AabbTree cf_aabb_tree_move cf_aabb_tree_get_fat_aabb cf_aabb_tree_get_udata
+ */
+CF_API CF_Aabb CF_CALL cf_aabb_tree_get_fat_aabb(const CF_AabbTree* tree, int leaf);
+
+/**
+ * @function cf_aabb_tree_get_udata
+ * @category collision
+ * @brief    Returns the `udata` a leaf was inserted with.
+ * @param    tree       The tree.
+ * @param    leaf       A leaf id from `cf_aabb_tree_insert`.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_get_fat_aabb cf_aabb_tree_get_udata
+ */
+CF_API uint64_t CF_CALL cf_aabb_tree_get_udata(const CF_AabbTree* tree, int leaf);
+
+/**
+ * @function cf_aabb_tree_count
+ * @category collision
+ * @brief    Returns the number of leaves in the tree.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_remove cf_aabb_tree_count
+ */
+CF_API int CF_CALL cf_aabb_tree_count(const CF_AabbTree* tree);
+
+/**
+ * @function cf_aabb_tree_rebuild
+ * @category collision
+ * @brief    Rebuilds the whole tree from scratch for faster queries.
+ * @param    tree       The tree.
+ * @remarks  Incremental inserts keep the tree reasonably balanced, but a full rebuild finds a better one. Worth calling after loading a
+ *           level full of static objects, or now and then for a tree that mostly moves.
+ * @related  CF_AabbTree cf_aabb_tree_insert cf_aabb_tree_rebuild
+ */
+CF_API void CF_CALL cf_aabb_tree_rebuild(CF_AabbTree* tree);
+
+/**
+ * @function CF_AabbTreeQueryFn
+ * @category collision
+ * @brief    Called once per leaf found by `cf_aabb_tree_query_aabb`.
+ * @param    leaf       The leaf id.
+ * @param    udata      The `udata` the leaf was inserted with.
+ * @param    fn_udata   The `fn_udata` passed to the query.
+ * @return   Return true to keep searching, or false to stop the query.
+ * @related  CF_AabbTreeQueryFn cf_aabb_tree_query_aabb
+ */
+typedef bool (CF_CALL CF_AabbTreeQueryFn)(int leaf, uint64_t udata, void* fn_udata);
+
+/**
+ * @function cf_aabb_tree_query_aabb
+ * @category collision
+ * @brief    Finds all leaves whose fattened box overlaps `aabb`.
+ * @param    tree       The tree.
+ * @param    aabb       The box to search with.
+ * @param    fn         Called once per overlapping leaf, see `CF_AabbTreeQueryFn`.
+ * @param    fn_udata   Can be `NULL`. Handed back to `fn`.
+ * @related  CF_AabbTree CF_AabbTreeQueryFn cf_aabb_tree_query_aabb cf_aabb_tree_raycast cf_aabb_tree_find_pairs
+ */
+CF_API void CF_CALL cf_aabb_tree_query_aabb(const CF_AabbTree* tree, CF_Aabb aabb, CF_AabbTreeQueryFn* fn, void* fn_udata);
+
+/**
+ * @function CF_AabbTreeRaycastFn
+ * @category collision
+ * @brief    Called once per leaf whose fattened box is hit by the ray in `cf_aabb_tree_raycast`.
+ * @param    leaf       The leaf id.
+ * @param    udata      The `udata` the leaf was inserted with.
+ * @param    ray        The ray, with `t` clipped to the closest distance returned so far.
+ * @param    fn_udata   The `fn_udata` passed to the raycast.
+ * @return   Usually you raycast the object in this leaf (e.g. with `cf_ray_to_poly`) and return the distance of the hit, which clips the
+ *           ray so farther leaves are skipped. Return `ray.t` to keep going without clipping, a negative value to ignore the leaf, or zero
+ *           to stop the raycast.
+ * @related  CF_AabbTreeRaycastFn cf_aabb_tree_raycast
+ */
+typedef float (CF_CALL CF_AabbTreeRaycastFn)(int leaf, uint64_t udata, CF_Ray ray, void* fn_udata);
+
+/**
+ * @function cf_aabb_tree_raycast
+ * @category collision
+ * @brief    Finds the leaves a ray passes through, nearest-first pruning as the callback reports hits.
+ * @param    tree       The tree.
+ * @param    ray        The ray.
+ * @param    fn         Called once per leaf, see `CF_AabbTreeRaycastFn`.
+ * @param    fn_udata   Can be `NULL`. Handed back to `fn`.
+ * @remarks  Leaves are not visited in distance order. To find the closest hit, return each hit's distance from `fn` and keep the smallest.
+ * @related  CF_AabbTree CF_AabbTreeRaycastFn cf_aabb_tree_raycast cf_aabb_tree_query_aabb
+ */
+CF_API void CF_CALL cf_aabb_tree_raycast(const CF_AabbTree* tree, CF_Ray ray, CF_AabbTreeRaycastFn* fn, void* fn_udata);
+
+/**
+ * @function CF_AabbTreePairFn
+ * @category collision
+ * @brief    Called once per overlapping pair of leaves found by `cf_aabb_tree_find_pairs`.
+ * @param    leaf_a     The first leaf id.
+ * @param    udata_a    The `udata` of the first leaf.
+ * @param    leaf_b     The second leaf id.
+ * @param    udata_b    The `udata` of the second leaf.
+ * @param    fn_udata   The `fn_udata` passed to `cf_aabb_tree_find_pairs`.
+ * @related  CF_AabbTreePairFn cf_aabb_tree_find_pairs
+ */
+typedef void (CF_CALL CF_AabbTreePairFn)(int leaf_a, uint64_t udata_a, int leaf_b, uint64_t udata_b, void* fn_udata);
+
+/**
+ * @function cf_aabb_tree_find_pairs
+ * @category collision
+ * @brief    Finds every pair of leaves with overlapping fattened boxes, reporting each pair once.
+ * @param    tree       The tree.
+ * @param    fn         Called once per pair, see `CF_AabbTreePairFn`.
+ * @param    fn_udata   Can be `NULL`. Handed back to `fn`.
+ * @return   Returns the number of pairs found.
+ * @remarks  Each leaf queries the tree once, so this costs about O(n log n) rather than the O(n^2) of testing every pair. `leaf_a` is
+ *           always less than `leaf_b`.
+ * @related  CF_AabbTree CF_AabbTreePairFn cf_aabb_tree_find_pairs cf_aabb_tree_query_aabb
+ */
+CF_API int CF_CALL cf_aabb_tree_find_pairs(const CF_AabbTree* tree, CF_AabbTreePairFn* fn, void* fn_udata);
+
+//--------------------------------------------------------------------------------------------------
+// Batched raycasts.
+
+// Declared here to keep the threading headers out of cute_math.h, see cute_multithreading.h.
+typedef struct cute_threadpool_t cute_threadpool_t;
+typedef cute_threadpool_t CF_Threadpool;
+
+/**
+ * @struct   CF_RayHit
+ * @category collision
+ * @brief    The closest hit of one ray in `cf_cast_rays` or `cf_cast_rays_tree`.
+ * @related  CF_RayHit cf_cast_rays cf_cast_rays_tree
+ */
+typedef struct CF_RayHit
+{
+	/* @member Index of the closest shape hit, or -1 if the ray hit nothing. */
+	int index;
+
+	/* @member The raycast against that shape, with time of impact and normal. `raycast.hit` is false if the ray hit nothing. */
+	CF_Raycast raycast;
+} CF_RayHit;
+// @end
+
+/**
+ * @function cf_cast_rays
+ * @category collision
+ * @brief    Finds the closest shape hit by each of many rays.
+ * @param    rays         The rays.
+ * @param    ray_count    The number of elements in `rays`.
+ * @param    shapes       An array of shapes, all of type `type`. For example a `CF_Circle*` when `type` is `CF_SHAPE_TYPE_CIRCLE`.
+ * @param    type         The `CF_ShapeType` of every shape in `shapes`.
+ * @param    shape_count  The number of elements in `shapes`.
+ * @param    hits         Written with the closest hit of each ray. Must hold `ray_count` elements.
+ * @param    pool         Can be `NULL` to cast all rays on the calling thread. Otherwise the rays are split across the threadpool.
+ * @remarks  Each ray is clipped to its closest hit so far, so shapes further along are skipped cheaply. Every ray still visits every shape;
+ *           for more than a few hundred shapes put them in a `CF_AabbTree` and use `cf_cast_rays_tree` instead.
+ * @related  CF_RayHit cf_cast_ray cf_cast_rays cf_cast_rays_tree
+ */
+CF_API void CF_CALL cf_cast_rays(const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, int shape_count, CF_RayHit* hits, CF_Threadpool* pool);
+
+/**
+ * @function cf_cast_rays_tree
+ * @category collision
+ * @brief    Finds the closest shape hit by each of many rays, using a `CF_AabbTree` to skip shapes far from each ray.
+ * @param    tree         The tree. Each leaf's `udata` must be the index of its shape in `shapes`.
+ * @param    rays         The rays.
+ * @param    ray_count    The number of elements in `rays`.
+ * @param    shapes       An array of shapes, all of type `type`.
+ * @param    type         The `CF_ShapeType` of every shape in `shapes`.
+ * @param    hits         Written with the closest hit of each ray. `index` is the hit shape's index in `shapes`. Must hold `ray_count` elements.
+ * @param    pool         Can be `NULL` to cast all rays on the calling thread. Otherwise the rays are split across the threadpool.
+ * @remarks  Each ray is clipped to its closest hit so far, so the tree stops visiting leaves further along the ray.
+ * @related  CF_RayHit CF_AabbTree cf_cast_rays cf_cast_rays_tree cf_aabb_tree_raycast
+ */
+CF_API void CF_CALL cf_cast_rays_tree(const CF_AabbTree* tree, const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, CF_RayHit* hits, CF_Threadpool* pool);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -3786,6 +4140,14 @@ CF_INLINE CF_Raycast ray_to_aabb(CF_Ray A, CF_Aabb B) { return cf_ray_to_aabb(A,
 CF_INLINE CF_Raycast ray_to_capsule(CF_Ray A, CF_Capsule B) { return cf_ray_to_capsule(A, B); }
 CF_INLINE CF_Raycast ray_to_poly(CF_Ray A, const CF_Poly* B) { return cf_ray_to_poly(A, B); }
 
+using CircleSoA = CF_CircleSoA;
+using AabbSoA = CF_AabbSoA;
+
+CF_INLINE int circle_to_circles(CF_Circle A, CircleSoA B, int* hits) { return cf_circle_to_circles(A, B, hits); }
+CF_INLINE int circle_to_aabbs(CF_Circle A, AabbSoA B, int* hits) { return cf_circle_to_aabbs(A, B, hits); }
+CF_INLINE int aabb_to_aabbs(CF_Aabb A, AabbSoA B, int* hits) { return cf_aabb_to_aabbs(A, B, hits); }
+CF_INLINE int ray_to_circles(CF_Ray A, CircleSoA B, int* hits, float* hit_t = NULL) { return cf_ray_to_circles(A, B, hits, hit_t); }
+
 CF_INLINE CF_Manifold circle_to_circle_manifold(CF_Circle A, CF_Circle B) { return cf_circle_to_circle_manifold(A, B); }
 CF_INLINE CF_Manifold circle_to_aabb_manifold(CF_Circle A, CF_Aabb B) { return cf_circle_to_aabb_manifold(A, B); }
 CF_INLINE CF_Manifold circle_to_capsule_manifold(CF_Circle A, CF_Capsule B) { return cf_circle_to_capsule_manifold(A, B); }
@@ -3811,6 +4173,24 @@ CF_INLINE int collided(const void* A, CF_ShapeType typeA, const void* B, CF_Shap
 CF_INLINE void collide(const void* A, CF_ShapeType typeA, const void* B, CF_ShapeType typeB, CF_Manifold* m) { return cf_collide(A, typeA, B, typeB, m); }
 CF_INLINE bool cast_ray(CF_Ray A, const void* B, CF_ShapeType typeB, CF_Raycast* out) { return cf_cast_ray(A, B, typeB, out); }
 
+using AabbTree = CF_AabbTree;
+CF_INLINE AabbTree* make_aabb_tree(float margin) { return cf_make_aabb_tree(margin); }
+CF_INLINE void destroy_aabb_tree(AabbTree* tree) { cf_destroy_aabb_tree(tree); }
+CF_INLINE int aabb_tree_insert(AabbTree* tree, CF_Aabb aabb, uint64_t udata) { return cf_aabb_tree_insert(tree, aabb, udata); }
+CF_INLINE void aabb_tree_remove(AabbTree* tree, int leaf) { cf_aabb_tree_remove(tree, leaf); }
+CF_INLINE bool aabb_tree_move(AabbTree* tree, int leaf, CF_Aabb aabb) { return cf_aabb_tree_move(tree, leaf, aabb); }
+CF_INLINE CF_Aabb aabb_tree_get_fat_aabb(const AabbTree* tree, int leaf) { return cf_aabb_tree_get_fat_aabb(tree, leaf); }
+CF_INLINE uint64_t aabb_tree_get_udata(const AabbTree* tree, int leaf) { return cf_aabb_tree_get_udata(tree, leaf); }
+CF_INLINE int aabb_tree_count(const AabbTree* tree) { return cf_aabb_tree_count(tree); }
+CF_INLINE void aabb_tree_rebuild(AabbTree* tree) { cf_aabb_tree_rebuild(tree); }
+CF_INLINE void aabb_tree_query_aabb(const AabbTree* tree, CF_Aabb aabb, CF_AabbTreeQueryFn* fn, void* fn_udata) { cf_aabb_tree_query_aabb(tree, aabb, fn, fn_udata); }
+CF_INLINE void aabb_tree_raycast(const AabbTree* tree, CF_Ray ray, CF_AabbTreeRaycastFn* fn, void* fn_udata) { cf_aabb_tree_raycast(tree, ray, fn, fn_udata); }
+CF_INLINE int aabb_tree_find_pairs(const AabbTree* tree, CF_AabbTreePairFn* fn, void* fn_udata) { return cf_aabb_tree_find_pairs(tree, fn, fn_udata); }
+
+using RayHit = CF_RayHit;
+CF_INLINE void cast_rays(const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, int shape_count, RayHit* hits, CF_Threadpool* pool = NULL) { cf_cast_rays(rays, ray_count, shapes, type, shape_count, hits, pool); }
+CF_INLINE void cast_rays_tree(const AabbTree* tree, const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, RayHit* hits, CF_Threadpool* pool = NULL) { cf_cast_rays_tree(tree, rays, ray_count, shapes, type, hits, pool); }
+
 }
 
 CF_INLINE Cute::v2 operator+(Cute::v2 a, Cute::v2 b) { return V2(a.x + b.x, a.y + b.y); }
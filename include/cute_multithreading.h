@@ -10,6 +10,7 @@
 
 #include "cute_defines.h"
 #include "cute_result.h"
+#include "cute_alloc.h"
 
 #include "cute/cute_sync.h"
 
@@ -48,6 +49,81 @@ typedef cute_cv_t CF_ConditionVariable;
 typedef cute_atomic_int_t CF_AtomicInt;
 // @end
 
+/**
+ * @struct   CF_AtomicInt64
+ * @category atomic
+ * @brief    An opaque handle representing a 64-bit atomic integer.
+ * @remarks  Useful for values that must never wrap, such as ever-increasing indices or byte counters. Atomics are an advanced
+ *           topic. You've been warned!
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+typedef cute_atomic64_t CF_AtomicInt64;
+// @end
+
+/**
+ * @struct   CF_SPSCQueue
+ * @category multithreading
+ * @brief    An opaque handle representing a bounded, lock-free, single-producer single-consumer queue.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+typedef struct CF_SPSCQueue CF_SPSCQueue;
+// @end
+
+/**
+ * @struct   CF_MPMCQueue
+ * @category multithreading
+ * @brief    An opaque handle representing a bounded, lock-free, multi-producer multi-consumer queue.
+ * @related  CF_MPMCQueue cf_make_mpmc_queue cf_destroy_mpmc_queue cf_mpmc_queue_push cf_mpmc_queue_pop
+ */
+typedef struct CF_MPMCQueue CF_MPMCQueue;
+// @end
+
+/**
+ * @struct   CF_MPSCNode
+ * @category multithreading
+ * @brief    A link embedded into your own struct to place it into a `CF_MPSCQueue`.
+ * @example  > Embedding a node, and getting back to the containing struct after a pop.
+ *     struct Message
+ *     {
+ *         CF_MPSCNode node;
+ *         int payload;
+ *     };
+ *
+ *     CF_MPSCNode* node = cf_mpsc_queue_pop(queue);
+ *     if (node) {
+ *         Message* msg = (Message*)((char*)node - offsetof(Message, node));
+ *     }
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+typedef struct CF_MPSCNode
+{
+	/* @member Used internally by the queue. */
+	struct CF_MPSCNode* next;
+} CF_MPSCNode;
+// @end
+
+/**
+ * @struct   CF_MPSCQueue
+ * @category multithreading
+ * @brief    An opaque handle representing an unbounded, lock-free, multi-producer single-consumer intrusive queue.
+ * @remarks  The queue never allocates -- elements are linked through a `CF_MPSCNode` you embed in your own struct.
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+typedef struct CF_MPSCQueue CF_MPSCQueue;
+// @end
+
+/**
+ * @struct   CF_ConcurrentPool
+ * @category multithreading
+ * @brief    An opaque handle representing a fixed-size element allocator that any thread may allocate from or free to.
+ * @remarks  The thread-safe counterpart of `CF_MemoryPool`. Each thread keeps a couple of small batches of free elements
+ *           (magazines), so nearly all allocations and frees touch only thread-local memory. Full and empty magazines are
+ *           traded through a shared lock-free depot, and the pool grows a block at a time when the depot runs dry.
+ * @related  CF_ConcurrentPool cf_make_concurrent_pool cf_destroy_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free cf_concurrent_pool_stats
+ */
+typedef struct CF_ConcurrentPool CF_ConcurrentPool;
+// @end
+
 /**
  * @struct   CF_Semaphore
  * @category multithreading
@@ -106,11 +182,25 @@ typedef cute_rw_lock_t CF_ReadWriteLock;
  * @struct   CF_Threadpool
  * @category multithreading
  * @brief    An opaque handle representing a threadpool.
+ * @remarks  Each worker thread owns a lock-free work-stealing deque. Workers run their own tasks first, and steal from each other
+ *           when they run dry, so fetching a task never takes a lock.
  * @related  CF_Threadpool CF_TaskFn cf_make_threadpool cf_destroy_threadpool cf_threadpool_add_task cf_threadpool_kick_and_wait cf_threadpool_kick
  */
 typedef cute_threadpool_t CF_Threadpool;
 // @end
 
+/**
+ * @struct   CF_JobCounter
+ * @category multithreading
+ * @brief    An atomic count of unfinished jobs in a `CF_Threadpool`, used as a wait group.
+ * @remarks  Initialize with `cf_make_job_counter`. Each call to `cf_threadpool_add_job` increments the counter, and the counter is decremented
+ *           once the job finishes. Use `cf_threadpool_wait_counter` to wait on the whole group. The counter can be inspected at any
+ *           time with `cf_atomic_get`.
+ * @related  CF_JobCounter cf_make_job_counter cf_threadpool_add_job cf_threadpool_wait_counter cf_parallel_for
+ */
+typedef cute_atomic_int_t CF_JobCounter;
+// @end
+
 /**
  * @function cf_make_mutex
  * @category multithreading
@@ -440,6 +530,60 @@ CF_API void* CF_CALL cf_atomic_ptr_get(void** atomic);
  */
 CF_API CF_Result CF_CALL cf_atomic_ptr_cas(void** atomic, void* expected, void* value);
 
+/**
+ * @function cf_atomic64_zero
+ * @category atomic
+ * @brief    Returns a 64-bit atomic integer of value zero.
+ * @remarks  Atomics are an advanced topic. You've been warned!
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+CF_API CF_AtomicInt64 CF_CALL cf_atomic64_zero(void);
+
+/**
+ * @function cf_atomic64_add
+ * @category atomic
+ * @brief    Atomically adds `addend` to `atomic` and returns the old value from `atomic`.
+ * @param    atomic     The integer to atomically manipulate.
+ * @param    addend     A value to atomically add to `atomic`.
+ * @remarks  Atomics are an advanced topic. You've been warned! Beej has a [good article on atomics](https://beej.us/guide/bgc/html/split/chapter-atomics.html).
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+CF_API int64_t CF_CALL cf_atomic64_add(CF_AtomicInt64* atomic, int64_t addend);
+
+/**
+ * @function cf_atomic64_set
+ * @category atomic
+ * @brief    Atomically sets `atomic` to `value` and returns the old value from `atomic`.
+ * @param    atomic     The integer to atomically manipulate.
+ * @param    value      A value to atomically set to `atomic`.
+ * @remarks  Atomics are an advanced topic. You've been warned! Beej has a [good article on atomics](https://beej.us/guide/bgc/html/split/chapter-atomics.html).
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+CF_API int64_t CF_CALL cf_atomic64_set(CF_AtomicInt64* atomic, int64_t value);
+
+/**
+ * @function cf_atomic64_get
+ * @category atomic
+ * @brief    Atomically fetches the value at `atomic`.
+ * @param    atomic     The integer to fetch from.
+ * @remarks  Atomics are an advanced topic. You've been warned! Beej has a [good article on atomics](https://beej.us/guide/bgc/html/split/chapter-atomics.html).
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+CF_API int64_t CF_CALL cf_atomic64_get(CF_AtomicInt64* atomic);
+
+/**
+ * @function cf_atomic64_cas
+ * @category atomic
+ * @brief    Atomically sets `atomic` to `value` if `expected` equals `atomic`.
+ * @param    atomic     The integer to atomically manipulate.
+ * @param    expected   Used to compare against `atomic`.
+ * @param    value      A value to atomically set to `atomic`.
+ * @return   Returns success if the value was set, error otherwise.
+ * @remarks  Atomics are an advanced topic. You've been warned! Beej has a [good article on atomics](https://beej.us/guide/bgc/html/split/chapter-atomics.html).
+ * @related  CF_AtomicInt64 cf_atomic64_zero cf_atomic64_add cf_atomic64_set cf_atomic64_get cf_atomic64_cas
+ */
+CF_API CF_Result CF_CALL cf_atomic64_cas(CF_AtomicInt64* atomic, int64_t expected, int64_t value);
+
 /**
  * @function cf_make_rw_lock
  * @category multithreading
@@ -498,6 +642,204 @@ CF_API void CF_CALL cf_write_lock(CF_ReadWriteLock* rw);
  */
 CF_API void CF_CALL cf_write_unlock(CF_ReadWriteLock* rw);
 
+/**
+ * @function cf_make_spsc_queue
+ * @category multithreading
+ * @brief    Returns a new `CF_SPSCQueue`, a fixed-size lock-free queue for exactly one producer thread and one consumer thread.
+ * @param    capacity      The most elements the queue can hold at once. Rounded up to a power of two.
+ * @param    element_size  The size of each element in bytes. Elements are copied in and out of the queue.
+ * @remarks  Only one thread may call `cf_spsc_queue_push`, and only one (other) thread may call `cf_spsc_queue_pop`. This is the
+ *           cheapest queue available, a good fit for handing commands to a dedicated thread (e.g. audio). Destroy the queue with
+ *           `cf_destroy_spsc_queue` when done.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+CF_API CF_SPSCQueue* CF_CALL cf_make_spsc_queue(int capacity, int element_size);
+
+/**
+ * @function cf_destroy_spsc_queue
+ * @category multithreading
+ * @brief    Destroys a `CF_SPSCQueue` created by `cf_make_spsc_queue`.
+ * @param    queue      The queue.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+CF_API void CF_CALL cf_destroy_spsc_queue(CF_SPSCQueue* queue);
+
+/**
+ * @function cf_spsc_queue_push
+ * @category multithreading
+ * @brief    Copies an element onto the back of the queue. Producer thread only.
+ * @param    queue      The queue.
+ * @param    element    Pointer to `element_size` bytes to copy in.
+ * @return   Returns false if the queue is full, in which case nothing was pushed.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+CF_API bool CF_CALL cf_spsc_queue_push(CF_SPSCQueue* queue, const void* element);
+
+/**
+ * @function cf_spsc_queue_pop
+ * @category multithreading
+ * @brief    Copies the front element out of the queue and removes it. Consumer thread only.
+ * @param    queue      The queue.
+ * @param    element    Pointer to `element_size` bytes to copy out to.
+ * @return   Returns false if the queue is empty.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+CF_API bool CF_CALL cf_spsc_queue_pop(CF_SPSCQueue* queue, void* element);
+
+/**
+ * @function cf_spsc_queue_count
+ * @category multithreading
+ * @brief    Returns the number of elements in the queue.
+ * @param    queue      The queue.
+ * @remarks  Only a snapshot, as the other thread may be pushing or popping concurrently.
+ * @related  CF_SPSCQueue cf_make_spsc_queue cf_destroy_spsc_queue cf_spsc_queue_push cf_spsc_queue_pop cf_spsc_queue_count
+ */
+CF_API int CF_CALL cf_spsc_queue_count(CF_SPSCQueue* queue);
+
+/**
+ * @function cf_make_mpmc_queue
+ * @category multithreading
+ * @brief    Returns a new `CF_MPMCQueue`, a fixed-size lock-free queue any number of threads can push to and pop from.
+ * @param    capacity      The most elements the queue can hold at once. Rounded up to a power of two.
+ * @param    element_size  The size of each element in bytes. Elements are copied in and out of the queue.
+ * @remarks  Based on Dmitry Vyukov's bounded MPMC queue. Each slot carries a sequence number, so producers and consumers only contend
+ *           on a single CAS each. Destroy the queue with `cf_destroy_mpmc_queue` when done.
+ * @related  CF_MPMCQueue cf_make_mpmc_queue cf_destroy_mpmc_queue cf_mpmc_queue_push cf_mpmc_queue_pop
+ */
+CF_API CF_MPMCQueue* CF_CALL cf_make_mpmc_queue(int capacity, int element_size);
+
+/**
+ * @function cf_destroy_mpmc_queue
+ * @category multithreading
+ * @brief    Destroys a `CF_MPMCQueue` created by `cf_make_mpmc_queue`.
+ * @param    queue      The queue.
+ * @related  CF_MPMCQueue cf_make_mpmc_queue cf_destroy_mpmc_queue cf_mpmc_queue_push cf_mpmc_queue_pop
+ */
+CF_API void CF_CALL cf_destroy_mpmc_queue(CF_MPMCQueue* queue);
+
+/**
+ * @function cf_mpmc_queue_push
+ * @category multithreading
+ * @brief    Copies an element onto the back of the queue. Safe to call from any thread.
+ * @param    queue      The queue.
+ * @param    element    Pointer to `element_size` bytes to copy in.
+ * @return   Returns false if the queue is full, in which case nothing was pushed.
+ * @related  CF_MPMCQueue cf_make_mpmc_queue cf_destroy_mpmc_queue cf_mpmc_queue_push cf_mpmc_queue_pop
+ */
+CF_API bool CF_CALL cf_mpmc_queue_push(CF_MPMCQueue* queue, const void* element);
+
+/**
+ * @function cf_mpmc_queue_pop
+ * @category multithreading
+ * @brief    Copies the front element out of the queue and removes it. Safe to call from any thread.
+ * @param    queue      The queue.
+ * @param    element    Pointer to `element_size` bytes to copy out to.
+ * @return   Returns false if the queue is empty.
+ * @related  CF_MPMCQueue cf_make_mpmc_queue cf_destroy_mpmc_queue cf_mpmc_queue_push cf_mpmc_queue_pop
+ */
+CF_API bool CF_CALL cf_mpmc_queue_pop(CF_MPMCQueue* queue, void* element);
+
+/**
+ * @function cf_make_mpsc_queue
+ * @category multithreading
+ * @brief    Returns a new, empty `CF_MPSCQueue`. Any number of threads may push, but only one thread may pop.
+ * @remarks  Based on Dmitry Vyukov's intrusive MPSC queue. Pushing is a single atomic exchange and never fails. Destroy the queue with
+ *           `cf_destroy_mpsc_queue` when done.
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+CF_API CF_MPSCQueue* CF_CALL cf_make_mpsc_queue(void);
+
+/**
+ * @function cf_destroy_mpsc_queue
+ * @category multithreading
+ * @brief    Destroys a `CF_MPSCQueue` created by `cf_make_mpsc_queue`.
+ * @param    queue      The queue.
+ * @remarks  Nodes still in the queue are owned by you, and are left untouched.
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+CF_API void CF_CALL cf_destroy_mpsc_queue(CF_MPSCQueue* queue);
+
+/**
+ * @function cf_mpsc_queue_push
+ * @category multithreading
+ * @brief    Links `node` onto the back of the queue. Safe to call from any thread.
+ * @param    queue      The queue.
+ * @param    node       A node embedded in your own struct, see `CF_MPSCNode`. Must stay alive until popped.
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+CF_API void CF_CALL cf_mpsc_queue_push(CF_MPSCQueue* queue, CF_MPSCNode* node);
+
+/**
+ * @function cf_mpsc_queue_pop
+ * @category multithreading
+ * @brief    Unlinks the front node of the queue. Consumer thread only.
+ * @param    queue      The queue.
+ * @return   Returns the node, or `NULL` if the queue is empty.
+ * @remarks  Can briefly return `NULL` while a producer is midway through `cf_mpsc_queue_push`, even though its node is nearly in the
+ *           queue. Just try again later, e.g. next frame.
+ * @related  CF_MPSCNode CF_MPSCQueue cf_make_mpsc_queue cf_destroy_mpsc_queue cf_mpsc_queue_push cf_mpsc_queue_pop
+ */
+CF_API CF_MPSCNode* CF_CALL cf_mpsc_queue_pop(CF_MPSCQueue* queue);
+
+/**
+ * @function cf_make_concurrent_pool
+ * @category multithreading
+ * @brief    Creates a thread-safe pool of fixed-size elements.
+ * @param    element_size   The size of each allocation.
+ * @param    element_count  The number of elements in each internal block. The pool grows one block at a time.
+ * @param    alignment      An alignment boundary, must be a power of two.
+ * @return   Returns a pool pointer. Free it with `cf_destroy_concurrent_pool`.
+ * @remarks  Good for objects allocated and freed from many threads at high rates, such as job payloads, network packets or
+ *           particles. Elements freed on one thread may be allocated again on another.
+ *
+ *           The first 64 threads to use any concurrent pool get lock-free per-thread caches; a thread that exits hands its
+ *           slot on to the next. Threads beyond that still work correctly, but take a lock on every call.
+ * @related  CF_ConcurrentPool cf_make_concurrent_pool cf_destroy_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free cf_concurrent_pool_stats
+ */
+CF_API CF_ConcurrentPool* CF_CALL cf_make_concurrent_pool(int element_size, int element_count, int alignment);
+
+/**
+ * @function cf_destroy_concurrent_pool
+ * @category multithreading
+ * @brief    Destroys a pool created by `cf_make_concurrent_pool`, along with every element allocated from it.
+ * @param    pool           The pool.
+ * @remarks  No other thread may be using the pool at the same time.
+ * @related  CF_ConcurrentPool cf_make_concurrent_pool cf_destroy_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free cf_concurrent_pool_stats
+ */
+CF_API void CF_CALL cf_destroy_concurrent_pool(CF_ConcurrentPool* pool);
+
+/**
+ * @function cf_concurrent_pool_alloc
+ * @category multithreading
+ * @brief    Allocates one element from the pool. Safe to call from any thread.
+ * @param    pool           The pool.
+ * @return   Returns an aligned pointer of `element_size` bytes. The memory is not cleared.
+ * @related  CF_ConcurrentPool cf_make_concurrent_pool cf_destroy_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free cf_concurrent_pool_stats
+ */
+CF_API void* CF_CALL cf_concurrent_pool_alloc(CF_ConcurrentPool* pool);
+
+/**
+ * @function cf_concurrent_pool_free
+ * @category multithreading
+ * @brief    Returns an element to the pool. Safe to call from any thread, not just the one that allocated it.
+ * @param    pool           The pool.
+ * @param    element        The element to free, from `cf_concurrent_pool_alloc`.
+ * @related  CF_ConcurrentPool cf_make_concurrent_pool cf_destroy_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free cf_concurrent_pool_stats
+ */
+CF_API void CF_CALL cf_concurrent_pool_free(CF_ConcurrentPool* pool, void* element);
+
+/**
+ * @function cf_concurrent_pool_stats
+ * @category multithreading
+ * @brief    Returns usage counters for the pool.
+ * @param    pool           The pool.
+ * @remarks  Counters are gathered from every thread's cache without stopping them, so while other threads are busy the result
+ *           is a close estimate rather than an exact snapshot. `high_water_mark` is sampled whenever a thread trades magazines
+ *           with the depot, so it can trail the true peak by about one magazine (32 elements) per thread.
+ * @related  CF_ConcurrentPool CF_MemoryPoolStats cf_make_concurrent_pool cf_concurrent_pool_alloc cf_concurrent_pool_free
+ */
+CF_API CF_MemoryPoolStats CF_CALL cf_concurrent_pool_stats(CF_ConcurrentPool* pool);
+
 /**
  * @function CF_TaskFn
  * @category multithreading
@@ -532,6 +874,17 @@ CF_API CF_Threadpool* CF_CALL cf_make_threadpool(int thread_count);
  */
 CF_API void CF_CALL cf_destroy_threadpool(CF_Threadpool* pool);
 
+/**
+ * @function cf_threadpool_thread_count
+ * @category multithreading
+ * @brief    Returns the number of threads the pool was made with, see `cf_make_threadpool`.
+ * @param    pool       The pool.
+ * @remarks  Threads waiting on the pool with `cf_threadpool_kick_and_wait` or `cf_threadpool_wait_counter` run tasks too, so a pool of
+ *           `n` threads can have `n + 1` tasks in flight at once.
+ * @related  cf_make_threadpool cf_threadpool_thread_count cf_core_count
+ */
+CF_API int CF_CALL cf_threadpool_thread_count(CF_Threadpool* pool);
+
 /**
  * @function cf_threadpool_add_task
  * @category multithreading
@@ -540,7 +893,8 @@ CF_API void CF_CALL cf_destroy_threadpool(CF_Threadpool* pool);
  * @param    task       The task for a thread in the pool to perform.
  * @param    param      Can be `NULL`. This gets handed to the `CF_TaskFn` when it gets called.
  * @remarks  Once a task is added to the pool `cf_threadpool_kick_and_wait` or `cf_threadpool_kick` must be called to wake threads. Once
- *           awake, threads will process the tasks. The order of start/finish for the tasks is not deterministic.
+ *           awake, threads will process the tasks. The order of start/finish for the tasks is not deterministic. Tasks may add more
+ *           tasks -- these go onto the calling worker's own deque without any locking.
  * @related  CF_TaskFn cf_make_threadpool cf_destroy_threadpool cf_threadpool_add_task cf_threadpool_kick_and_wait cf_threadpool_kick
  */
 CF_API void CF_CALL cf_threadpool_add_task(CF_Threadpool* pool, CF_TaskFn* task, void* param);
@@ -550,7 +904,8 @@ CF_API void CF_CALL cf_threadpool_add_task(CF_Threadpool* pool, CF_TaskFn* task,
  * @category multithreading
  * @brief    Tells the internal threads to wake and start processing tasks, and blocks until all tasks are done.
  * @param    pool       The pool.
- * @remarks  This function will block until all tasks are completed.
+ * @remarks  This function will block until all tasks are completed, including tasks still running on worker threads. The calling
+ *           thread helps run tasks while waiting. Do not call this from within a task running on the same pool.
  * @related  CF_TaskFn cf_make_threadpool cf_destroy_threadpool cf_threadpool_add_task cf_threadpool_kick_and_wait cf_threadpool_kick
  */
 CF_API void CF_CALL cf_threadpool_kick_and_wait(CF_Threadpool* pool);
@@ -565,6 +920,99 @@ CF_API void CF_CALL cf_threadpool_kick_and_wait(CF_Threadpool* pool);
  */
 CF_API void CF_CALL cf_threadpool_kick(CF_Threadpool* pool);
 
+/**
+ * @function cf_make_job_counter
+ * @category multithreading
+ * @brief    Returns a `CF_JobCounter` of value zero.
+ * @related  CF_JobCounter cf_make_job_counter cf_threadpool_add_job cf_threadpool_wait_counter cf_parallel_for
+ */
+CF_API CF_JobCounter CF_CALL cf_make_job_counter(void);
+
+/**
+ * @function cf_threadpool_add_job
+ * @category multithreading
+ * @brief    Adds a `CF_TaskFn` to the threadpool as part of a group tracked by `counter`.
+ * @param    pool       The pool.
+ * @param    task       The task for a thread in the pool to perform.
+ * @param    param      Can be `NULL`. This gets handed to the `CF_TaskFn` when it gets called.
+ * @param    counter    Incremented now, and decremented once the job finishes. Must stay alive until it reaches zero.
+ * @remarks  Many jobs can share one counter. Wait on the group with `cf_threadpool_wait_counter`, or poll it with `cf_atomic_get`.
+ *           Like `cf_threadpool_add_task` the job starts once the pool is kicked -- `cf_threadpool_wait_counter` kicks for you.
+ * @related  CF_JobCounter cf_make_job_counter cf_threadpool_add_job cf_threadpool_wait_counter cf_parallel_for
+ */
+CF_API void CF_CALL cf_threadpool_add_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter);
+
+/**
+ * @function cf_threadpool_wait_counter
+ * @category multithreading
+ * @brief    Kicks the pool and waits until `counter` reaches zero.
+ * @param    pool       The pool.
+ * @param    counter    The counter to wait on.
+ * @remarks  Rather than sleeping, the calling thread runs other jobs from the pool while it waits. Unlike `cf_threadpool_kick_and_wait`
+ *           this is safe to call from within a job, which is how one job can depend on the results of others. Called from within a
+ *           fiber job (see `cf_threadpool_add_fiber_job`) the fiber is suspended instead, and the worker moves on to other jobs. A
+ *           fiber only sleeps until `counter` reaches zero when `counter` tracks jobs of its own pool, otherwise it re-checks it
+ *           each time around the pool's queue.
+ * @related  CF_JobCounter cf_make_job_counter cf_threadpool_add_job cf_threadpool_wait_counter cf_parallel_for cf_threadpool_add_fiber_job
+ */
+CF_API void CF_CALL cf_threadpool_wait_counter(CF_Threadpool* pool, CF_JobCounter* counter);
+
+/**
+ * @function cf_threadpool_add_fiber_job
+ * @category multithreading
+ * @brief    Same as `cf_threadpool_add_job`, but the job runs on its own stack and can be suspended while it waits.
+ * @param    pool       The pool.
+ * @param    task       The task for a thread in the pool to perform.
+ * @param    param      Can be `NULL`. This gets handed to the `CF_TaskFn` when it gets called.
+ * @param    counter    Can be `NULL`. Incremented now, and decremented once the job finishes. Must stay alive until it reaches zero.
+ * @remarks  Fiber jobs run on pooled coroutine stacks (see `CF_Coroutine`). When a fiber job calls `cf_threadpool_wait_counter` it is
+ *           suspended and held by the pool until the counter reaches zero, freeing the worker to run something else (or sleep).
+ *           `cf_fiber_job_yield` instead re-queues the fiber behind the pool's other jobs. This is a good fit for long chains of
+ *           dependent jobs such as asset loading, where regular jobs waiting on each other would pile up on the workers' call stacks.
+ *           A suspended fiber job may resume on a different thread, and thread-local state doesn't follow it. Don't keep pointers to
+ *           thread-local data across a wait, and don't let a `CF_ALLOC_TAG_SCOPE` (or `cf_alloc_tag_push`) span one -- this asserts.
+ *           Each fiber job costs an extra context switch or two over a regular job, so prefer `cf_threadpool_add_job` for short jobs
+ *           that never wait.
+ * @related  cf_threadpool_add_fiber_job cf_fiber_job_yield cf_threadpool_add_job cf_threadpool_wait_counter
+ */
+CF_API void CF_CALL cf_threadpool_add_fiber_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter);
+
+/**
+ * @function cf_fiber_job_yield
+ * @category multithreading
+ * @brief    Suspends the currently running fiber job and lets the worker run other jobs, resuming some time later.
+ * @return   Returns false, without doing anything, if not called from within a fiber job.
+ * @remarks  Useful for polling something that isn't a `CF_JobCounter`, such as an I/O request, without tying up a worker.
+ * @related  cf_threadpool_add_fiber_job cf_fiber_job_yield cf_threadpool_wait_counter
+ */
+CF_API bool CF_CALL cf_fiber_job_yield(void);
+
+/**
+ * @function CF_ParallelForFn
+ * @category multithreading
+ * @brief    A function pointer for one chunk of a `cf_parallel_for`.
+ * @param    begin      The first index of this chunk.
+ * @param    end        One past the last index of this chunk.
+ * @param    udata      The `udata` passed to `cf_parallel_for`.
+ * @related  CF_ParallelForFn cf_parallel_for
+ */
+typedef void (CF_CALL CF_ParallelForFn)(int begin, int end, void* udata);
+
+/**
+ * @function cf_parallel_for
+ * @category multithreading
+ * @brief    Splits the range [`begin`, `end`) into chunks and runs `fn` on each chunk across the pool, returning once all chunks are done.
+ * @param    pool       The pool. Can be `NULL`, in which case the whole range runs on the calling thread.
+ * @param    begin      The first index.
+ * @param    end        One past the last index.
+ * @param    grain      The number of indices per chunk. Pass zero or less to pick a size automatically.
+ * @param    fn         Called once per chunk, see `CF_ParallelForFn`.
+ * @param    udata      Can be `NULL`. Handed back to `fn`.
+ * @remarks  The calling thread runs chunks too. Safe to call from within a job, so parallel loops can nest.
+ * @related  CF_ParallelForFn cf_parallel_for CF_JobCounter cf_threadpool_wait_counter
+ */
+CF_API void CF_CALL cf_parallel_for(CF_Threadpool* pool, int begin, int end, int grain, CF_ParallelForFn* fn, void* udata);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -614,6 +1062,12 @@ CF_INLINE void* atomic_ptr_set(void** atomic, void* value) { return cf_atomic_pt
 CF_INLINE void* atomic_ptr_get(void** atomic) { return cf_atomic_ptr_get(atomic); }
 CF_INLINE CF_Result atomic_ptr_cas(void** atomic, void* expected, void* value) { return cf_atomic_ptr_cas(atomic, expected, value); }
 
+CF_INLINE CF_AtomicInt64 atomic64_zero() { return cf_atomic64_zero(); }
+CF_INLINE int64_t atomic64_add(CF_AtomicInt64* atomic, int64_t addend) { return cf_atomic64_add(atomic, addend); }
+CF_INLINE int64_t atomic64_set(CF_AtomicInt64* atomic, int64_t value) { return cf_atomic64_set(atomic, value); }
+CF_INLINE int64_t atomic64_get(CF_AtomicInt64* atomic) { return cf_atomic64_get(atomic); }
+CF_INLINE CF_Result atomic64_cas(CF_AtomicInt64* atomic, int64_t expected, int64_t value) { return cf_atomic64_cas(atomic, expected, value); }
+
 CF_INLINE CF_ReadWriteLock make_rw_lock() { return cf_make_rw_lock(); }
 CF_INLINE void destroy_rw_lock(CF_ReadWriteLock* rw) { cf_destroy_rw_lock(rw); }
 CF_INLINE void read_lock(CF_ReadWriteLock* rw) { cf_read_lock(rw); }
@@ -621,11 +1075,40 @@ CF_INLINE void read_unlock(CF_ReadWriteLock* rw) { cf_read_unlock(rw); }
 CF_INLINE void write_lock(CF_ReadWriteLock* rw) { cf_write_lock(rw); }
 CF_INLINE void write_unlock(CF_ReadWriteLock* rw) { cf_write_unlock(rw); }
 
+CF_INLINE CF_SPSCQueue* make_spsc_queue(int capacity, int element_size) { return cf_make_spsc_queue(capacity, element_size); }
+CF_INLINE void destroy_spsc_queue(CF_SPSCQueue* queue) { cf_destroy_spsc_queue(queue); }
+CF_INLINE bool spsc_queue_push(CF_SPSCQueue* queue, const void* element) { return cf_spsc_queue_push(queue, element); }
+CF_INLINE bool spsc_queue_pop(CF_SPSCQueue* queue, void* element) { return cf_spsc_queue_pop(queue, element); }
+CF_INLINE int spsc_queue_count(CF_SPSCQueue* queue) { return cf_spsc_queue_count(queue); }
+
+CF_INLINE CF_MPMCQueue* make_mpmc_queue(int capacity, int element_size) { return cf_make_mpmc_queue(capacity, element_size); }
+CF_INLINE void destroy_mpmc_queue(CF_MPMCQueue* queue) { cf_destroy_mpmc_queue(queue); }
+CF_INLINE bool mpmc_queue_push(CF_MPMCQueue* queue, const void* element) { return cf_mpmc_queue_push(queue, element); }
+CF_INLINE bool mpmc_queue_pop(CF_MPMCQueue* queue, void* element) { return cf_mpmc_queue_pop(queue, element); }
+
+CF_INLINE CF_MPSCQueue* make_mpsc_queue() { return cf_make_mpsc_queue(); }
+CF_INLINE void destroy_mpsc_queue(CF_MPSCQueue* queue) { cf_destroy_mpsc_queue(queue); }
+CF_INLINE void mpsc_queue_push(CF_MPSCQueue* queue, CF_MPSCNode* node) { cf_mpsc_queue_push(queue, node); }
+CF_INLINE CF_MPSCNode* mpsc_queue_pop(CF_MPSCQueue* queue) { return cf_mpsc_queue_pop(queue); }
+
+CF_INLINE CF_ConcurrentPool* make_concurrent_pool(int element_size, int element_count, int alignment) { return cf_make_concurrent_pool(element_size, element_count, alignment); }
+CF_INLINE void destroy_concurrent_pool(CF_ConcurrentPool* pool) { cf_destroy_concurrent_pool(pool); }
+CF_INLINE void* concurrent_pool_alloc(CF_ConcurrentPool* pool) { return cf_concurrent_pool_alloc(pool); }
+CF_INLINE void concurrent_pool_free(CF_ConcurrentPool* pool, void* element) { cf_concurrent_pool_free(pool, element); }
+CF_INLINE CF_MemoryPoolStats concurrent_pool_stats(CF_ConcurrentPool* pool) { return cf_concurrent_pool_stats(pool); }
+
 CF_INLINE CF_Threadpool* make_threadpool(int thread_count) { return cf_make_threadpool(thread_count); }
 CF_INLINE void destroy_threadpool(CF_Threadpool* pool) { return cf_destroy_threadpool(pool); }
+CF_INLINE int threadpool_thread_count(CF_Threadpool* pool) { return cf_threadpool_thread_count(pool); }
 CF_INLINE void threadpool_add_task(CF_Threadpool* pool, CF_TaskFn* task, void* param) { return cf_threadpool_add_task(pool, task, param); }
 CF_INLINE void threadpool_kick_and_wait(CF_Threadpool* pool) { return cf_threadpool_kick_and_wait(pool); }
 CF_INLINE void threadpool_kick(CF_Threadpool* pool) { return cf_threadpool_kick(pool); }
+CF_INLINE CF_JobCounter make_job_counter() { return cf_make_job_counter(); }
+CF_INLINE void threadpool_add_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter) { cf_threadpool_add_job(pool, task, param, counter); }
+CF_INLINE void threadpool_wait_counter(CF_Threadpool* pool, CF_JobCounter* counter) { cf_threadpool_wait_counter(pool, counter); }
+CF_INLINE void threadpool_add_fiber_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter = NULL) { cf_threadpool_add_fiber_job(pool, task, param, counter); }
+CF_INLINE bool fiber_job_yield() { return cf_fiber_job_yield(); }
+CF_INLINE void parallel_for(CF_Threadpool* pool, int begin, int end, int grain, CF_ParallelForFn* fn, void* udata = NULL) { cf_parallel_for(pool, begin, end, grain, fn, udata); }
 
 }
 
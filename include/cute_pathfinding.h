@@ -0,0 +1,238 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_PATHFINDING_H
+#define CF_PATHFINDING_H
+
+#include "cute_defines.h"
+#include "cute_multithreading.h"
+
+//--------------------------------------------------------------------------------------------------
+// C API
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @struct   CF_PathGrid
+ * @category pathfinding
+ * @brief    A uniform grid of walkable and blocked cells to find paths on.
+ * @remarks  Every cell starts out walkable. Moving to a side neighbor costs 1, and moving diagonally costs sqrt(2). Diagonal moves never
+ *           cut corners: both cells beside the move must be walkable too.
+ * @related  CF_PathGrid cf_make_path_grid cf_destroy_path_grid cf_path_grid_set_blocked cf_path_grid_find_path cf_path_grid_find_paths
+ */
+typedef struct CF_PathGrid CF_PathGrid;
+// @end
+
+/**
+ * @struct   CF_PathCell
+ * @category pathfinding
+ * @brief    The coordinates of one cell in a `CF_PathGrid`.
+ * @related  CF_PathCell CF_PathGrid cf_path_grid_find_path
+ */
+typedef struct CF_PathCell
+{
+	/* @member Column, from 0 to the grid's width - 1. */
+	int x;
+
+	/* @member Row, from 0 to the grid's height - 1. */
+	int y;
+} CF_PathCell;
+// @end
+
+/**
+ * @enum     CF_PathAlgorithm
+ * @category pathfinding
+ * @brief    The search algorithms `cf_path_grid_find_path` can use.
+ * @related  CF_PathAlgorithm cf_path_algorithm_to_string cf_path_grid_find_path
+ */
+#define CF_PATH_ALGORITHM_DEFS \
+	/* @entry Classic A*. Finds the shortest path, visiting every cell that might be on it. */ \
+	CF_ENUM(PATH_ALGORITHM_ASTAR, 0)                                                           \
+	/* @entry Jump point search. Finds the same length paths as A*, but skips over open areas, often visiting far fewer cells. Needs diagonal movement, otherwise runs A*. */ \
+	CF_ENUM(PATH_ALGORITHM_JPS,   1)                                                           \
+	/* @entry Hierarchical A*. Searches a coarse graph of grid regions first, see `cf_path_grid_build_hierarchy`. Much faster on big maps, but paths can be a few percent longer than the shortest. */ \
+	CF_ENUM(PATH_ALGORITHM_HPA,   2)                                                           \
+	/* @end */
+
+typedef enum CF_PathAlgorithm
+{
+	#define CF_ENUM(K, V) CF_##K = V,
+	CF_PATH_ALGORITHM_DEFS
+	#undef CF_ENUM
+} CF_PathAlgorithm;
+
+/**
+ * @function cf_path_algorithm_to_string
+ * @category pathfinding
+ * @brief    Converts a `CF_PathAlgorithm` to a C string.
+ * @related  CF_PathAlgorithm cf_path_algorithm_to_string
+ */
+CF_INLINE const char* cf_path_algorithm_to_string(CF_PathAlgorithm algorithm)
+{
+	switch (algorithm) {
+	#define CF_ENUM(K, V) case CF_##K: return CF_STRINGIZE(CF_##K);
+	CF_PATH_ALGORITHM_DEFS
+	#undef CF_ENUM
+	default: return NULL;
+	}
+}
+
+/**
+ * @function cf_make_path_grid
+ * @category pathfinding
+ * @brief    Returns a new `CF_PathGrid` with every cell walkable.
+ * @param    w          Number of columns.
+ * @param    h          Number of rows.
+ * @related  CF_PathGrid cf_make_path_grid cf_destroy_path_grid
+ */
+CF_API CF_PathGrid* CF_CALL cf_make_path_grid(int w, int h);
+
+/**
+ * @function cf_destroy_path_grid
+ * @category pathfinding
+ * @brief    Destroys a `CF_PathGrid` made by `cf_make_path_grid`.
+ * @related  CF_PathGrid cf_make_path_grid cf_destroy_path_grid
+ */
+CF_API void CF_CALL cf_destroy_path_grid(CF_PathGrid* grid);
+
+/**
+ * @function cf_path_grid_set_blocked
+ * @category pathfinding
+ * @brief    Marks a cell as blocked (a wall) or walkable.
+ * @remarks  Makes the hierarchy from `cf_path_grid_build_hierarchy` out of date.
+ * @related  CF_PathGrid cf_path_grid_set_blocked cf_path_grid_is_blocked cf_path_grid_build_hierarchy
+ */
+CF_API void CF_CALL cf_path_grid_set_blocked(CF_PathGrid* grid, int x, int y, bool blocked);
+
+/**
+ * @function cf_path_grid_is_blocked
+ * @category pathfinding
+ * @brief    Returns true if a cell is blocked. Cells outside the grid count as blocked.
+ * @related  CF_PathGrid cf_path_grid_set_blocked cf_path_grid_is_blocked
+ */
+CF_API bool CF_CALL cf_path_grid_is_blocked(const CF_PathGrid* grid, int x, int y);
+
+/**
+ * @function cf_path_grid_set_diagonals
+ * @category pathfinding
+ * @brief    Sets whether paths may move diagonally. On by default.
+ * @remarks  Makes the hierarchy from `cf_path_grid_build_hierarchy` out of date.
+ * @related  CF_PathGrid cf_path_grid_set_diagonals cf_path_grid_find_path
+ */
+CF_API void CF_CALL cf_path_grid_set_diagonals(CF_PathGrid* grid, bool allow_diagonals);
+
+/**
+ * @function cf_path_grid_build_hierarchy
+ * @category pathfinding
+ * @brief    Prepares the grid for `CF_PATH_ALGORITHM_HPA` searches.
+ * @param    grid          The grid.
+ * @param    cluster_size  Width and height of each region, in cells. 16 is a good start; bigger maps can go bigger.
+ * @remarks  Splits the grid into square regions and precomputes the costs of crossing each one, between the openings along its borders.
+ *           Call this again after editing the grid with `cf_path_grid_set_blocked` or `cf_path_grid_set_diagonals`. Until then
+ *           `CF_PATH_ALGORITHM_HPA` searches run plain A* instead.
+ * @related  CF_PathGrid CF_PathAlgorithm cf_path_grid_build_hierarchy cf_path_grid_find_path
+ */
+CF_API void CF_CALL cf_path_grid_build_hierarchy(CF_PathGrid* grid, int cluster_size);
+
+/**
+ * @function cf_path_grid_find_path
+ * @category pathfinding
+ * @brief    Finds a path between two cells.
+ * @param    grid       The grid.
+ * @param    start      The cell to start from.
+ * @param    goal       The cell to reach.
+ * @param    algorithm  The search algorithm, see `CF_PathAlgorithm`.
+ * @param    path       Written with every cell along the path, from `start` to `goal` inclusive, each a single step from the last.
+ * @param    capacity   The number of elements `path` can hold.
+ * @return   Returns the number of cells in the path, or 0 if there's no path. This may be more than `capacity`, in which case only the
+ *           first `capacity` cells are written.
+ * @remarks  Safe to call from many threads at once, as long as nobody is editing the grid. To find many paths at once see `cf_path_grid_find_paths`.
+ * @related  CF_PathGrid CF_PathCell CF_PathAlgorithm cf_path_grid_find_path cf_path_grid_find_paths
+ */
+CF_API int CF_CALL cf_path_grid_find_path(const CF_PathGrid* grid, CF_PathCell start, CF_PathCell goal, CF_PathAlgorithm algorithm, CF_PathCell* path, int capacity);
+
+/**
+ * @struct   CF_PathRequest
+ * @category pathfinding
+ * @brief    One path to find with `cf_path_grid_find_paths`.
+ * @related  CF_PathRequest cf_path_grid_find_paths
+ */
+typedef struct CF_PathRequest
+{
+	/* @member The cell to start from. */
+	CF_PathCell start;
+
+	/* @member The cell to reach. */
+	CF_PathCell goal;
+
+	/* @member The search algorithm, see `CF_PathAlgorithm`. */
+	CF_PathAlgorithm algorithm;
+
+	/* @member Written with the path, see `cf_path_grid_find_path`. */
+	CF_PathCell* path;
+
+	/* @member The number of elements `path` can hold. */
+	int capacity;
+
+	/* @member Written with the number of cells in the path, or 0 if there's no path. May be more than `capacity`. */
+	int count;
+} CF_PathRequest;
+// @end
+
+/**
+ * @function cf_path_grid_find_paths
+ * @category pathfinding
+ * @brief    Finds many paths at once, optionally split across a threadpool.
+ * @param    grid       The grid.
+ * @param    requests   The paths to find. Each request's `count` is written with the result.
+ * @param    count      The number of elements in `requests`.
+ * @param    pool       Can be `NULL` to find all paths on the calling thread.
+ * @remarks  Gather the path requests of all your agents over a frame and find them in one go. Search memory is kept by the grid and reused
+ *           from search to search, instead of allocated per path. It's freed by `cf_destroy_path_grid`.
+ * @related  CF_PathGrid CF_PathRequest cf_path_grid_find_path cf_path_grid_find_paths
+ */
+CF_API void CF_CALL cf_path_grid_find_paths(const CF_PathGrid* grid, CF_PathRequest* requests, int count, CF_Threadpool* pool);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+//--------------------------------------------------------------------------------------------------
+// C++ API
+
+#ifdef CF_CPP
+
+namespace Cute
+{
+
+using PathGrid = CF_PathGrid;
+using PathCell = CF_PathCell;
+using PathRequest = CF_PathRequest;
+
+using PathAlgorithm = CF_PathAlgorithm;
+#define CF_ENUM(K, V) CF_INLINE constexpr PathAlgorithm K = CF_##K;
+CF_PATH_ALGORITHM_DEFS
+#undef CF_ENUM
+
+CF_INLINE const char* to_string(PathAlgorithm algorithm) { return cf_path_algorithm_to_string(algorithm); }
+
+CF_INLINE PathGrid* make_path_grid(int w, int h) { return cf_make_path_grid(w, h); }
+CF_INLINE void destroy_path_grid(PathGrid* grid) { cf_destroy_path_grid(grid); }
+CF_INLINE void path_grid_set_blocked(PathGrid* grid, int x, int y, bool blocked) { cf_path_grid_set_blocked(grid, x, y, blocked); }
+CF_INLINE bool path_grid_is_blocked(const PathGrid* grid, int x, int y) { return cf_path_grid_is_blocked(grid, x, y); }
+CF_INLINE void path_grid_set_diagonals(PathGrid* grid, bool allow_diagonals) { cf_path_grid_set_diagonals(grid, allow_diagonals); }
+CF_INLINE void path_grid_build_hierarchy(PathGrid* grid, int cluster_size = 16) { cf_path_grid_build_hierarchy(grid, cluster_size); }
+CF_INLINE int path_grid_find_path(const PathGrid* grid, PathCell start, PathCell goal, PathAlgorithm algorithm, PathCell* path, int capacity) { return cf_path_grid_find_path(grid, start, goal, algorithm, path, capacity); }
+CF_INLINE void path_grid_find_paths(const PathGrid* grid, PathRequest* requests, int count, CF_Threadpool* pool = NULL) { cf_path_grid_find_paths(grid, requests, count, pool); }
+
+}
+
+#endif // CF_CPP
+
+#endif // CF_PATHFINDING_H
@@ -12,6 +12,7 @@
 #include "cute_math.h"
 #include "cute_math3d.h"
 #include "cute_time.h"
+#include "cute_multithreading.h"
 
 #include <box2d/box2d.h>
 #include <box3d/box3d.h>
@@ -36,6 +37,8 @@
 //       (which means anti-aliased SDF shapes, layers, and the current 2d camera).
 //     - A stepping helper: `cf_physics_step` ties `b2World_Step` to CF's fixed-timestep
 //       clock. Enable `cf_set_fixed_timestep` and call it from your `CF_OnUpdateFn`.
+//     - A task-system bridge: `cf_physics_world_def_threadpool` hands Box2D a `CF_Threadpool`, so
+//       big worlds step across all your cores instead of one.
 //
 // The stateless collision queries in cute_math.h (`cf_circle_to_poly`, manifolds,
 // raycasts, `cf_gjk`, `cf_toi`, ...) are ALSO powered by Box2D's geometry layer -- use
@@ -165,7 +168,10 @@ CF_API b2Polygon CF_CALL cf_poly_to_b2(const CF_Poly* poly, float radius);
  *           `b2DebugDraw` option before handing it to `b2World_Draw`. Shapes render into
  *           the current 2d camera, layer, and color state like any other `cf_draw_*`
  *           call. For the common case see `cf_physics_draw`.
- * @related  cf_physics_draw cf_physics_step
+ *
+ *           Nothing is culled. To skip off-screen shapes set `drawingBounds` and turn on
+ *           `useDrawingBounds`, which `cf_physics_draw` does from the current 2d camera.
+ * @related  cf_physics_draw cf_physics_draw_lod cf_physics_step
  */
 CF_API b2DebugDraw CF_CALL cf_physics_debug_draw_defaults(float thickness);
 
@@ -176,11 +182,161 @@ CF_API b2DebugDraw CF_CALL cf_physics_debug_draw_defaults(float thickness);
  * @param    world      The world to draw.
  * @param    thickness  Stroke width for outlines/segments, in your 2d camera's world units.
  * @remarks  Sugar over `cf_physics_debug_draw_defaults` + `b2World_Draw` with shapes and
- *           joints on. Call it anywhere you'd call other `cf_draw_*` functions.
- * @related  cf_physics_debug_draw_defaults cf_physics_step
+ *           joints on. Call it anywhere you'd call other `cf_draw_*` functions. Only shapes
+ *           within the current camera's view are drawn.
+ * @related  cf_physics_debug_draw_defaults cf_physics_draw_lod cf_physics_step
  */
 CF_API void CF_CALL cf_physics_draw(b2WorldId world, float thickness);
 
+/**
+ * @function cf_physics_draw_lod
+ * @category physics
+ * @brief    Same as `cf_physics_draw`, but shapes too small to make out are drawn as plain boxes.
+ * @param    world      The world to draw.
+ * @param    thickness  Stroke width for outlines/segments, in your 2d camera's world units.
+ * @param    lod_pixels Shapes whose bounds span fewer than this many pixels on screen draw as their filled bounding box.
+ * @remarks  Zoomed far out over a big world, thousands of shapes shrink to a few pixels each. Drawing each one as a box is
+ *           cheaper and looks the same at that size.
+ * @related  cf_physics_draw cf_physics_debug_draw_defaults
+ */
+CF_API void CF_CALL cf_physics_draw_lod(b2WorldId world, float thickness, float lod_pixels);
+
+/**
+ * @function cf_physics_world_def
+ * @category physics
+ * @brief    Returns a `b2WorldDef` whose world steps on the calling thread.
+ * @remarks  Same as `b2DefaultWorldDef`. See `cf_physics_world_def_threadpool` to step across a threadpool instead.
+ * @related  cf_physics_world_def_threadpool cf_physics_step cf_physics_world_def3
+ */
+CF_API b2WorldDef CF_CALL cf_physics_world_def(void);
+
+/**
+ * @function cf_physics_world_def_threadpool
+ * @category physics
+ * @brief    Returns a `b2WorldDef` that steps its world across a `CF_Threadpool`.
+ * @param    pool       Can be `NULL`, which is the same as `cf_physics_world_def`: the world steps on the calling thread.
+ * @remarks  Box2D can split each step into tasks, but only runs them in parallel when the world def has a task system. This wires
+ *           `workerCount`, `enqueueTask` and `finishTask` to `pool`, using one worker per pool thread plus the stepping thread (see
+ *           `cf_threadpool_thread_count`). Set gravity and friends as usual, and keep the pool alive until the world is destroyed.
+ *           Step the world from outside the pool's own jobs: Box2D's solver tasks wait on each other, and need every worker to have
+ *           a thread to run on.
+ * @related  cf_physics_world_def cf_physics_step cf_make_threadpool
+ */
+CF_API b2WorldDef CF_CALL cf_physics_world_def_threadpool(CF_Threadpool* pool);
+
+//--------------------------------------------------------------------------------------------------
+// Render interpolation: body transforms gathered from Box2D's move events, smoothed between fixed
+// ticks in bulk.
+
+/**
+ * @struct   CF_PhysicsTransforms
+ * @category physics
+ * @brief    Keeps the previous and current transforms of many Box2D bodies, for rendering between fixed ticks.
+ * @remarks  Fixed-timestep physics moves bodies in discrete ticks, which stutters when rendered as-is at any other framerate. The usual
+ *           fix is to draw each body part way between its last two transforms, by `CF_DELTA_TIME_INTERPOLANT`. Instead of calling
+ *           `b2Body_GetTransform` on every body each tick, `cf_physics_transforms_update` only reads Box2D's move events (see
+ *           `b2World_GetBodyEvents`), which list just the bodies that moved. `cf_physics_transforms_interpolate` then blends every
+ *           body in one pass, several at a time with SIMD.
+ *
+ *           ```c
+ *           // Inside the fixed update:
+ *           cf_physics_step(world, 4);
+ *           cf_physics_transforms_update(transforms);
+ *
+ *           // When drawing:
+ *           const CF_Transform* tf = cf_physics_transforms_interpolate(transforms, CF_DELTA_TIME_INTERPOLANT);
+ *           for (int i = 0; i < cf_physics_transforms_count(transforms); ++i) {
+ *               draw_body(i, tf[i]);
+ *           }
+ *           ```
+ * @related  CF_PhysicsTransforms cf_make_physics_transforms cf_physics_transforms_add cf_physics_transforms_update cf_physics_transforms_interpolate
+ */
+typedef struct CF_PhysicsTransforms CF_PhysicsTransforms;
+// @end
+
+/**
+ * @function cf_make_physics_transforms
+ * @category physics
+ * @brief    Returns a new `CF_PhysicsTransforms` for bodies of `world`, holding no bodies yet.
+ * @param    world      The world the bodies live in.
+ * @related  CF_PhysicsTransforms cf_make_physics_transforms cf_destroy_physics_transforms cf_physics_transforms_add
+ */
+CF_API CF_PhysicsTransforms* CF_CALL cf_make_physics_transforms(b2WorldId world);
+
+/**
+ * @function cf_destroy_physics_transforms
+ * @category physics
+ * @brief    Destroys a `CF_PhysicsTransforms` made by `cf_make_physics_transforms`.
+ * @related  CF_PhysicsTransforms cf_make_physics_transforms cf_destroy_physics_transforms
+ */
+CF_API void CF_CALL cf_destroy_physics_transforms(CF_PhysicsTransforms* transforms);
+
+/**
+ * @function cf_physics_transforms_add
+ * @category physics
+ * @brief    Starts tracking a body, and returns its index.
+ * @param    transforms The transforms.
+ * @param    body       A body in the world `transforms` was made for.
+ * @return   Returns the body's index into `cf_physics_transforms_bodies` and `cf_physics_transforms_interpolate`. Adding a body again
+ *           returns its existing index.
+ * @remarks  The previous and current transforms both start as the body's transform right now.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_add cf_physics_transforms_remove cf_physics_transforms_bodies
+ */
+CF_API int CF_CALL cf_physics_transforms_add(CF_PhysicsTransforms* transforms, b2BodyId body);
+
+/**
+ * @function cf_physics_transforms_remove
+ * @category physics
+ * @brief    Stops tracking a body.
+ * @param    transforms The transforms.
+ * @param    body       The body to remove. Does nothing if it isn't tracked.
+ * @remarks  The last body moves into the removed body's index. Remove bodies before destroying them with `b2DestroyBody`.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_add cf_physics_transforms_remove
+ */
+CF_API void CF_CALL cf_physics_transforms_remove(CF_PhysicsTransforms* transforms, b2BodyId body);
+
+/**
+ * @function cf_physics_transforms_count
+ * @category physics
+ * @brief    Returns the number of tracked bodies.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_count cf_physics_transforms_bodies
+ */
+CF_API int CF_CALL cf_physics_transforms_count(const CF_PhysicsTransforms* transforms);
+
+/**
+ * @function cf_physics_transforms_bodies
+ * @category physics
+ * @brief    Returns the tracked bodies, `cf_physics_transforms_count` of them, in index order.
+ * @remarks  Invalidated by adding or removing bodies.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_count cf_physics_transforms_bodies cf_physics_transforms_interpolate
+ */
+CF_API const b2BodyId* CF_CALL cf_physics_transforms_bodies(const CF_PhysicsTransforms* transforms);
+
+/**
+ * @function cf_physics_transforms_update
+ * @category physics
+ * @brief    Records the transforms of a world step.
+ * @param    transforms The transforms.
+ * @remarks  Call once right after each `cf_physics_step` (or `b2World_Step`). The current transforms become the previous ones, and bodies
+ *           in the step's move events get new current transforms. Bodies that didn't move, such as sleeping ones, stay put without
+ *           any calls into Box2D. Moving a body with `b2Body_SetTransform` doesn't make a move event until the next step.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_update cf_physics_transforms_interpolate cf_physics_step
+ */
+CF_API void CF_CALL cf_physics_transforms_update(CF_PhysicsTransforms* transforms);
+
+/**
+ * @function cf_physics_transforms_interpolate
+ * @category physics
+ * @brief    Blends every body between its previous and current transform.
+ * @param    transforms The transforms.
+ * @param    alpha      How far to blend, from 0 (previous) to 1 (current). Usually `CF_DELTA_TIME_INTERPOLANT`.
+ * @return   Returns `cf_physics_transforms_count` transforms, one per body in index order. Valid until the next call to this
+ *           function, or until bodies are added or removed.
+ * @remarks  Positions blend linearly, and rotations by normalized linear blending of their sin/cos pairs.
+ * @related  CF_PhysicsTransforms cf_physics_transforms_update cf_physics_transforms_interpolate CF_DELTA_TIME_INTERPOLANT
+ */
+CF_API const CF_Transform* CF_CALL cf_physics_transforms_interpolate(CF_PhysicsTransforms* transforms, float alpha);
+
 //--------------------------------------------------------------------------------------------------
 // 3d: Box3D, exposed the same way Box2D is above. The b3* API mirrors b2's design (id
 // handles, b3Default*Def() initializers, polled event buffers), and CF supplies the same
@@ -304,7 +460,10 @@ CF_API b3WorldDef CF_CALL cf_physics_world_def3(void);
  *           wireframes; height fields and compounds draw their bounds. `drawShapes` is
  *           enabled; toggle any other option before `b3World_Draw`. Create the world from
  *           `cf_physics_world_def3` so the shape bake callbacks are wired.
- * @related  cf_physics_draw3 cf_physics_world_def3 cf_physics_step3
+ *
+ *           Nothing is culled. `cf_physics_draw3` additionally skips shapes outside the view
+ *           frustum of the current 3d camera stacks (projection, view, and transform).
+ * @related  cf_physics_draw3 cf_physics_draw3_lod cf_physics_world_def3 cf_physics_step3
  */
 CF_API b3DebugDraw CF_CALL cf_physics_debug_draw3_defaults(float thickness);
 
@@ -316,10 +475,22 @@ CF_API b3DebugDraw CF_CALL cf_physics_debug_draw3_defaults(float thickness);
  * @param    thickness  Stroke width for wireframes/segments, in world units.
  * @remarks  Sugar over `cf_physics_debug_draw3_defaults` + `b3World_Draw` with shapes and
  *           joints on. Call it under your 3d camera stacks like any `cf_draw3d_*` call.
- * @related  cf_physics_debug_draw3_defaults cf_physics_world_def3 cf_physics_step3
+ *           Shapes outside the camera's view frustum are skipped.
+ * @related  cf_physics_debug_draw3_defaults cf_physics_draw3_lod cf_physics_world_def3 cf_physics_step3
  */
 CF_API void CF_CALL cf_physics_draw3(b3WorldId world, float thickness);
 
+/**
+ * @function cf_physics_draw3_lod
+ * @category physics
+ * @brief    Same as `cf_physics_draw3`, but distant shapes are drawn as plain boxes.
+ * @param    world         The world, created from `cf_physics_world_def3`.
+ * @param    thickness     Stroke width for wireframes/segments, in world units.
+ * @param    lod_distance  Shapes farther than this from the camera draw as solid cubes filling their bounding box.
+ * @related  cf_physics_draw3 cf_physics_debug_draw3_defaults
+ */
+CF_API void CF_CALL cf_physics_draw3_lod(b3WorldId world, float thickness, float lod_distance);
+
 /**
  * @function cf_physics_step3
  * @category physics
@@ -353,8 +524,8 @@ CF_API void CF_CALL cf_physics_step3(b3WorldId world, int substep_count);
  *           (and Box2D v3's determinism actually holds). Without fixed timestep enabled
  *           it falls back to the variable `CF_DELTA_TIME`, which works but wobbles.
  *           When rendering between fixed ticks, interpolate transforms with
- *           `CF_DELTA_TIME_INTERPOLANT`.
- * @related  cf_physics_draw cf_set_fixed_timestep CF_DELTA_TIME_FIXED CF_DELTA_TIME_INTERPOLANT
+ *           `CF_DELTA_TIME_INTERPOLANT`, see `CF_PhysicsTransforms`.
+ * @related  cf_physics_draw cf_set_fixed_timestep CF_DELTA_TIME_FIXED CF_DELTA_TIME_INTERPOLANT CF_PhysicsTransforms
  */
 CF_API void CF_CALL cf_physics_step(b2WorldId world, int substep_count);
 
@@ -382,10 +553,23 @@ CF_INLINE CF_SinCos from_b2(b2Rot q) { return cf_b2_to_sincos(q); }
 CF_INLINE CF_Transform from_b2(b2Transform tf) { return cf_b2_to_transform(tf); }
 CF_INLINE CF_Aabb from_b2(b2AABB bb) { return cf_b2_to_aabb(bb); }
 
+CF_INLINE b2WorldDef physics_world_def() { return cf_physics_world_def(); }
+CF_INLINE b2WorldDef physics_world_def(CF_Threadpool* pool) { return cf_physics_world_def_threadpool(pool); }
 CF_INLINE b2DebugDraw physics_debug_draw_defaults(float thickness) { return cf_physics_debug_draw_defaults(thickness); }
 CF_INLINE void physics_draw(b2WorldId world, float thickness) { cf_physics_draw(world, thickness); }
+CF_INLINE void physics_draw_lod(b2WorldId world, float thickness, float lod_pixels) { cf_physics_draw_lod(world, thickness, lod_pixels); }
 CF_INLINE void physics_step(b2WorldId world, int substep_count) { cf_physics_step(world, substep_count); }
 
+using PhysicsTransforms = CF_PhysicsTransforms;
+CF_INLINE PhysicsTransforms* make_physics_transforms(b2WorldId world) { return cf_make_physics_transforms(world); }
+CF_INLINE void destroy_physics_transforms(PhysicsTransforms* transforms) { cf_destroy_physics_transforms(transforms); }
+CF_INLINE int physics_transforms_add(PhysicsTransforms* transforms, b2BodyId body) { return cf_physics_transforms_add(transforms, body); }
+CF_INLINE void physics_transforms_remove(PhysicsTransforms* transforms, b2BodyId body) { cf_physics_transforms_remove(transforms, body); }
+CF_INLINE int physics_transforms_count(const PhysicsTransforms* transforms) { return cf_physics_transforms_count(transforms); }
+CF_INLINE const b2BodyId* physics_transforms_bodies(const PhysicsTransforms* transforms) { return cf_physics_transforms_bodies(transforms); }
+CF_INLINE void physics_transforms_update(PhysicsTransforms* transforms) { cf_physics_transforms_update(transforms); }
+CF_INLINE const CF_Transform* physics_transforms_interpolate(PhysicsTransforms* transforms, float alpha = CF_DELTA_TIME_INTERPOLANT) { return cf_physics_transforms_interpolate(transforms, alpha); }
+
 CF_INLINE b3Vec3 to_b3(CF_V3 v) { return cf_v3_to_b3(v); }
 CF_INLINE b3Quat to_b3(CF_Quat q) { return cf_quat_to_b3(q); }
 CF_INLINE b3Transform to_b3(CF_M4x4 m) { return cf_m4_to_b3(m); }
@@ -400,6 +584,7 @@ CF_INLINE CF_Aabb3 from_b3(b3AABB bb) { return cf_b3_to_aabb3(bb); }
 CF_INLINE b3WorldDef physics_world_def3() { return cf_physics_world_def3(); }
 CF_INLINE b3DebugDraw physics_debug_draw3_defaults(float thickness) { return cf_physics_debug_draw3_defaults(thickness); }
 CF_INLINE void physics_draw3(b3WorldId world, float thickness) { cf_physics_draw3(world, thickness); }
+CF_INLINE void physics_draw3_lod(b3WorldId world, float thickness, float lod_distance) { cf_physics_draw3_lod(world, thickness, lod_distance); }
 CF_INLINE void physics_step3(b3WorldId world, int substep_count) { cf_physics_step3(world, substep_count); }
 
 }
@@ -21,7 +21,7 @@ namespace Cute
  * Implements a heap data structure in order to implement other more advanced algorithms within Cute Framework,
  * such as A* or branch-and-bound for the AABB tree.
  *
- * Currently not thoroughly tested.
+ * The predicates return positive when the first element belongs closer to the root.
  */
 
 template <typename T>
@@ -158,7 +158,7 @@ int PriorityQueue<T>::predicate_min(int iA, int iB)
 {
 	float costA = m_costs[iA];
 	float costB = m_costs[iB];
-	return costA < costB ? -1 : costA > costB ? 1 : 0;
+	return costA < costB ? 1 : costA > costB ? -1 : 0;
 }
 
 template <typename T>
@@ -166,7 +166,7 @@ int PriorityQueue<T>::predicate_max(int iA, int iB)
 {
 	float costA = m_costs[iA];
 	float costB = m_costs[iB];
-	return costA > costB ? -1 : costA < costB ? 1 : 0;
+	return costA > costB ? 1 : costA < costB ? -1 : 0;
 }
 
 template <typename T>
@@ -181,6 +181,153 @@ void PriorityQueue<T>::swap(int iA, int iB)
 	m_costs[iB] = fval;
 }
 
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * A min-heap of integer ids with decrease-key, for searches like A* or Dijkstra over nodes numbered [0, n).
+ *
+ * Each id is in the heap at most once. Pushing an id already in the heap lowers its cost instead of
+ * adding a duplicate entry, so searches never pop stale nodes. The heap is `D`-ary: wider nodes make
+ * the tree shallower, trading a few extra compares per pop for fewer cache misses.
+ */
+template <int D = 4>
+struct IndexedPriorityQueue
+{
+	// Pushes `id`, or lowers its cost if it's already queued with a higher one. Returns true if anything changed.
+	bool push_or_decrease(int id, float cost);
+	bool pop_min(int* id = NULL, float* cost = NULL);
+
+	bool contains(int id) const;
+	float cost(int id) const;
+	int count() const;
+
+	// Empties the heap in O(count), ready for the next search.
+	void clear();
+
+private:
+	Array<int> m_ids;
+	Array<float> m_costs;
+	Array<int> m_slots; // Heap index of each id, or -1.
+
+	void place(int i, int id, float cost);
+	void sift_up(int i, int id, float cost);
+	void sift_down(int i, int id, float cost);
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template <int D>
+bool IndexedPriorityQueue<D>::push_or_decrease(int id, float cost)
+{
+	CF_ASSERT(id >= 0);
+	if (id >= m_slots.count()) {
+		int old_count = m_slots.count();
+		m_slots.ensure_count(id + 1);
+		for (int i = old_count; i <= id; ++i) m_slots[i] = -1;
+	}
+
+	int i = m_slots[id];
+	if (i < 0) {
+		m_ids.add(id);
+		m_costs.add(cost);
+		sift_up(m_ids.count() - 1, id, cost);
+		return true;
+	} else if (cost < m_costs[i]) {
+		sift_up(i, id, cost);
+		return true;
+	}
+	return false;
+}
+
+template <int D>
+bool IndexedPriorityQueue<D>::pop_min(int* id, float* cost)
+{
+	int count = m_ids.count();
+	if (!count) return false;
+	if (id) *id = m_ids[0];
+	if (cost) *cost = m_costs[0];
+
+	m_slots[m_ids[0]] = -1;
+	int last_id = m_ids.pop();
+	float last_cost = m_costs.pop();
+	if (count > 1) sift_down(0, last_id, last_cost);
+	return true;
+}
+
+template <int D>
+bool IndexedPriorityQueue<D>::contains(int id) const
+{
+	return id >= 0 && id < m_slots.count() && m_slots[id] >= 0;
+}
+
+template <int D>
+float IndexedPriorityQueue<D>::cost(int id) const
+{
+	CF_ASSERT(contains(id));
+	return m_costs[m_slots[id]];
+}
+
+template <int D>
+int IndexedPriorityQueue<D>::count() const
+{
+	return m_ids.count();
+}
+
+template <int D>
+void IndexedPriorityQueue<D>::clear()
+{
+	for (int i = 0; i < m_ids.count(); ++i) {
+		m_slots[m_ids[i]] = -1;
+	}
+	m_ids.clear();
+	m_costs.clear();
+}
+
+template <int D>
+void IndexedPriorityQueue<D>::place(int i, int id, float cost)
+{
+	m_ids.data()[i] = id;
+	m_costs.data()[i] = cost;
+	m_slots.data()[id] = i;
+}
+
+// Both sifts move a hole instead of swapping, and drop the element in once its spot is found. They
+// index the raw arrays, as they're the hot loop of every search.
+template <int D>
+void IndexedPriorityQueue<D>::sift_up(int i, int id, float cost)
+{
+	const int* ids = m_ids.data();
+	const float* costs = m_costs.data();
+	while (i > 0) {
+		int parent = (i - 1) / D;
+		if (!(cost < costs[parent])) break;
+		place(i, ids[parent], costs[parent]);
+		i = parent;
+	}
+	place(i, id, cost);
+}
+
+template <int D>
+void IndexedPriorityQueue<D>::sift_down(int i, int id, float cost)
+{
+	const int* ids = m_ids.data();
+	const float* costs = m_costs.data();
+	int count = m_ids.count();
+	while (true) {
+		int first = i * D + 1;
+		if (first >= count) break;
+		int last = first + D < count ? first + D : count;
+		int best = first;
+		for (int c = first + 1; c < last; ++c) {
+			if (costs[c] < costs[best]) best = c;
+		}
+		if (!(costs[best] < cost)) break;
+		place(i, ids[best], costs[best]);
+		i = best;
+	}
+	place(i, id, cost);
+}
+
 }
 
 #endif // CF_CPP
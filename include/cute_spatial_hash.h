@@ -0,0 +1,147 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_SPATIAL_HASH_H
+#define CF_SPATIAL_HASH_H
+
+#include "cute_defines.h"
+#include "cute_math.h"
+#include "cute_multithreading.h"
+
+//--------------------------------------------------------------------------------------------------
+// C API
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @struct   CF_SpatialHash
+ * @category collision
+ * @brief    A uniform grid of square cells for finding which boxes overlap a region, rebuilt from scratch each frame.
+ * @remarks  Great for dense scenes full of similarly sized objects such as bullets, particles or crowds, where a `CF_AabbTree` is
+ *           overkill. Each frame call `cf_spatial_hash_clear`, `cf_spatial_hash_add` for every object, then `cf_spatial_hash_build`. The
+ *           build is a counting sort into one flat array, so there are no per-cell allocations and no pointers to chase, and the memory
+ *           is reused from frame to frame.
+ *
+ *           Pick a cell size around the size of a typical object. Every cell a box touches stores a reference to it, so boxes much
+ *           larger than a cell get expensive.
+ * @related  CF_SpatialHash cf_make_spatial_hash cf_destroy_spatial_hash cf_spatial_hash_clear cf_spatial_hash_add cf_spatial_hash_build cf_spatial_hash_query cf_spatial_hash_query_batch
+ */
+typedef struct CF_SpatialHash CF_SpatialHash;
+// @end
+
+/**
+ * @function cf_make_spatial_hash
+ * @category collision
+ * @brief    Returns a new, empty `CF_SpatialHash`.
+ * @param    cell_size  The width and height of each grid cell.
+ * @related  CF_SpatialHash cf_make_spatial_hash cf_destroy_spatial_hash
+ */
+CF_API CF_SpatialHash* CF_CALL cf_make_spatial_hash(float cell_size);
+
+/**
+ * @function cf_destroy_spatial_hash
+ * @category collision
+ * @brief    Destroys a `CF_SpatialHash` made by `cf_make_spatial_hash`.
+ * @related  CF_SpatialHash cf_make_spatial_hash cf_destroy_spatial_hash
+ */
+CF_API void CF_CALL cf_destroy_spatial_hash(CF_SpatialHash* hash);
+
+/**
+ * @function cf_spatial_hash_clear
+ * @category collision
+ * @brief    Removes all boxes, keeping the memory around for the next build.
+ * @related  CF_SpatialHash cf_spatial_hash_clear cf_spatial_hash_add cf_spatial_hash_build
+ */
+CF_API void CF_CALL cf_spatial_hash_clear(CF_SpatialHash* hash);
+
+/**
+ * @function cf_spatial_hash_add
+ * @category collision
+ * @brief    Adds a box to the hash.
+ * @param    hash       The hash.
+ * @param    aabb       The box.
+ * @param    id         Reported by queries, usually an index into your own array of objects.
+ * @remarks  Boxes aren't visible to queries until the next call to `cf_spatial_hash_build`.
+ * @related  CF_SpatialHash cf_spatial_hash_clear cf_spatial_hash_add cf_spatial_hash_build
+ */
+CF_API void CF_CALL cf_spatial_hash_add(CF_SpatialHash* hash, CF_Aabb aabb, int id);
+
+/**
+ * @function cf_spatial_hash_build
+ * @category collision
+ * @brief    Sorts all added boxes into their cells, readying the hash for queries.
+ * @related  CF_SpatialHash cf_spatial_hash_clear cf_spatial_hash_add cf_spatial_hash_build cf_spatial_hash_query
+ */
+CF_API void CF_CALL cf_spatial_hash_build(CF_SpatialHash* hash);
+
+/**
+ * @function cf_spatial_hash_count
+ * @category collision
+ * @brief    Returns the number of boxes added since the last `cf_spatial_hash_clear`.
+ * @related  CF_SpatialHash cf_spatial_hash_add cf_spatial_hash_count
+ */
+CF_API int CF_CALL cf_spatial_hash_count(const CF_SpatialHash* hash);
+
+/**
+ * @function cf_spatial_hash_query
+ * @category collision
+ * @brief    Finds the ids of all boxes overlapping `aabb`.
+ * @param    hash       The hash.
+ * @param    aabb       The region to search.
+ * @param    ids        Written with the found ids, each id once, in no particular order.
+ * @param    capacity   The number of elements `ids` can hold.
+ * @return   Returns the number of boxes found. This may be more than `capacity`, in which case only the first `capacity` ids are written.
+ * @remarks  Safe to call from many threads at once, as long as nobody is modifying the hash.
+ * @related  CF_SpatialHash cf_spatial_hash_build cf_spatial_hash_query cf_spatial_hash_query_batch
+ */
+CF_API int CF_CALL cf_spatial_hash_query(const CF_SpatialHash* hash, CF_Aabb aabb, int* ids, int capacity);
+
+/**
+ * @function cf_spatial_hash_query_batch
+ * @category collision
+ * @brief    Runs many `cf_spatial_hash_query`'s at once, optionally split across a threadpool.
+ * @param    hash          The hash.
+ * @param    queries       The regions to search.
+ * @param    query_count   The number of elements in `queries`.
+ * @param    ids           Results of query `i` are written to `ids + i * capacity`. Must hold `query_count * capacity` elements.
+ * @param    capacity      The maximum number of ids written per query.
+ * @param    counts        Written with the return value of `cf_spatial_hash_query` for each query. Must hold `query_count` elements.
+ * @param    pool          Can be `NULL` to run all queries on the calling thread.
+ * @related  CF_SpatialHash cf_spatial_hash_build cf_spatial_hash_query cf_spatial_hash_query_batch cf_parallel_for
+ */
+CF_API void CF_CALL cf_spatial_hash_query_batch(const CF_SpatialHash* hash, const CF_Aabb* queries, int query_count, int* ids, int capacity, int* counts, CF_Threadpool* pool);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+//--------------------------------------------------------------------------------------------------
+// C++ API
+
+#ifdef CF_CPP
+
+namespace Cute
+{
+
+using SpatialHash = CF_SpatialHash;
+
+CF_INLINE SpatialHash* make_spatial_hash(float cell_size) { return cf_make_spatial_hash(cell_size); }
+CF_INLINE void destroy_spatial_hash(SpatialHash* hash) { cf_destroy_spatial_hash(hash); }
+CF_INLINE void spatial_hash_clear(SpatialHash* hash) { cf_spatial_hash_clear(hash); }
+CF_INLINE void spatial_hash_add(SpatialHash* hash, CF_Aabb aabb, int id) { cf_spatial_hash_add(hash, aabb, id); }
+CF_INLINE void spatial_hash_build(SpatialHash* hash) { cf_spatial_hash_build(hash); }
+CF_INLINE int spatial_hash_count(const SpatialHash* hash) { return cf_spatial_hash_count(hash); }
+CF_INLINE int spatial_hash_query(const SpatialHash* hash, CF_Aabb aabb, int* ids, int capacity) { return cf_spatial_hash_query(hash, aabb, ids, capacity); }
+CF_INLINE void spatial_hash_query_batch(const SpatialHash* hash, const CF_Aabb* queries, int query_count, int* ids, int capacity, int* counts, CF_Threadpool* pool) { cf_spatial_hash_query_batch(hash, queries, query_count, ids, capacity, counts, pool); }
+
+}
+
+#endif // CF_CPP
+
+#endif // CF_SPATIAL_HASH_H
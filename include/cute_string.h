@@ -105,6 +105,7 @@ extern "C" {
  *           - You can simply compare pointers for equality, as opposed to comparing the string contents, as long as both strings came from this function.
  *           - You may optionally call `cf_sinuke` to free all resources used by the global string table.
  *           - This function is very fast if the string was already stored previously.
+ *           - Safe to call from any thread. Strings already in the table are found without taking a lock.
  * @related  cf_sintern cf_sintern_range cf_sivalid cf_silen cf_sinuke
  */
 #define cf_sintern(s) sintern(s)
@@ -156,7 +157,8 @@ extern "C" {
  * @remarks  All strings previously returned by `cf_sintern` are now invalid. Do not call
  *           while an app exists: the engine holds interned pointers as map keys (material
  *           names, shader reflection, and more), and nuking the table out from under them
- *           is undefined. Call it after `cf_destroy_app`, or never -- the table is tiny.
+ *           is undefined. Call it after `cf_destroy_app`, or never -- the table is tiny. Unlike `cf_sintern`
+ *           this is not thread-safe, no other thread may be interning at the same time.
  * @related  cf_sintern cf_sintern_range cf_sivalid cf_silen cf_sinuke
  */
 #define cf_sinuke() sinuke()
@@ -562,14 +564,43 @@ extern "C" {
 /**
  * @function cf_string_hash
  * @category string
- * @brief    Returns a FNV1a hash of the string.
+ * @brief    Returns a hash of the string.
  * @param    s            The string.
  * @return   Returns a `uint64_t` hash value.
- * @remarks  Shortform: `shash(s)`.
- * @related  cf_string_equ cf_string_cmp
+ * @remarks  Shortform: `shash(s)`. Same as `cf_hash_bytes` over the string's bytes, not including the nul-terminator.
+ * @related  cf_string_equ cf_string_cmp cf_hash_bytes
  */
 #define cf_string_hash(s) shash(s)
 
+/**
+ * @function cf_hash_bytes
+ * @category string
+ * @brief    Returns a 64-bit hash of `size` bytes at `data`.
+ * @param    data         The bytes to hash. Can be `NULL` when `size` is zero.
+ * @param    size         Number of bytes, as `size_t`.
+ * @return   Returns a `uint64_t` hash value.
+ * @remarks  This is wyhash: fast on short keys, and several GB/s on large buffers, so it's a good fit for hashing
+ *           whole file contents or long strings. Not suitable for cryptography. The result is stable across runs and
+ *           platforms of the same byte order, so it may be stored on disk as a content signature. `cf_string_hash`
+ *           and `cf_array_hash` both use this function.
+ * @related  cf_hash_bytes_seeded cf_string_hash cf_array_hash
+ */
+#define cf_hash_bytes(data, size) ck_hash_bytes(data, size, 0)
+
+/**
+ * @function cf_hash_bytes_seeded
+ * @category string
+ * @brief    Returns a 64-bit hash of `size` bytes at `data`, mixed with `seed`.
+ * @param    data         The bytes to hash. Can be `NULL` when `size` is zero.
+ * @param    size         Number of bytes, as `size_t`.
+ * @param    seed         A `uint64_t` seed. Different seeds give unrelated hashes of the same bytes.
+ * @return   Returns a `uint64_t` hash value.
+ * @remarks  A seed of zero matches `cf_hash_bytes`. Useful for a second independent hash of the same data, or to
+ *           randomize a table's hashes per-run so its layout can't be predicted from the input.
+ * @related  cf_hash_bytes cf_string_hash cf_array_hash
+ */
+#define cf_hash_bytes_seeded(data, size, seed) ck_hash_bytes(data, size, seed)
+
 /**
  * @function cf_string_append
  * @category string
@@ -136,8 +136,8 @@
 // arev: Reverse array in-place.
 #define arev(a)       ((a) ? ck_arev(a, sizeof(*(a))) : (void*)0)
 
-// ahash: Hash all bytes in the array using FNV1a.
-#define ahash(a)      ((a) ? ck_hash_fnv1a(a, sizeof(*(a)) * asize(a)) : 0)
+// ahash: Hash all bytes in the array (see ck_hash_bytes).
+#define ahash(a)      ((a) ? ck_hash_bytes(a, sizeof(*(a)) * asize(a), 0) : 0)
 
 // afree: Free array memory and set pointer to NULL.
 #define afree(a)      do { CK_ACANARY(a); if (a && !CK_AHDR(a)->is_static) CK_FREE(CK_AHDR(a)); (a) = NULL; } while (0)
@@ -243,8 +243,8 @@
 #define stoupper(s)             ck_stoupper(s)
 #define stolower(s)             ck_stolower(s)
 
-// shash: FNV-1a hash of string.
-#define shash(s)                ck_hash_fnv1a(s, slen(s))
+// shash: Hash of the string's bytes (see ck_hash_bytes).
+#define shash(s)                ck_hash_bytes(s, slen(s), 0)
 
 // strim/sltrim/srtrim: Trim whitespace from both ends, left only, or right only.
 #define strim(s)                (s = ck_strim(s))
@@ -435,13 +435,15 @@
 // C/C++ specific map macros (type inference differs).
 //
 // map_get: Get value by key. Returns zero-initialized value if not found.
+// map_get_or: Get value by key. Returns the given default if not found.
 // map_get_ptr: Get pointer to value. Returns NULL if not found.
 // map_set: Set value for key. Creates entry if not exists.
 // map_add: Alias for map_set with uint64_t value (backwards compat).
 
 #ifdef __cplusplus
 #	include <type_traits>
-#	define map_get(m, k) (map_validate(m), (m) && ck_map_find_impl(CK_MHDR(m), (uint64_t)(k)) >= 0 ? (m)[ck_map_find_impl(CK_MHDR(m), (uint64_t)(k))] : std::remove_pointer_t<std::remove_reference_t<decltype(m)>>{})
+#	define map_get(m, k) (map_validate(m), ck_map_get_or((m), (uint64_t)(k), std::remove_pointer_t<std::remove_reference_t<decltype(m)>>{}))
+#	define map_get_or(m, k, d) (map_validate(m), ck_map_get_or((m), (uint64_t)(k), std::remove_pointer_t<std::remove_reference_t<decltype(m)>>(d)))
 #	define map_get_ptr(m, k) (map_validate(m), (m) ? (std::remove_reference_t<decltype(m)>)ck_map_get_ptr_impl(CK_MHDR(m), (uint64_t)(k)) : nullptr)
 #	define map_set(m, k, v) do { std::remove_pointer_t<decltype(m)> ck_v_ = (v); ck_map_set_stretchy((void**)&(m), (uint64_t)(k), &ck_v_, sizeof(ck_v_)); map_validate(m); } while(0)
 #	define map_add(m, k, v) do { uint64_t ck_v_ = (uint64_t)(v); ck_map_set_stretchy((void**)&(m), (uint64_t)(k), &ck_v_, sizeof(ck_v_)); map_validate(m); } while(0)
@@ -451,9 +453,13 @@
 //     int x = map_get(m, sintern("x"));
 #define map_get(m, k) ( \
 	map_validate(m), \
-	(m) && ck_map_find_impl(CK_MHDR(m), (uint64_t)(k)) >= 0 \
-		? (m)[ck_map_find_impl(CK_MHDR(m), (uint64_t)(k))] \
-		: (typeof(*(m))){ 0 })
+	*(typeof(m))ck_map_get_or_impl(CK_MHDR(m), (uint64_t)(k), (typeof(*(m))[1]){ 0 }))
+
+// map_get_or: Get value by key. Returns d if not found.
+//     int hp = map_get_or(m, sintern("hp"), 100);
+#define map_get_or(m, k, d) ( \
+	map_validate(m), \
+	*(typeof(m))ck_map_get_or_impl(CK_MHDR(m), (uint64_t)(k), (typeof(*(m))[1]){ d }))
 
 // map_get_ptr: Get pointer to value. Returns NULL if not found.
 //     int* px = map_get_ptr(m, sintern("x"));
@@ -497,6 +503,9 @@
 //     CK_MAP(int) m = NULL;
 //     map_set(m, sintern("x"), 10);
 //     int x = map_get(m, sintern("x"));  // 10
+//
+// Thread-safe. The table is split into shards by hash; looking up a string that's already
+// interned takes no lock, and inserting a new one only locks its shard.
 
 // sintern: Return interned string. Same contents always returns same pointer.
 #define sintern(s) ck_sintern(s)
@@ -511,6 +520,7 @@
 #define silen(s)   (((CK_UniqueString*)(s) - 1)->len)
 
 // sinuke: Free all interned strings. All previous pointers become invalid.
+// Not thread-safe -- no other thread may intern while nuking.
 #define sinuke()   sintern_nuke()
 
 //--------------------------------------------------------------------------------------------------
@@ -541,7 +551,7 @@ typedef struct CK_UniqueString
 {
 	CK_Cookie cookie;
 	int len;
-	struct CK_UniqueString* next;
+	uint64_t hash;
 	char* str;
 } CK_UniqueString;
 
@@ -575,13 +585,6 @@ CK_API void* ck_astatic(const void* a, int buffer_size, size_t element_size);
 CK_API void* ck_aset(const void* a, const void* b, size_t element_size);
 CK_API void* ck_arev(const void* a, size_t element_size);
 
-typedef struct CK_MapSlot
-{
-	uint64_t h;
-	int item_index;
-	int base_count;
-} CK_MapSlot;
-
 // Safety cookie for map validation.
 #define CK_MAP_COOKIE CK_COOKIE_VAL('M','A','P','!')
 
@@ -596,9 +599,12 @@ typedef struct CK_MapSlot
 // islot: after keys (already 8-byte aligned since keys are uint64_t)
 #define ck_map_islot_ptr(hdr) ((int*)(ck_map_keys_ptr(hdr) + (hdr)->capacity))
 
-// slots: after islot (aligned to 8 for CK_MapSlot)
-#define ck_map_slots_offset(hdr) CK_ALIGN8((size_t)((char*)(ck_map_islot_ptr(hdr) + (hdr)->capacity) - (char*)(hdr)))
-#define ck_map_slots_ptr(hdr) ((CK_MapSlot*)((char*)(hdr) + ck_map_slots_offset(hdr)))
+// ctrl: after islot, one control byte per hash slot
+#define ck_map_ctrl_ptr(hdr) ((uint8_t*)(ck_map_islot_ptr(hdr) + (hdr)->capacity))
+
+// sidx: after ctrl (aligned to 8), the item index held by each hash slot
+#define ck_map_sidx_offset(hdr) CK_ALIGN8((size_t)((char*)(ck_map_ctrl_ptr(hdr) + (hdr)->slot_capacity) - (char*)(hdr)))
+#define ck_map_sidx_ptr(hdr) ((int*)((char*)(hdr) + ck_map_sidx_offset(hdr)))
 
 // Internal: Get header pointer from map pointer.
 #define CK_MHDR(m) ((m) ? (CK_MapHeader*)((char*)(m) - sizeof(CK_MapHeader)) : NULL)
@@ -607,26 +613,30 @@ typedef struct CK_MapSlot
 #define map_validate(m) ((void)(!(m) || (assert(CK_MHDR(m)->cookie.val == CK_MAP_COOKIE), 1)))
 
 // Map header stored just before the values array.
-// All arrays (items, keys, islot, slots) are in a single allocation following the header.
-// Layout: [Header][items...][keys...][islot...][slots...]
+// All arrays (items, keys, islot, ctrl, sidx) are in a single allocation following the header.
+// Layout: [Header][items...][keys...][islot...][ctrl...][sidx...]
+//
+// The hash slots are SwissTable-style: each slot has a control byte holding 7 bits of the key's
+// hash (or empty/deleted), and slots are probed in groups of 16 with one SIMD compare per group.
 typedef struct CK_MapHeader
 {
 	CK_Cookie    cookie;         // Safety cookie for validation
 	int          val_size;       // Size of each value in bytes
 	int          size;           // Number of items
 	int          capacity;       // Capacity for items/keys/islot
-	int          slot_count;     // Number of used hash slots
-	int          slot_capacity;  // Capacity for hash slots (power of 2)
+	int          slot_count;     // Number of used hash slots, including deleted ones
+	int          slot_capacity;  // Capacity for hash slots (power of 2, at least 16)
 } CK_MapHeader;
 
 // Alignment helper.
 #define CK_ALIGN8(x) (((x) + 7) & ~(size_t)7)
 
 // Map implementation functions.
-CK_API void  ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_size);
+CK_API void* ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_size);
 CK_API CK_MapHeader* ck_map_ensure_capacity(void** m_ptr, int want_items, int val_size);
 CK_API int   ck_map_find_impl(CK_MapHeader* hdr, uint64_t key);
 CK_API void* ck_map_get_ptr_impl(CK_MapHeader* hdr, uint64_t key);
+CK_API void* ck_map_get_or_impl(CK_MapHeader* hdr, uint64_t key, void* fallback);
 CK_API int   ck_map_del_impl(CK_MapHeader* hdr, uint64_t key);
 CK_API void  ck_map_clear_impl(CK_MapHeader* hdr);
 CK_API void  ck_map_free_impl(CK_MapHeader* hdr);
@@ -690,8 +700,20 @@ CK_API const char* ck_sintern(const char* s);
 CK_API const char* ck_sintern_range(const char* start, const char* end);
 CK_API uint64_t ck_hash_fnv1a(const void* ptr, size_t sz);
 
+// General purpose 64-bit hash of a byte range (wyhash). Much faster than FNV-1a past a handful of
+// bytes. Not cryptographic, and the result is only stable for a given byte order.
+CK_API uint64_t ck_hash_bytes(const void* ptr, size_t sz, uint64_t seed);
+
 #ifdef __cplusplus
 } // extern "C"
+
+// Backs map_get and map_get_or -- a single hash lookup either way.
+template <typename T>
+inline T ck_map_get_or(T* m, uint64_t key, const T& fallback)
+{
+	T* p = (T*)ck_map_get_ptr_impl(CK_MHDR(m), key);
+	return p ? *p : fallback;
+}
 #endif
 
 #endif // CKIT_H
@@ -708,6 +730,24 @@ CK_API uint64_t ck_hash_fnv1a(const void* ptr, size_t sz);
 #include <stdio.h>
 #include <inttypes.h>
 
+// SIMD for map slot probing. Define CK_MAP_NO_SIMD to force the portable path.
+#if !defined(CK_MAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	include <emmintrin.h>
+#	define CK_MAP_SSE2 1
+#elif !defined(CK_MAP_NO_SIMD) && defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#	include <arm_neon.h>
+#	define CK_MAP_NEON 1
+#endif
+#ifndef CK_MAP_SSE2
+#	define CK_MAP_SSE2 0
+#endif
+#ifndef CK_MAP_NEON
+#	define CK_MAP_NEON 0
+#endif
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1401,14 +1441,65 @@ uint64_t ck_map_hash(uint64_t x)
 	return x ? x : 1ull;
 }
 
+// Control bytes. Full slots hold the top 7 bits of the hash (high bit clear).
+#define CK_MAP_CTRL_EMPTY   ((uint8_t)0x80)
+#define CK_MAP_CTRL_DELETED ((uint8_t)0xFE)
+#define CK_MAP_GROUP_SIZE   16
+
+static inline uint8_t ck_map_h2(uint64_t h) { return (uint8_t)(h >> 57); }
+
+static inline int ck_map_ctz(unsigned x)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward(&i, x);
+	return (int)i;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+#if CK_MAP_NEON
+static inline unsigned ck_map_neon_mask(uint8x16_t eq)
+{
+	static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t m = vandq_u8(eq, vld1q_u8(bits));
+	return (unsigned)vaddv_u8(vget_low_u8(m)) | ((unsigned)vaddv_u8(vget_high_u8(m)) << 8);
+}
+#endif
+
+// Bit i is set when ctrl[i] == b, for the 16 control bytes of a group.
+static inline unsigned ck_map_group_match(const uint8_t* ctrl, uint8_t b)
+{
+#if CK_MAP_SSE2
+	__m128i g = _mm_loadu_si128((const __m128i*)ctrl);
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)b)));
+#elif CK_MAP_NEON
+	return ck_map_neon_mask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(b)));
+#else
+	unsigned mask = 0;
+	for (int i = 0; i < CK_MAP_GROUP_SIZE; ++i) mask |= (unsigned)(ctrl[i] == b) << i;
+	return mask;
+#endif
+}
+
+// Bit i is set when ctrl[i] is empty or deleted.
+static inline unsigned ck_map_group_match_free(const uint8_t* ctrl)
+{
+#if CK_MAP_SSE2
+	return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#elif CK_MAP_NEON
+	return ck_map_neon_mask(vtstq_u8(vld1q_u8(ctrl), vdupq_n_u8(0x80)));
+#else
+	unsigned mask = 0;
+	for (int i = 0; i < CK_MAP_GROUP_SIZE; ++i) mask |= (unsigned)(ctrl[i] >> 7) << i;
+	return mask;
+#endif
+}
+
 void ck_map_zero_slots(CK_MapHeader* hdr)
 {
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
-	for (int i = 0; i < hdr->slot_capacity; ++i) {
-		slots[i].h = 0;
-		slots[i].item_index = -1;
-		slots[i].base_count = 0;
-	}
+	memset(ck_map_ctrl_ptr(hdr), CK_MAP_CTRL_EMPTY, (size_t)hdr->slot_capacity);
 	hdr->slot_count = 0;
 }
 
@@ -1418,80 +1509,71 @@ size_t ck_map_alloc_size(int capacity, int val_size, int slot_capacity)
 	size_t items_end = sizeof(CK_MapHeader) + CK_ALIGN8((size_t)capacity * val_size);
 	size_t keys_end = items_end + (size_t)capacity * sizeof(uint64_t);
 	size_t islot_end = keys_end + (size_t)capacity * sizeof(int);
-	size_t slots_start = CK_ALIGN8(islot_end);
-	return slots_start + (size_t)slot_capacity * sizeof(CK_MapSlot);
+	size_t sidx_start = CK_ALIGN8(islot_end + (size_t)slot_capacity);
+	return sidx_start + (size_t)slot_capacity * sizeof(int);
 }
 
+// Groups are probed triangularly (+1, +2, +3...), which visits every group when the group count
+// is a power of two. The load factor guarantees some group has an empty slot to stop on.
 int ck_map_find_insertion_slot(CK_MapHeader* hdr, uint64_t h)
 {
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
-	int mask = hdr->slot_capacity - 1;
-	int base = (int)(h & (uint64_t)mask);
-	int slot = base, first_free = base;
-	int remaining = slots[base].base_count;
-
-	while (remaining > 0) {
-		if (slots[slot].item_index < 0 && slots[first_free].item_index >= 0)
-			first_free = slot;
-		uint64_t sh = slots[slot].h;
-		if (sh) {
-			if (((int)(sh & (uint64_t)mask)) == base) --remaining;
-		}
-		slot = (slot + 1) & mask;
+	const uint8_t* ctrl = ck_map_ctrl_ptr(hdr);
+	int group_mask = hdr->slot_capacity / CK_MAP_GROUP_SIZE - 1;
+	int g = (int)(h & (uint64_t)group_mask);
+	for (int probe = 1;; ++probe) {
+		unsigned free_mask = ck_map_group_match_free(ctrl + g * CK_MAP_GROUP_SIZE);
+		if (free_mask) return g * CK_MAP_GROUP_SIZE + ck_map_ctz(free_mask);
+		g = (g + probe) & group_mask;
 	}
-
-	slot = first_free;
-	while (slots[slot].item_index >= 0) {
-		slot = (slot + 1) & mask;
-	}
-	return slot;
 }
 
 int ck_map_find_slot(const CK_MapHeader* hdr, uint64_t key, uint64_t h)
 {
 	if (hdr->slot_capacity == 0) return -1;
-	CK_MapSlot* slots = ck_map_slots_ptr((CK_MapHeader*)hdr);
-	uint64_t* keys = ck_map_keys_ptr((CK_MapHeader*)hdr);
-	int mask = hdr->slot_capacity - 1;
-	int base = (int)(h & (uint64_t)mask);
-	int slot = base;
-	int remaining = slots[base].base_count;
-	while (remaining > 0) {
-		int item = slots[slot].item_index;
-		if (item >= 0) {
-			uint64_t sh = slots[slot].h;
-			if (((int)(sh & (uint64_t)mask)) == base) {
-				--remaining;
-				if (sh == h && keys[item] == key) return slot;
-			}
+	const uint8_t* ctrl = ck_map_ctrl_ptr((CK_MapHeader*)hdr);
+	const int* sidx = ck_map_sidx_ptr((CK_MapHeader*)hdr);
+	const uint64_t* keys = ck_map_keys_ptr((CK_MapHeader*)hdr);
+	uint8_t h2 = ck_map_h2(h);
+	int group_mask = hdr->slot_capacity / CK_MAP_GROUP_SIZE - 1;
+	int g = (int)(h & (uint64_t)group_mask);
+	for (int probe = 1;; ++probe) {
+		const uint8_t* group = ctrl + g * CK_MAP_GROUP_SIZE;
+		unsigned match = ck_map_group_match(group, h2);
+		while (match) {
+			int slot = g * CK_MAP_GROUP_SIZE + ck_map_ctz(match);
+			if (keys[sidx[slot]] == key) return slot;
+			match &= match - 1;
 		}
-		slot = (slot + 1) & mask;
+		// An empty slot means the key would have been placed here, so it doesn't exist.
+		if (ck_map_group_match(group, CK_MAP_CTRL_EMPTY)) return -1;
+		g = (g + probe) & group_mask;
 	}
-	return -1;
 }
 
-// Rebuild hash table after reallocation. Assumes slots are already zeroed.
+// Claims a free slot for item idx.
+static void ck_map_insert_slot(CK_MapHeader* hdr, uint64_t h, int idx)
+{
+	uint8_t* ctrl = ck_map_ctrl_ptr(hdr);
+	int slot = ck_map_find_insertion_slot(hdr, h);
+	if (ctrl[slot] == CK_MAP_CTRL_EMPTY) ++hdr->slot_count;
+	ctrl[slot] = ck_map_h2(h);
+	ck_map_sidx_ptr(hdr)[slot] = idx;
+	ck_map_islot_ptr(hdr)[idx] = slot;
+}
+
+// Rebuild hash table after reallocation. Assumes slots are already emptied.
 void ck_map_rebuild_slots(CK_MapHeader* hdr)
 {
 	if (hdr->slot_capacity == 0) return;
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
 	uint64_t* keys = ck_map_keys_ptr(hdr);
-	int* islot = ck_map_islot_ptr(hdr);
 	for (int idx = 0; idx < hdr->size; ++idx) {
-		uint64_t h = ck_map_hash(keys[idx]);
-		int slot = ck_map_find_insertion_slot(hdr, h);
-		int base = (int)(h & (uint64_t)(hdr->slot_capacity - 1));
-		slots[slot].h = h;
-		slots[slot].item_index = idx;
-		++slots[base].base_count;
-		islot[idx] = slot;
-		++hdr->slot_count;
+		ck_map_insert_slot(hdr, ck_map_hash(keys[idx]), idx);
 	}
 }
 
 // Ensure we have capacity for 'want' items. May reallocate and update m_ptr.
 // Returns the possibly-updated header pointer.
-// Single allocation: [Header][items][keys][islot][slots]
+// Single allocation: [Header][items][keys][islot][ctrl][sidx]
 CK_MapHeader* ck_map_ensure_capacity(void** m_ptr, int want_items, int val_size)
 {
 	CK_MapHeader* hdr = *m_ptr ? (CK_MapHeader*)((char*)*m_ptr - sizeof(CK_MapHeader)) : NULL;
@@ -1515,17 +1597,16 @@ CK_MapHeader* ck_map_ensure_capacity(void** m_ptr, int want_items, int val_size)
 		while (new_slot_cap < min_slot_cap) new_slot_cap *= 2;
 	}
 
-	// Also check load factor on existing slots.
+	// Also check load factor on existing slots. Live items never exceed half the slots, so a full
+	// table here means deleted slots piled up -- rebuilding at the same size clears them out.
+	int rehash = 0;
 	if (hdr && hdr->slot_capacity > 0) {
 		int thresh = hdr->slot_capacity - (hdr->slot_capacity >> 2); // 75%
-		if (hdr->slot_count >= thresh) {
-			int grown = hdr->slot_capacity * 2;
-			if (grown > new_slot_cap) new_slot_cap = grown;
-		}
+		if (hdr->slot_count >= thresh) rehash = 1;
 	}
 
 	// If no change needed, return current.
-	if (new_item_cap == old_item_cap && new_slot_cap == old_slot_cap) {
+	if (new_item_cap == old_item_cap && new_slot_cap == old_slot_cap && !rehash) {
 		return hdr;
 	}
 
@@ -1552,9 +1633,8 @@ CK_MapHeader* ck_map_ensure_capacity(void** m_ptr, int want_items, int val_size)
 	int* new_islot = ck_map_islot_ptr(new_hdr);
 	for (int i = 0; i < new_item_cap; i++) new_islot[i] = -1;
 
-	// Initialize slots item_index to -1 (0 would appear occupied).
-	CK_MapSlot* new_slots = ck_map_slots_ptr(new_hdr);
-	for (int i = 0; i < new_slot_cap; i++) new_slots[i].item_index = -1;
+	// Mark every slot empty (0 would read as a full slot).
+	ck_map_zero_slots(new_hdr);
 
 	// Rebuild hash table.
 	ck_map_rebuild_slots(new_hdr);
@@ -1573,11 +1653,10 @@ int ck_map_find_impl(CK_MapHeader* hdr, uint64_t key)
 	uint64_t h = ck_map_hash(key);
 	int s = ck_map_find_slot(hdr, key, h);
 	if (s < 0) return -1;
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
-	return slots[s].item_index;
+	return ck_map_sidx_ptr(hdr)[s];
 }
 
-void ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_size)
+void* ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_size)
 {
 	CK_MapHeader* hdr = *m_ptr ? (CK_MapHeader*)((char*)*m_ptr - sizeof(CK_MapHeader)) : NULL;
 	uint64_t h = ck_map_hash(key);
@@ -1586,11 +1665,10 @@ void ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_si
 	if (hdr && hdr->slot_capacity) {
 		int s = ck_map_find_slot(hdr, key, h);
 		if (s >= 0) {
-			CK_MapSlot* slots = ck_map_slots_ptr(hdr);
-			int idx = slots[s].item_index;
+			int idx = ck_map_sidx_ptr(hdr)[s];
 			char* items = (char*)ck_map_items_ptr(hdr);
 			memcpy(items + idx * hdr->val_size, val, (size_t)hdr->val_size);
-			return;
+			return items + idx * hdr->val_size;
 		}
 	}
 
@@ -1602,8 +1680,6 @@ void ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_si
 	// Get array pointers (may have changed after realloc).
 	char* items = (char*)ck_map_items_ptr(hdr);
 	uint64_t* keys = ck_map_keys_ptr(hdr);
-	int* islot = ck_map_islot_ptr(hdr);
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
 
 	// Append to dense set.
 	int idx = hdr->size++;
@@ -1611,13 +1687,8 @@ void ck_map_set_stretchy(void** m_ptr, uint64_t key, const void* val, int val_si
 	memcpy(items + idx * hdr->val_size, val, (size_t)hdr->val_size);
 
 	// Insert into hash slots.
-	int slot = ck_map_find_insertion_slot(hdr, h);
-	int base = (int)(h & (uint64_t)(hdr->slot_capacity - 1));
-	slots[slot].h = h;
-	slots[slot].item_index = idx;
-	++slots[base].base_count;
-	islot[idx] = slot;
-	++hdr->slot_count;
+	ck_map_insert_slot(hdr, h, idx);
+	return items + idx * hdr->val_size;
 }
 
 void* ck_map_get_ptr_impl(CK_MapHeader* hdr, uint64_t key)
@@ -1626,8 +1697,13 @@ void* ck_map_get_ptr_impl(CK_MapHeader* hdr, uint64_t key)
 	uint64_t h = ck_map_hash(key);
 	int s = ck_map_find_slot(hdr, key, h);
 	if (s < 0) return NULL;
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
-	return (char*)ck_map_items_ptr(hdr) + slots[s].item_index * hdr->val_size;
+	return (char*)ck_map_items_ptr(hdr) + ck_map_sidx_ptr(hdr)[s] * hdr->val_size;
+}
+
+void* ck_map_get_or_impl(CK_MapHeader* hdr, uint64_t key, void* fallback)
+{
+	void* p = ck_map_get_ptr_impl(hdr, key);
+	return p ? p : fallback;
 }
 
 int ck_map_del_impl(CK_MapHeader* hdr, uint64_t key)
@@ -1637,25 +1713,30 @@ int ck_map_del_impl(CK_MapHeader* hdr, uint64_t key)
 	int s = ck_map_find_slot(hdr, key, h);
 	if (s < 0) return 0;
 
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
+	uint8_t* ctrl = ck_map_ctrl_ptr(hdr);
+	int* sidx = ck_map_sidx_ptr(hdr);
 	uint64_t* keys = ck_map_keys_ptr(hdr);
 	int* islot = ck_map_islot_ptr(hdr);
 	char* items = (char*)ck_map_items_ptr(hdr);
 
-	int mask = hdr->slot_capacity - 1;
-	int base = (int)(h & (uint64_t)mask);
-	int idx = slots[s].item_index;
+	int idx = sidx[s];
 	int last = hdr->size - 1;
 
-	--slots[base].base_count;
-	slots[s].item_index = -1;
-	--hdr->slot_count;
+	// A group that still has an empty slot has never been full, so no probe ever continued
+	// past it and the slot can go straight back to empty. Otherwise leave a deleted marker.
+	const uint8_t* group = ctrl + (s & ~(CK_MAP_GROUP_SIZE - 1));
+	if (ck_map_group_match(group, CK_MAP_CTRL_EMPTY)) {
+		ctrl[s] = CK_MAP_CTRL_EMPTY;
+		--hdr->slot_count;
+	} else {
+		ctrl[s] = CK_MAP_CTRL_DELETED;
+	}
 
 	if (idx != last) {
 		keys[idx] = keys[last];
 		memcpy(items + idx * hdr->val_size, items + last * hdr->val_size, (size_t)hdr->val_size);
 		int ms = islot[last];
-		slots[ms].item_index = idx;
+		sidx[ms] = idx;
 		islot[idx] = ms;
 	}
 	islot[last] = -1;
@@ -1671,7 +1752,7 @@ void ck_map_swap_impl(CK_MapHeader* hdr, int i, int j)
 
 	uint64_t* keys = ck_map_keys_ptr(hdr);
 	int* islot = ck_map_islot_ptr(hdr);
-	CK_MapSlot* slots = ck_map_slots_ptr(hdr);
+	int* sidx = ck_map_sidx_ptr(hdr);
 	char* items = (char*)ck_map_items_ptr(hdr);
 
 	// Swap keys.
@@ -1690,8 +1771,8 @@ void ck_map_swap_impl(CK_MapHeader* hdr, int i, int j)
 	// Swap islot backpointers.
 	int si = islot[i];
 	int sj = islot[j];
-	if (si >= 0) slots[si].item_index = j;
-	if (sj >= 0) slots[sj].item_index = i;
+	if (si >= 0) sidx[si] = j;
+	if (sj >= 0) sidx[sj] = i;
 	islot[i] = sj;
 	islot[j] = si;
 }
@@ -1761,7 +1842,83 @@ void ck_map_clear_impl(CK_MapHeader* hdr)
 }
 
 //--------------------------------------------------------------------------------------------------
-// String interning (originally from Per Vognsen).
+// Hashing. ck_hash_bytes is wyhash (final version 4, public domain, Wang Yi). Input is consumed in
+// 48 byte strides split over three independent multiply-mix lanes, so long inputs run near memory
+// bandwidth instead of being bound by FNV-1a's serial multiply per byte.
+
+static const uint64_t ck_wyp[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+// 64x64 -> 128 bit multiply, *a receives the low half and *b the high half.
+static inline void ck_wymum(uint64_t* a, uint64_t* b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t)*a * *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	*a = _umul128(*a, *b, b);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+	uint64_t lo = *a * *b;
+	*b = __umulh(*a, *b);
+	*a = lo;
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+	uint64_t c = t < rl, lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t ck_wymix(uint64_t a, uint64_t b) { ck_wymum(&a, &b); return a ^ b; }
+static inline uint64_t ck_wyr8(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint64_t ck_wyr4(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static inline uint64_t ck_wyr3(const uint8_t* p, size_t k) { return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1]; }
+
+uint64_t ck_hash_bytes(const void* ptr, size_t sz, uint64_t seed)
+{
+	const uint8_t* p = (const uint8_t*)ptr;
+	seed ^= ck_wymix(seed ^ ck_wyp[0], ck_wyp[1]);
+	uint64_t a, b;
+	if (sz <= 16) {
+		if (sz >= 4) {
+			// Two overlapping 4 byte reads from each end cover 4..16 bytes without a loop.
+			a = (ck_wyr4(p) << 32) | ck_wyr4(p + ((sz >> 3) << 2));
+			b = (ck_wyr4(p + sz - 4) << 32) | ck_wyr4(p + sz - 4 - ((sz >> 3) << 2));
+		} else if (sz > 0) {
+			a = ck_wyr3(p, sz);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = sz;
+		if (i >= 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = ck_wymix(ck_wyr8(p) ^ ck_wyp[1], ck_wyr8(p + 8) ^ seed);
+				see1 = ck_wymix(ck_wyr8(p + 16) ^ ck_wyp[2], ck_wyr8(p + 24) ^ see1);
+				see2 = ck_wymix(ck_wyr8(p + 32) ^ ck_wyp[3], ck_wyr8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i >= 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = ck_wymix(ck_wyr8(p) ^ ck_wyp[1], ck_wyr8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		// The last 16 bytes, overlapping what the loops consumed when the tail is short.
+		a = ck_wyr8(p + i - 16);
+		b = ck_wyr8(p + i - 8);
+	}
+	a ^= ck_wyp[1];
+	b ^= seed;
+	ck_wymum(&a, &b);
+	return ck_wymix(a ^ ck_wyp[0] ^ sz, b ^ ck_wyp[1]);
+}
 
 uint64_t ck_hash_fnv1a(const void* ptr, size_t sz)
 {
@@ -1774,6 +1931,9 @@ uint64_t ck_hash_fnv1a(const void* ptr, size_t sz)
 	return x;
 }
 
+//--------------------------------------------------------------------------------------------------
+// String interning (originally from Per Vognsen).
+
 // C11 atomics for C, std::atomic for C++
 // Must close extern "C" before including <atomic> since it contains C++ templates.
 #ifdef __cplusplus
@@ -1794,10 +1954,33 @@ extern "C" {
 #define ck_atomic_compare_exchange_weak(p, expected, desired) atomic_compare_exchange_weak(p, expected, desired)
 #endif
 
-typedef struct CK_InternTable
+// Interned strings live in open-addressed tables of atomic pointers, one per shard. Readers probe
+// without locking: a slot is either empty or points at a fully built string. Writers lock only
+// their shard. A shard grows by publishing a bigger copy of its table; the old one stays alive
+// (readers may still be probing it) and is freed by sintern_nuke().
+#ifndef CK_INTERN_SHARD_BITS
+#	define CK_INTERN_SHARD_BITS 6
+#endif
+#define CK_INTERN_SHARD_COUNT (1 << CK_INTERN_SHARD_BITS)
+
+typedef struct CK_InternSlots
+{
+	int capacity; // Power of two.
+	struct CK_InternSlots* retired;
+	CK_ATOMIC(CK_UniqueString*)* slots;
+} CK_InternSlots;
+
+typedef struct CK_InternShard
 {
-	CK_MAP(CK_UniqueString*) interns;
+	CK_ATOMIC(CK_InternSlots*) table;
 	CK_ATOMIC(int) lock;
+	int count;
+	char pad[64 - sizeof(CK_ATOMIC(CK_InternSlots*)) - sizeof(CK_ATOMIC(int)) - sizeof(int)];
+} CK_InternShard;
+
+typedef struct CK_InternTable
+{
+	CK_InternShard shards[CK_INTERN_SHARD_COUNT];
 } CK_InternTable;
 
 static CK_ATOMIC(CK_InternTable*) g_intern_table;
@@ -1822,17 +2005,48 @@ static CK_InternTable* ck_sintern_get_table()
 	return table;
 }
 
-static void ck_sintern_lock(CK_InternTable* table)
+static void ck_sintern_lock(CK_InternShard* shard)
 {
 	int expected = 0;
-	while (!ck_atomic_compare_exchange_weak(&table->lock, &expected, 1)) {
+	while (!ck_atomic_compare_exchange_weak(&shard->lock, &expected, 1)) {
 		expected = 0;
 	}
 }
 
-static void ck_sintern_unlock(CK_InternTable* table)
+static void ck_sintern_unlock(CK_InternShard* shard)
+{
+	ck_atomic_store(&shard->lock, 0);
+}
+
+static CK_InternSlots* ck_sintern_make_slots(int capacity)
 {
-	ck_atomic_store(&table->lock, 0);
+	size_t bytes = sizeof(CK_InternSlots) + sizeof(CK_ATOMIC(CK_UniqueString*)) * capacity;
+	CK_InternSlots* slots = (CK_InternSlots*)CK_ALLOC(bytes);
+	memset(slots, 0, bytes);
+	slots->capacity = capacity;
+	slots->slots = (CK_ATOMIC(CK_UniqueString*)*)(slots + 1);
+	return slots;
+}
+
+// Returns the matching string, or NULL. Safe to call without the shard lock.
+static CK_UniqueString* ck_sintern_find(CK_InternSlots* table, uint64_t hash, const char* start, size_t len)
+{
+	if (!table) return NULL;
+	int mask = table->capacity - 1;
+	for (int i = (int)hash & mask;; i = (i + 1) & mask) {
+		CK_UniqueString* it = ck_atomic_load(&table->slots[i]);
+		if (!it) return NULL;
+		if (it->hash == hash && (size_t)it->len == len && memcmp(it->str, start, len) == 0) return it;
+	}
+}
+
+// Shard lock must be held. The slot is stored last, so readers never see a partial string.
+static void ck_sintern_insert(CK_InternSlots* table, CK_UniqueString* node)
+{
+	int mask = table->capacity - 1;
+	int i = (int)node->hash & mask;
+	while (ck_atomic_load(&table->slots[i])) i = (i + 1) & mask;
+	ck_atomic_store(&table->slots[i], node);
 }
 
 const char* ck_sintern(const char* s)
@@ -1867,29 +2081,50 @@ const char* ck_sintern_range(const char* start, const char* end)
 {
 	CK_InternTable* table = ck_sintern_get_table();
 	size_t len = (size_t)(end - start);
-	uint64_t key = ck_hash_fnv1a((void*)start, len);
-
-	ck_sintern_lock(table);
+	uint64_t hash = ck_hash_bytes(start, len, 0);
+	// Top bits pick the shard, low bits pick the slot within it.
+	CK_InternShard* shard = table->shards + (hash >> (64 - CK_INTERN_SHARD_BITS));
+
+	// Fast path, no lock: the string was interned before.
+	CK_UniqueString* found = ck_sintern_find(ck_atomic_load(&shard->table), hash, start, len);
+	if (found) return found->str;
+
+	ck_sintern_lock(shard);
+
+	// Another thread may have inserted it (or grown the table) since the unlocked lookup.
+	CK_InternSlots* slots = ck_atomic_load(&shard->table);
+	found = ck_sintern_find(slots, hash, start, len);
+	if (found) {
+		ck_sintern_unlock(shard);
+		return found->str;
+	}
 
-	CK_UniqueString* head = map_get(table->interns, key);
-	for (CK_UniqueString* it = head; it; it = it->next) {
-		if ((size_t)it->len == len && memcmp(it->str, start, len) == 0) {
-			ck_sintern_unlock(table);
-			return it->str;
+	// Keep the load factor at or below one half so probe sequences stay short.
+	if (!slots || (shard->count + 1) * 2 > slots->capacity) {
+		CK_InternSlots* grown = ck_sintern_make_slots(slots ? slots->capacity * 2 : 64);
+		if (slots) {
+			for (int i = 0; i < slots->capacity; ++i) {
+				CK_UniqueString* it = ck_atomic_load(&slots->slots[i]);
+				if (it) ck_sintern_insert(grown, it);
+			}
 		}
+		grown->retired = slots;
+		ck_atomic_store(&shard->table, grown);
+		slots = grown;
 	}
 
 	size_t bytes = sizeof(CK_UniqueString) + len + 1;
 	CK_UniqueString* node = (CK_UniqueString*)CK_ALLOC(bytes);
 	node->cookie.val = CK_INTERN_COOKIE;
 	node->len = (int)len;
-	node->next = head;
+	node->hash = hash;
 	node->str = (char*)(node + 1);
 	memcpy(node->str, start, len);
 	node->str[len] = '\0';
-	map_set(table->interns, key, node);
+	ck_sintern_insert(slots, node);
+	shard->count++;
 
-	ck_sintern_unlock(table);
+	ck_sintern_unlock(shard);
 	return node->str;
 }
 
@@ -1898,20 +2133,25 @@ void sintern_nuke()
 	g_sintern_gen++;
 	CK_InternTable* table = ck_atomic_load(&g_intern_table);
 	if (!table) return;
-
-	ck_sintern_lock(table);
 	ck_atomic_store(&g_intern_table, (CK_InternTable*)NULL);
 
-	for (int i = 0; i < map_size(table->interns); ++i) {
-		CK_UniqueString* it = map_items(table->interns)[i];
-		while (it) {
-			CK_UniqueString* next = it->next;
-			CK_FREE(it);
-			it = next;
+	for (int i = 0; i < CK_INTERN_SHARD_COUNT; ++i) {
+		CK_InternShard* shard = table->shards + i;
+		ck_sintern_lock(shard);
+		CK_InternSlots* slots = ck_atomic_load(&shard->table);
+		if (slots) {
+			for (int j = 0; j < slots->capacity; ++j) {
+				CK_UniqueString* it = ck_atomic_load(&slots->slots[j]);
+				if (it) CK_FREE(it);
+			}
+		}
+		while (slots) {
+			CK_InternSlots* retired = slots->retired;
+			CK_FREE(slots);
+			slots = retired;
 		}
+		ck_sintern_unlock(shard);
 	}
-	map_free(table->interns);
-	ck_sintern_unlock(table);
 	CK_FREE(table);
 }
 
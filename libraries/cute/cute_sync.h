@@ -3,7 +3,7 @@
 		Licensing information can be found at the end of the file.
 	------------------------------------------------------------------------------
 
-	cute_sync.h - v1.02
+	cute_sync.h - v1.03
 
 	To create implementation (the function definitions)
 		#define CUTE_SYNC_IMPLEMENTATION
@@ -62,11 +62,22 @@
 		     - Fixed race conditions in cute_threadpool_kick and cute_threadpool_kick_and_wait
 		     - Fixed resource leaks in cute_threadpool_destroy (mutex/semaphore not freed)
 		     - Removed unused sem_mutex field from threadpool
+		1.03 (10/17/2026) Work-stealing threadpool:
+		     - Added 64-bit atomics (cute_atomic64_t)
+		     - Threadpool tasks now live in per-worker Chase-Lev deques, workers steal
+		       from each other instead of contending on a single mutex
+		     - cute_threadpool_kick_and_wait now waits for in-flight tasks to finish
+		     - Added task counters, see cute_threadpool_add_task_with_counter and
+		       cute_threadpool_wait_counter
+		     - Added cute_threadpool_add_task_shared to re-schedule a task behind others
+		     - Added cute_threadpool_add_task_after to hold a task back until a counter
+		       reaches zero, without anything spinning on it
 */
 
 #if !defined(CUTE_SYNC_H)
 
 typedef union cute_atomic_int_t cute_atomic_int_t;
+typedef union cute_atomic64_t cute_atomic64_t;
 typedef union cute_mutex_t cute_mutex_t;
 typedef union cute_cv_t cute_cv_t;
 typedef struct cute_semaphore_t cute_semaphore_t;
@@ -221,6 +232,27 @@ void* cute_atomic_ptr_get(void** atomic);
  */
 int cute_atomic_ptr_cas(void** atomic, void* expected, void* value);
 
+/**
+ * Atomically adds `addend` at `atomic` and returns the old value at `atomic`.
+ */
+long long cute_atomic64_add(cute_atomic64_t* atomic, long long addend);
+
+/**
+ * Atomically sets `value` at `atomic` and returns the old value at `atomic`.
+ */
+long long cute_atomic64_set(cute_atomic64_t* atomic, long long value);
+
+/**
+ * Atomically fetches the value at `atomic`.
+ */
+long long cute_atomic64_get(cute_atomic64_t* atomic);
+
+/**
+ * Atomically sets `atomic` to `value` if `expected` equals `atomic`.
+ * Returns 1 of the value was set, 0 otherwise.
+ */
+int cute_atomic64_cas(cute_atomic64_t* atomic, long long expected, long long value);
+
 /**
  * A reader/writer mutual exclusion lock. Allows many simultaneous readers or a single writer.
  *
@@ -274,20 +306,56 @@ typedef struct cute_threadpool_t cute_threadpool_t;
  * cache line size on a given machine. `CUTE_SYNC_CACHELINE_SIZE` defaults to 128 bytes, and can
  * be overidden by defining CUTE_SYNC_CACHELINE_SIZE before including cute_sync.h
  *
- * Makes a modest attempt at memory aligning to avoid false sharing, as an optimization.
+ * Each worker owns a lock-free work-stealing deque (Chase-Lev). Workers pop their own tasks
+ * and steal from each other when they run dry, so no lock is taken to fetch a task.
  */
 cute_threadpool_t* cute_threadpool_create(int thread_count, void* mem_ctx);
 
 /**
- * Atomically adds a single task to the internal task stack (FIFO order). The task is represented
- * as a function pointer `func`, which does work. The `param` is passed to the `func` when the
- * task is started.
+ * Adds a single task to the pool. The task is represented as a function pointer `func`, which
+ * does work. The `param` is passed to the `func` when the task is started.
+ *
+ * Called from a worker thread (e.g. from within a task) the task goes onto that worker's own
+ * deque without locking. Called from any other thread the task goes onto a shared injection
+ * deque, which only locks against other adding threads -- workers grab from it lock-free.
  */
 void cute_threadpool_add_task(cute_threadpool_t* pool, void (*func)(void*), void* param);
 
+/**
+ * Same as `cute_threadpool_add_task`, but `counter` is incremented now and decremented once the
+ * task finishes. Many tasks can share one counter to form a group, which can then be waited on
+ * with `cute_threadpool_wait_counter`. `counter` must stay alive until it reaches zero.
+ */
+void cute_threadpool_add_task_with_counter(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter);
+
+/**
+ * Same as `cute_threadpool_add_task_with_counter`, but the task always goes onto the shared
+ * injection deque, even when called from a worker. Tasks already on the calling worker's own
+ * deque run first, so a task can re-add itself to check on something again later without
+ * starving the tasks it's waiting on.
+ */
+void cute_threadpool_add_task_shared(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter);
+
+/**
+ * Same as `cute_threadpool_add_task_shared`, but the task is held back until `wait_counter`
+ * reaches zero. Nothing polls a held task, so workers can go to sleep in the meantime. Held
+ * tasks are checked whenever one of this pool's task counters reaches zero, so `wait_counter`
+ * must be counting tasks added to this same pool. If `wait_counter` is already zero the task
+ * is added right away.
+ */
+void cute_threadpool_add_task_after(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter, cute_atomic_int_t* wait_counter);
+
+/**
+ * Wakes internal threads and waits until `counter` reaches zero. Instead of sleeping, the calling
+ * thread runs other tasks while waiting. Unlike `cute_threadpool_kick_and_wait` this is safe to
+ * call from within a task, which is how a task can depend on other tasks.
+ */
+void cute_threadpool_wait_counter(cute_threadpool_t* pool, cute_atomic_int_t* counter);
+
 /**
  * Wakes internal threads to perform tasks, and waits for all tasks to complete before returning.
- * The calling thread will help perform available tasks while waiting.
+ * The calling thread will help perform available tasks while waiting. Must not be called from
+ * within a task running on the same pool.
  */
 void cute_threadpool_kick_and_wait(cute_threadpool_t* pool);
 
@@ -309,6 +377,7 @@ void cute_threadpool_destroy(cute_threadpool_t* pool);
 #ifndef CUTE_SYNC_TYPE_DEFINITIONS_H
 
 union  cute_atomic_int_t { void* align; long i;                  };
+union  cute_atomic64_t   { void* align; long long i;             };
 union  cute_mutex_t      { void* align; char data[64];           };
 union  cute_cv_t         { void* align; char data[64];           };
 struct cute_semaphore_t  { void* id;    cute_atomic_int_t count; };
@@ -392,6 +461,28 @@ struct cute_rw_lock_t
 	#define CUTE_SYNC_CACHELINE_SIZE 128
 #endif
 
+#if !defined(CUTE_SYNC_THREAD_LOCAL)
+	#if defined(__cplusplus)
+		#define CUTE_SYNC_THREAD_LOCAL thread_local
+	#elif defined(_MSC_VER)
+		#define CUTE_SYNC_THREAD_LOCAL __declspec(thread)
+	#else
+		#define CUTE_SYNC_THREAD_LOCAL _Thread_local
+	#endif
+#endif
+
+// Relaxed loads/stores for pointer-sized values that are read racily by design (e.g. the task
+// slots of a work-stealing deque). MSVC's plain accesses are already atomic at this size.
+#if !defined(CUTE_SYNC_RELAXED_LOAD)
+	#if defined(_MSC_VER)
+		#define CUTE_SYNC_RELAXED_LOAD(ptr) (*(ptr))
+		#define CUTE_SYNC_RELAXED_STORE(ptr, value) (*(ptr) = (value))
+	#else
+		#define CUTE_SYNC_RELAXED_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+		#define CUTE_SYNC_RELAXED_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+	#endif
+#endif
+
 // Atomics implementation.
 // Use SDL3's implementation if available, otherwise WIN32 and GCC-like compilers are supported out-of-the-box.
 #ifdef CUTE_SYNC_SDL
@@ -530,6 +621,75 @@ int cute_atomic_ptr_cas(void** atomic, void* expected, void* value)
 
 #endif // End atomics implementation.
 
+// 64-bit atomics go straight to compiler intrinsics for every backend, as SDL3 only exposes
+// 32-bit and pointer atomics.
+#if defined(_MSC_VER)
+
+#include <intrin.h>
+
+long long cute_atomic64_add(cute_atomic64_t* atomic, long long addend)
+{
+	return _InterlockedExchangeAdd64(&atomic->i, addend);
+}
+
+long long cute_atomic64_set(cute_atomic64_t* atomic, long long value)
+{
+	return _InterlockedExchange64(&atomic->i, value);
+}
+
+long long cute_atomic64_get(cute_atomic64_t* atomic)
+{
+	return _InterlockedCompareExchange64(&atomic->i, 0, 0);
+}
+
+int cute_atomic64_cas(cute_atomic64_t* atomic, long long expected, long long value)
+{
+	return _InterlockedCompareExchange64(&atomic->i, value, expected) == expected;
+}
+
+#else
+
+long long cute_atomic64_add(cute_atomic64_t* atomic, long long addend)
+{
+	return __atomic_fetch_add(&atomic->i, addend, __ATOMIC_SEQ_CST);
+}
+
+long long cute_atomic64_set(cute_atomic64_t* atomic, long long value)
+{
+	return __atomic_exchange_n(&atomic->i, value, __ATOMIC_SEQ_CST);
+}
+
+long long cute_atomic64_get(cute_atomic64_t* atomic)
+{
+	return __atomic_load_n(&atomic->i, __ATOMIC_SEQ_CST);
+}
+
+int cute_atomic64_cas(cute_atomic64_t* atomic, long long expected, long long value)
+{
+	return __atomic_compare_exchange_n(&atomic->i, &expected, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif
+
+// Acquire loads and release stores, cheaper than the sequentially consistent atomics above when
+// only one side writes (e.g. the indices of a single-producer single-consumer ring). MSVC falls
+// back to full barriers, since its plain accesses aren't ordered on ARM.
+#if defined(_MSC_VER)
+
+static long long cute_load_acquire64_internal(long long* ptr) { return _InterlockedCompareExchange64(ptr, 0, 0); }
+static void cute_store_release64_internal(long long* ptr, long long value) { _InterlockedExchange64(ptr, value); }
+static void* cute_load_acquire_ptr_internal(void** ptr) { return _InterlockedCompareExchangePointer(ptr, NULL, NULL); }
+static void cute_store_release_ptr_internal(void** ptr, void* value) { _InterlockedExchangePointer(ptr, value); }
+
+#else
+
+static long long cute_load_acquire64_internal(long long* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+static void cute_store_release64_internal(long long* ptr, long long value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+static void* cute_load_acquire_ptr_internal(void** ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+static void cute_store_release_ptr_internal(void** ptr, void* value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+
+#endif
+
 #if defined(CUTE_SYNC_SDL)
 
 cute_mutex_t cute_mutex_create()
@@ -1217,7 +1377,7 @@ static void* cute_malloc_aligned(size_t size, int alignment, void* mem_ctx)
 	void* p = CUTE_SYNC_ALLOC(size + alignment, mem_ctx);
 	if (!p) return 0;
 	unsigned char offset = (unsigned char)((size_t)p & (alignment - 1));
-	p = (void*)CUTE_SYNC_ALIGN_PTR(p + 1, alignment);
+	p = (void*)CUTE_SYNC_ALIGN_PTR((char*)p + 1, alignment);
 	*((char*)p - 1) = alignment - offset;
 	return p;
 }
@@ -1234,51 +1394,313 @@ typedef struct cute_task_t
 {
 	void (*do_work)(void*);
 	void* param;
+	cute_atomic_int_t* counter;
 } cute_task_t;
 
-typedef struct cute_threadpool_t
+// A task held back by `cute_threadpool_add_task_after`.
+typedef struct cute_held_task_t
+{
+	cute_task_t task;
+	cute_atomic_int_t* wait_counter;
+} cute_held_task_t;
+
+// Backing ring buffer of a deque. Only the owner grows the ring. Old rings are kept on a list
+// until the pool is destroyed, since a thief may still be reading from one mid-steal.
+typedef struct cute_task_ring_t
 {
-	int task_capacity;
-	int task_count;
+	long long capacity;
+	struct cute_task_ring_t* next_retired;
 	cute_task_t* tasks;
-	cute_mutex_t task_mutex;
+} cute_task_ring_t;
+
+// Chase-Lev work-stealing deque. A single owner pushes and pops from the bottom without any
+// locking, while thieves race to take tasks from the top with a CAS.
+// See "Dynamic Circular Work-Stealing Deque" (Chase, Lev 2005) and "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli 2013).
+typedef struct cute_deque_t
+{
+	cute_atomic64_t top;
+	char pad0[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	cute_atomic64_t bottom;
+	char pad1[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	void* ring;
+	cute_task_ring_t* retired;
+	char pad2[CUTE_SYNC_CACHELINE_SIZE - sizeof(void*) * 2];
+} cute_deque_t;
+
+typedef struct cute_worker_t
+{
+	cute_deque_t deque;
+	cute_threadpool_t* pool;
+	int index;
+	unsigned seed;
+	char pad[CUTE_SYNC_CACHELINE_SIZE - sizeof(void*) - sizeof(int) * 2];
+} cute_worker_t;
+
+typedef struct cute_threadpool_t
+{
+	// Tasks added from threads outside the pool land here. Adding threads lock against each
+	// other, while workers steal from it lock-free in batches.
+	cute_deque_t inject;
+	cute_mutex_t inject_mutex;
 
 	int thread_count;
 	cute_thread_t** threads;
+	cute_worker_t* workers;
+
+	// Number of added tasks not yet finished. Workers report finished tasks in batches to
+	// keep this cache line quiet.
+	cute_atomic64_t pending;
+
+	// Tasks waiting on a counter, guarded by `inject_mutex`. `held_count` is read without the
+	// lock, so finishing a counter doesn't lock unless something is actually waiting.
+	cute_held_task_t* held;
+	int held_capacity;
+	cute_atomic_int_t held_count;
 
 	cute_atomic_int_t running;
 	cute_semaphore_t semaphore;
 	void* mem_ctx;
 } cute_threadpool_t;
 
-int cute_try_pop_task_internal(cute_threadpool_t* pool, cute_task_t* task)
+// How many tasks a worker finishes before reporting them to `pending`.
+#define CUTE_SYNC_COMPLETION_BATCH 64
+
+// Most tasks a thief takes from the injection deque at once.
+#define CUTE_SYNC_STEAL_BATCH 32
+
+// The worker (if any) running on the calling thread.
+static CUTE_SYNC_THREAD_LOCAL cute_worker_t* cute_tls_worker;
+
+static cute_task_ring_t* cute_task_ring_create_internal(long long capacity, void* mem_ctx)
 {
-	cute_lock(&pool->task_mutex);
+	cute_task_ring_t* ring = (cute_task_ring_t*)CUTE_SYNC_ALLOC(sizeof(cute_task_ring_t) + sizeof(cute_task_t) * capacity, mem_ctx);
+	ring->capacity = capacity;
+	ring->next_retired = NULL;
+	ring->tasks = (cute_task_t*)(ring + 1);
+	return ring;
+}
 
-	if (pool->task_count) {
-		*task = pool->tasks[--pool->task_count];
-		cute_unlock(&pool->task_mutex);
-		return 1;
+// Slots may be read by a thief racing against the owner overwriting them. The thief's CAS on
+// `top` fails in that case and the torn read is discarded, but each field still goes through
+// a relaxed atomic so the race is well defined.
+static cute_task_t cute_task_ring_get_internal(cute_task_ring_t* ring, long long i)
+{
+	cute_task_t* slot = ring->tasks + (i & (ring->capacity - 1));
+	cute_task_t task;
+	task.do_work = CUTE_SYNC_RELAXED_LOAD(&slot->do_work);
+	task.param = CUTE_SYNC_RELAXED_LOAD(&slot->param);
+	task.counter = CUTE_SYNC_RELAXED_LOAD(&slot->counter);
+	return task;
+}
+
+static void cute_task_ring_set_internal(cute_task_ring_t* ring, long long i, cute_task_t task)
+{
+	cute_task_t* slot = ring->tasks + (i & (ring->capacity - 1));
+	CUTE_SYNC_RELAXED_STORE(&slot->do_work, task.do_work);
+	CUTE_SYNC_RELAXED_STORE(&slot->param, task.param);
+	CUTE_SYNC_RELAXED_STORE(&slot->counter, task.counter);
+}
+
+static void cute_deque_init_internal(cute_deque_t* deque, void* mem_ctx)
+{
+	deque->top.i = 0;
+	deque->bottom.i = 0;
+	deque->ring = cute_task_ring_create_internal(256, mem_ctx);
+	deque->retired = NULL;
+}
+
+static void cute_deque_destroy_internal(cute_deque_t* deque, void* mem_ctx)
+{
+	(void)mem_ctx;
+	cute_task_ring_t* ring = deque->retired;
+	while (ring) {
+		cute_task_ring_t* next = ring->next_retired;
+		CUTE_SYNC_FREE(ring, mem_ctx);
+		ring = next;
 	}
+	CUTE_SYNC_FREE(deque->ring, mem_ctx);
+}
+
+// Owner only.
+static void cute_deque_push_internal(cute_deque_t* deque, cute_task_t task, void* mem_ctx)
+{
+	long long b = cute_atomic64_get(&deque->bottom);
+	long long t = cute_atomic64_get(&deque->top);
+	cute_task_ring_t* ring = (cute_task_ring_t*)CUTE_SYNC_RELAXED_LOAD(&deque->ring);
+
+	if (b - t >= ring->capacity - 1) {
+		cute_task_ring_t* bigger = cute_task_ring_create_internal(ring->capacity * 2, mem_ctx);
+		for (long long i = t; i < b; ++i) {
+			cute_task_ring_set_internal(bigger, i, cute_task_ring_get_internal(ring, i));
+		}
+		ring->next_retired = deque->retired;
+		deque->retired = ring;
+		cute_atomic_ptr_set(&deque->ring, bigger);
+		ring = bigger;
+	}
+
+	cute_task_ring_set_internal(ring, b, task);
+	cute_atomic64_set(&deque->bottom, b + 1);
+}
+
+// Owner only.
+static int cute_deque_pop_internal(cute_deque_t* deque, cute_task_t* task)
+{
+	long long b = cute_atomic64_get(&deque->bottom) - 1;
+	cute_task_ring_t* ring = (cute_task_ring_t*)CUTE_SYNC_RELAXED_LOAD(&deque->ring);
+	cute_atomic64_set(&deque->bottom, b);
+	long long t = cute_atomic64_get(&deque->top);
+
+	if (t > b) {
+		// Empty.
+		cute_atomic64_set(&deque->bottom, b + 1);
+		return 0;
+	}
+
+	*task = cute_task_ring_get_internal(ring, b);
+	if (t == b) {
+		// Last task, race against thieves for it.
+		int won = cute_atomic64_cas(&deque->top, t, t + 1);
+		cute_atomic64_set(&deque->bottom, b + 1);
+		return won;
+	}
+
+	return 1;
+}
+
+// Any thread. Returns 1 on success, 0 if empty, and -1 if another thief won the race (the
+// deque may still hold tasks).
+static int cute_deque_steal_internal(cute_deque_t* deque, cute_task_t* task)
+{
+	long long t = cute_atomic64_get(&deque->top);
+	long long b = cute_atomic64_get(&deque->bottom);
+	if (t >= b) return 0;
+
+	cute_task_ring_t* ring = (cute_task_ring_t*)cute_atomic_ptr_get(&deque->ring);
+	*task = cute_task_ring_get_internal(ring, t);
+	return cute_atomic64_cas(&deque->top, t, t + 1) ? 1 : -1;
+}
+
+// Steals up to half of the injection deque. The first task is returned, and the rest go
+// onto `self`'s own deque. This is only safe since nobody ever pops the injection deque from
+// the bottom. Returns the same codes as `cute_deque_steal_internal`.
+static int cute_deque_steal_batch_internal(cute_threadpool_t* pool, cute_worker_t* self, cute_task_t* task)
+{
+	cute_deque_t* deque = &pool->inject;
+	long long t = cute_atomic64_get(&deque->top);
+	long long b = cute_atomic64_get(&deque->bottom);
+	if (t >= b) return 0;
+
+	long long n = self ? (b - t + 1) / 2 : 1;
+	if (n > CUTE_SYNC_STEAL_BATCH) n = CUTE_SYNC_STEAL_BATCH;
+
+	cute_task_t batch[CUTE_SYNC_STEAL_BATCH];
+	cute_task_ring_t* ring = (cute_task_ring_t*)cute_atomic_ptr_get(&deque->ring);
+	for (long long i = 0; i < n; ++i) {
+		batch[i] = cute_task_ring_get_internal(ring, t + i);
+	}
+	if (!cute_atomic64_cas(&deque->top, t, t + n)) return -1;
+
+	*task = batch[0];
+	for (long long i = 1; i < n; ++i) {
+		cute_deque_push_internal(&self->deque, batch[i], pool->mem_ctx);
+	}
+	return 1;
+}
+
+// Looks for a task in the order: own deque, injection deque, other workers' deques.
+static int cute_find_task_internal(cute_threadpool_t* pool, cute_worker_t* self, cute_task_t* task)
+{
+	if (self && cute_deque_pop_internal(&self->deque, task)) return 1;
+
+	int contended;
+	do {
+		contended = 0;
+
+		int result = cute_deque_steal_batch_internal(pool, self, task);
+		if (result > 0) return 1;
+		if (result < 0) contended = 1;
+
+		// Pick a pseudo-random victim to start from so thieves spread out.
+		int n = pool->thread_count;
+		unsigned start = 0;
+		if (self) {
+			self->seed ^= self->seed << 13;
+			self->seed ^= self->seed >> 17;
+			self->seed ^= self->seed << 5;
+			start = self->seed;
+		}
+		for (int i = 0; i < n; ++i) {
+			cute_worker_t* victim = pool->workers + (start + i) % n;
+			if (victim == self) continue;
+			result = cute_deque_steal_internal(&victim->deque, task);
+			if (result > 0) return 1;
+			if (result < 0) contended = 1;
+		}
+	} while (contended);
 
-	cute_unlock(&pool->task_mutex);
 	return 0;
 }
 
-int cute_worker_thread_internal(void* udata)
+// Moves held tasks whose counter reached zero onto the injection deque.
+static void cute_release_held_tasks_internal(cute_threadpool_t* pool)
 {
-	cute_threadpool_t* pool = (cute_threadpool_t*)udata;
-	while (cute_atomic_get(&pool->running)) {
-		// Wait for a signal that there's work to do (or shutdown).
-		cute_semaphore_wait(&pool->semaphore);
+	int released = 0;
+	cute_lock(&pool->inject_mutex);
+	int count = cute_atomic_get(&pool->held_count);
+	for (int i = 0; i < count;) {
+		cute_held_task_t* held = pool->held + i;
+		if (cute_atomic_get(held->wait_counter) > 0) {
+			++i;
+			continue;
+		}
+		cute_deque_push_internal(&pool->inject, held->task, pool->mem_ctx);
+		*held = pool->held[--count];
+		++released;
+	}
+	cute_atomic_set(&pool->held_count, count);
+	cute_unlock(&pool->inject_mutex);
+	if (released) cute_threadpool_kick(pool);
+}
 
-		// Process tasks until the queue is empty. This ensures all tasks get
-		// processed even if more tasks exist than semaphore posts were made.
+static void cute_run_task_internal(cute_threadpool_t* pool, cute_task_t task)
+{
+	task.do_work(task.param);
+	if (task.counter && cute_atomic_add(task.counter, -1) == 1) {
+		// Pairs with the increment of `held_count` in `cute_threadpool_add_task_after`. Both
+		// sides write before reading, so at least one of them sees the other.
+		if (cute_atomic_get(&pool->held_count)) cute_release_held_tasks_internal(pool);
+	}
+}
+
+static int cute_worker_thread_internal(void* udata)
+{
+	cute_worker_t* self = (cute_worker_t*)udata;
+	cute_threadpool_t* pool = self->pool;
+	cute_tls_worker = self;
+	long long done = 0;
+
+	while (cute_atomic_get(&pool->running)) {
+		// Process tasks until there's nothing left to find, including in other deques.
 		cute_task_t task;
-		while (cute_try_pop_task_internal(pool, &task)) {
-			task.do_work(task.param);
+		while (cute_find_task_internal(pool, self, &task)) {
+			cute_run_task_internal(pool, task);
+			if (++done == CUTE_SYNC_COMPLETION_BATCH) {
+				cute_atomic64_add(&pool->pending, -done);
+				done = 0;
+			}
+		}
+		if (done) {
+			cute_atomic64_add(&pool->pending, -done);
+			done = 0;
 		}
+
+		// Wait for a signal that there's work to do (or shutdown).
+		cute_semaphore_wait(&pool->semaphore);
 	}
+
+	cute_tls_worker = NULL;
 	return 0;
 }
 
@@ -1286,19 +1708,30 @@ cute_threadpool_t* cute_threadpool_create(int thread_count, void* mem_ctx)
 {
 	if (CUTE_SYNC_CACHELINE_SIZE < cute_cacheline_size()) return 0;
 
-	cute_threadpool_t* pool = (cute_threadpool_t*)CUTE_SYNC_ALLOC(sizeof(cute_threadpool_t), mem_ctx);
-	pool->task_capacity = 64;
-	pool->task_count = 0;
-	pool->tasks = (cute_task_t*)cute_malloc_aligned(sizeof(cute_task_t) * pool->task_capacity, CUTE_SYNC_CACHELINE_SIZE, mem_ctx);
-	pool->task_mutex = cute_mutex_create();
+	cute_threadpool_t* pool = (cute_threadpool_t*)cute_malloc_aligned(sizeof(cute_threadpool_t), CUTE_SYNC_CACHELINE_SIZE, mem_ctx);
+	cute_deque_init_internal(&pool->inject, mem_ctx);
+	pool->inject_mutex = cute_mutex_create();
 	pool->thread_count = thread_count;
 	pool->threads = (cute_thread_t**)cute_malloc_aligned(sizeof(cute_thread_t*) * thread_count, CUTE_SYNC_CACHELINE_SIZE, mem_ctx);
+	pool->workers = (cute_worker_t*)cute_malloc_aligned(sizeof(cute_worker_t) * thread_count, CUTE_SYNC_CACHELINE_SIZE, mem_ctx);
+	pool->pending.i = 0;
+	pool->held = NULL;
+	pool->held_capacity = 0;
+	cute_atomic_set(&pool->held_count, 0);
 	cute_atomic_set(&pool->running, 1);
 	pool->semaphore = cute_semaphore_create(0);
 	pool->mem_ctx = mem_ctx;
 
 	for (int i = 0; i < thread_count; ++i) {
-		pool->threads[i] = cute_thread_create(cute_worker_thread_internal, 0, pool);
+		cute_worker_t* worker = pool->workers + i;
+		cute_deque_init_internal(&worker->deque, mem_ctx);
+		worker->pool = pool;
+		worker->index = i;
+		worker->seed = 0x9E3779B9u * (unsigned)(i + 1);
+	}
+
+	for (int i = 0; i < thread_count; ++i) {
+		pool->threads[i] = cute_thread_create(cute_worker_thread_internal, 0, pool->workers + i);
 	}
 
 	return pool;
@@ -1306,54 +1739,128 @@ cute_threadpool_t* cute_threadpool_create(int thread_count, void* mem_ctx)
 
 void cute_threadpool_add_task(cute_threadpool_t* pool, void (*func)(void*), void* param)
 {
-	cute_lock(&pool->task_mutex);
+	cute_threadpool_add_task_with_counter(pool, func, param, NULL);
+}
+
+void cute_threadpool_add_task_with_counter(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter)
+{
+	cute_task_t task;
+	task.do_work = func;
+	task.param = param;
+	task.counter = counter;
+	if (counter) cute_atomic_add(counter, 1);
+	cute_atomic64_add(&pool->pending, 1);
 
-	if (pool->task_count == pool->task_capacity) {
-		int new_cap = pool->task_capacity * 2;
-		cute_task_t* new_tasks = (cute_task_t*)cute_malloc_aligned(sizeof(cute_task_t) * new_cap, CUTE_SYNC_CACHELINE_SIZE, pool->mem_ctx);
-		CUTE_SYNC_MEMCPY(new_tasks, pool->tasks, sizeof(cute_task_t) * pool->task_count);
-		cute_free_aligned(pool->tasks, pool->mem_ctx);
-		pool->task_capacity = new_cap;
-		pool->tasks = new_tasks;
+	cute_worker_t* self = cute_tls_worker;
+	if (self && self->pool == pool) {
+		cute_deque_push_internal(&self->deque, task, pool->mem_ctx);
+	} else {
+		cute_lock(&pool->inject_mutex);
+		cute_deque_push_internal(&pool->inject, task, pool->mem_ctx);
+		cute_unlock(&pool->inject_mutex);
 	}
+}
 
+void cute_threadpool_add_task_shared(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter)
+{
 	cute_task_t task;
 	task.do_work = func;
 	task.param = param;
-	pool->tasks[pool->task_count++] = task;
+	task.counter = counter;
+	if (counter) cute_atomic_add(counter, 1);
+	cute_atomic64_add(&pool->pending, 1);
+
+	cute_lock(&pool->inject_mutex);
+	cute_deque_push_internal(&pool->inject, task, pool->mem_ctx);
+	cute_unlock(&pool->inject_mutex);
+}
 
-	cute_unlock(&pool->task_mutex);
+void cute_threadpool_add_task_after(cute_threadpool_t* pool, void (*func)(void*), void* param, cute_atomic_int_t* counter, cute_atomic_int_t* wait_counter)
+{
+	cute_task_t task;
+	task.do_work = func;
+	task.param = param;
+	task.counter = counter;
+	if (counter) cute_atomic_add(counter, 1);
+	cute_atomic64_add(&pool->pending, 1);
+
+	cute_lock(&pool->inject_mutex);
+	int count = cute_atomic_add(&pool->held_count, 1);
+	if (cute_atomic_get(wait_counter) <= 0) {
+		// Already finished (or finished just now, before the task could be held).
+		cute_atomic_add(&pool->held_count, -1);
+		cute_deque_push_internal(&pool->inject, task, pool->mem_ctx);
+	} else {
+		if (count == pool->held_capacity) {
+			int capacity = pool->held_capacity ? pool->held_capacity * 2 : 16;
+			cute_held_task_t* held = (cute_held_task_t*)CUTE_SYNC_ALLOC(sizeof(cute_held_task_t) * capacity, pool->mem_ctx);
+			if (count) CUTE_SYNC_MEMCPY(held, pool->held, sizeof(cute_held_task_t) * count);
+			if (pool->held) CUTE_SYNC_FREE(pool->held, pool->mem_ctx);
+			pool->held = held;
+			pool->held_capacity = capacity;
+		}
+		pool->held[count].task = task;
+		pool->held[count].wait_counter = wait_counter;
+	}
+	cute_unlock(&pool->inject_mutex);
 }
 
 void cute_threadpool_kick_and_wait(cute_threadpool_t* pool)
 {
 	cute_threadpool_kick(pool);
 
-	// Help process tasks on the calling thread while waiting.
-	cute_task_t task;
-	while (cute_try_pop_task_internal(pool, &task)) {
-		task.do_work(task.param);
+	// Help process tasks on the calling thread while waiting, then spin until workers finish
+	// any tasks still in flight.
+	long long done = 0;
+	for (;;) {
+		cute_task_t task;
+		if (cute_find_task_internal(pool, NULL, &task)) {
+			cute_run_task_internal(pool, task);
+			if (++done == CUTE_SYNC_COMPLETION_BATCH) {
+				cute_atomic64_add(&pool->pending, -done);
+				done = 0;
+			}
+			continue;
+		}
+		if (done) {
+			cute_atomic64_add(&pool->pending, -done);
+			done = 0;
+		}
+		if (cute_atomic64_get(&pool->pending) <= 0) break;
+		CUTE_SYNC_YIELD();
 	}
+}
 
-	// Spin until all tasks are complete (workers may still be processing).
-	int pending;
-	do {
-		cute_lock(&pool->task_mutex);
-		pending = pool->task_count;
-		cute_unlock(&pool->task_mutex);
-		if (pending) CUTE_SYNC_YIELD();
-	} while (pending);
+void cute_threadpool_wait_counter(cute_threadpool_t* pool, cute_atomic_int_t* counter)
+{
+	if (cute_atomic_get(counter) <= 0) return;
+	cute_threadpool_kick(pool);
+
+	// From within a task, keep using the worker's own deque so tasks it added are found first.
+	cute_worker_t* self = cute_tls_worker;
+	if (self && self->pool != pool) self = NULL;
+
+	long long done = 0;
+	while (cute_atomic_get(counter) > 0) {
+		cute_task_t task;
+		if (cute_find_task_internal(pool, self, &task)) {
+			cute_run_task_internal(pool, task);
+			++done;
+			continue;
+		}
+		// The remaining tasks of the group are running on other threads.
+		CUTE_SYNC_YIELD();
+	}
+	if (done) cute_atomic64_add(&pool->pending, -done);
 }
 
 void cute_threadpool_kick(cute_threadpool_t* pool)
 {
-	cute_lock(&pool->task_mutex);
-	int task_count = pool->task_count;
-	cute_unlock(&pool->task_mutex);
+	long long task_count = cute_atomic64_get(&pool->pending);
 
-	if (task_count) {
+	if (task_count > 0) {
 		// Wake enough threads to handle all tasks (up to thread_count).
-		int count = task_count < pool->thread_count ? task_count : pool->thread_count;
+		int count = task_count < pool->thread_count ? (int)task_count : pool->thread_count;
 		for (int i = 0; i < count; ++i) {
 			cute_semaphore_post(&pool->semaphore);
 		}
@@ -1374,14 +1881,19 @@ void cute_threadpool_destroy(cute_threadpool_t* pool)
 	}
 
 	// Clean up synchronization primitives.
-	cute_mutex_destroy(&pool->task_mutex);
+	cute_mutex_destroy(&pool->inject_mutex);
 	cute_semaphore_destroy(&pool->semaphore);
 
-	cute_free_aligned(pool->tasks, pool->mem_ctx);
-	cute_free_aligned(pool->threads, pool->mem_ctx);
 	void* mem_ctx = pool->mem_ctx;
 	(void)mem_ctx;
-	CUTE_SYNC_FREE(pool, mem_ctx);
+	for (int i = 0; i < pool->thread_count; ++i) {
+		cute_deque_destroy_internal(&pool->workers[i].deque, mem_ctx);
+	}
+	cute_deque_destroy_internal(&pool->inject, mem_ctx);
+	if (pool->held) CUTE_SYNC_FREE(pool->held, mem_ctx);
+	cute_free_aligned(pool->workers, mem_ctx);
+	cute_free_aligned(pool->threads, mem_ctx);
+	cute_free_aligned(pool, mem_ctx);
 }
 
 #endif // CUTE_SYNC_IMPLEMENTATION_ONCE
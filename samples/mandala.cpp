@@ -136,7 +136,7 @@ int main(int argc, char* argv[])
 		{
 			int tiled_batches, instanced_batches;
 			uint64_t upload;
-			cf_draw_tiled_stats(&tiled_batches, &instanced_batches, &upload);
+			cf_draw_tiled_stats(&tiled_batches, &instanced_batches, &upload, NULL);
 			char buf[256];
 			snprintf(buf, sizeof(buf), "%s  |  %d shapes + 24 sprites  |  %.2f ms  |  batches tiled %d / instanced %d  |  upload %d KB",
 				mode_names[mode], count, avg_ms, tiled_batches, instanced_batches, (int)(upload / 1024));
@@ -53,6 +53,7 @@ struct AsteroidBarn
 	CF_Poly poly[ASTEROIDS_MAX];
 	v2 center_mass[ASTEROIDS_MAX];
 	float slice_timeout[ASTEROIDS_MAX];
+	SpatialHash* hash;
 
 	void add(v2 p, v2 v, float size);
 	void add(CF_Poly p, v2 v, float a, float timeout);
@@ -61,6 +62,7 @@ struct AsteroidBarn
 	void draw();
 	void hit(v2 hit, float radius);
 	void explode(int i);
+	void build_hash();
 };
 
 #define TRAIL_MAX 128
@@ -435,15 +437,22 @@ void BulletBarn::hit(int i)
 
 void BulletBarn::update()
 {
+	// Only test each bullet against the asteroids sharing its grid cells.
+	g->asteroids.build_hash();
+	int nearby[ASTEROIDS_MAX];
 	for (int i = 0; i < BULLETS_MAX; ++i) {
 		if (!alive[i]) continue;
 		p[i] += V2(0,1) * 300.0f * CF_DELTA_TIME;
 		if (p[i].y > 240.0f + 10.0f) {
 			alive[i] = false;
 		} else {
-			for (int j = 0; j < ASTEROIDS_MAX; ++j) {
-				if (!g->asteroids.alive[j]) continue;
-				if (circle_to_poly(make_circle(p[i], BULLETS_RADIUS), g->asteroids.poly + j)) {
+			CF_Circle c = make_circle(p[i], BULLETS_RADIUS);
+			v2 e = V2(BULLETS_RADIUS, BULLETS_RADIUS);
+			// The query returns the total number of hits, which may be more than fit in `nearby`.
+			int count = spatial_hash_query(g->asteroids.hash, make_aabb(p[i] - e, p[i] + e), nearby, ASTEROIDS_MAX);
+			count = cf_min(count, ASTEROIDS_MAX);
+			for (int k = 0; k < count; ++k) {
+				if (circle_to_poly(c, g->asteroids.poly + nearby[k])) {
 					hit(i);
 				}
 			}
@@ -588,6 +597,16 @@ void AsteroidBarn::explode(int i)
 	g->line_particles.add(poly[i], velocity[i], angular_velocity[i] * 3.0f, rnd_range(0.5f, 1.0f));
 }
 
+void AsteroidBarn::build_hash()
+{
+	spatial_hash_clear(hash);
+	for (int i = 0; i < ASTEROIDS_MAX; ++i) {
+		if (!alive[i]) continue;
+		spatial_hash_add(hash, make_aabb(poly[i].verts, poly[i].count), i);
+	}
+	spatial_hash_build(hash);
+}
+
 void player_movement_routine()
 {
 	g->player.iframes -= CF_DELTA_TIME;
@@ -1112,6 +1131,7 @@ int main(int argc, char* argv[])
 
 	g = (Game*)cf_calloc(sizeof(Game), 1);
 	g->rnd = rnd_seed(0);
+	g->asteroids.hash = make_spatial_hash(64.0f);
 	g->player.reset();
 	g->boss1 = true;
 
@@ -1202,6 +1222,7 @@ int main(int argc, char* argv[])
 		app_draw_onto_screen(true);
 	}
 
+	destroy_spatial_hash(g->asteroids.hash);
 	destroy_app();
 
 	// [x] Bullet pop asteroid
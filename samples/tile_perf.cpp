@@ -118,7 +118,7 @@ int main(int argc, char* argv[])
 	double accum_ms = 0;
 	int accum_frames = 0;
 	double shown_ms = 0;
-	int shown_tiled_batches = 0, shown_instanced_batches = 0;
+	int shown_tiled_batches = 0, shown_instanced_batches = 0, shown_culled = 0;
 	double shown_upload_kb = 0;
 
 	while (cf_app_is_running()) {
@@ -162,19 +162,20 @@ int main(int argc, char* argv[])
 			accum_ms = 0;
 			accum_frames = 0;
 			uint64_t upload_bytes;
-			cf_draw_tiled_stats(&shown_tiled_batches, &shown_instanced_batches, &upload_bytes);
+			cf_draw_tiled_stats(&shown_tiled_batches, &shown_instanced_batches, &upload_bytes, &shown_culled);
 			shown_upload_kb = upload_bytes / 1024.0;
 		}
 
 		char buf[256];
-		snprintf(buf, sizeof(buf), "%s  |  %d objects  |  %.2f ms/frame (%.0f fps)\ntiled batches: %d  instanced batches: %d  tiled upload: %.0f KB",
+		snprintf(buf, sizeof(buf), "%s  |  %d objects  |  %.2f ms/frame (%.0f fps)\ntiled batches: %d  instanced batches: %d  tiled upload: %.0f KB  culled: %d",
 			use_tiled ? "TILED" : "INSTANCED",
 			object_count,
 			shown_ms,
 			shown_ms > 0 ? 1000.0 / shown_ms : 0,
 			shown_tiled_batches,
 			shown_instanced_batches,
-			shown_upload_kb);
+			shown_upload_kb,
+			shown_culled);
 		cf_draw_push_color(cf_color_white());
 		cf_push_font_size(20);
 		cf_draw_text(buf, cf_v2(-620, 340), -1);
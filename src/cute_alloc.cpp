@@ -11,13 +11,28 @@
 #	include <crtdbg.h>
 #endif
 #include <stdlib.h>
+#include <limits.h>
 
 #include <cute_alloc.h>
 #include <cute_c_runtime.h>
 #include <cute_array.h>
+#include <cute_multithreading.h>
+#include <cute_time.h>
 
 #include <internal/cute_alloc_internal.h>
 
+#ifdef CF_WINDOWS
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#elif !defined(CF_EMSCRIPTEN)
+#	include <sys/mman.h>
+#endif
+
 void* s_default_alloc(size_t size, void* udata)
 {
 	CF_UNUSED(udata);
@@ -47,39 +62,83 @@ CF_Allocator s_default_allocator = {
 	s_default_alloc,
 	s_default_free,
 	s_default_calloc,
-	s_default_realloc
+	s_default_realloc,
 };
 
 CF_GLOBAL CF_Allocator s_allocator = s_default_allocator;
+CF_GLOBAL CF_AlignedAllocator s_aligned_allocator;
+
+static CF_AtomicInt s_tracking;
+static void s_track_alloc(void* ptr, size_t size, void* callsite, bool count_alloc = true);
+static bool s_track_free(void* ptr, uint64_t* size = NULL, int* tag = NULL);
+static void s_track_restore(void* ptr, uint64_t size, int tag);
+
+// Set by cf_aligned_alloc and allocator wrappers so allocations are attributed to their caller.
+static thread_local void* s_callsite_override;
+
+static void* s_callsite(void* return_address)
+{
+	return s_callsite_override ? s_callsite_override : return_address;
+}
+
+void* cf_alloc_set_callsite(void* callsite)
+{
+	void* prev = s_callsite_override;
+	s_callsite_override = callsite;
+	return prev;
+}
 
 void cf_allocator_override(CF_Allocator allocator)
 {
 	s_allocator = allocator;
+	s_aligned_allocator = CF_AlignedAllocator { };
+}
+
+void cf_allocator_override_aligned(CF_AlignedAllocator allocator)
+{
+	CF_ASSERT(!allocator.aligned_alloc_fn == !allocator.aligned_free_fn);
+	s_aligned_allocator = allocator;
 }
 
 void cf_allocator_restore_default(void)
 {
 	s_allocator = s_default_allocator;
+	s_aligned_allocator = CF_AlignedAllocator { };
 }
 
 void* cf_alloc(size_t size)
 {
-	return s_allocator.alloc_fn ? s_allocator.alloc_fn(size, s_allocator.udata) : s_default_alloc(size, s_allocator.udata);
+	void* ptr = s_allocator.alloc_fn ? s_allocator.alloc_fn(size, s_allocator.udata) : s_default_alloc(size, s_allocator.udata);
+	if (cf_atomic_get(&s_tracking) && ptr) s_track_alloc(ptr, size, s_callsite(CF_RETURN_ADDRESS()));
+	return ptr;
 }
 
 void cf_free(void* ptr)
 {
+	// Untrack first, another thread may be handed this address the moment it's freed.
+	if (cf_atomic_get(&s_tracking) && ptr) s_track_free(ptr);
 	s_allocator.free_fn ? s_allocator.free_fn(ptr, s_allocator.udata) : s_default_free(ptr, s_allocator.udata);
 }
 
 void* cf_calloc(size_t size, size_t count)
 {
-	return s_allocator.calloc_fn ? s_allocator.calloc_fn(size, count, s_allocator.udata) : s_default_calloc(size, count, s_allocator.udata);
+	void* ptr = s_allocator.calloc_fn ? s_allocator.calloc_fn(size, count, s_allocator.udata) : s_default_calloc(size, count, s_allocator.udata);
+	if (cf_atomic_get(&s_tracking) && ptr) s_track_alloc(ptr, size * count, s_callsite(CF_RETURN_ADDRESS()));
+	return ptr;
 }
 
 void* cf_realloc(void* ptr, size_t size)
 {
-	return s_allocator.realloc_fn ? s_allocator.realloc_fn(ptr, size, s_allocator.udata) : s_default_realloc(ptr, size, s_allocator.udata);
+	bool tracking = cf_atomic_get(&s_tracking);
+	uint64_t old_size = 0;
+	int old_tag = 0;
+	bool was_tracked = tracking && ptr && s_track_free(ptr, &old_size, &old_tag);
+	void* result = s_allocator.realloc_fn ? s_allocator.realloc_fn(ptr, size, s_allocator.udata) : s_default_realloc(ptr, size, s_allocator.udata);
+	// Resizing in place isn't a new allocation, so it only updates the live and peak bytes.
+	if (tracking && result) s_track_alloc(result, size, s_callsite(CF_RETURN_ADDRESS()), result != ptr || !was_tracked);
+	// A failed realloc leaves the original block alive, so it goes back in the records.
+	else if (was_tracked && size) s_track_restore(ptr, old_size, old_tag);
+	return result;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -87,7 +146,15 @@ void* cf_realloc(void* ptr, size_t size)
 void* cf_aligned_alloc(size_t size, int alignment)
 {
 	CF_ASSERT(alignment <= 256);
+	if (s_aligned_allocator.aligned_alloc_fn) {
+		void* p = s_aligned_allocator.aligned_alloc_fn(size, alignment, s_aligned_allocator.udata);
+		if (cf_atomic_get(&s_tracking) && p) s_track_alloc(p, size, s_callsite(CF_RETURN_ADDRESS()));
+		return p;
+	}
+	void* prev = s_callsite_override;
+	if (cf_atomic_get(&s_tracking)) s_callsite_override = s_callsite(CF_RETURN_ADDRESS());
 	void* p = CF_ALLOC(size + alignment);
+	s_callsite_override = prev;
 	if (!p) return NULL;
 	size_t offset = (size_t)p & (alignment - 1);
 	p = CF_ALIGN_FORWARD_PTR((char*)p + 1, alignment);
@@ -99,12 +166,395 @@ void* cf_aligned_alloc(size_t size, int alignment)
 void cf_aligned_free(void* p)
 {
 	if (!p) return;
+	if (s_aligned_allocator.aligned_free_fn) {
+		if (cf_atomic_get(&s_tracking)) s_track_free(p);
+		s_aligned_allocator.aligned_free_fn(p, s_aligned_allocator.udata);
+		return;
+	}
 	size_t offset = (size_t)*((uint8_t*)p - 1);
 	CF_FREE((char*)p - (offset & 0xFF));
 }
 
 //--------------------------------------------------------------------------------------------------
 
+// Virtual memory for reserve/commit arenas. Address space is reserved inaccessible, and pages are
+// committed read/write as the arena grows into them.
+
+#define CF_ARENA_COMMIT_SIZE (64 * CF_KB)
+
+#if defined(CF_WINDOWS)
+
+static void* s_vm_reserve(size_t size) { return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS); }
+static bool s_vm_commit(void* ptr, size_t size) { return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL; }
+static void s_vm_decommit(void* ptr, size_t size) { VirtualFree(ptr, size, MEM_DECOMMIT); }
+static void s_vm_release(void* ptr, size_t size) { CF_UNUSED(size); VirtualFree(ptr, 0, MEM_RELEASE); }
+
+#elif !defined(CF_EMSCRIPTEN)
+
+#ifndef MAP_NORESERVE
+#	define MAP_NORESERVE 0
+#endif
+
+static void* s_vm_reserve(size_t size)
+{
+	void* ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+static bool s_vm_commit(void* ptr, size_t size) { return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0; }
+
+// Mapping fresh inaccessible pages over the range drops the old ones on every POSIX platform,
+// where madvise flags differ in whether they actually release anything.
+static void s_vm_decommit(void* ptr, size_t size) { mmap(ptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0); }
+static void s_vm_release(void* ptr, size_t size) { munmap(ptr, size); }
+
+#else
+
+// Wasm has a single linear memory and no way to reserve without committing.
+#define CF_ARENA_NO_VIRTUAL_MEMORY
+
+#endif
+
+//--------------------------------------------------------------------------------------------------
+// Slab allocator. Small sizes are rounded up to a size class and carved out of 256KB slabs, each
+// mapped at a 256KB-aligned address with a header in front, so the size class of any pointer is
+// found by masking off its low bits. Large sizes get their own mapping with the same header. Each
+// thread caches a free list per size class and trades batches with the shared class under a lock.
+
+#define CF_SLAB_SIZE (256 * CF_KB)
+#define CF_SLAB_HEADER_SIZE 256 // Keeps the first element of every slab 256-byte aligned.
+#define CF_SLAB_PAGE_SIZE (4 * CF_KB)
+#define CF_SLAB_MAX_SIZE (32 * CF_KB)
+#define CF_SLAB_CLASS_COUNT 40
+#define CF_SLAB_LARGE -1
+
+// 16 byte steps up to 128, then four classes per doubling.
+static const int s_slab_class_sizes[CF_SLAB_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+	2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192, 10240, 12288, 14336, 16384, 20480, 24576, 28672, 32768,
+};
+
+// Elements moved between a thread and its class at a time, about 64KB worth but capped at 64.
+static const int s_slab_class_batches[CF_SLAB_CLASS_COUNT] = {
+	64, 64, 64, 64, 64, 64, 64, 64,
+	64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 51, 42, 36, 32,
+	25, 21, 18, 16, 12, 10, 9, 8, 6, 5, 4, 4, 3, 2, 2, 2,
+};
+
+struct CF_SlabHeader
+{
+	int size_class; // CF_SLAB_LARGE for a mapping holding a single large allocation.
+	size_t mapped_size;
+	void* raw; // Web only, the block to hand back to free.
+};
+
+struct CF_SlabClass
+{
+	CF_AtomicInt lock;
+	void* free_list;
+	char* bump; // Not yet carved remainder of the newest slab.
+	char* bump_end;
+	char pad[64 - sizeof(CF_AtomicInt) - sizeof(void*) * 3];
+};
+
+static CF_SlabClass s_slab_classes[CF_SLAB_CLASS_COUNT];
+
+struct CF_SlabCache
+{
+	void* free_lists[CF_SLAB_CLASS_COUNT];
+	int counts[CF_SLAB_CLASS_COUNT];
+	bool flushed; // The thread is exiting, from here on everything goes straight to the classes.
+};
+
+static thread_local CF_SlabCache s_slab_cache;
+
+// Hands a thread's cached elements back when it exits. Kept apart from CF_SlabCache so the cache
+// stays usable by anything that still allocates after this destructor has run.
+struct CF_SlabCacheFlusher
+{
+	bool active = false;
+	~CF_SlabCacheFlusher();
+};
+
+static thread_local CF_SlabCacheFlusher s_slab_cache_flusher;
+
+static int s_slab_class_of(size_t size)
+{
+	if (size <= 128) return size ? (int)((size - 1) >> 4) : 0;
+	unsigned s = (unsigned)(size - 1);
+#ifdef _MSC_VER
+	unsigned long msb;
+	_BitScanReverse(&msb, s);
+#else
+	int msb = 31 - __builtin_clz(s);
+#endif
+	return 8 + ((int)msb - 7) * 4 + (int)((s >> (msb - 2)) & 3);
+}
+
+static CF_SlabHeader* s_slab_header(void* ptr)
+{
+	return (CF_SlabHeader*)CF_ALIGN_TRUNCATE_PTR(ptr, CF_SLAB_SIZE);
+}
+
+// Maps `size` bytes of read/write memory, aligned to CF_SLAB_SIZE.
+static char* s_slab_map(size_t size)
+{
+#if defined(CF_WINDOWS)
+	// Part of a reservation can't be released on Windows. Reserve extra to find an aligned address,
+	// let go of it, then claim just the aligned range -- retrying if another thread got there first.
+	for (int tries = 0; tries < 8; ++tries) {
+		char* p = (char*)s_vm_reserve(size + CF_SLAB_SIZE);
+		if (!p) return NULL;
+		char* aligned = (char*)CF_ALIGN_FORWARD_PTR(p, CF_SLAB_SIZE);
+		s_vm_release(p, size + CF_SLAB_SIZE);
+		p = (char*)VirtualAlloc(aligned, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (p) return p;
+	}
+	return NULL;
+#elif !defined(CF_ARENA_NO_VIRTUAL_MEMORY)
+	char* p = (char*)s_vm_reserve(size + CF_SLAB_SIZE);
+	if (!p) return NULL;
+	char* aligned = (char*)CF_ALIGN_FORWARD_PTR(p, CF_SLAB_SIZE);
+	if (aligned > p) s_vm_release(p, aligned - p);
+	if (p + CF_SLAB_SIZE > aligned) s_vm_release(aligned + size, p + CF_SLAB_SIZE - aligned);
+	if (!s_vm_commit(aligned, size)) {
+		s_vm_release(aligned, size);
+		return NULL;
+	}
+	return aligned;
+#else
+	char* p = (char*)s_default_alloc(size + CF_SLAB_SIZE, NULL);
+	if (!p) return NULL;
+	char* aligned = (char*)CF_ALIGN_FORWARD_PTR(p, CF_SLAB_SIZE);
+	((CF_SlabHeader*)aligned)->raw = p;
+	return aligned;
+#endif
+}
+
+static void s_slab_unmap(CF_SlabHeader* header, size_t size)
+{
+#if defined(CF_WINDOWS) || !defined(CF_ARENA_NO_VIRTUAL_MEMORY)
+	s_vm_release(header, size);
+#else
+	CF_UNUSED(size);
+	s_default_free(header->raw, NULL);
+#endif
+}
+
+static void s_slab_lock(CF_SlabClass* k)
+{
+	while (cf_atomic_set(&k->lock, 1)) {
+		cf_sleep(0);
+	}
+}
+
+static void s_slab_unlock(CF_SlabClass* k)
+{
+	cf_atomic_set(&k->lock, 0);
+}
+
+// Pulls up to `n` elements from a class as a linked list, carving new slabs as needed. Returns
+// how many it got, which is only short of `n` when out of memory.
+static int s_slab_take(int c, void** list, int n)
+{
+	CF_SlabClass* k = s_slab_classes + c;
+	size_t size = (size_t)s_slab_class_sizes[c];
+	void* head = NULL;
+	int taken = 0;
+	s_slab_lock(k);
+	for (; taken < n && k->free_list; ++taken) {
+		void* element = k->free_list;
+		k->free_list = *(void**)element;
+		*(void**)element = head;
+		head = element;
+	}
+	for (; taken < n; ++taken) {
+		if (k->bump + size > k->bump_end) {
+			char* slab = s_slab_map(CF_SLAB_SIZE);
+			if (!slab) break;
+			CF_SlabHeader* header = (CF_SlabHeader*)slab;
+			header->size_class = c;
+			header->mapped_size = CF_SLAB_SIZE;
+			k->bump = slab + CF_SLAB_HEADER_SIZE;
+			k->bump_end = slab + CF_SLAB_SIZE;
+		}
+		void* element = k->bump;
+		k->bump += size;
+		*(void**)element = head;
+		head = element;
+	}
+	s_slab_unlock(k);
+	*list = head;
+	return taken;
+}
+
+static void s_slab_give(int c, void* head, void* tail)
+{
+	CF_SlabClass* k = s_slab_classes + c;
+	s_slab_lock(k);
+	*(void**)tail = k->free_list;
+	k->free_list = head;
+	s_slab_unlock(k);
+}
+
+CF_SlabCacheFlusher::~CF_SlabCacheFlusher()
+{
+	CF_SlabCache* cache = &s_slab_cache;
+	for (int c = 0; c < CF_SLAB_CLASS_COUNT; ++c) {
+		void* head = cache->free_lists[c];
+		if (!head) continue;
+		void* tail = head;
+		while (*(void**)tail) tail = *(void**)tail;
+		s_slab_give(c, head, tail);
+		cache->free_lists[c] = NULL;
+		cache->counts[c] = 0;
+	}
+	cache->flushed = true;
+}
+
+static void* s_slab_alloc_class(int c)
+{
+	CF_SlabCache* cache = &s_slab_cache;
+	void* element = cache->free_lists[c];
+	if (element) {
+		cache->free_lists[c] = *(void**)element;
+		cache->counts[c]--;
+		return element;
+	}
+	if (cache->flushed) {
+		return s_slab_take(c, &element, 1) ? element : NULL;
+	}
+	if (!s_slab_cache_flusher.active) s_slab_cache_flusher.active = true;
+	int n = s_slab_take(c, &element, s_slab_class_batches[c]);
+	if (!n) return NULL;
+	cache->free_lists[c] = *(void**)element;
+	cache->counts[c] = n - 1;
+	return element;
+}
+
+static void s_slab_free_class(void* ptr, int c)
+{
+	CF_SlabCache* cache = &s_slab_cache;
+	if (cache->flushed) {
+		s_slab_give(c, ptr, ptr);
+		return;
+	}
+	*(void**)ptr = cache->free_lists[c];
+	cache->free_lists[c] = ptr;
+	int batch = s_slab_class_batches[c];
+	if (++cache->counts[c] == 1 && !s_slab_cache_flusher.active) s_slab_cache_flusher.active = true;
+	if (cache->counts[c] >= batch * 2) {
+		// Hand a batch back, so a thread that only frees (say, a consumer of another thread's
+		// allocations) doesn't hoard memory.
+		void* head = cache->free_lists[c];
+		void* tail = head;
+		for (int i = 1; i < batch; ++i) tail = *(void**)tail;
+		cache->free_lists[c] = *(void**)tail;
+		cache->counts[c] -= batch;
+		s_slab_give(c, head, tail);
+	}
+}
+
+static void* s_slab_alloc_large(size_t size)
+{
+	size_t mapped_size = CF_ALIGN_FORWARD(size + CF_SLAB_HEADER_SIZE, CF_SLAB_PAGE_SIZE);
+	char* base = s_slab_map(mapped_size);
+	if (!base) return NULL;
+	CF_SlabHeader* header = (CF_SlabHeader*)base;
+	header->size_class = CF_SLAB_LARGE;
+	header->mapped_size = mapped_size;
+	return base + CF_SLAB_HEADER_SIZE;
+}
+
+static size_t s_slab_usable_size(void* ptr)
+{
+	CF_SlabHeader* header = s_slab_header(ptr);
+	return header->size_class == CF_SLAB_LARGE ? header->mapped_size - CF_SLAB_HEADER_SIZE : (size_t)s_slab_class_sizes[header->size_class];
+}
+
+static void* s_slab_alloc(size_t size, void* udata)
+{
+	CF_UNUSED(udata);
+	return size <= CF_SLAB_MAX_SIZE ? s_slab_alloc_class(s_slab_class_of(size)) : s_slab_alloc_large(size);
+}
+
+static void s_slab_free(void* ptr, void* udata)
+{
+	CF_UNUSED(udata);
+	if (!ptr) return;
+	CF_SlabHeader* header = s_slab_header(ptr);
+	if (header->size_class == CF_SLAB_LARGE) {
+		s_slab_unmap(header, header->mapped_size);
+	} else {
+		s_slab_free_class(ptr, header->size_class);
+	}
+}
+
+static void* s_slab_calloc(size_t size, size_t count, void* udata)
+{
+	if (count && size > SIZE_MAX / count) return NULL;
+	void* ptr = s_slab_alloc(size * count, udata);
+	if (ptr) CF_MEMSET(ptr, 0, size * count);
+	return ptr;
+}
+
+static void* s_slab_realloc(void* ptr, size_t size, void* udata)
+{
+	if (!ptr) return s_slab_alloc(size, udata);
+	if (!size) {
+		s_slab_free(ptr, udata);
+		return NULL;
+	}
+	size_t usable = s_slab_usable_size(ptr);
+	int size_class = s_slab_header(ptr)->size_class;
+	if (size_class != CF_SLAB_LARGE && size <= CF_SLAB_MAX_SIZE && s_slab_class_of(size) == size_class) return ptr;
+	if (size_class == CF_SLAB_LARGE && size > CF_SLAB_MAX_SIZE && size <= usable && size >= usable / 2) return ptr;
+	void* result = s_slab_alloc(size, udata);
+	if (!result) return NULL;
+	CF_MEMCPY(result, ptr, size < usable ? size : usable);
+	s_slab_free(ptr, udata);
+	return result;
+}
+
+static void* s_slab_aligned_alloc(size_t size, int alignment, void* udata)
+{
+	CF_ASSERT(alignment <= CF_SLAB_HEADER_SIZE);
+	if (alignment <= 16) return s_slab_alloc(size, udata);
+	if (size <= CF_SLAB_MAX_SIZE) {
+		// Elements sit at multiples of their class size past an aligned header, so any class whose
+		// size is a multiple of the alignment hands out aligned memory. The largest class always is.
+		for (int c = s_slab_class_of(size < (size_t)alignment ? (size_t)alignment : size); c < CF_SLAB_CLASS_COUNT; ++c) {
+			if (!(s_slab_class_sizes[c] & (alignment - 1))) return s_slab_alloc_class(c);
+		}
+	}
+	return s_slab_alloc_large(size);
+}
+
+CF_Allocator cf_slab_allocator()
+{
+	CF_Allocator allocator = {
+		NULL,
+		s_slab_alloc,
+		s_slab_free,
+		s_slab_calloc,
+		s_slab_realloc,
+	};
+	return allocator;
+}
+
+CF_AlignedAllocator cf_slab_aligned_allocator()
+{
+	CF_AlignedAllocator allocator = {
+		NULL,
+		s_slab_aligned_alloc,
+		s_slab_free,
+	};
+	return allocator;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 CF_Arena cf_make_arena(int alignment, int block_size)
 {
 	CF_Arena arena;
@@ -114,21 +564,65 @@ CF_Arena cf_make_arena(int alignment, int block_size)
 	return arena;
 }
 
+CF_Arena cf_make_virtual_arena(int alignment, size_t reserve_size)
+{
+	CF_ASSERT(alignment <= 4096);
+#ifndef CF_ARENA_NO_VIRTUAL_MEMORY
+	reserve_size = CF_ALIGN_FORWARD(reserve_size, CF_ARENA_COMMIT_SIZE);
+	char* base = (char*)s_vm_reserve(reserve_size);
+	if (base) {
+		CF_Arena arena = cf_make_arena(alignment, 0);
+		arena.base = base;
+		arena.ptr = base;
+		arena.end = base;
+		arena.reserve_end = base + reserve_size;
+		return arena;
+	}
+#endif
+	return cf_make_arena(alignment, reserve_size < CF_MB ? (int)reserve_size : CF_MB);
+}
+
 void* cf_arena_alloc(CF_Arena* arena, int size)
 {
-	CF_ASSERT((int)size < arena->block_size);
-	if (size > (int)(arena->end - arena->ptr)) {
+	// Allocations are padded out to the alignment, keeping `ptr` aligned for the next one.
+	size_t needed = CF_ALIGN_FORWARD((size_t)size, arena->alignment);
+	if (arena->base) {
+#ifndef CF_ARENA_NO_VIRTUAL_MEMORY
+		if (needed > (size_t)(arena->reserve_end - arena->ptr)) return NULL;
+		if (needed > (size_t)(arena->end - arena->ptr)) {
+			// Commit whole steps, so growing one small allocation at a time stays cheap.
+			size_t commit = CF_ALIGN_FORWARD(needed - (size_t)(arena->end - arena->ptr), CF_ARENA_COMMIT_SIZE);
+			size_t uncommitted = (size_t)(arena->reserve_end - arena->end);
+			if (commit > uncommitted) commit = uncommitted;
+			if (!s_vm_commit(arena->end, commit)) return NULL;
+			arena->end += commit;
+		}
+		void* result = arena->ptr;
+		arena->ptr += needed;
+		return result;
+#endif
+	}
+	if (needed > (size_t)(arena->end - arena->ptr)) {
+		// Oversized allocations get a block of their own.
+		int block_size = (int)needed > arena->block_size ? (int)needed : arena->block_size;
 		if (arena->block_index < asize(arena->blocks)) {
+			if (arena->block_sizes[arena->block_index] < block_size) {
+				// The cached block is too small for this allocation, trade it for one that fits.
+				cf_aligned_free(arena->blocks[arena->block_index]);
+				arena->blocks[arena->block_index] = (char*)cf_aligned_alloc(block_size, arena->alignment);
+				arena->block_sizes[arena->block_index] = block_size;
+			}
 			arena->ptr = arena->blocks[arena->block_index];
 		} else {
-			arena->ptr = (char*)cf_aligned_alloc(arena->block_size, arena->alignment);
+			arena->ptr = (char*)cf_aligned_alloc(block_size, arena->alignment);
 			apush(arena->blocks, arena->ptr);
+			apush(arena->block_sizes, block_size);
 		}
-		arena->end = arena->ptr + arena->block_size;
+		arena->end = arena->ptr + arena->block_sizes[arena->block_index];
 		arena->block_index++;
 	}
 	void* result = arena->ptr;
-	arena->ptr = (char*)CF_ALIGN_FORWARD_PTR(arena->ptr + size, arena->alignment);
+	arena->ptr += needed;
 	CF_ASSERT(!(((int)(uintptr_t)(arena->ptr)) & (arena->alignment - 1)));
 	CF_ASSERT(arena->ptr <= arena->end);
 	return result;
@@ -136,6 +630,11 @@ void* cf_arena_alloc(CF_Arena* arena, int size)
 
 void cf_arena_free(CF_Arena* arena, int size)
 {
+	if (arena->base) {
+		arena->ptr = (char*)CF_ALIGN_BACKWARD_PTR(arena->ptr - size, arena->alignment);
+		CF_ASSERT(arena->ptr >= arena->base);
+		return;
+	}
 	CF_ASSERT(arena->block_index > 0);
 	char* aligned_ptr = (char*)CF_ALIGN_BACKWARD_PTR(arena->ptr - size, arena->alignment);
 	if (aligned_ptr >= arena->blocks[arena->block_index - 1]) {
@@ -146,13 +645,14 @@ void cf_arena_free(CF_Arena* arena, int size)
 		while (size > 0 && arena->block_index > 0) {
 			arena->block_index--;
 			CF_ASSERT(arena->block_index >= 0);
+			int block_size = arena->block_sizes[arena->block_index];
 			arena->ptr = arena->blocks[arena->block_index];
-			arena->end = arena->ptr + arena->block_size;
-			if (size < arena->block_size) {
+			arena->end = arena->ptr + block_size;
+			if (size < block_size) {
 				arena->ptr = (char*)CF_ALIGN_BACKWARD_PTR(arena->end - size, arena->alignment);
 				size = 0;
 			} else {
-				size -= arena->block_size;
+				size -= block_size;
 			}
 		}
 		CF_ASSERT(size == 0);
@@ -161,9 +661,11 @@ void cf_arena_free(CF_Arena* arena, int size)
 
 void cf_arena_reset(CF_Arena* arena)
 {
-	if (arena->blocks && asize(arena->blocks) > 0) {
+	if (arena->base) {
+		arena->ptr = arena->base;
+	} else if (arena->blocks && asize(arena->blocks) > 0) {
 		arena->ptr = arena->blocks[0];
-		arena->end = arena->ptr + arena->block_size;
+		arena->end = arena->ptr + arena->block_sizes[0];
 		arena->block_index = 1;
 	} else {
 		arena->ptr = NULL;
@@ -172,18 +674,199 @@ void cf_arena_reset(CF_Arena* arena)
 	}
 }
 
+void cf_arena_decommit(CF_Arena* arena)
+{
+	if (arena->base) {
+#ifndef CF_ARENA_NO_VIRTUAL_MEMORY
+		// Commit steps are measured from the base, keep the one `ptr` is in.
+		char* keep = arena->base + CF_ALIGN_FORWARD((size_t)(arena->ptr - arena->base), CF_ARENA_COMMIT_SIZE);
+		if (keep < arena->end) {
+			s_vm_decommit(keep, (size_t)(arena->end - keep));
+			arena->end = keep;
+		}
+#endif
+		return;
+	}
+	if (!arena->blocks) return;
+	for (int i = arena->block_index; i < asize(arena->blocks); ++i) {
+		cf_aligned_free(arena->blocks[i]);
+	}
+	asetlen(arena->blocks, arena->block_index);
+	asetlen(arena->block_sizes, arena->block_index);
+}
+
 void cf_destroy_arena(CF_Arena* arena)
 {
+#ifndef CF_ARENA_NO_VIRTUAL_MEMORY
+	if (arena->base) {
+		s_vm_release(arena->base, (size_t)(arena->reserve_end - arena->base));
+	}
+#endif
 	if (arena->blocks) {
 		for (int i = 0; i < asize(arena->blocks); ++i) {
 			cf_aligned_free(arena->blocks[i]);
 		}
 		afree(arena->blocks);
+		afree(arena->block_sizes);
 	}
 	arena->ptr = NULL;
 	arena->end = NULL;
 	arena->blocks = NULL;
+	arena->block_sizes = NULL;
 	arena->block_index = 0;
+	arena->base = NULL;
+	arena->reserve_end = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Frame allocator. Each thread owns its arenas, so allocating never takes a lock. Instead of
+// resetting every thread's arenas at the frame boundary, cf_frame_alloc_advance only bumps a
+// counter, and each thread resets its own arenas when it next allocates and sees the counter
+// moved.
+
+#define CF_FRAME_ARENA_RESERVE ((size_t)256 * CF_MB)
+
+struct CF_FrameArenas
+{
+	CF_Arena frame;
+	CF_Arena double_buffered[2]; // Indexed by frame parity.
+	int frame_index;             // The frame `frame` was last reset for.
+	int double_buffered_index;   // The frame `double_buffered[frame & 1]` was last reset for.
+	CF_FrameArenas* next;
+};
+
+static CF_AtomicInt s_frame_index;
+static CF_AtomicInt s_frame_generation; // Bumped by cf_destroy_frame_arenas to orphan thread-locals.
+static CF_AtomicInt s_frame_arenas_lock;
+static CF_FrameArenas* s_frame_arenas;  // Every thread's arenas, guarded by s_frame_arenas_lock.
+static thread_local CF_FrameArenas* s_thread_frame_arenas;
+static thread_local int s_thread_frame_generation;
+
+// Gives a thread's arenas back when it exits, so threads that come and go (pools, jobs) don't
+// each leave their reserve behind until cf_destroy_frame_arenas.
+struct CF_FrameArenasReleaser
+{
+	bool active = false;
+	~CF_FrameArenasReleaser();
+};
+
+static thread_local CF_FrameArenasReleaser s_frame_arenas_releaser;
+
+static void s_frame_arenas_lock_acquire()
+{
+	while (cf_atomic_set(&s_frame_arenas_lock, 1)) {
+		cf_sleep(0);
+	}
+}
+
+static void s_frame_arenas_lock_release()
+{
+	cf_atomic_set(&s_frame_arenas_lock, 0);
+}
+
+static CF_FrameArenas* s_get_frame_arenas()
+{
+	int generation = cf_atomic_get(&s_frame_generation);
+	if (s_thread_frame_arenas && s_thread_frame_generation == generation) {
+		return s_thread_frame_arenas;
+	}
+
+	CF_FrameArenas* arenas = (CF_FrameArenas*)CF_ALLOC(sizeof(CF_FrameArenas));
+	arenas->frame = cf_make_virtual_arena(16, CF_FRAME_ARENA_RESERVE);
+	arenas->double_buffered[0] = cf_make_virtual_arena(16, CF_FRAME_ARENA_RESERVE);
+	arenas->double_buffered[1] = cf_make_virtual_arena(16, CF_FRAME_ARENA_RESERVE);
+	arenas->frame_index = arenas->double_buffered_index = cf_atomic_get(&s_frame_index);
+
+	s_frame_arenas_lock_acquire();
+	arenas->next = s_frame_arenas;
+	s_frame_arenas = arenas;
+	s_frame_arenas_lock_release();
+
+	s_thread_frame_arenas = arenas;
+	s_thread_frame_generation = generation;
+	if (!s_frame_arenas_releaser.active) s_frame_arenas_releaser.active = true;
+	return arenas;
+}
+
+static void s_destroy_frame_arenas(CF_FrameArenas* arenas)
+{
+	cf_destroy_arena(&arenas->frame);
+	cf_destroy_arena(&arenas->double_buffered[0]);
+	cf_destroy_arena(&arenas->double_buffered[1]);
+	CF_FREE(arenas);
+}
+
+CF_FrameArenasReleaser::~CF_FrameArenasReleaser()
+{
+	CF_FrameArenas* arenas = s_thread_frame_arenas;
+	if (!arenas) return;
+	s_thread_frame_arenas = NULL;
+
+	// cf_destroy_frame_arenas bumps the generation under the same lock, so a matching generation
+	// means the arenas are still on the list and still ours to free.
+	bool unlinked = false;
+	s_frame_arenas_lock_acquire();
+	if (s_thread_frame_generation == cf_atomic_get(&s_frame_generation)) {
+		for (CF_FrameArenas** link = &s_frame_arenas; *link; link = &(*link)->next) {
+			if (*link == arenas) {
+				*link = arenas->next;
+				unlinked = true;
+				break;
+			}
+		}
+	}
+	s_frame_arenas_lock_release();
+	if (unlinked) s_destroy_frame_arenas(arenas);
+}
+
+void* cf_frame_alloc(size_t size)
+{
+	CF_ASSERT(size <= INT_MAX);
+	CF_FrameArenas* arenas = s_get_frame_arenas();
+	int frame = cf_atomic_get(&s_frame_index);
+	if (arenas->frame_index != frame) {
+		cf_arena_reset(&arenas->frame);
+		arenas->frame_index = frame;
+	}
+	void* result = cf_arena_alloc(&arenas->frame, (int)size);
+	CF_ASSERT(result && "Out of frame memory -- is cf_frame_alloc_advance (cf_app_update) being called every frame?");
+	return result;
+}
+
+void* cf_frame_alloc_double_buffered(size_t size)
+{
+	CF_ASSERT(size <= INT_MAX);
+	CF_FrameArenas* arenas = s_get_frame_arenas();
+	int frame = cf_atomic_get(&s_frame_index);
+	CF_Arena* arena = arenas->double_buffered + (frame & 1);
+	if (arenas->double_buffered_index != frame) {
+		// This arena last served frame - 2 or earlier, which has expired. The other one may hold
+		// frame - 1's allocations, which must live through this frame.
+		cf_arena_reset(arena);
+		arenas->double_buffered_index = frame;
+	}
+	void* result = cf_arena_alloc(arena, (int)size);
+	CF_ASSERT(result && "Out of frame memory -- is cf_frame_alloc_advance (cf_app_update) being called every frame?");
+	return result;
+}
+
+void cf_frame_alloc_advance()
+{
+	cf_atomic_add(&s_frame_index, 1);
+}
+
+void cf_destroy_frame_arenas()
+{
+	s_frame_arenas_lock_acquire();
+	CF_FrameArenas* arenas = s_frame_arenas;
+	s_frame_arenas = NULL;
+	cf_atomic_add(&s_frame_generation, 1);
+	s_frame_arenas_lock_release();
+	while (arenas) {
+		CF_FrameArenas* next = arenas->next;
+		s_destroy_frame_arenas(arenas);
+		arenas = next;
+	}
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -202,6 +885,9 @@ struct CF_MemoryPool
 	void* free_list;
 	CF_MemoryBlock* blocks;
 	int element_count_per_block;
+	int block_count;
+	int live_count;
+	int high_water_mark;
 };
 
 CF_MemoryPool* cf_make_memory_pool(int element_size, int element_count, int alignment)
@@ -216,6 +902,9 @@ CF_MemoryPool* cf_make_memory_pool(int element_size, int element_count, int alig
 	pool->alignment = alignment;
 	pool->free_list = NULL;
 	pool->element_count_per_block = element_count;
+	pool->block_count = 1;
+	pool->live_count = 0;
+	pool->high_water_mark = 0;
 
 	// Allocate the first block and initialize the free list.
 	CF_MemoryBlock* block = (CF_MemoryBlock*)cf_aligned_alloc(sizeof(CF_MemoryBlock), alignment);
@@ -252,6 +941,7 @@ void* cf_memory_pool_alloc(CF_MemoryPool* pool)
 	if (pool->free_list) {
 		void* mem = pool->free_list;
 		pool->free_list = *(void**)pool->free_list;
+		if (++pool->live_count > pool->high_water_mark) pool->high_water_mark = pool->live_count;
 		return mem;
 	}
 
@@ -260,6 +950,7 @@ void* cf_memory_pool_alloc(CF_MemoryPool* pool)
 	new_block->memory = (uint8_t*)cf_aligned_alloc(pool->block_size, pool->alignment);
 	new_block->next = pool->blocks;
 	pool->blocks = new_block;
+	pool->block_count++;
 	pool->free_list = new_block->memory;
 	for (int i = 0; i < pool->element_count_per_block - 1; ++i) {
 		void** element = (void**)(new_block->memory + pool->element_size * i);
@@ -276,4 +967,419 @@ void cf_memory_pool_free(CF_MemoryPool* pool, void* element)
 {
 	*(void**)element = pool->free_list;
 	pool->free_list = element;
-}
\ No newline at end of file
+	pool->live_count--;
+}
+
+CF_MemoryPoolStats cf_memory_pool_stats(CF_MemoryPool* pool)
+{
+	CF_MemoryPoolStats stats;
+	stats.live_elements = pool->live_count;
+	stats.high_water_mark = pool->high_water_mark;
+	stats.block_count = pool->block_count;
+	stats.elements_per_block = pool->element_count_per_block;
+	return stats;
+}
+//--------------------------------------------------------------------------------------------------
+// Allocation tracking. Live allocations are recorded in an open-addressed table keyed by address
+// instead of a header in front of each allocation, so tracking can be switched on at any time:
+// frees of memory allocated before then (or by anyone bypassing cf_alloc) are just not found.
+// The tables come straight from malloc to keep them out of their own stats.
+
+#define CF_ALLOC_MAX_TAGS 64
+#define CF_ALLOC_TAG_STACK_DEPTH 32
+#define CF_ALLOC_MAX_CALLSITES 4096
+#define CF_ALLOC_TOMBSTONE ((uintptr_t)1)
+
+struct CF_AllocRecord
+{
+	uintptr_t ptr; // 0 for an empty slot, CF_ALLOC_TOMBSTONE for a removed one.
+	uint64_t size;
+	int tag;
+};
+
+struct CF_AllocTag
+{
+	const char* name;
+	uint64_t live_bytes;
+	uint64_t peak_bytes;
+	int live_count;
+	int frame_allocs;
+	int next_frame_allocs;
+	uint64_t frame_bytes;
+	uint64_t next_frame_bytes;
+	uint64_t total_allocs;
+};
+
+struct CF_AllocCallsiteRecord
+{
+	uintptr_t address;
+	uint64_t bytes;
+	uint64_t count;
+};
+
+static CF_AtomicInt s_tracking_lock;
+static CF_AllocRecord* s_records;
+static int s_record_capacity;
+static int s_record_count;
+static int s_record_tombstones;
+static CF_AllocCallsiteRecord* s_callsites; // NULL unless callsites are tracked.
+static CF_AllocTag s_totals;
+
+// Tags are only ever appended, and a name is written before the count that publishes it, so
+// cf_alloc_tag_push can look up a tag it has seen before without taking the lock.
+static CF_AllocTag s_tags[CF_ALLOC_MAX_TAGS] = { { "untagged" } };
+static CF_AtomicInt s_named_tag_count; // Not counting "untagged" at index 0.
+
+static thread_local int s_tag_stack[CF_ALLOC_TAG_STACK_DEPTH];
+static thread_local int s_tag_depth;
+
+static int s_tag_count()
+{
+	return cf_atomic_get(&s_named_tag_count) + 1;
+}
+
+static void s_tracking_lock_acquire()
+{
+	while (cf_atomic_set(&s_tracking_lock, 1)) {
+		cf_sleep(0);
+	}
+}
+
+static void s_tracking_lock_release()
+{
+	cf_atomic_set(&s_tracking_lock, 0);
+}
+
+static uint32_t s_ptr_hash(uintptr_t ptr)
+{
+	uint64_t h = (uint64_t)ptr * 0x9E3779B97F4A7C15ull;
+	return (uint32_t)(h >> 32);
+}
+
+static CF_AllocRecord* s_record_find(uintptr_t ptr)
+{
+	int mask = s_record_capacity - 1;
+	for (int i = (int)(s_ptr_hash(ptr) & mask);; i = (i + 1) & mask) {
+		CF_AllocRecord* r = s_records + i;
+		if (r->ptr == ptr) return r;
+		if (!r->ptr) return NULL;
+	}
+}
+
+static void s_record_insert(CF_AllocRecord record)
+{
+	if ((s_record_count + s_record_tombstones + 1) * 4 > s_record_capacity * 3) {
+		// Rehash, which also clears out tombstones.
+		int capacity = s_record_capacity;
+		while ((s_record_count + 1) * 2 > capacity) capacity *= 2;
+		CF_AllocRecord* old = s_records;
+		int old_capacity = s_record_capacity;
+		s_records = (CF_AllocRecord*)calloc(capacity, sizeof(CF_AllocRecord));
+		s_record_capacity = capacity;
+		s_record_tombstones = 0;
+		s_record_count = 0;
+		for (int i = 0; i < old_capacity; ++i) {
+			if (old[i].ptr > CF_ALLOC_TOMBSTONE) s_record_insert(old[i]);
+		}
+		free(old);
+	}
+	int mask = s_record_capacity - 1;
+	int i = (int)(s_ptr_hash(record.ptr) & mask);
+	while (s_records[i].ptr > CF_ALLOC_TOMBSTONE) i = (i + 1) & mask;
+	if (s_records[i].ptr == CF_ALLOC_TOMBSTONE) s_record_tombstones--;
+	s_records[i] = record;
+	s_record_count++;
+}
+
+static void s_callsite_add(uintptr_t address, size_t size)
+{
+	int mask = CF_ALLOC_MAX_CALLSITES - 1;
+	for (int i = (int)(s_ptr_hash(address) & mask), probes = 0; probes < CF_ALLOC_MAX_CALLSITES; i = (i + 1) & mask, ++probes) {
+		CF_AllocCallsiteRecord* c = s_callsites + i;
+		if (!c->address) c->address = address;
+		if (c->address == address) {
+			c->bytes += size;
+			c->count++;
+			return;
+		}
+	}
+	// Table full, the callsite goes unrecorded.
+}
+
+static void s_track_alloc(void* ptr, size_t size, void* callsite, bool count_alloc)
+{
+	int tag = s_tag_depth ? s_tag_stack[(s_tag_depth < CF_ALLOC_TAG_STACK_DEPTH ? s_tag_depth : CF_ALLOC_TAG_STACK_DEPTH) - 1] : 0;
+	s_tracking_lock_acquire();
+	// Tracking may have been switched off while this thread was on its way here.
+	if (s_records) {
+		CF_AllocRecord record = { (uintptr_t)ptr, (uint64_t)size, tag };
+		s_record_insert(record);
+		CF_AllocTag* stats[2] = { s_tags + tag, &s_totals };
+		for (int i = 0; i < 2; ++i) {
+			CF_AllocTag* t = stats[i];
+			t->live_bytes += size;
+			if (t->live_bytes > t->peak_bytes) t->peak_bytes = t->live_bytes;
+			t->live_count++;
+			if (count_alloc) {
+				t->next_frame_allocs++;
+				t->next_frame_bytes += size;
+				t->total_allocs++;
+			}
+		}
+		if (s_callsites && count_alloc) s_callsite_add((uintptr_t)callsite, size);
+	}
+	s_tracking_lock_release();
+}
+
+static bool s_track_free(void* ptr, uint64_t* size, int* tag)
+{
+	s_tracking_lock_acquire();
+	CF_AllocRecord* r = s_records ? s_record_find((uintptr_t)ptr) : NULL;
+	if (r) {
+		CF_AllocTag* stats[2] = { s_tags + r->tag, &s_totals };
+		for (int i = 0; i < 2; ++i) {
+			stats[i]->live_bytes -= r->size;
+			stats[i]->live_count--;
+		}
+		if (size) *size = r->size;
+		if (tag) *tag = r->tag;
+		r->ptr = CF_ALLOC_TOMBSTONE;
+		s_record_count--;
+		s_record_tombstones++;
+	}
+	s_tracking_lock_release();
+	return r != NULL;
+}
+
+// Puts back a record s_track_free removed, without counting it as a new allocation.
+static void s_track_restore(void* ptr, uint64_t size, int tag)
+{
+	s_tracking_lock_acquire();
+	if (s_records) {
+		CF_AllocRecord record = { (uintptr_t)ptr, size, tag };
+		s_record_insert(record);
+		CF_AllocTag* stats[2] = { s_tags + tag, &s_totals };
+		for (int i = 0; i < 2; ++i) {
+			stats[i]->live_bytes += size;
+			stats[i]->live_count++;
+		}
+	}
+	s_tracking_lock_release();
+}
+
+static CF_AllocTagStats s_tag_stats(const CF_AllocTag* t)
+{
+	CF_AllocTagStats stats;
+	stats.name = t->name;
+	stats.live_bytes = t->live_bytes;
+	stats.peak_bytes = t->peak_bytes;
+	stats.live_count = t->live_count;
+	stats.frame_allocs = t->frame_allocs;
+	stats.frame_bytes = t->frame_bytes;
+	stats.total_allocs = t->total_allocs;
+	return stats;
+}
+
+// Leaves the name alone, cf_alloc_tag_push reads it without the lock.
+static void s_tag_reset(CF_AllocTag* t)
+{
+	t->live_bytes = 0;
+	t->peak_bytes = 0;
+	t->live_count = 0;
+	t->frame_allocs = 0;
+	t->next_frame_allocs = 0;
+	t->frame_bytes = 0;
+	t->next_frame_bytes = 0;
+	t->total_allocs = 0;
+}
+
+void cf_alloc_tracking_enable(bool track_callsites)
+{
+	s_tracking_lock_acquire();
+	if (!s_records) {
+		s_record_capacity = 1024;
+		s_records = (CF_AllocRecord*)calloc(s_record_capacity, sizeof(CF_AllocRecord));
+		s_record_count = 0;
+		s_record_tombstones = 0;
+		for (int i = 0; i < s_tag_count(); ++i) s_tag_reset(s_tags + i);
+		s_tag_reset(&s_totals);
+	}
+	if (track_callsites && !s_callsites) {
+		s_callsites = (CF_AllocCallsiteRecord*)calloc(CF_ALLOC_MAX_CALLSITES, sizeof(CF_AllocCallsiteRecord));
+	}
+	cf_atomic_set(&s_tracking, 1);
+	s_tracking_lock_release();
+}
+
+void cf_alloc_tracking_disable()
+{
+	s_tracking_lock_acquire();
+	cf_atomic_set(&s_tracking, 0);
+	free(s_records);
+	free(s_callsites);
+	s_records = NULL;
+	s_callsites = NULL;
+	s_record_capacity = 0;
+	s_tracking_lock_release();
+}
+
+void cf_alloc_tag_push(const char* tag)
+{
+	int index = -1;
+	int count = s_tag_count();
+	for (int i = 0; i < count; ++i) {
+		if (s_tags[i].name == tag) {
+			index = i;
+			break;
+		}
+	}
+	if (index < 0) {
+		// Not seen by pointer. Fall back to comparing strings, since the same literal may have
+		// different addresses in different translation units or modules.
+		s_tracking_lock_acquire();
+		count = s_tag_count();
+		for (int i = 0; i < count; ++i) {
+			if (!CF_STRCMP(s_tags[i].name, tag)) {
+				index = i;
+				break;
+			}
+		}
+		if (index < 0) {
+			CF_ASSERT(count < CF_ALLOC_MAX_TAGS);
+			if (count < CF_ALLOC_MAX_TAGS) {
+				s_tags[count].name = tag;
+				index = count;
+				cf_atomic_set(&s_named_tag_count, count);
+			} else {
+				index = 0;
+			}
+		}
+		s_tracking_lock_release();
+	}
+	// Past the maximum depth allocations stay with the deepest recorded tag, but depth keeps
+	// counting so pops still line up.
+	if (s_tag_depth < CF_ALLOC_TAG_STACK_DEPTH) s_tag_stack[s_tag_depth] = index;
+	s_tag_depth++;
+}
+
+void cf_alloc_tag_pop()
+{
+	CF_ASSERT(s_tag_depth > 0);
+	if (s_tag_depth > 0) s_tag_depth--;
+}
+
+int cf_alloc_tag_depth()
+{
+	return s_tag_depth;
+}
+
+void cf_alloc_tracking_advance_frame()
+{
+	if (!cf_atomic_get(&s_tracking)) return;
+	s_tracking_lock_acquire();
+	int count = s_tag_count();
+	for (int i = 0; i <= count; ++i) {
+		CF_AllocTag* t = i < count ? s_tags + i : &s_totals;
+		t->frame_allocs = t->next_frame_allocs;
+		t->frame_bytes = t->next_frame_bytes;
+		t->next_frame_allocs = 0;
+		t->next_frame_bytes = 0;
+	}
+	s_tracking_lock_release();
+}
+
+int cf_alloc_tracking_tag_count()
+{
+	return s_tag_count();
+}
+
+CF_AllocTagStats cf_alloc_tracking_tag_stats(int index)
+{
+	CF_ASSERT(index >= 0 && index < s_tag_count());
+	s_tracking_lock_acquire();
+	CF_AllocTagStats stats = s_tag_stats(s_tags + index);
+	s_tracking_lock_release();
+	return stats;
+}
+
+CF_AllocTagStats cf_alloc_tracking_totals()
+{
+	s_tracking_lock_acquire();
+	CF_AllocTagStats stats = s_tag_stats(&s_totals);
+	s_tracking_lock_release();
+	stats.name = "total";
+	return stats;
+}
+
+static int s_callsite_compare(const void* a, const void* b)
+{
+	const CF_AllocCallsiteRecord* x = (const CF_AllocCallsiteRecord*)a;
+	const CF_AllocCallsiteRecord* y = (const CF_AllocCallsiteRecord*)b;
+	return x->bytes < y->bytes ? 1 : x->bytes > y->bytes ? -1 : 0;
+}
+
+int cf_alloc_tracking_top_callsites(CF_AllocCallsite* callsites, int max)
+{
+	// Copy out under the lock and sort outside of it.
+	CF_AllocCallsiteRecord* copy = (CF_AllocCallsiteRecord*)malloc(sizeof(CF_AllocCallsiteRecord) * CF_ALLOC_MAX_CALLSITES);
+	int count = 0;
+	s_tracking_lock_acquire();
+	if (s_callsites) {
+		for (int i = 0; i < CF_ALLOC_MAX_CALLSITES; ++i) {
+			if (s_callsites[i].address) copy[count++] = s_callsites[i];
+		}
+	}
+	s_tracking_lock_release();
+	qsort(copy, count, sizeof(CF_AllocCallsiteRecord), s_callsite_compare);
+	count = count < max ? count : max;
+	for (int i = 0; i < count; ++i) {
+		callsites[i].address = (const void*)copy[i].address;
+		callsites[i].bytes = copy[i].bytes;
+		callsites[i].count = copy[i].count;
+	}
+	free(copy);
+	return count;
+}
+
+static void s_json_tag(char** json, CF_AllocTagStats stats)
+{
+	sappend(*json, "{\"name\":\"");
+	for (const char* c = stats.name; *c; ++c) {
+		if (*c == '"' || *c == '\\') spush(*json, '\\');
+		spush(*json, *c);
+	}
+	sfmt_append(*json, "\",\"live_bytes\":%llu,\"peak_bytes\":%llu,\"live_count\":%d,\"frame_allocs\":%d,\"frame_bytes\":%llu,\"total_allocs\":%llu}",
+		(unsigned long long)stats.live_bytes, (unsigned long long)stats.peak_bytes, stats.live_count, stats.frame_allocs,
+		(unsigned long long)stats.frame_bytes, (unsigned long long)stats.total_allocs);
+}
+
+char* cf_alloc_tracking_to_json(int max_callsites)
+{
+	// Snapshot everything first, building the string allocates.
+	CF_AllocTagStats tags[CF_ALLOC_MAX_TAGS];
+	s_tracking_lock_acquire();
+	int tag_count = s_tag_count();
+	for (int i = 0; i < tag_count; ++i) tags[i] = s_tag_stats(s_tags + i);
+	CF_AllocTagStats totals = s_tag_stats(&s_totals);
+	s_tracking_lock_release();
+	totals.name = "total";
+	CF_AllocCallsite* callsites = (CF_AllocCallsite*)malloc(sizeof(CF_AllocCallsite) * (max_callsites > 0 ? max_callsites : 1));
+	int callsite_count = cf_alloc_tracking_top_callsites(callsites, max_callsites);
+
+	char* json = NULL;
+	sset(json, "{\"total\":");
+	s_json_tag(&json, totals);
+	sappend(json, ",\"tags\":[");
+	for (int i = 0; i < tag_count; ++i) {
+		if (i) spush(json, ',');
+		s_json_tag(&json, tags[i]);
+	}
+	sappend(json, "],\"callsites\":[");
+	for (int i = 0; i < callsite_count; ++i) {
+		sfmt_append(json, "%s{\"address\":\"%p\",\"bytes\":%llu,\"count\":%llu}", i ? "," : "",
+			callsites[i].address, (unsigned long long)callsites[i].bytes, (unsigned long long)callsites[i].count);
+	}
+	sappend(json, "]}");
+	free(callsites);
+	return json;
+}
@@ -19,6 +19,7 @@
 #include <internal/cute_input_internal.h>
 #include <internal/cute_graphics_internal.h>
 #include <internal/cute_draw_internal.h>
+#include <internal/cute_ecs_internal.h>
 #include <internal/cute_custom_sprite_internal.h>
 #include <internal/cute_aseprite_cache_internal.h>
 #include <internal/cute_imgui_internal.h>
@@ -427,6 +428,7 @@ void cf_destroy_app()
 #endif
 		}
 	}
+	cf_destroy_ecs();
 	cf_destroy_aseprite_cache();
 	cf_destroy_custom_sprite_cache();
 	cs_shutdown();
@@ -441,6 +443,7 @@ void cf_destroy_app()
 	CF_FREE(app);
 	app = NULL;
 	cf_fs_destroy();
+	cf_destroy_frame_arenas();
 }
 
 bool cf_app_is_running()
@@ -478,6 +481,8 @@ static void s_on_update(void* udata)
 
 void cf_app_update(CF_OnUpdateFn* on_update)
 {
+	cf_frame_alloc_advance();
+	cf_alloc_tracking_advance_frame();
 	if (s_draw) s_draw->defragged_this_frame = false; // New frame: the defrag latch re-arms.
 	if (app->gfx_enabled) {
 		if (app->using_imgui) {
@@ -588,22 +593,7 @@ int cf_app_draw_onto_screen(bool clear)
 	}
 
 	// Clear all pushed draw parameters.
-	s_draw->alpha_discards.set_count(1);
-	s_draw->colors.set_count(1);
-	s_draw->antialias.set_count(1);
-	s_draw->render_states.set_count(1);
-	s_draw->scissors.set_count(1);
-	s_draw->viewports.set_count(1);
-	s_draw->layers.set_count(1);
-	s_draw->reset_cam();
-	s_draw->font_sizes.set_count(1);
-	s_draw->fonts.set_count(1);
-	s_draw->blurs.set_count(1);
-	s_draw->text_wrap_widths.set_count(1);
-	s_draw->vertical.set_count(1);
-	s_draw->text_ids.set_count(1);
-	s_draw->user_params.set_count(1);
-	s_draw->shaders.set_count(1);
+	cf_draw_reset_state(s_draw);
 	s_draw->draw_item_order = 0;
 	s_draw->cmds.clear();
 	s_draw->add_cmd();
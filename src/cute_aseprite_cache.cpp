@@ -341,7 +341,7 @@ void cf_aseprite_cache_unload(const char* aseprite_path)
 	for (int i = 0; i < asize(asset->frame_ids); ++i) {
 		uint64_t id = asset->frame_ids[i];
 		g_ase_cache->id_to_pixels.remove(id);
-		atlas_cache_invalidate(&s_draw->atlas_cache, id);
+		atlas_cache_invalidate(&s_draw_app->atlas_cache, id);
 	}
 
 	s_free_asset(asset);
@@ -376,7 +376,7 @@ void cf_aseprite_cache_reload_asset(uint64_t asset_id, ase_t* new_ase)
 	for (int i = 0; i < common; ++i) {
 		uint64_t id = asset->frame_ids[i];
 		g_ase_cache->id_to_pixels.insert(id, new_ase->frames[i].pixels);
-		atlas_cache_invalidate(&s_draw->atlas_cache, id);
+		atlas_cache_invalidate(&s_draw_app->atlas_cache, id);
 	}
 
 	// Allocate new IDs for additional frames.
@@ -390,7 +390,7 @@ void cf_aseprite_cache_reload_asset(uint64_t asset_id, ase_t* new_ase)
 	for (int i = common; i < old_count; ++i) {
 		uint64_t id = asset->frame_ids[i];
 		g_ase_cache->id_to_pixels.remove(id);
-		atlas_cache_invalidate(&s_draw->atlas_cache, id);
+		atlas_cache_invalidate(&s_draw_app->atlas_cache, id);
 	}
 	if (new_count < old_count) {
 		asetlen(asset->frame_ids, new_count);
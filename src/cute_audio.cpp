@@ -21,10 +21,21 @@
 #	endif // CUTE_SOUND_SCALAR_MODE
 #endif // CF_EMSCRIPTEN
 
+// Everything cute_sound allocates is tagged for the allocation tracker, and credited to the
+// cute_sound function asking for it.
+static CF_NOINLINE void* s_audio_alloc(size_t size)
+{
+	CF_ALLOC_TAG_SCOPE("audio");
+	void* prev = cf_alloc_set_callsite(CF_RETURN_ADDRESS());
+	void* ptr = cf_alloc(size);
+	cf_alloc_set_callsite(prev);
+	return ptr;
+}
+
 #define CUTE_SOUND_IMPLEMENTATION
 #define CUTE_SOUND_FORCE_SDL
 #define CUTE_SOUND_ASSERT CF_ASSERT
-#define CUTE_SOUND_ALLOC(size, ctx) cf_alloc(size)
+#define CUTE_SOUND_ALLOC(size, ctx) s_audio_alloc(size)
 #define CUTE_SOUND_FREE(mem, ctx) cf_free(mem)
 #include <cute/cute_sound.h>
 
@@ -21,7 +21,9 @@
 #include <internal/cute_font_internal.h>
 #include <internal/cute_graphics_internal.h>
 
-struct CF_Draw* s_draw;
+struct CF_Draw* s_draw_app;
+thread_local struct CF_Draw* s_draw_recorder;
+std::atomic<int> s_draw_recording;
 static const char* s_text_without_markups = NULL;
 
 //#define ATLAS_CACHE_LOG printf
@@ -241,17 +243,18 @@ void cf_get_pixels(ATLAS_CACHE_U64 image_id, void* buffer, int bytes_to_fill, vo
 // (fill-in-place: no stack struct, no copy; unset fields stay zero).
 static CF_INLINE BatchGeometry& s_push_geom()
 {
-	CF_Command& cmd = s_draw->cmds.last();
+	CF_Draw* draw = s_draw;
+	CF_Command& cmd = draw->cmds.last();
 	BatchGeometry& g = cmd.geoms.add();
-	g.mvp = s_draw->mvp;
-	g.blend = s_draw->blends.last();
+	g.mvp = draw->mvp;
+	g.blend = draw->blends.last();
 	// Stroke/effect state is captured for every geometry here rather than per emitter, so a
 	// shape type that never looks at it still has it well-defined.
-	g.dash = s_draw->dashes.last();
-	g.fx.outline = premultiply(s_draw->outlines.last());
-	g.fx.outline_width = s_draw->outline_widths.last();
-	g.fx.glow = premultiply(s_draw->glows.last());
-	g.fx.glow_radius = s_draw->glow_radii.last();
+	g.dash = draw->dashes.last();
+	g.fx.outline = premultiply(draw->outlines.last());
+	g.fx.outline_width = draw->outline_widths.last();
+	g.fx.glow = premultiply(draw->glows.last());
+	g.fx.glow_radius = draw->glow_radii.last();
 	return g;
 }
 
@@ -259,19 +262,190 @@ static CF_INLINE BatchGeometry& s_push_geom()
 // (cf_draw_shape_group_begin) can stage them as operands instead of emitting commands.
 static CF_INLINE BatchGeometry& s_push_shape_geom()
 {
-	if (s_draw->shape_group_active) {
-		BatchGeometry& g = s_draw->group_geoms.add();
+	CF_Draw* draw = s_draw;
+	if (draw->shape_group_active) {
+		BatchGeometry& g = draw->group_geoms.add();
 		CF_MEMSET(&g, 0, sizeof(g));
-		g.mvp = s_draw->mvp;
-		g.blend = s_draw->blends.last();
+		g.mvp = draw->mvp;
+		g.blend = draw->blends.last();
 		g.csg_operand = true;
-		g.csg_op = s_draw->shape_group_op;
-		g.csg_k = s_draw->shape_group_k;
+		g.csg_op = draw->shape_group_op;
+		g.csg_k = draw->shape_group_k;
 		return g;
 	}
 	return s_push_geom();
 }
 
+//--------------------------------------------------------------------------------------------------
+// Flush stream encoding. See CF_GeomHeader in cute_draw_internal.h.
+
+// True if every bit of a float block is zero. `size` is a multiple of 4.
+static CF_INLINE bool s_is_zero(const void* p, size_t size)
+{
+	const uint32_t* w = (const uint32_t*)p;
+	uint32_t bits = 0;
+	for (size_t i = 0; i < size / 4; ++i) bits |= w[i];
+	return bits == 0;
+}
+
+#define CF_GEOM_WRITE(p, src, size) (CF_MEMCPY(p, src, size), (p) += (size))
+#define CF_GEOM_READ(dst, p, size) (CF_MEMCPY(dst, p, size), (p) += (size))
+
+int cf_encode_geom(const BatchGeometry& g, Array<CF_M3x2>* mvps, Array<CF_GeomWord>* stream)
+{
+	if (!mvps->count() || CF_MEMCMP(&mvps->last(), &g.mvp, sizeof(CF_M3x2)) != 0) {
+		mvps->add(g.mvp);
+	}
+
+	int shape_count = 8;
+	while (shape_count && g.shape[shape_count - 1].x == 0 && g.shape[shape_count - 1].y == 0) --shape_count;
+	uint16_t flags = 0;
+	if (g.is_text) flags |= GEOM_FLAG_TEXT;
+	if (g.is_sprite) flags |= GEOM_FLAG_SPRITE;
+	if (g.fill) flags |= GEOM_FLAG_FILL;
+	if (g.csg_operand) flags |= GEOM_FLAG_CSG_OPERAND;
+	if (!s_is_zero(g.box, sizeof(g.box))) flags |= GEOM_FLAG_BOX;
+	if (g.dash.on > 0) flags |= GEOM_FLAG_DASH;
+	if (g.fx.outline_width > 0 || g.fx.glow_radius > 0) flags |= GEOM_FLAG_FX;
+	if (g.csg_op || g.csg_k != 0) flags |= GEOM_FLAG_CSG;
+	if (!s_is_zero(&g.user_params, sizeof(g.user_params))) flags |= GEOM_FLAG_USER_PARAMS;
+	if (g.is_text || g.type == BATCH_GEOMETRY_TYPE_GLYPH) flags |= GEOM_FLAG_CORNER_COLORS;
+	else {
+		if (g.use_tri_colors) flags |= GEOM_FLAG_TRI_COLORS;
+		if (g.use_tri_attributes) flags |= GEOM_FLAG_TRI_ATTRIBUTES;
+	}
+
+	int size = (int)sizeof(CF_GeomHeader) + shape_count * (int)sizeof(CF_V2);
+	if (flags & GEOM_FLAG_BOX) size += sizeof(g.box);
+	if (flags & GEOM_FLAG_DASH) size += sizeof(g.dash);
+	if (flags & GEOM_FLAG_FX) size += sizeof(g.fx);
+	if (flags & GEOM_FLAG_CSG) size += sizeof(g.csg_op) + sizeof(g.csg_k);
+	if (flags & GEOM_FLAG_USER_PARAMS) size += sizeof(g.user_params);
+	if (flags & GEOM_FLAG_CORNER_COLORS) size += sizeof(g.text_colors);
+	if (flags & GEOM_FLAG_TRI_COLORS) size += sizeof(g.tri_colors);
+	if (flags & GEOM_FLAG_TRI_ATTRIBUTES) size += sizeof(g.tri_attributes);
+
+	CF_GeomHeader h;
+	h.type = (uint8_t)g.type;
+	h.blend = (uint8_t)g.blend;
+	h.shape_count = (uint8_t)shape_count;
+	h.unused = 0;
+	h.flags = flags;
+	h.size = (uint16_t)size;
+	h.n = g.n;
+	h.mvp = (uint32_t)(mvps->count() - 1);
+	h.color = g.color;
+	h.alpha = g.alpha;
+	h.radius = g.radius;
+	h.stroke = g.stroke;
+	h.aa = g.aa;
+
+	Array<CF_GeomWord>& out = *stream;
+	int at = out.count();
+	out.set_count(at + size / 4);
+	uint8_t* p = (uint8_t*)(out.data() + at);
+	CF_GEOM_WRITE(p, &h, sizeof(h));
+	if (flags & GEOM_FLAG_BOX) CF_GEOM_WRITE(p, g.box, sizeof(g.box));
+	CF_GEOM_WRITE(p, g.shape, shape_count * sizeof(CF_V2));
+	if (flags & GEOM_FLAG_DASH) CF_GEOM_WRITE(p, &g.dash, sizeof(g.dash));
+	if (flags & GEOM_FLAG_FX) CF_GEOM_WRITE(p, &g.fx, sizeof(g.fx));
+	if (flags & GEOM_FLAG_CSG) {
+		CF_GEOM_WRITE(p, &g.csg_op, sizeof(g.csg_op));
+		CF_GEOM_WRITE(p, &g.csg_k, sizeof(g.csg_k));
+	}
+	if (flags & GEOM_FLAG_USER_PARAMS) CF_GEOM_WRITE(p, &g.user_params, sizeof(g.user_params));
+	if (flags & GEOM_FLAG_CORNER_COLORS) CF_GEOM_WRITE(p, g.text_colors, sizeof(g.text_colors));
+	if (flags & GEOM_FLAG_TRI_COLORS) CF_GEOM_WRITE(p, g.tri_colors, sizeof(g.tri_colors));
+	if (flags & GEOM_FLAG_TRI_ATTRIBUTES) CF_GEOM_WRITE(p, g.tri_attributes, sizeof(g.tri_attributes));
+	CF_ASSERT(p == (uint8_t*)(out.data() + out.count()));
+	return size;
+}
+
+// Appends `g` to the flush stream.
+static void s_encode_geom(const BatchGeometry& g)
+{
+	int size = cf_encode_geom(g, &s_draw->pending_mvps, &s_draw->pending_stream);
+	s_draw->stream_geom_count++;
+	s_draw->stream_bytes += (uint64_t)size;
+}
+
+const uint8_t* cf_decode_geom(const uint8_t* p, const CF_M3x2* mvps, BatchGeometry* g)
+{
+	CF_GeomHeader h;
+	CF_MEMCPY(&h, p, sizeof(h));
+	const uint8_t* next = p + h.size;
+	p += sizeof(h);
+	g->type = (BatchGeometryType)h.type;
+	g->blend = h.blend;
+	g->n = h.n;
+	g->mvp = mvps[h.mvp];
+	g->color = h.color;
+	g->alpha = h.alpha;
+	g->radius = h.radius;
+	g->stroke = h.stroke;
+	g->aa = h.aa;
+	g->is_text = (h.flags & GEOM_FLAG_TEXT) != 0;
+	g->is_sprite = (h.flags & GEOM_FLAG_SPRITE) != 0;
+	g->fill = (h.flags & GEOM_FLAG_FILL) != 0;
+	g->csg_operand = (h.flags & GEOM_FLAG_CSG_OPERAND) != 0;
+	g->use_tri_colors = (h.flags & GEOM_FLAG_TRI_COLORS) != 0;
+	g->use_tri_attributes = (h.flags & GEOM_FLAG_TRI_ATTRIBUTES) != 0;
+	if (h.flags & GEOM_FLAG_BOX) CF_GEOM_READ(g->box, p, sizeof(g->box));
+	else CF_MEMSET(g->box, 0, sizeof(g->box));
+	CF_GEOM_READ(g->shape, p, h.shape_count * sizeof(CF_V2));
+	CF_MEMSET(g->shape + h.shape_count, 0, (8 - h.shape_count) * sizeof(CF_V2));
+	if (h.flags & GEOM_FLAG_DASH) CF_GEOM_READ(&g->dash, p, sizeof(g->dash));
+	else CF_MEMSET(&g->dash, 0, sizeof(g->dash));
+	if (h.flags & GEOM_FLAG_FX) CF_GEOM_READ(&g->fx, p, sizeof(g->fx));
+	else CF_MEMSET(&g->fx, 0, sizeof(g->fx));
+	if (h.flags & GEOM_FLAG_CSG) {
+		CF_GEOM_READ(&g->csg_op, p, sizeof(g->csg_op));
+		CF_GEOM_READ(&g->csg_k, p, sizeof(g->csg_k));
+	} else {
+		g->csg_op = 0;
+		g->csg_k = 0;
+	}
+	if (h.flags & GEOM_FLAG_USER_PARAMS) CF_GEOM_READ(&g->user_params, p, sizeof(g->user_params));
+	else CF_MEMSET(&g->user_params, 0, sizeof(g->user_params));
+	CF_MEMSET(g->tri_colors, 0, sizeof(g->tri_colors) + sizeof(g->tri_attributes));
+	if (h.flags & GEOM_FLAG_CORNER_COLORS) CF_GEOM_READ(g->text_colors, p, sizeof(g->text_colors));
+	if (h.flags & GEOM_FLAG_TRI_COLORS) CF_GEOM_READ(g->tri_colors, p, sizeof(g->tri_colors));
+	if (h.flags & GEOM_FLAG_TRI_ATTRIBUTES) CF_GEOM_READ(g->tri_attributes, p, sizeof(g->tri_attributes));
+	CF_ASSERT(p == next);
+	return next;
+}
+
+// Reads just a record's header, for walks that only need its type, flags, or blend.
+static CF_INLINE const CF_GeomHeader* s_geom_header(const uint8_t* p)
+{
+	return (const CF_GeomHeader*)p;
+}
+
+// Decodes only the leading part of a record: the header fields, box corners and shape points,
+// which is all a coverage estimate needs. Everything after the shape block is left untouched.
+static void s_decode_geom_coverage(const uint8_t* p, const CF_M3x2* mvps, BatchGeometry* g)
+{
+	const CF_GeomHeader* h = s_geom_header(p);
+	p += sizeof(CF_GeomHeader);
+	g->type = (BatchGeometryType)h->type;
+	g->mvp = mvps[h->mvp];
+	g->color = h->color;
+	g->alpha = h->alpha;
+	g->fill = (h->flags & GEOM_FLAG_FILL) != 0;
+	if (h->flags & GEOM_FLAG_BOX) CF_GEOM_READ(g->box, p, sizeof(g->box));
+	else CF_MEMSET(g->box, 0, sizeof(g->box));
+	CF_MEMCPY(g->shape, p, h->shape_count * sizeof(CF_V2));
+	CF_MEMSET(g->shape + h->shape_count, 0, (8 - h->shape_count) * sizeof(CF_V2));
+}
+
+void cf_draw_stream_stats(int* geoms, uint64_t* bytes)
+{
+	if (geoms) *geoms = s_draw->stream_geom_count;
+	if (bytes) *bytes = s_draw->stream_bytes;
+	s_draw->stream_geom_count = 0;
+	s_draw->stream_bytes = 0;
+}
+
 //--------------------------------------------------------------------------------------------------
 // Tiled renderer. See the comment block in cute_draw_internal.h for an overview.
 
@@ -290,6 +464,45 @@ bool cf_tile_range(float min_x, float min_y, float max_x, float max_y, int tiles
 }
 
 
+CF_CmdKey* cf_sort_cmd_keys(CF_CmdKey* keys, CF_CmdKey* scratch, int count)
+{
+	// The common case -- one layer, commands in submission order -- is already sorted.
+	int i = 1;
+	while (i < count && keys[i - 1].key <= keys[i].key) ++i;
+	if (i >= count) return keys;
+
+	// Histogram all eight digits in one read.
+	static const int k_digits = 8;
+	int counts[k_digits][256];
+	CF_MEMSET(counts, 0, sizeof(counts));
+	for (int j = 0; j < count; ++j) {
+		uint64_t key = keys[j].key;
+		for (int d = 0; d < k_digits; ++d) {
+			counts[d][(key >> (d * 8)) & 0xFF]++;
+		}
+	}
+
+	CF_CmdKey* src = keys;
+	CF_CmdKey* dst = scratch;
+	for (int d = 0; d < k_digits; ++d) {
+		// Every key shares this digit, so the pass would be the identity.
+		if (counts[d][(src[0].key >> (d * 8)) & 0xFF] == count) continue;
+		int offsets[256];
+		int sum = 0;
+		for (int b = 0; b < 256; ++b) {
+			offsets[b] = sum;
+			sum += counts[d][b];
+		}
+		for (int j = 0; j < count; ++j) {
+			dst[offsets[(src[j].key >> (d * 8)) & 0xFF]++] = src[j];
+		}
+		CF_CmdKey* t = src;
+		src = dst;
+		dst = t;
+	}
+	return src;
+}
+
 void cf_draw_set_tiled_enabled(bool enabled) { s_draw->tiled_mode = enabled ? 2 : 1; }
 bool cf_draw_get_tiled_enabled() { return s_draw->tiled_mode == 2; }
 bool cf_draw_tiled_available() { return s_draw->tiled_available; }
@@ -305,7 +518,7 @@ struct CF_TiledBatchStats
 	bool has_big_opaque;
 };
 
-static CF_TiledBatchStats s_tiled_batch_stats(const BatchGeometry* geoms, int start, int end)
+static CF_TiledBatchStats s_tiled_batch_stats(const uint8_t* records, int start, int end)
 {
 	CF_TiledBatchStats stats = { 0, false };
 	int canvas_w, canvas_h;
@@ -313,9 +526,16 @@ static CF_TiledBatchStats s_tiled_batch_stats(const BatchGeometry* geoms, int st
 	if (canvas_w <= 0 || canvas_h <= 0) return stats;
 	float w2 = canvas_w * 0.5f;
 	float h2 = canvas_h * 0.5f;
+	const CF_M3x2* mvps = s_draw->pending_mvps.data();
+	const uint8_t* p = records;
+	BatchGeometry geom;
 	for (int i = start; i < end; ++i) {
-		const BatchGeometry& geom = geoms[i];
-		if (geom.csg_operand) continue; // Folded into a preceding CSG head.
+		if (s_geom_header(p)->flags & GEOM_FLAG_CSG_OPERAND) { // Folded into a preceding CSG head.
+			p += s_geom_header(p)->size;
+			continue;
+		}
+		s_decode_geom_coverage(p, mvps, &geom);
+		p += s_geom_header(p)->size;
 		const CF_V2* src = geom.box;
 		int nverts = 4;
 		bool is_sdf = true;
@@ -367,14 +587,16 @@ static void s_tile_ensure_rw_buffer(CF_StorageBuffer* buf, int* cap, int size)
 	*cap = new_cap;
 }
 
-void cf_draw_tiled_stats(int* tiled_batches, int* instanced_batches, uint64_t* upload_bytes)
+void cf_draw_tiled_stats(int* tiled_batches, int* instanced_batches, uint64_t* upload_bytes, int* culled)
 {
 	if (tiled_batches) *tiled_batches = s_draw->tiled_batch_count;
 	if (instanced_batches) *instanced_batches = s_draw->instanced_batch_count;
 	if (upload_bytes) *upload_bytes = s_draw->tiled_upload_bytes;
+	if (culled) *culled = s_draw->culled_count;
 	s_draw->tiled_batch_count = 0;
 	s_draw->instanced_batch_count = 0;
 	s_draw->tiled_upload_bytes = 0;
+	s_draw->culled_count = 0;
 }
 
 static bool s_tiled_batch_eligible(int count)
@@ -421,7 +643,9 @@ static CF_RenderState s_blend_run_state(CF_RenderState rs, int blend, bool tiled
 	return rs;
 }
 
-static void s_draw_report_tiled(const BatchGeometry* geoms, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h, int blend, bool instanced)
+// Builds and draws one run of the flush stream. `records` points at the run's first record,
+// geometry index `start`.
+static void s_draw_report_tiled(const uint8_t* records, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h, int blend, bool instanced)
 {
 	CF_Command& cmd = s_draw->cmds[s_draw->cmd_index];
 	int canvas_w, canvas_h;
@@ -445,11 +669,18 @@ static void s_draw_report_tiled(const BatchGeometry* geoms, const CF_PendingUV*
 	uint32_t inv_off = 0;
 	float ux0 = FLT_MAX, uy0 = FLT_MAX, ux1 = -FLT_MAX, uy1 = -FLT_MAX;
 
-	// Walk the geometry stream range in paint order. Sprite/text atlas uvs come from
-	// the per-flush uv table the atlas callbacks filled in.
+	// Walk the geometry stream range in paint order, decoding each record once. Sprite/text
+	// atlas uvs come from the per-flush uv table the atlas callbacks filled in.
+	const CF_M3x2* mvps = s_draw->pending_mvps.data();
+	const uint8_t* p = records;
+	BatchGeometry geom;
+	BatchGeometry og;
 	for (int k = start; k < end; ++k) {
-		const BatchGeometry& geom = geoms[k];
-		if (geom.csg_operand) continue; // Consumed by its preceding CSG head.
+		if (s_geom_header(p)->flags & GEOM_FLAG_CSG_OPERAND) { // Consumed by its preceding CSG head.
+			p += s_geom_header(p)->size;
+			continue;
+		}
+		p = cf_decode_geom(p, mvps, &geom);
 		const CF_PendingUV* s = NULL;
 		if (geom.is_sprite || geom.is_text) {
 			s = uvs + k;
@@ -671,7 +902,7 @@ static void s_draw_report_tiled(const BatchGeometry* geoms, const CF_PendingUV*
 				// Operands trail the head in the stream.
 				pay.add({ geom.box[0].x, geom.box[0].y, geom.box[2].x, geom.box[2].y });
 				for (int oi = 0; oi < geom.n; ++oi) {
-					const BatchGeometry& og = geoms[k + 1 + oi];
+					p = cf_decode_geom(p, mvps, &og);
 					float prim, aux = 0;
 					switch (og.type) {
 					case BATCH_GEOMETRY_TYPE_QUAD: prim = 2; break;
@@ -932,7 +1163,7 @@ static void s_draw_report(atlas_cache_entry_t* entries, int count, int texture_w
 }
 
 // Routes one paint-ordered run of the stream to the tiled or instanced path.
-static void s_draw_report_range(const BatchGeometry* geoms, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h, int blend)
+static void s_draw_report_range(const uint8_t* records, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h, int blend)
 {
 	int total = end - start;
 	if (total <= 0) return;
@@ -941,7 +1172,7 @@ static void s_draw_report_range(const BatchGeometry* geoms, const CF_PendingUV*
 		// tiled wins decisively when its opaque-cover cull can engage (up to ~9x on
 		// stacked opaque scenes). Route tiled only when a big opaque cover exists --
 		// which requires normal blending (other modes never hide what's beneath).
-		CF_TiledBatchStats stats = s_tiled_batch_stats(geoms, start, end);
+		CF_TiledBatchStats stats = s_tiled_batch_stats(records, start, end);
 		bool take = s_draw->tiled_mode == 0 ? (stats.has_big_opaque && blend == CF_DRAW_BLEND_NORMAL) : true;
 		// Bin lists are sized as the sum of per-command tile footprints, and the gather
 		// walks every command per touched tile -- a pathological batch (thousands of
@@ -950,13 +1181,13 @@ static void s_draw_report_range(const BatchGeometry* geoms, const CF_PendingUV*
 		// batch instead (it is O(cmds) regardless of footprint).
 		if (take && stats.footprint_tiles > s_draw->tiled_list_budget) take = false;
 		if (take) {
-			s_draw_report_tiled(geoms, uvs, start, end, texture_id, texture_w, texture_h, blend, false);
+			s_draw_report_tiled(records, uvs, start, end, texture_id, texture_w, texture_h, blend, false);
 			return;
 		}
 	}
 	s_draw->instanced_batch_count++;
 	if (!s_draw->instanced_available) return; // Draw shader failed to compile; nothing can render.
-	s_draw_report_tiled(geoms, uvs, start, end, texture_id, texture_w, texture_h, blend, true);
+	s_draw_report_tiled(records, uvs, start, end, texture_id, texture_w, texture_h, blend, true);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -985,8 +1216,8 @@ static void s_init_atlas_cache(int w, int h)
 	s_draw->atlas_dims = V2((float)w, (float)h);
 
 	if (atlas_cache_init(&s_draw->atlas_cache, &config, NULL)) {
-		CF_FREE(s_draw);
-		s_draw = NULL;
+		CF_FREE(s_draw_app);
+		s_draw_app = NULL;
 		CF_ASSERT(false);
 		return;
 	}
@@ -1006,15 +1237,15 @@ void CF_Draw::reset_cam()
 	cam_stack.clear();
 	cam_stack.add(cf_make_identity());
 	mvp = projection;
-	s_draw->set_aaf();
+	set_aaf();
 }
 
 // Sets the anti-alias factor, the width of roughly one pixel scaled.
 // This factor remains constant-size despite zooming in/out with the camera.
 void CF_Draw::set_aaf()
 {
-	float inv_cam_scale = 1.0f / len(s_draw->cam_stack.last().m.y);
-	float scale = s_draw->antialias.last();
+	float inv_cam_scale = 1.0f / len(cam_stack.last().m.y);
+	float scale = antialias.last();
 	// The canvas is now rasterized at `pixel_scale` device pixels per logical unit,
 	// so divide by it here to keep the AA band one device pixel wide (instead of
 	// one logical unit wide, which would now span multiple device pixels).
@@ -1023,11 +1254,14 @@ void CF_Draw::set_aaf()
 
 void cf_make_draw()
 {
-	s_draw = CF_NEW(CF_Draw);
+	CF_ALLOC_TAG_SCOPE("draw");
+	s_draw_app = CF_NEW(CF_Draw);
 	s_draw->path_image_id_gen = CF_PATH_ID_RANGE_LO;
 	s_draw->projection = ortho_2d(0, 0, (float)app->w, (float)app->h);
 	s_draw->reset_cam();
-	s_draw->uniform_arena = cf_make_arena(32, CF_MB);
+	// Per-frame uniform payloads. One contiguous reservation, so a frame that pushes unusually many
+	// (or unusually large) uniforms just commits more pages instead of hitting a block size limit.
+	s_draw->uniform_arena = cf_make_virtual_arena(32, (size_t)256 * CF_MB);
 
 	// Shaders.
 	s_draw->shaders.add(app->draw_shader);
@@ -1107,8 +1341,13 @@ void cf_make_draw()
 	s_draw->add_cmd();
 }
 
+static void s_free_draw_recorder(CF_DrawRecorderData* rec);
+
 void cf_destroy_draw()
 {
+	for (int i = 0; i < s_draw->recorders.count(); ++i) {
+		s_free_draw_recorder(s_draw->recorders[i]);
+	}
 	cf_destroy_draw3d();
 	if (s_draw->blit_init) {
 		cf_destroy_mesh(s_draw->blit_mesh);
@@ -1129,8 +1368,44 @@ void cf_destroy_draw()
 	cf_destroy_texture(s_draw->white_texture);
 	atlas_cache_term(&s_draw->atlas_cache);
 	cf_destroy_material(s_draw->material);
+	cf_destroy_arena(&s_draw->uniform_arena);
 	s_draw->~CF_Draw();
-	CF_FREE(s_draw);
+	CF_FREE(s_draw_app);
+	s_draw_app = NULL;
+}
+
+void cf_draw_reset_state(CF_Draw* draw)
+{
+	draw->alpha_discards.set_count(1);
+	draw->colors.set_count(1);
+	draw->antialias.set_count(1);
+	draw->render_states.set_count(1);
+	draw->scissors.set_count(1);
+	draw->viewports.set_count(1);
+	draw->layers.set_count(1);
+	draw->reset_cam();
+	draw->font_sizes.set_count(1);
+	draw->fonts.set_count(1);
+	draw->blurs.set_count(1);
+	draw->text_wrap_widths.set_count(1);
+	draw->vertical.set_count(1);
+	draw->text_ids.set_count(1);
+	draw->user_params.set_count(1);
+	draw->shaders.set_count(1);
+	draw->sprite_edges.set_count(1);
+	draw->blends.set_count(1);
+	draw->dashes.set_count(1);
+	draw->outlines.set_count(1);
+	draw->outline_widths.set_count(1);
+	draw->glows.set_count(1);
+	draw->glow_radii.set_count(1);
+	draw->filter_modes.set_count(1);
+	draw->tri_colors0.set_count(1);
+	draw->tri_colors1.set_count(1);
+	draw->tri_colors2.set_count(1);
+	draw->tri_attributes0.set_count(1);
+	draw->tri_attributes1.set_count(1);
+	draw->tri_attributes2.set_count(1);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1161,7 +1436,7 @@ void cf_draw_sprite(const CF_Sprite* sprite)
 			s.image_id = sprite->_image_id;
 		}
 	} else if (sprite->easy_sprite_id >= CF_PREMADE_ID_RANGE_LO && sprite->easy_sprite_id <= CF_PREMADE_ID_RANGE_HI) {
-		CF_AtlasSubImage sub_image = s_draw->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
+		CF_AtlasSubImage sub_image = s_draw_app->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
 		s.minx = sub_image.minx;
 		s.maxx = sub_image.maxx;
 		s.miny = sub_image.miny;
@@ -1278,7 +1553,7 @@ void cf_draw_sprite_9_slice(const CF_Sprite* sprite)
 		&& sprite->easy_sprite_id <= CF_PREMADE_ID_RANGE_HI;
 	CF_AtlasSubImage premade_sub = { 0 };
 	if (is_premade) {
-		premade_sub = s_draw->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
+		premade_sub = s_draw_app->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
 	}
 
 	// Center patch edges in Aseprite pixel space (origin top-left of sprite, Y down):
@@ -1494,7 +1769,7 @@ void cf_draw_sprite_9_slice_tiled(const CF_Sprite* sprite)
 		&& sprite->easy_sprite_id <= CF_PREMADE_ID_RANGE_HI;
 	CF_AtlasSubImage premade_sub = { 0 };
 	if (is_premade) {
-		premade_sub = s_draw->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
+		premade_sub = s_draw_app->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
 	}
 
 	// Center patch edges in Aseprite pixel space (origin top-left of sprite, Y down):
@@ -1925,10 +2200,11 @@ void cf_draw_circle_fill2(CF_V2 position, float radius)
 
 static void s_draw_capsule(v2 a, v2 b, float stroke, float radius, bool fill)
 {
+	CF_Draw* draw = s_draw;
 	BatchGeometry& g = s_push_shape_geom();
 	g.type = BATCH_GEOMETRY_TYPE_CAPSULE;
 
-	float cap_pad = radius + stroke + s_draw->aaf;
+	float cap_pad = radius + stroke + draw->aaf;
 	v2 cap_mn = V2(cf_min(a.x, b.x) - cap_pad, cf_min(a.y, b.y) - cap_pad);
 	v2 cap_mx = V2(cf_max(a.x, b.x) + cap_pad, cf_max(a.y, b.y) + cap_pad);
 	g.box[0] = cap_mn;
@@ -1938,14 +2214,14 @@ static void s_draw_capsule(v2 a, v2 b, float stroke, float radius, bool fill)
 	g.shape[0] = a;
 	g.shape[1] = b;
 	g.shape[2] = a;
-	g.color = premultiply(s_draw->colors.last());
+	g.color = premultiply(draw->colors.last());
 	g.alpha = 1.0f;
 	g.radius = radius;
 	g.stroke = stroke;
 	g.fill = fill;
-	g.aa = s_draw->aaf;
-	g.dash = s_draw->dashes.last();
-	g.user_params = s_draw->user_params.last();
+	g.aa = draw->aaf;
+	g.dash = draw->dashes.last();
+	g.user_params = draw->user_params.last();
 }
 
 void cf_draw_capsule(CF_Capsule capsule, float thickness)
@@ -1971,12 +2247,13 @@ void cf_draw_capsule_fill2(CF_V2 a, CF_V2 b, float radius)
 
 static void s_draw_tri(v2 a, v2 b, v2 c, float stroke, float radius, bool fill)
 {
+	CF_Draw* draw = s_draw;
 	BatchGeometry& g = s_push_shape_geom();
 
 	// A CSG group needs a distance function, so force the SDF triangle variant there.
-	if (stroke > 0 || radius > 0 || !fill || s_draw->antialias.last() || s_draw->shape_group_active) {
+	if (stroke > 0 || radius > 0 || !fill || draw->antialias.last() || draw->shape_group_active) {
 		g.type = BATCH_GEOMETRY_TYPE_TRI_SDF;
-		float tri_pad = radius + stroke + s_draw->aaf;
+		float tri_pad = radius + stroke + draw->aaf;
 	v2 tri_mn = V2(cf_min(a.x, cf_min(b.x, c.x)) - tri_pad, cf_min(a.y, cf_min(b.y, c.y)) - tri_pad);
 	v2 tri_mx = V2(cf_max(a.x, cf_max(b.x, c.x)) + tri_pad, cf_max(a.y, cf_max(b.y, c.y)) + tri_pad);
 	g.box[0] = tri_mn;
@@ -1993,28 +2270,28 @@ static void s_draw_tri(v2 a, v2 b, v2 c, float stroke, float radius, bool fill)
 		g.shape[2] = c;
 	}
 
-	g.color = premultiply(s_draw->colors.last());
+	g.color = premultiply(draw->colors.last());
 	g.alpha = 1.0f;
 	g.radius = radius;
 	g.stroke = stroke;
 	g.fill = fill;
-	g.aa = s_draw->aaf;
-	g.user_params = s_draw->user_params.last();
+	g.aa = draw->aaf;
+	g.user_params = draw->user_params.last();
 
 	// Per-vertex triangle colors.
-	g.use_tri_colors = s_draw->tri_colors0.count() > 1;
+	g.use_tri_colors = draw->tri_colors0.count() > 1;
 	if (g.use_tri_colors) {
-		g.tri_colors[0] = premultiply(s_draw->tri_colors0.last());
-		g.tri_colors[1] = premultiply(s_draw->tri_colors1.last());
-		g.tri_colors[2] = premultiply(s_draw->tri_colors2.last());
+		g.tri_colors[0] = premultiply(draw->tri_colors0.last());
+		g.tri_colors[1] = premultiply(draw->tri_colors1.last());
+		g.tri_colors[2] = premultiply(draw->tri_colors2.last());
 	}
 
 	// Per-vertex triangle attributes.
-	g.use_tri_attributes = s_draw->tri_attributes0.count() > 1;
+	g.use_tri_attributes = draw->tri_attributes0.count() > 1;
 	if (g.use_tri_attributes) {
-		g.tri_attributes[0] = s_draw->tri_attributes0.last();
-		g.tri_attributes[1] = s_draw->tri_attributes1.last();
-		g.tri_attributes[2] = s_draw->tri_attributes2.last();
+		g.tri_attributes[0] = draw->tri_attributes0.last();
+		g.tri_attributes[1] = draw->tri_attributes1.last();
+		g.tri_attributes[2] = draw->tri_attributes2.last();
 	}
 
 }
@@ -2036,6 +2313,7 @@ void cf_draw_line(CF_V2 p0, CF_V2 p1, float thickness)
 
 void cf_draw_polyline(const CF_V2* pts, int count, float thickness, bool loop)
 {
+	CF_Draw* draw = s_draw;
 	float radius = thickness * 0.5f;
 
 	if (count <= 0) {
@@ -2055,10 +2333,10 @@ void cf_draw_polyline(const CF_V2* pts, int count, float thickness, bool loop)
 	// where neighboring bodies agree on distance. No joint triangulation, no case
 	// analysis -- the coverage quad is a loose capsule OBB and the planes do the exact
 	// work per pixel.
-	CF_Color color = premultiply(s_draw->colors.last());
-	CF_Color user_params = s_draw->user_params.last();
-	float aaf = s_draw->aaf;
-	CF_DrawDash dash = s_draw->dashes.last();
+	CF_Color color = premultiply(draw->colors.last());
+	CF_Color user_params = draw->user_params.last();
+	float aaf = draw->aaf;
+	CF_DrawDash dash = draw->dashes.last();
 	float dash_arclength = 0; // Accumulated so the pattern flows unbroken through joints.
 
 	// Bisector of two segment directions; perpendicular split for exact 180 folds.
@@ -2125,7 +2403,7 @@ void cf_draw_polyline(const CF_V2* pts, int count, float thickness, bool loop)
 
 		g.shape[0] = a;
 		g.shape[1] = b;
-		float body_pad = radius + s_draw->aaf;
+		float body_pad = radius + draw->aaf;
 		v2 body_mn = V2(cf_min(a.x, b.x) - body_pad, cf_min(a.y, b.y) - body_pad);
 		v2 body_mx = V2(cf_max(a.x, b.x) + body_pad, cf_max(a.y, b.y) + body_pad);
 		g.box[0] = body_mn;
@@ -2200,6 +2478,7 @@ bool is_ear(const v2* polygon, int i, int n)
 
 // Converts a polygon into renderable triangles.
 // ...Uses a simple ear-clipping routine.
+// ...Returns frame memory (cf_frame_alloc), valid until the next cf_app_update.
 // ...Will produce incorrect results for: complex polygons (self-intersecting), duplicate/repeat verts,
 //    non-CCW ordering of inputs.
 v2* triangulate(v2* polygon, int n, int* out_count)
@@ -2211,7 +2490,7 @@ v2* triangulate(v2* polygon, int n, int* out_count)
 	}
 
 	int max_triangles = n - 2;
-	v2* triangles = (v2*)cf_alloc(max_triangles * 3 * sizeof(v2));
+	v2* triangles = (v2*)cf_frame_alloc(max_triangles * 3 * sizeof(v2));
 	int count = 0;
 
 	int remaining = n;
@@ -2238,7 +2517,6 @@ v2* triangulate(v2* polygon, int n, int* out_count)
 
 		if (!ear_found) {
 			// If we can't find an ear, the polygon might be invalid (e.g. self-intersecting).
-			cf_free(triangles);
 			*out_count = 0;
 			return NULL;
 		}
@@ -2250,7 +2528,7 @@ v2* triangulate(v2* polygon, int n, int* out_count)
 
 void cf_draw_polygon_fill_simple(const CF_V2* points, int count)
 {
-	v2* points_copy = (v2*)cf_alloc(sizeof(v2) * count);
+	v2* points_copy = (v2*)cf_frame_alloc(sizeof(v2) * count);
 	CF_MEMCPY(points_copy, points, sizeof(v2) * count);
 
 	int n = 0;
@@ -2261,37 +2539,30 @@ void cf_draw_polygon_fill_simple(const CF_V2* points, int count)
 		v2 c = triangles[i+2];
 		s_draw_tri(a, b, c, 0, 0, true);
 	}
-
-	cf_free(triangles);
-	cf_free(points_copy);
 }
 
 void cf_draw_bezier_line(CF_V2 a, CF_V2 c0, CF_V2 b, int iters, float thickness)
 {
-	s_draw->temp.ensure_capacity(iters);
-	s_draw->temp.clear();
+	CF_V2* pts = (CF_V2*)cf_frame_alloc(sizeof(CF_V2) * (iters + 1));
 	float step = 1.0f / (float)iters;
-	s_draw->temp.add(a);
+	pts[0] = a;
 	for (int i = 1; i < iters; ++i) {
-		CF_V2 p = cf_bezier(a, c0, b, i * step);
-		s_draw->temp.add(p);
+		pts[i] = cf_bezier(a, c0, b, i * step);
 	}
-	s_draw->temp.add(b);
-	cf_draw_polyline(s_draw->temp.data(), s_draw->temp.count(), thickness, false);
+	pts[iters] = b;
+	cf_draw_polyline(pts, iters + 1, thickness, false);
 }
 
 void cf_draw_bezier_line2(CF_V2 a, CF_V2 c0, CF_V2 c1, CF_V2 b, int iters, float thickness)
 {
-	s_draw->temp.ensure_capacity(iters);
-	s_draw->temp.clear();
+	CF_V2* pts = (CF_V2*)cf_frame_alloc(sizeof(CF_V2) * (iters + 1));
 	float step = 1.0f / (float)iters;
-	s_draw->temp.add(a);
+	pts[0] = a;
 	for (int i = 1; i < iters; ++i) {
-		CF_V2 p = cf_bezier2(a, c0, c1, b, i * step);
-		s_draw->temp.add(p);
+		pts[i] = cf_bezier2(a, c0, c1, b, i * step);
 	}
-	s_draw->temp.add(b);
-	cf_draw_polyline(s_draw->temp.data(), s_draw->temp.count(), thickness, false);
+	pts[iters] = b;
+	cf_draw_polyline(pts, iters + 1, thickness, false);
 }
 
 void cf_draw_arrow(CF_V2 a, CF_V2 b, float thickness, float arrow_width)
@@ -2368,7 +2639,7 @@ CF_CustomShape cf_make_custom_shape(const char* sdf_src)
 
 static void s_draw_custom_shape(CF_CustomShape shape, CF_Aabb bounds, float stroke, bool fill, const float* params, int param_count)
 {
-	if (!shape.id || (int)shape.id > s_draw->custom_shape_srcs.count()) return;
+	if (!shape.id || (int)shape.id > s_draw_app->custom_shape_srcs.count()) return;
 	BatchGeometry& g = s_push_shape_geom();
 	g.type = BATCH_GEOMETRY_TYPE_CUSTOM;
 	float pad = stroke + s_draw->aaf;
@@ -2485,6 +2756,7 @@ void cf_draw_shape_group_end_stroked(float thickness)
 
 CF_Result cf_make_font_from_memory(void* data, int size, const char* font_name)
 {
+	CF_ALLOC_TAG_SCOPE("fonts");
 	font_name = sintern(font_name);
 	CF_Font* font = (CF_Font*)CF_NEW(CF_Font);
 	font->file_data = (uint8_t*)data;
@@ -3028,7 +3300,7 @@ void cf_destroy_path(CF_DrawPath path)
 
 static void s_draw_path(CF_DrawPath path, float stroke, bool fill)
 {
-	CF_DrawPathData* pd = s_draw->draw_paths.try_get(path.id);
+	CF_DrawPathData* pd = s_draw_app->draw_paths.try_get(path.id);
 	if (!pd) return;
 	float aaf = s_draw->aaf;
 
@@ -3201,7 +3473,7 @@ void cf_draw_list_end()
 
 void cf_draw_list(CF_DrawList list)
 {
-	CF_DrawListData** data_ptr = s_draw->draw_lists.try_get(list.id);
+	CF_DrawListData** data_ptr = s_draw_app->draw_lists.try_get(list.id);
 	if (!data_ptr) return;
 	CF_DrawListData* data = *data_ptr;
 	// Replays borrow the list's geometry (no deep copy): the collate step flattens
@@ -3235,6 +3507,87 @@ void cf_draw_list(CF_DrawList list)
 	s_draw->add_cmd();
 }
 
+//--------------------------------------------------------------------------------------------------
+// Draw recorders (cf_make_draw_recorder): let other threads record 2d draw calls. Each recorder
+// is a CF_Draw of its own, and begin/end point the calling thread's s_draw at it, so every
+// cf_draw_* call records exactly as it does on the main thread -- just into the recorder's
+// stacks and commands. Nothing is shared while recording, so there are no locks; the main
+// thread moves the commands over in cf_render_layers_to.
+
+static CF_DrawRecorderData* s_get_draw_recorder(CF_DrawRecorder recorder)
+{
+	return (CF_DrawRecorderData*)(uintptr_t)recorder.id;
+}
+
+CF_DrawRecorder cf_make_draw_recorder()
+{
+	CF_ALLOC_TAG_SCOPE("draw");
+	CF_DrawRecorderData* rec = CF_NEW(CF_DrawRecorderData);
+	CF_Draw* draw = &rec->draw;
+	draw->recorder = rec;
+	draw->uniform_arena = cf_make_virtual_arena(32, (size_t)64 * CF_MB);
+	draw->shaders.add(s_draw_app->shaders[0]);
+	draw->render_states.add(s_draw_app->render_states[0]);
+	draw->projection = s_draw_app->projection;
+	draw->reset_cam();
+	s_draw_app->recorders.add(rec);
+	CF_DrawRecorder result = { (uint64_t)(uintptr_t)rec };
+	return result;
+}
+
+static void s_free_draw_recorder(CF_DrawRecorderData* rec)
+{
+	for (int i = 0; i < rec->draw.cmds.count(); ++i) {
+		cf_draw3d_free_cmd(&rec->draw.cmds[i]);
+	}
+	cf_destroy_arena(&rec->draw.uniform_arena);
+	rec->~CF_DrawRecorderData();
+	CF_FREE(rec);
+}
+
+void cf_destroy_draw_recorder(CF_DrawRecorder recorder)
+{
+	CF_DrawRecorderData* rec = s_get_draw_recorder(recorder);
+	if (!rec) return;
+	CF_ASSERT(!rec->recording);
+	// Keep the rest in creation order, it's their merge order.
+	Array<CF_DrawRecorderData*>& recorders = s_draw_app->recorders;
+	int index = 0;
+	while (index < recorders.count() && recorders[index] != rec) ++index;
+	CF_ASSERT(index < recorders.count());
+	for (int i = index + 1; i < recorders.count(); ++i) {
+		recorders[i - 1] = recorders[i];
+	}
+	recorders.pop();
+	s_free_draw_recorder(rec);
+}
+
+void cf_draw_recorder_begin(CF_DrawRecorder recorder)
+{
+	CF_DrawRecorderData* rec = s_get_draw_recorder(recorder);
+	CF_ASSERT(rec && !rec->recording);
+	if (!rec) return;
+	rec->recording = true;
+	rec->prev = s_draw_recorder;
+	s_draw_recorder = &rec->draw;
+	s_draw_recording.fetch_add(1, std::memory_order_relaxed);
+	// Start from default state like a fresh frame, since nothing pushed on another thread
+	// carries over. Earlier recordings this frame stay queued.
+	cf_draw_reset_state(s_draw);
+	s_draw->add_cmd();
+}
+
+void cf_draw_recorder_end()
+{
+	CF_DrawRecorderData* rec = s_draw_recorder ? s_draw_recorder->recorder : NULL;
+	CF_ASSERT(rec);
+	if (!rec) return;
+	s_draw_recorder = rec->prev;
+	s_draw_recording.fetch_sub(1, std::memory_order_relaxed);
+	rec->prev = NULL;
+	rec->recording = false;
+}
+
 float cf_font_get_kern(CF_Font* font, float font_size, int code0, int code1)
 {
 	// Prefer GPOS -- stb's codepoint API converts to glyph indices internally and
@@ -3435,7 +3788,8 @@ static v2 s_draw_text(const char* text, CF_V2 position, int text_length, bool re
 // lines connect through each junction instead of stair-stepping.
 static void s_draw_strike_lines(Cute::Array<CF_Strike>& lines)
 {
-	Array<CF_V2> pts;
+	// A run holds at most every segment's start plus the last segment's end.
+	CF_V2* pts = (CF_V2*)cf_frame_alloc(sizeof(CF_V2) * (lines.count() + 1));
 	int i = 0;
 	while (i < lines.count()) {
 		const CF_Strike& run = lines[i];
@@ -3448,12 +3802,12 @@ static void s_draw_strike_lines(Cute::Array<CF_Strike>& lines)
 			if (fabsf(next.p0.x - lines[j].p1.x) > cf_max(2.0f, run.thickness)) break;
 			++j;
 		}
-		pts.clear();
-		pts.add(run.p0);
-		for (int k = i + 1; k <= j; ++k) pts.add(lines[k].p0);
-		pts.add(lines[j].p1);
+		int count = 0;
+		pts[count++] = run.p0;
+		for (int k = i + 1; k <= j; ++k) pts[count++] = lines[k].p0;
+		pts[count++] = lines[j].p1;
 		cf_draw_push_color(run.color);
-		cf_draw_polyline(pts.data(), pts.count(), run.thickness, false);
+		cf_draw_polyline(pts, count, run.thickness, false);
 		cf_draw_pop_color();
 		i = j + 1;
 	}
@@ -4031,7 +4385,7 @@ static v2 s_draw_text(const char* text, CF_V2 position, int text_length, bool re
 
 	// Text id can be custom or based on text's content
 	uint64_t text_id = s_draw->text_ids.last();
-	uint64_t text_hash = fnv1a(text, (int)CF_STRLEN(text) + 1);
+	uint64_t text_hash = cf_hash_bytes(text, CF_STRLEN(text) + 1);
 	if (text_id == 0) { text_id = text_hash; }
 
 	// Effect state is key'd by text id
@@ -5150,7 +5504,7 @@ void static s_blit(CF_Command* cmd, CF_Canvas src, CF_Canvas dst, bool clear_dst
 	cf_draw_elements();
 }
 
-static void s_draw_report_range(const BatchGeometry* geoms, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h);
+static void s_draw_report_range(const uint8_t* records, const CF_PendingUV* uvs, int start, int end, uint64_t texture_id, int texture_w, int texture_h, int blend);
 
 // Runs after every atlas_cache_flush (which filled the per-flush uv table via the
 // callbacks): render the collated stream in paint order, splitting into a new draw
@@ -5158,44 +5512,129 @@ static void s_draw_report_range(const BatchGeometry* geoms, const CF_PendingUV*
 // whichever run they fall in.
 static void s_flush_pending_geoms()
 {
-	const BatchGeometry* geoms = s_draw->pending_geoms.data();
+	// Splitting only looks at record headers; the report paths decode the records.
+	const uint8_t* stream = (const uint8_t*)s_draw->pending_stream.data();
 	const CF_PendingUV* uvs = s_draw->pending_uvs.data();
-	int n = s_draw->pending_geoms.count();
+	int n = s_draw->pending_uvs.count();
 	int start = 0;
+	const uint8_t* start_p = stream;
+	const uint8_t* p = stream;
 	uint64_t run_tex = 0;
 	int run_w = 1, run_h = 1;
-	int run_blend = n ? geoms[0].blend : 0;
+	int run_blend = n ? s_geom_header(stream)->blend : 0;
 	for (int i = 0; i < n; ++i) {
-		const BatchGeometry& g = geoms[i];
-		if (g.csg_operand) continue; // Rides with its CSG head.
+		const CF_GeomHeader* h = s_geom_header(p);
+		const uint8_t* at = p;
+		p += h->size;
+		if (h->flags & GEOM_FLAG_CSG_OPERAND) continue; // Rides with its CSG head.
 		// Blend mode changes split the stream: each run renders with its mode's exact
 		// fixed-function canvas state, and run sequencing preserves paint order.
-		if (g.blend != run_blend) {
-			s_draw_report_range(geoms, uvs, start, i, run_tex, run_w, run_h, run_blend);
+		if (h->blend != run_blend) {
+			s_draw_report_range(start_p, uvs, start, i, run_tex, run_w, run_h, run_blend);
 			start = i;
+			start_p = at;
 			run_tex = 0;
 			run_w = run_h = 1;
-			run_blend = g.blend;
+			run_blend = h->blend;
 		}
-		if (!(g.is_sprite || g.is_text)) continue;
+		if (!(h->flags & (GEOM_FLAG_SPRITE | GEOM_FLAG_TEXT))) continue;
 		if (uvs[i].texture_id == 0) continue;
 		if (run_tex == 0) {
 			run_tex = uvs[i].texture_id;
 			run_w = uvs[i].tex_w;
 			run_h = uvs[i].tex_h;
 		} else if (uvs[i].texture_id != run_tex) {
-			s_draw_report_range(geoms, uvs, start, i, run_tex, run_w, run_h, run_blend);
+			s_draw_report_range(start_p, uvs, start, i, run_tex, run_w, run_h, run_blend);
 			start = i;
+			start_p = at;
 			run_tex = uvs[i].texture_id;
 			run_w = uvs[i].tex_w;
 			run_h = uvs[i].tex_h;
 		}
 	}
-	s_draw_report_range(geoms, uvs, start, n, run_tex, run_w, run_h, run_blend);
-	s_draw->pending_geoms.clear();
+	s_draw_report_range(start_p, uvs, start, n, run_tex, run_w, run_h, run_blend);
+	s_draw->pending_stream.clear();
+	s_draw->pending_mvps.clear();
 	s_draw->pending_uvs.clear();
 }
 
+// Pixel rect (top-left origin) a command can draw into -- its canvas clipped to the viewport
+// and scissor -- plus the NDC -> pixel mapping its viewport implies.
+struct CF_CullView
+{
+	float ox, oy, sx, sy; // pixel = (ox + (ndc.x + 1) * sx, oy + (1 - ndc.y) * sy)
+	float x0, y0, x1, y1;
+};
+
+static bool s_cull_view(const CF_Command* cmd, CF_CullView* view)
+{
+	int canvas_w, canvas_h;
+	cf_current_canvas_size(&canvas_w, &canvas_h);
+	if (canvas_w <= 0 || canvas_h <= 0) return false;
+	view->x0 = 0;
+	view->y0 = 0;
+	view->x1 = (float)canvas_w;
+	view->y1 = (float)canvas_h;
+	CF_Rect viewport = cmd->viewport;
+	if (viewport.w >= 0 && viewport.h >= 0) {
+		view->ox = (float)viewport.x;
+		view->oy = (float)viewport.y;
+		view->sx = viewport.w * 0.5f;
+		view->sy = viewport.h * 0.5f;
+		view->x0 = cf_max(view->x0, (float)viewport.x);
+		view->y0 = cf_max(view->y0, (float)viewport.y);
+		view->x1 = cf_min(view->x1, (float)(viewport.x + viewport.w));
+		view->y1 = cf_min(view->y1, (float)(viewport.y + viewport.h));
+	} else {
+		view->ox = 0;
+		view->oy = 0;
+		view->sx = canvas_w * 0.5f;
+		view->sy = canvas_h * 0.5f;
+	}
+	CF_Rect scissor = cmd->scissor;
+	if (scissor.w >= 0 && scissor.h >= 0) {
+		view->x0 = cf_max(view->x0, (float)scissor.x);
+		view->y0 = cf_max(view->y0, (float)scissor.y);
+		view->x1 = cf_min(view->x1, (float)(scissor.x + scissor.w));
+		view->y1 = cf_min(view->y1, (float)(scissor.y + scissor.h));
+	}
+	return true;
+}
+
+// True when a geometry's coverage lies entirely outside the view. Uses the same coverage the
+// command paths rasterize (sprite/tri corners, otherwise the box), padded for effects like the
+// tile walk does, plus a pixel of slack for antialiasing.
+static bool s_geom_offscreen(const BatchGeometry& g, const CF_CullView& view)
+{
+	const CF_V2* src = g.box;
+	int nverts = 4;
+	if (g.type == BATCH_GEOMETRY_TYPE_SPRITE) {
+		src = g.shape;
+	} else if (g.type == BATCH_GEOMETRY_TYPE_TRI) {
+		src = g.shape;
+		nverts = 3;
+	}
+	float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+	for (int j = 0; j < nverts; ++j) {
+		v2 ndc;
+		CF_MUL_M32_V2(ndc, g.mvp, src[j]);
+		float px = view.ox + (ndc.x + 1.0f) * view.sx;
+		float py = view.oy + (1.0f - ndc.y) * view.sy;
+		min_x = cf_min(min_x, px);
+		min_y = cf_min(min_y, py);
+		max_x = cf_max(max_x, px);
+		max_y = cf_max(max_y, py);
+	}
+	float pad = 1.0f;
+	float fx_extent = cf_max(g.fx.outline_width, g.fx.glow_radius);
+	if (fx_extent > 0) {
+		float sx = cf_len(cf_v2(g.mvp.m.x.x, g.mvp.m.x.y)) * view.sx;
+		float sy = cf_len(cf_v2(g.mvp.m.y.x, g.mvp.m.y.y)) * view.sy;
+		pad += fx_extent * cf_max(sx, sy);
+	}
+	return max_x + pad < view.x0 || max_y + pad < view.y0 || min_x - pad > view.x1 || min_y - pad > view.y1;
+}
+
 static void s_process_command(CF_Canvas canvas, CF_Command* cmd, CF_Command* next, bool& clear)
 {
 	if (cmd->processed) return;
@@ -5247,31 +5686,59 @@ static void s_process_command(CF_Canvas canvas, CF_Command* cmd, CF_Command* nex
 		return;
 	}
 
-	// Collate the drawable items: all geometry appends to the flush-ordered stream;
+	// Collate the drawable items: all geometry encodes onto the flush-ordered stream;
 	// sprites/text additionally push a small atlas entry to the atlas_cache whose seq
-	// is rebased to index the stream (commands were layer-sorted, so the rebase
+	// is remapped to index the stream (commands were layer-sorted, so the remap
 	// happens here, not at record time). Draw list replays borrow their list's geometry
 	// (geoms_ref) and compose the replay transform during this one copy.
+	//
+	// Geometry entirely outside the canvas, viewport, and scissor is culled here, before it
+	// reaches the stream: culled sprites and text never touch the atlas cache, and nothing of
+	// them is packed or uploaded. A culled CSG head takes its operands with it.
 	const Cute::Array<BatchGeometry>* src_geoms = cmd->geoms_ref ? cmd->geoms_ref : &cmd->geoms;
 	if (src_geoms->count()) {
-		s_draw->need_flush = true;
-		int base = s_draw->pending_geoms.count();
+		CF_CullView view;
+		bool cull = s_cull_view(cmd, &view);
+		Array<int>& remap = s_draw->cull_remap;
+		remap.set_count(src_geoms->count());
+		int base = s_draw->pending_uvs.count();
+		int skip_operands = 0;
 		for (int i = 0; i < src_geoms->count(); ++i) {
-			s_draw->pending_geoms.add((*src_geoms)[i]);
+			const BatchGeometry* g = &(*src_geoms)[i];
+			BatchGeometry replayed;
 			if (cmd->geoms_ref) {
-				BatchGeometry& g = s_draw->pending_geoms.last();
-				CF_MUL_M32_M32(g.mvp, cmd->replay_mvp, g.mvp);
-				float extra = g.aa * (cmd->replay_aa_scale - 1.0f);
-				g.aa *= cmd->replay_aa_scale;
-				if (extra > 0) s_replay_inflate_quad(&g, extra);
+				replayed = *g;
+				CF_MUL_M32_M32(replayed.mvp, cmd->replay_mvp, replayed.mvp);
+				float extra = replayed.aa * (cmd->replay_aa_scale - 1.0f);
+				replayed.aa *= cmd->replay_aa_scale;
+				if (extra > 0) s_replay_inflate_quad(&replayed, extra);
+				g = &replayed;
 			}
+			if (skip_operands) {
+				--skip_operands;
+				remap[i] = -1;
+				continue;
+			}
+			if (cull && !g->csg_operand && s_geom_offscreen(*g, view)) {
+				if (g->type == BATCH_GEOMETRY_TYPE_CSG) skip_operands = g->n;
+				remap[i] = -1;
+				s_draw->culled_count++;
+				continue;
+			}
+			remap[i] = s_draw->pending_uvs.count();
+			s_encode_geom(*g);
 			CF_PendingUV uv = { 0 };
 			s_draw->pending_uvs.add(uv);
 		}
-		for (int i = 0; i < cmd->items.count(); ++i) {
-			atlas_cache_entry_t sp = cmd->items[i];
-			sp.udata += (ATLAS_CACHE_U64)base;
-			atlas_cache_push(&s_draw->atlas_cache, sp);
+		if (s_draw->pending_uvs.count() > base) {
+			s_draw->need_flush = true;
+			for (int i = 0; i < cmd->items.count(); ++i) {
+				atlas_cache_entry_t sp = cmd->items[i];
+				int index = remap[(int)sp.udata];
+				if (index < 0) continue;
+				sp.udata = (ATLAS_CACHE_U64)index;
+				atlas_cache_push(&s_draw->atlas_cache, sp);
+			}
 		}
 	}
 
@@ -5323,7 +5790,11 @@ void cf_draw_on_app_canvas_resized(int w, int h)
 	// startup and never again, so any resize (cf_app_set_size or a user dragging a resizable
 	// window) silently rescaled every world-space 2d draw. Refresh it with the canvas; a
 	// custom cf_draw_projection is per-frame state and simply overrides this as usual.
-	if (s_draw) s_draw->projection = ortho_2d(0, 0, (float)w, (float)h);
+	if (!s_draw_app) return;
+	s_draw_app->projection = ortho_2d(0, 0, (float)w, (float)h);
+	for (int i = 0; i < s_draw_app->recorders.count(); ++i) {
+		s_draw_app->recorders[i]->draw.projection = s_draw_app->projection;
+	}
 }
 
 void cf_atlas_defrag_once()
@@ -5333,8 +5804,39 @@ void cf_atlas_defrag_once()
 	atlas_cache_defrag(&s_draw->atlas_cache);
 }
 
+// Moves every recorder's commands onto the end of the app's, recorder by recorder in creation
+// order, renumbering their ids as it goes. The layer sort then keeps them after the main thread's
+// commands within each layer, in recorder order, each in its own submission order.
+static void s_merge_draw_recorders()
+{
+	for (int i = 0; i < s_draw->recorders.count(); ++i) {
+		CF_DrawRecorderData* rec = s_draw->recorders[i];
+		CF_ASSERT(!rec->recording); // Wait for recording threads before rendering.
+		Array<CF_Command>& cmds = rec->draw.cmds;
+		for (int j = 0; j < cmds.count(); ++j) {
+			CF_Command& cmd = cmds[j];
+			if (cf_cmd_is_empty(cmd)) continue;
+			if (cmd.u.data) {
+				// The recorder's arena resets below; the frame's arena holds uniforms until render.
+				void* data = cf_arena_alloc(&s_draw->uniform_arena, cmd.u.size);
+				CF_MEMCPY(data, cmd.u.data, cmd.u.size);
+				cmd.u.data = data;
+			}
+			cmd.id = s_draw->draw_item_order++;
+			s_draw->cmds.add(cf_move(cmd));
+		}
+		cmds.clear();
+		rec->draw.draw_item_order = 0;
+		cf_arena_reset(&rec->draw.uniform_arena);
+	}
+}
+
 void cf_render_layers_to(CF_Canvas canvas, int layer_lo, int layer_hi, bool clear)
 {
+	CF_ALLOC_TAG_SCOPE("draw");
+	CF_ASSERT(s_draw == s_draw_app); // Can't render while this thread is recording.
+	s_merge_draw_recorders();
+
 	// Stage 3d instance uploads while no render pass is live -- must run before the canvas
 	// (and its pass) is applied. See cf_draw3d_prepare_uploads.
 	cf_draw3d_prepare_uploads(layer_lo, layer_hi);
@@ -5345,23 +5847,32 @@ void cf_render_layers_to(CF_Canvas canvas, int layer_lo, int layer_hi, bool clea
 	// Uniform-only commands (no geometry, not canvas blits) inherit the layer of their
 	// next draw command. This keeps set_texture/set_uniform grouped with the draw_sprite
 	// calls that depend on them through the layer sort.
+	int count = s_draw->cmds.count();
+	s_draw->cmd_keys.set_count(count);
+	s_draw->cmd_keys_tmp.set_count(count);
 	{
 		int next_draw_layer = 0;
-		for (int i = s_draw->cmds.count() - 1; i >= 0; i--) {
+		for (int i = count - 1; i >= 0; i--) {
 			CF_Command& cmd = s_draw->cmds[i];
 			if (cmd.geoms.count() || cmd.geoms_ref || cmd.is_canvas || cmd.mesh3d) {
 				next_draw_layer = cmd.layer;
 			} else {
 				cmd.layer = next_draw_layer;
 			}
+			s_draw->cmd_keys[i].key = cf_cmd_sort_key(cmd.layer, cmd.id);
+			s_draw->cmd_keys[i].index = i;
 		}
 	}
 
-	// Sort the commands by layer first, then by age (to maintain relative ordering).
-	std::stable_sort(s_draw->cmds.begin(), s_draw->cmds.end(), [](const CF_Command& a, const CF_Command& b) {
-		if (a.layer == b.layer) return a.id < b.id;
-		else return a.layer < b.layer;
-	});
+	// Sort by layer first, then by age (to maintain relative ordering). Only the compact
+	// keys move; the commands stay put and are visited through cmd_order.
+	CF_CmdKey* sorted = cf_sort_cmd_keys(s_draw->cmd_keys.data(), s_draw->cmd_keys_tmp.data(), count);
+	Array<int>& order = s_draw->cmd_order;
+	order.set_count(count);
+	for (int i = 0; i < count; ++i) {
+		order[i] = sorted[i].index;
+	}
+	CF_Command* cmds = s_draw->cmds.data();
 
 	// Within each maximal run of consecutive 3d commands in a layer, move depth-writing
 	// commands (opaque solids) ahead of non-writing ones (translucent strokes) -- the classic
@@ -5373,32 +5884,30 @@ void cf_render_layers_to(CF_Canvas canvas, int layer_lo, int layer_hi, bool clea
 		// submission leaves one on the stream (see s_submit in cute_draw3d.cpp), so requiring
 		// strictly consecutive mesh3d commands would cap every run at length 1 and turn the
 		// partition into a no-op. Empties draw nothing, so the partition may place them freely.
-		int n = s_draw->cmds.count();
 		int i = 0;
-		while (i < n) {
-			if (!s_draw->cmds[i].mesh3d) { ++i; continue; }
+		while (i < count) {
+			if (!cmds[order[i]].mesh3d) { ++i; continue; }
 			int j = i + 1;
-			while (j < n && (s_draw->cmds[j].mesh3d || cf_cmd_is_empty(s_draw->cmds[j])) && s_draw->cmds[j].layer == s_draw->cmds[i].layer) ++j;
-			auto mid = std::stable_partition(s_draw->cmds.begin() + i, s_draw->cmds.begin() + j, [](const CF_Command& c) {
-				return c.mesh3d && c.render_state.depth_write_enabled;
+			while (j < count && (cmds[order[j]].mesh3d || cf_cmd_is_empty(cmds[order[j]])) && cmds[order[j]].layer == cmds[order[i]].layer) ++j;
+			auto mid = std::stable_partition(order.begin() + i, order.begin() + j, [cmds](int c) {
+				return cmds[c].mesh3d && cmds[c].render_state.depth_write_enabled;
 			});
 			// The non-writing (translucent) tail sorts back-to-front on the submission
 			// anchors captured in depth3d, so overlapping translucents composite correctly
 			// regardless of submission order. Writers keep submission order; the depth
 			// test owns them. Empty spacers carry depth 0 and sort harmlessly.
-			std::stable_sort(mid, s_draw->cmds.begin() + j, [](const CF_Command& a, const CF_Command& b) {
-				return a.depth3d > b.depth3d;
+			std::stable_sort(mid, order.begin() + j, [cmds](int a, int b) {
+				return cmds[a].depth3d > cmds[b].depth3d;
 			});
 			i = j;
 		}
 	}
 
 	// Process each rendering command.
-	int count = s_draw->cmds.count();
 	for (int i = 0; i < count; ++i) {
-		s_draw->cmd_index = i;
-		CF_Command* cmd = &s_draw->cmds[i];
-		CF_Command* next = i + 1 == count ? NULL : s_draw->cmds + (i + 1);
+		s_draw->cmd_index = order[i];
+		CF_Command* cmd = &s_draw->cmds[order[i]];
+		CF_Command* next = i + 1 == count ? NULL : &s_draw->cmds[order[i + 1]];
 		if (cmd->layer >= layer_lo && cmd->layer <= layer_hi) {
 			s_process_command(canvas, cmd, next, clear);
 		} else if (cmd->layer > layer_hi) {
@@ -5562,7 +6071,7 @@ CF_TemporaryImage cf_fetch_image(const CF_Sprite* sprite)
 	s_draw->delay_defrag = true;
 
 	if (sprite->easy_sprite_id >= CF_PREMADE_ID_RANGE_LO && sprite->easy_sprite_id <= CF_PREMADE_ID_RANGE_HI) {
-		CF_AtlasSubImage sub_image = s_draw->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
+		CF_AtlasSubImage sub_image = s_draw_app->premade_sub_image_id_to_sub_image.find(sprite->easy_sprite_id);
 		atlas_cache_entry_t s = atlas_cache_fetch(&s_draw->atlas_cache, sprite->easy_sprite_id, sprite->w, sprite->h);
 		CF_TemporaryImage image;
 		image.tex = { sub_image.image_id }; // @JANK - Hijacked to store texture_id and avoid an extra hashtable lookup.
@@ -259,6 +259,7 @@ static CF_Draw3d* s_draw3d;
 
 void cf_make_draw3d()
 {
+	CF_ALLOC_TAG_SCOPE("draw");
 	s_draw3d = CF_NEW(CF_Draw3d);
 	s_draw3d->projections.add(cf_m4_identity());
 	s_draw3d->views.add(cf_m4_identity());
@@ -370,7 +371,7 @@ static CF_INLINE uint64_t s_uniform_hash(const char* name, CF_UniformType type,
 	uint64_t h = cf_fnv1a(&name, (int)sizeof(name));
 	int meta[2] = { (int)type, array_length };
 	h ^= cf_fnv1a(meta, (int)sizeof(meta));
-	return h ^ cf_fnv1a(data, size);
+	return h ^ cf_hash_bytes(data, (size_t)size);
 }
 
 // The shared setter body. `name` is already interned. Each entry's content hash XORs into one
@@ -2231,13 +2232,13 @@ static uint64_t s_bake_group_hash(const CF_Command* c)
 	int meta[3] = { mc->sprite_textured ? 1 : 0, c->layer, mc->ambient_shader ? 1 : 0 };
 	h ^= cf_fnv1a(meta, (int)sizeof(meta));
 	h ^= cf_fnv1a(&c->shader.id, (int)sizeof(c->shader.id));
-	h ^= cf_fnv1a(&c->render_state, (int)sizeof(c->render_state));
+	h ^= cf_hash_bytes(&c->render_state, sizeof(c->render_state));
 	h ^= cf_fnv1a(&c->scissor, (int)sizeof(c->scissor));
 	h ^= cf_fnv1a(&c->viewport, (int)sizeof(c->viewport));
 	for (int i = 0; i < mc->uniforms.count(); ++i) {
 		const CF_Uniform3d& u = mc->uniforms[i];
 		h ^= cf_fnv1a(&u.name, (int)sizeof(u.name));
-		h ^= cf_fnv1a(u.data, u.size);
+		h ^= cf_hash_bytes(u.data, (size_t)u.size);
 	}
 	for (int i = 0; i < mc->textures.count(); ++i) {
 		h ^= cf_fnv1a(&mc->textures[i].name, (int)sizeof(mc->textures[i].name));
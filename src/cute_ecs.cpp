@@ -0,0 +1,930 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include <cute_ecs.h>
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_map.h>
+#include <cute_math.h>
+#include <cute_string.h>
+#include <cute_multithreading.h>
+
+#include <internal/cute_alloc_internal.h>
+#include <internal/cute_ecs_internal.h>
+
+using namespace Cute;
+
+// Entities are grouped into archetypes, one table per unique set of components. Each table is a
+// list of fixed size chunks, and each chunk stores its rows as structure-of-arrays: the entity
+// handles first, then one tightly packed column per component. Every chunk but the last one of an
+// archetype is always full -- removing a row swaps the very last row of the archetype into the hole.
+
+#define CF_ECS_MAX_COMPONENTS 256
+#define CF_ECS_CHUNK_SIZE     (16 * 1024)
+#define CF_ECS_COLUMN_ALIGN   16
+
+struct CF_ComponentMask
+{
+	uint64_t bits[CF_ECS_MAX_COMPONENTS / 64];
+};
+
+static CF_INLINE void s_mask_set(CF_ComponentMask* mask, int i) { mask->bits[i >> 6] |= 1ULL << (i & 63); }
+static CF_INLINE void s_mask_clear(CF_ComponentMask* mask, int i) { mask->bits[i >> 6] &= ~(1ULL << (i & 63)); }
+static CF_INLINE bool s_mask_has(const CF_ComponentMask* mask, int i) { return (mask->bits[i >> 6] >> (i & 63)) & 1; }
+
+static bool s_mask_contains(const CF_ComponentMask* a, const CF_ComponentMask* b)
+{
+	for (int i = 0; i < (int)CF_ARRAY_SIZE(a->bits); ++i) {
+		if ((a->bits[i] & b->bits[i]) != b->bits[i]) return false;
+	}
+	return true;
+}
+
+static bool s_mask_intersects(const CF_ComponentMask* a, const CF_ComponentMask* b)
+{
+	for (int i = 0; i < (int)CF_ARRAY_SIZE(a->bits); ++i) {
+		if (a->bits[i] & b->bits[i]) return true;
+	}
+	return false;
+}
+
+static bool s_mask_empty(const CF_ComponentMask* mask)
+{
+	for (int i = 0; i < (int)CF_ARRAY_SIZE(mask->bits); ++i) {
+		if (mask->bits[i]) return false;
+	}
+	return true;
+}
+
+struct CF_ComponentType
+{
+	const char* name = NULL;
+	int size = 0;
+	CF_ComponentFn* initializer = NULL;
+	void* initializer_udata = NULL;
+	CF_ComponentFn* cleanup = NULL;
+	void* cleanup_udata = NULL;
+};
+
+struct CF_Archetype;
+
+struct CF_Chunk
+{
+	CF_Archetype* archetype;
+	uint8_t* data;
+	int count;
+};
+
+struct CF_Archetype
+{
+	CF_ComponentMask mask;
+	Array<int> components; // Component type indices, ascending.
+	Array<int> offsets;    // Byte offset of each column within a chunk, parallel to `components`.
+	int16_t column_of[CF_ECS_MAX_COMPONENTS]; // Component type index -> column, or -1.
+	int capacity = 0;      // Rows per chunk.
+	int chunk_size = 0;    // Bytes per chunk, only bigger than CF_ECS_CHUNK_SIZE for huge rows.
+	int entity_count = 0;
+	Array<CF_Chunk*> chunks;
+	Map<CF_Archetype*> add_edges;    // Component type index -> archetype with that component attached.
+	Map<CF_Archetype*> remove_edges; // Component type index -> archetype with that component detached.
+};
+
+struct CF_EntitySlot
+{
+	uint32_t generation;
+	CF_Archetype* archetype; // NULL when the slot is free.
+	int chunk;
+	int row;
+};
+
+enum CF_EcsCommandType
+{
+	CF_ECS_COMMAND_MAKE,
+	CF_ECS_COMMAND_DESTROY,
+	CF_ECS_COMMAND_ATTACH,
+	CF_ECS_COMMAND_DETACH,
+};
+
+// A structural change recorded while systems are running, applied once they've all finished.
+struct CF_EcsCommand
+{
+	CF_EcsCommandType type;
+	CF_Entity entity;
+	CF_Archetype* archetype;
+	int component;
+};
+
+// Structural changes recorded by one system during a run. Each system records into its own buffer,
+// and buffers are applied in registration order, so the result doesn't depend on thread timing.
+struct CF_EcsCommandBuffer
+{
+	Array<CF_EcsCommand> commands;
+	int made = 0; // Entities made this run, see cf_make_entity.
+};
+
+struct CF_System
+{
+	const char* name = NULL;
+	CF_SystemUpdateFn* update = NULL;
+	void* udata = NULL;
+	CF_SystemFn* pre_update = NULL;
+	CF_SystemFn* post_update = NULL;
+	CF_ComponentMask required = { };
+	CF_ComponentMask writes = { };
+	Array<CF_Archetype*> archetypes; // Cached query results.
+	int archetypes_checked = 0;      // How many of CF_Ecs::archetypes have been tested against `required`.
+	int stage = 0;
+	CF_EcsCommandBuffer commands;
+};
+
+struct CF_Ecs
+{
+	Array<CF_ComponentType> components;
+	Map<int> component_index; // Interned name -> index into `components`.
+	Map<CF_Archetype*> entity_types; // Interned name -> archetype.
+	Array<CF_Archetype*> archetypes;
+	Map<CF_Archetype*> archetype_lookup; // Hash of the component mask -> archetype, linearly probed on collision.
+	Array<CF_EntitySlot> slots;
+	Array<int> free_slots;
+	int entity_count = 0;
+	Array<CF_System> systems;
+	bool schedule_dirty = true;
+	int stage_count = 0;
+
+	// Deferred structural changes, see cf_run_systems. Systems record into their own buffers, anything
+	// else running during a run (such as jobs a system adds to a threadpool) shares this locked one.
+	bool running = false;
+	CF_Mutex command_lock;
+	CF_EcsCommandBuffer commands;
+
+	// Builders.
+	CF_ComponentType component_builder;
+	const char* entity_builder_name = NULL;
+	CF_ComponentMask entity_builder_mask = { };
+	CF_System system_builder;
+};
+
+CF_GLOBAL static CF_Ecs* s_ecs;
+
+// The system running on the calling thread, if any.
+static thread_local CF_System* s_running_system;
+
+static CF_Ecs* s_get_ecs()
+{
+	if (!s_ecs) {
+		s_ecs = CF_NEW(CF_Ecs);
+		s_ecs->command_lock = cf_make_mutex();
+	}
+	return s_ecs;
+}
+
+static int s_component_index(const char* name)
+{
+	int* index = s_get_ecs()->component_index.try_get(sintern(name));
+	return index ? *index : -1;
+}
+
+static CF_INLINE uint32_t s_entity_index(CF_Entity e) { return (uint32_t)(e.id & 0xFFFFFFFFULL); }
+static CF_INLINE uint32_t s_entity_generation(CF_Entity e) { return (uint32_t)(e.id >> 32); }
+static CF_INLINE CF_Entity s_make_handle(uint32_t index, uint32_t generation) { CF_Entity e; e.id = ((uint64_t)generation << 32) | index; return e; }
+
+static CF_EntitySlot* s_slot(CF_Entity e)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	uint32_t index = s_entity_index(e);
+	if (!e.id || index >= (uint32_t)ecs->slots.count()) return NULL;
+	CF_EntitySlot* slot = &ecs->slots[index];
+	if (slot->generation != s_entity_generation(e) || !slot->archetype) return NULL;
+	return slot;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Archetypes and chunks.
+
+static int s_align_up(int x, int align)
+{
+	return (x + align - 1) & ~(align - 1);
+}
+
+// Lays out columns for `capacity` rows, returning the total bytes needed.
+static int s_layout(CF_Archetype* archetype, int capacity)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	int offset = s_align_up(capacity * (int)sizeof(CF_Entity), CF_ECS_COLUMN_ALIGN);
+	for (int i = 0; i < archetype->components.count(); ++i) {
+		archetype->offsets[i] = offset;
+		offset = s_align_up(offset + capacity * ecs->components[archetype->components[i]].size, CF_ECS_COLUMN_ALIGN);
+	}
+	return offset;
+}
+
+static CF_Archetype* s_find_or_make_archetype(const CF_ComponentMask* mask)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	uint64_t key = cf_fnv1a(mask, sizeof(*mask));
+	while (CF_Archetype** found = ecs->archetype_lookup.try_get(key)) {
+		if (!CF_MEMCMP(&(*found)->mask, mask, sizeof(*mask))) return *found;
+		++key;
+	}
+
+	CF_Archetype* archetype = CF_NEW(CF_Archetype);
+	archetype->mask = *mask;
+	CF_MEMSET(archetype->column_of, 0xFF, sizeof(archetype->column_of));
+	for (int i = 0; i < ecs->components.count(); ++i) {
+		if (!s_mask_has(mask, i)) continue;
+		archetype->column_of[i] = (int16_t)archetype->components.count();
+		archetype->components.add(i);
+		archetype->offsets.add(0);
+	}
+
+	int row_size = (int)sizeof(CF_Entity);
+	for (int i = 0; i < archetype->components.count(); ++i) {
+		row_size += ecs->components[archetype->components[i]].size;
+	}
+	int capacity = max(1, CF_ECS_CHUNK_SIZE / row_size);
+	while (capacity > 1 && s_layout(archetype, capacity) > CF_ECS_CHUNK_SIZE) --capacity;
+	archetype->capacity = capacity;
+	archetype->chunk_size = max(CF_ECS_CHUNK_SIZE, s_layout(archetype, capacity));
+
+	ecs->archetype_lookup.insert(key, archetype);
+	ecs->archetypes.add(archetype);
+	return archetype;
+}
+
+static CF_INLINE CF_Entity* s_chunk_entities(CF_Chunk* chunk)
+{
+	return (CF_Entity*)chunk->data;
+}
+
+static CF_INLINE void* s_chunk_component(CF_Archetype* archetype, CF_Chunk* chunk, int column, int row)
+{
+	return chunk->data + archetype->offsets[column] + row * s_get_ecs()->components[archetype->components[column]].size;
+}
+
+// Appends an uninitialized row to `archetype` for `e`, and points e's slot at it.
+static void s_push_row(CF_Archetype* archetype, CF_Entity e, CF_EntitySlot* slot)
+{
+	CF_Chunk* chunk = archetype->chunks.count() ? archetype->chunks.last() : NULL;
+	if (!chunk || chunk->count == archetype->capacity) {
+		chunk = (CF_Chunk*)CF_ALLOC(sizeof(CF_Chunk));
+		chunk->archetype = archetype;
+		chunk->data = (uint8_t*)cf_aligned_alloc(archetype->chunk_size, 64);
+		chunk->count = 0;
+		archetype->chunks.add(chunk);
+	}
+	int row = chunk->count++;
+	s_chunk_entities(chunk)[row] = e;
+	slot->archetype = archetype;
+	slot->chunk = archetype->chunks.count() - 1;
+	slot->row = row;
+	archetype->entity_count++;
+}
+
+// Removes a row by moving the archetype's last row into it. Components are not cleaned up.
+static void s_remove_row(CF_Archetype* archetype, int chunk_index, int row)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_Chunk* chunk = archetype->chunks[chunk_index];
+	CF_Chunk* last = archetype->chunks.last();
+	int last_row = last->count - 1;
+	if (chunk != last || row != last_row) {
+		CF_Entity moved = s_chunk_entities(last)[last_row];
+		s_chunk_entities(chunk)[row] = moved;
+		for (int i = 0; i < archetype->components.count(); ++i) {
+			int size = ecs->components[archetype->components[i]].size;
+			CF_MEMCPY(s_chunk_component(archetype, chunk, i, row), s_chunk_component(archetype, last, i, last_row), size);
+		}
+		CF_EntitySlot* slot = &ecs->slots[s_entity_index(moved)];
+		slot->chunk = chunk_index;
+		slot->row = row;
+	}
+	last->count--;
+	archetype->entity_count--;
+	if (last->count == 0 && archetype->chunks.count() > 1) {
+		cf_aligned_free(last->data);
+		CF_FREE(last);
+		archetype->chunks.pop();
+	}
+}
+
+static void s_init_component(CF_Archetype* archetype, CF_Chunk* chunk, int column, int row, CF_Entity e)
+{
+	const CF_ComponentType* type = &s_get_ecs()->components[archetype->components[column]];
+	void* component = s_chunk_component(archetype, chunk, column, row);
+	CF_MEMSET(component, 0, type->size);
+	if (type->initializer) type->initializer(e, component, type->initializer_udata);
+}
+
+static void s_cleanup_component(CF_Archetype* archetype, CF_Chunk* chunk, int column, int row, CF_Entity e)
+{
+	const CF_ComponentType* type = &s_get_ecs()->components[archetype->components[column]];
+	if (type->cleanup) type->cleanup(e, s_chunk_component(archetype, chunk, column, row), type->cleanup_udata);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Immediate structural changes.
+
+static void s_spawn(CF_Entity e, CF_Archetype* archetype)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_EntitySlot* slot = &ecs->slots[s_entity_index(e)];
+	slot->generation = s_entity_generation(e);
+	s_push_row(archetype, e, slot);
+	CF_Chunk* chunk = archetype->chunks[slot->chunk];
+	for (int i = 0; i < archetype->components.count(); ++i) {
+		s_init_component(archetype, chunk, i, slot->row, e);
+	}
+	ecs->entity_count++;
+}
+
+static void s_destroy(CF_Entity e)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_EntitySlot* slot = s_slot(e);
+	if (!slot) return;
+	CF_Archetype* archetype = slot->archetype;
+	CF_Chunk* chunk = archetype->chunks[slot->chunk];
+	for (int i = 0; i < archetype->components.count(); ++i) {
+		s_cleanup_component(archetype, chunk, i, slot->row, e);
+	}
+	s_remove_row(archetype, slot->chunk, slot->row);
+	slot->archetype = NULL;
+	if (++slot->generation == 0) slot->generation = 1;
+	ecs->free_slots.add((int)s_entity_index(e));
+	ecs->entity_count--;
+}
+
+// Moves `e` to the archetype with `component` attached or detached.
+static void s_move(CF_Entity e, int component, bool attach)
+{
+	CF_EntitySlot* slot = s_slot(e);
+	if (!slot || component < 0) return;
+	CF_Archetype* src = slot->archetype;
+	if (s_mask_has(&src->mask, component) == attach) return;
+
+	Map<CF_Archetype*>& edges = attach ? src->add_edges : src->remove_edges;
+	CF_Archetype** edge = edges.try_get((uint64_t)component);
+	CF_Archetype* dst;
+	if (edge) {
+		dst = *edge;
+	} else {
+		CF_ComponentMask mask = src->mask;
+		if (attach) s_mask_set(&mask, component);
+		else s_mask_clear(&mask, component);
+		dst = s_find_or_make_archetype(&mask);
+		edges.insert((uint64_t)component, dst);
+	}
+
+	int src_chunk_index = slot->chunk;
+	int src_row = slot->row;
+	CF_Chunk* src_chunk = src->chunks[src_chunk_index];
+	if (!attach) {
+		s_cleanup_component(src, src_chunk, src->column_of[component], src_row, e);
+	}
+	s_push_row(dst, e, slot);
+	CF_Chunk* dst_chunk = dst->chunks[slot->chunk];
+	for (int i = 0; i < dst->components.count(); ++i) {
+		int src_column = src->column_of[dst->components[i]];
+		if (src_column < 0) {
+			s_init_component(dst, dst_chunk, i, slot->row, e);
+		} else {
+			int size = s_get_ecs()->components[dst->components[i]].size;
+			CF_MEMCPY(s_chunk_component(dst, dst_chunk, i, slot->row), s_chunk_component(src, src_chunk, src_column, src_row), size);
+		}
+	}
+	s_remove_row(src, src_chunk_index, src_row);
+}
+
+// Command buffers are numbered by system, with the shared buffer last.
+static CF_EcsCommandBuffer* s_command_buffer(int lane)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	return lane < ecs->systems.count() ? &ecs->systems[lane].commands : &ecs->commands;
+}
+
+// The calling thread's command buffer. Unlock with s_unlock_commands.
+static CF_EcsCommandBuffer* s_lock_commands(int* lane)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_System* system = s_running_system;
+	if (system) {
+		*lane = (int)(system - ecs->systems.data());
+		return &system->commands;
+	}
+	cf_mutex_lock(&ecs->command_lock);
+	*lane = ecs->systems.count();
+	return &ecs->commands;
+}
+
+static void s_unlock_commands(CF_EcsCommandBuffer* buffer)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	if (buffer == &ecs->commands) cf_mutex_unlock(&ecs->command_lock);
+}
+
+static void s_push_command(CF_EcsCommandType type, CF_Entity e, CF_Archetype* archetype, int component)
+{
+	CF_EcsCommand cmd;
+	cmd.type = type;
+	cmd.entity = e;
+	cmd.archetype = archetype;
+	cmd.component = component;
+	int lane;
+	CF_EcsCommandBuffer* buffer = s_lock_commands(&lane);
+	buffer->commands.add(cmd);
+	s_unlock_commands(buffer);
+}
+
+// Handles made during a run are dealt out without touching any shared state: the free slots (top of
+// the stack first) followed by fresh slots past the end form one sequence, and buffer `lane` takes
+// every `lane_count`th entry of it starting at `lane`. Which handle an entity gets then only depends
+// on which system made it, not on how the systems interleaved.
+static uint32_t s_deferred_slot(int position)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	int free_count = ecs->free_slots.count();
+	if (position < free_count) return (uint32_t)ecs->free_slots[free_count - 1 - position];
+	return (uint32_t)(ecs->slots.count() + position - free_count);
+}
+
+// Claims the slots handed out by s_deferred_slot once the run is over. Anything dealt to a buffer
+// that made fewer entities stays free.
+static void s_claim_deferred_slots()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	int lane_count = ecs->systems.count() + 1;
+	int position_count = 0;
+	for (int lane = 0; lane < lane_count; ++lane) {
+		int made = s_command_buffer(lane)->made;
+		if (made) position_count = max(position_count, lane + (made - 1) * lane_count + 1);
+	}
+	if (!position_count) return;
+
+	Array<bool> taken;
+	taken.ensure_count(position_count);
+	CF_MEMSET(taken.data(), 0, sizeof(bool) * position_count);
+	for (int lane = 0; lane < lane_count; ++lane) {
+		CF_EcsCommandBuffer* buffer = s_command_buffer(lane);
+		for (int i = 0; i < buffer->made; ++i) taken[lane + i * lane_count] = true;
+		buffer->made = 0;
+	}
+
+	// Drop the taken free slots, keeping the rest in stack order.
+	int free_count = ecs->free_slots.count();
+	int reused = min(position_count, free_count);
+	int kept = free_count - reused;
+	for (int position = reused - 1; position >= 0; --position) {
+		if (!taken[position]) ecs->free_slots[kept++] = ecs->free_slots[free_count - 1 - position];
+	}
+	ecs->free_slots.set_count(kept);
+
+	int first_fresh = ecs->slots.count();
+	for (int position = reused; position < position_count; ++position) {
+		CF_EntitySlot slot = { 1, NULL, 0, 0 };
+		ecs->slots.add(slot);
+	}
+	for (int position = position_count - 1; position >= reused; --position) {
+		if (!taken[position]) ecs->free_slots.add(first_fresh + position - reused);
+	}
+}
+
+static void s_flush_commands()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	s_claim_deferred_slots();
+
+	int lane_count = ecs->systems.count() + 1;
+	for (int lane = 0; lane < lane_count; ++lane) {
+		Array<CF_EcsCommand>& commands = s_command_buffer(lane)->commands;
+		for (int i = 0; i < commands.count(); ++i) {
+			CF_EcsCommand cmd = commands[i];
+			switch (cmd.type) {
+			case CF_ECS_COMMAND_MAKE: s_spawn(cmd.entity, cmd.archetype); break;
+			case CF_ECS_COMMAND_DESTROY: s_destroy(cmd.entity); break;
+			case CF_ECS_COMMAND_ATTACH: s_move(cmd.entity, cmd.component, true); break;
+			case CF_ECS_COMMAND_DETACH: s_move(cmd.entity, cmd.component, false); break;
+			}
+		}
+		commands.clear();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Components.
+
+void cf_component_begin()
+{
+	s_get_ecs()->component_builder = CF_ComponentType();
+}
+
+void cf_component_set_name(const char* name)
+{
+	s_get_ecs()->component_builder.name = sintern(name);
+}
+
+void cf_component_set_size(int size)
+{
+	s_get_ecs()->component_builder.size = size;
+}
+
+void cf_component_set_optional_initializer(CF_ComponentFn* initializer, void* udata)
+{
+	s_get_ecs()->component_builder.initializer = initializer;
+	s_get_ecs()->component_builder.initializer_udata = udata;
+}
+
+void cf_component_set_optional_cleanup(CF_ComponentFn* cleanup, void* udata)
+{
+	s_get_ecs()->component_builder.cleanup = cleanup;
+	s_get_ecs()->component_builder.cleanup_udata = udata;
+}
+
+void cf_component_end()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ComponentType type = ecs->component_builder;
+	CF_ASSERT(type.name);
+	CF_ASSERT(type.size >= 0);
+	CF_ASSERT(!ecs->running);
+	int* index = ecs->component_index.try_get(type.name);
+	if (index) {
+		// Archetypes bake component sizes into their chunk layouts.
+		CF_ASSERT(ecs->components[*index].size == type.size || !ecs->archetypes.count());
+		ecs->components[*index] = type;
+	} else {
+		CF_ASSERT(ecs->components.count() < CF_ECS_MAX_COMPONENTS);
+		ecs->component_index.insert(type.name, ecs->components.count());
+		ecs->components.add(type);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Entity types.
+
+void cf_entity_begin()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	ecs->entity_builder_name = NULL;
+	CF_MEMSET(&ecs->entity_builder_mask, 0, sizeof(ecs->entity_builder_mask));
+}
+
+void cf_entity_set_name(const char* entity_type)
+{
+	s_get_ecs()->entity_builder_name = sintern(entity_type);
+}
+
+void cf_entity_add_component(const char* component_name)
+{
+	int component = s_component_index(component_name);
+	CF_ASSERT(component >= 0);
+	if (component < 0) return;
+	s_mask_set(&s_get_ecs()->entity_builder_mask, component);
+}
+
+void cf_entity_end()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(ecs->entity_builder_name);
+	CF_ASSERT(!ecs->running);
+	ecs->entity_types.insert(ecs->entity_builder_name, s_find_or_make_archetype(&ecs->entity_builder_mask));
+}
+
+//--------------------------------------------------------------------------------------------------
+// Entities.
+
+CF_Entity cf_make_entity(const char* entity_type)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_Archetype** archetype = ecs->entity_types.try_get(sintern(entity_type));
+	if (!archetype) return CF_INVALID_ENTITY;
+
+	if (ecs->running) {
+		// Slots can't be touched while systems may be reading them. The handle is picked now, but its
+		// slot is only claimed once the run is over, see s_claim_deferred_slots.
+		int lane;
+		CF_EcsCommandBuffer* buffer = s_lock_commands(&lane);
+		int position = lane + buffer->made++ * (ecs->systems.count() + 1);
+		uint32_t index = s_deferred_slot(position);
+		uint32_t generation = index < (uint32_t)ecs->slots.count() ? ecs->slots[index].generation : 1;
+		CF_Entity e = s_make_handle(index, generation);
+		CF_EcsCommand cmd = { CF_ECS_COMMAND_MAKE, e, *archetype, -1 };
+		buffer->commands.add(cmd);
+		s_unlock_commands(buffer);
+		return e;
+	}
+
+	uint32_t index;
+	if (ecs->free_slots.count()) {
+		index = (uint32_t)ecs->free_slots.pop();
+	} else {
+		index = (uint32_t)ecs->slots.count();
+		CF_EntitySlot slot = { 1, NULL, 0, 0 };
+		ecs->slots.add(slot);
+	}
+	CF_Entity e = s_make_handle(index, ecs->slots[index].generation);
+	s_spawn(e, *archetype);
+	return e;
+}
+
+void cf_destroy_entity(CF_Entity entity)
+{
+	CF_Ecs* ecs = s_get_ecs();
+	if (ecs->running) {
+		s_push_command(CF_ECS_COMMAND_DESTROY, entity, NULL, -1);
+	} else {
+		s_destroy(entity);
+	}
+}
+
+bool cf_entity_is_valid(CF_Entity entity)
+{
+	return s_slot(entity) != NULL;
+}
+
+void* cf_entity_get_component(CF_Entity entity, const char* component_name)
+{
+	CF_EntitySlot* slot = s_slot(entity);
+	if (!slot) return NULL;
+	int component = s_component_index(component_name);
+	if (component < 0) return NULL;
+	CF_Archetype* archetype = slot->archetype;
+	int column = archetype->column_of[component];
+	if (column < 0) return NULL;
+	return s_chunk_component(archetype, archetype->chunks[slot->chunk], column, slot->row);
+}
+
+bool cf_entity_has_component(CF_Entity entity, const char* component_name)
+{
+	CF_EntitySlot* slot = s_slot(entity);
+	if (!slot) return false;
+	int component = s_component_index(component_name);
+	return component >= 0 && s_mask_has(&slot->archetype->mask, component);
+}
+
+void cf_entity_attach_component(CF_Entity entity, const char* component_name)
+{
+	int component = s_component_index(component_name);
+	CF_ASSERT(component >= 0);
+	if (s_get_ecs()->running) {
+		s_push_command(CF_ECS_COMMAND_ATTACH, entity, NULL, component);
+	} else {
+		s_move(entity, component, true);
+	}
+}
+
+void cf_entity_detach_component(CF_Entity entity, const char* component_name)
+{
+	int component = s_component_index(component_name);
+	if (s_get_ecs()->running) {
+		s_push_command(CF_ECS_COMMAND_DETACH, entity, NULL, component);
+	} else {
+		s_move(entity, component, false);
+	}
+}
+
+int cf_entity_count()
+{
+	return s_get_ecs()->entity_count;
+}
+
+void cf_destroy_all_entities()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(!ecs->running);
+	for (int i = 0; i < ecs->archetypes.count(); ++i) {
+		CF_Archetype* archetype = ecs->archetypes[i];
+		for (int j = 0; j < archetype->chunks.count(); ++j) {
+			CF_Chunk* chunk = archetype->chunks[j];
+			for (int row = 0; row < chunk->count; ++row) {
+				for (int k = 0; k < archetype->components.count(); ++k) {
+					s_cleanup_component(archetype, chunk, k, row, s_chunk_entities(chunk)[row]);
+				}
+			}
+			cf_aligned_free(chunk->data);
+			CF_FREE(chunk);
+		}
+		archetype->chunks.clear();
+		archetype->entity_count = 0;
+	}
+
+	// Bump every generation so old handles stay stale once their slots are reused.
+	ecs->free_slots.clear();
+	for (int i = ecs->slots.count() - 1; i >= 0; --i) {
+		CF_EntitySlot* slot = &ecs->slots[i];
+		if (slot->archetype) {
+			slot->archetype = NULL;
+			if (++slot->generation == 0) slot->generation = 1;
+		}
+		ecs->free_slots.add(i);
+	}
+	ecs->entity_count = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Systems.
+
+void cf_system_begin()
+{
+	s_get_ecs()->system_builder = CF_System();
+}
+
+void cf_system_set_name(const char* name)
+{
+	s_get_ecs()->system_builder.name = sintern(name);
+}
+
+void cf_system_set_update(CF_SystemUpdateFn* update)
+{
+	s_get_ecs()->system_builder.update = update;
+}
+
+void cf_system_set_optional_update_udata(void* udata)
+{
+	s_get_ecs()->system_builder.udata = udata;
+}
+
+void cf_system_set_optional_pre_update(CF_SystemFn* pre_update)
+{
+	s_get_ecs()->system_builder.pre_update = pre_update;
+}
+
+void cf_system_set_optional_post_update(CF_SystemFn* post_update)
+{
+	s_get_ecs()->system_builder.post_update = post_update;
+}
+
+void cf_system_require_component(const char* component_name)
+{
+	int component = s_component_index(component_name);
+	CF_ASSERT(component >= 0);
+	if (component < 0) return;
+	s_mask_set(&s_get_ecs()->system_builder.required, component);
+	s_mask_set(&s_get_ecs()->system_builder.writes, component);
+}
+
+void cf_system_require_component_read_only(const char* component_name)
+{
+	int component = s_component_index(component_name);
+	CF_ASSERT(component >= 0);
+	if (component < 0) return;
+	s_mask_set(&s_get_ecs()->system_builder.required, component);
+}
+
+void cf_system_end()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(!ecs->running);
+	ecs->systems.add(ecs->system_builder);
+	ecs->system_builder = CF_System();
+	ecs->schedule_dirty = true;
+}
+
+void cf_clear_systems()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(!ecs->running);
+	ecs->systems.clear();
+	ecs->schedule_dirty = true;
+}
+
+void* cf_get_components(CF_ComponentList component_list, const char* component_name)
+{
+	CF_Chunk* chunk = (CF_Chunk*)(uintptr_t)component_list.id;
+	int component = s_component_index(component_name);
+	if (component < 0) return NULL;
+	CF_Archetype* archetype = chunk->archetype;
+	int column = archetype->column_of[component];
+	if (column < 0) return NULL;
+	return chunk->data + archetype->offsets[column];
+}
+
+CF_Entity* cf_get_entities(CF_ComponentList component_list)
+{
+	CF_Chunk* chunk = (CF_Chunk*)(uintptr_t)component_list.id;
+	return s_chunk_entities(chunk);
+}
+
+// Tests only the archetypes made since the last run against each system's requirements.
+static void s_update_queries()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	for (int i = 0; i < ecs->systems.count(); ++i) {
+		CF_System* system = &ecs->systems[i];
+		for (; system->archetypes_checked < ecs->archetypes.count(); ++system->archetypes_checked) {
+			CF_Archetype* archetype = ecs->archetypes[system->archetypes_checked];
+			if (s_mask_contains(&archetype->mask, &system->required)) {
+				system->archetypes.add(archetype);
+			}
+		}
+	}
+}
+
+static bool s_systems_conflict(const CF_System* a, const CF_System* b)
+{
+	if (s_mask_empty(&a->required) || s_mask_empty(&b->required)) return true;
+	return s_mask_intersects(&a->writes, &b->required) || s_mask_intersects(&b->writes, &a->required);
+}
+
+// Each system runs one stage after the latest earlier system it conflicts with.
+static void s_update_schedule()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	if (!ecs->schedule_dirty) return;
+	ecs->stage_count = 0;
+	for (int i = 0; i < ecs->systems.count(); ++i) {
+		CF_System* system = &ecs->systems[i];
+		system->stage = 0;
+		for (int j = 0; j < i; ++j) {
+			if (s_systems_conflict(system, &ecs->systems[j])) {
+				system->stage = max(system->stage, ecs->systems[j].stage + 1);
+			}
+		}
+		ecs->stage_count = max(ecs->stage_count, system->stage + 1);
+	}
+	ecs->schedule_dirty = false;
+}
+
+static void s_run_system(void* param)
+{
+	CF_System* system = (CF_System*)param;
+	// Restored afterwards, in case this thread picked the system up while waiting inside another one.
+	CF_System* prev = s_running_system;
+	s_running_system = system;
+	if (system->pre_update) system->pre_update(system->udata);
+	if (system->update) {
+		for (int i = 0; i < system->archetypes.count(); ++i) {
+			CF_Archetype* archetype = system->archetypes[i];
+			for (int j = 0; j < archetype->chunks.count(); ++j) {
+				CF_Chunk* chunk = archetype->chunks[j];
+				if (!chunk->count) continue;
+				CF_ComponentList list;
+				list.id = (uint64_t)(uintptr_t)chunk;
+				system->update(list, chunk->count, system->udata);
+			}
+		}
+	}
+	if (system->post_update) system->post_update(system->udata);
+	s_running_system = prev;
+}
+
+void cf_run_systems()
+{
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(!ecs->running);
+	s_update_queries();
+	ecs->running = true;
+	for (int i = 0; i < ecs->systems.count(); ++i) {
+		s_run_system(&ecs->systems[i]);
+	}
+	ecs->running = false;
+	s_flush_commands();
+}
+
+void cf_run_systems_parallel(CF_Threadpool* pool)
+{
+	if (!pool) {
+		cf_run_systems();
+		return;
+	}
+
+	CF_Ecs* ecs = s_get_ecs();
+	CF_ASSERT(!ecs->running);
+	s_update_queries();
+	s_update_schedule();
+	ecs->running = true;
+	for (int stage = 0; stage < ecs->stage_count; ++stage) {
+		CF_JobCounter counter = cf_make_job_counter();
+		CF_System* last = NULL;
+		for (int i = 0; i < ecs->systems.count(); ++i) {
+			CF_System* system = &ecs->systems[i];
+			if (system->stage != stage) continue;
+			if (last) cf_threadpool_add_job(pool, s_run_system, last, &counter);
+			last = system;
+		}
+		// The calling thread takes one system itself rather than idling.
+		cf_threadpool_kick(pool);
+		if (last) s_run_system(last);
+		cf_threadpool_wait_counter(pool, &counter);
+	}
+	ecs->running = false;
+	s_flush_commands();
+}
+
+void cf_destroy_ecs()
+{
+	if (!s_ecs) return;
+	cf_destroy_all_entities();
+	for (int i = 0; i < s_ecs->archetypes.count(); ++i) {
+		CF_Archetype* archetype = s_ecs->archetypes[i];
+		archetype->~CF_Archetype();
+		CF_FREE(archetype);
+	}
+	cf_destroy_mutex(&s_ecs->command_lock);
+	s_ecs->~CF_Ecs();
+	CF_FREE(s_ecs);
+	s_ecs = NULL;
+}
@@ -235,14 +235,14 @@ static void s_shader_auto_reload(const char* changed_key)
 
 	// Draw shaders (and their attached blit shaders). Collect first: reload
 	// mutates no draw maps, but collecting keeps this robust either way.
-	if (s_draw) {
+	if (s_draw_app) {
 		Array<uint64_t> ids;
 		Array<const char*> paths;
-		int n = s_draw->shader_paths.count();
+		int n = s_draw_app->shader_paths.count();
 		for (int i = 0; i < n; ++i) {
-			if (matches(s_draw->shader_paths.items()[i])) {
-				ids.add(s_draw->shader_paths.keys()[i]);
-				paths.add(s_draw->shader_paths.items()[i]);
+			if (matches(s_draw_app->shader_paths.items()[i])) {
+				ids.add(s_draw_app->shader_paths.keys()[i]);
+				paths.add(s_draw_app->shader_paths.items()[i]);
 			}
 		}
 		for (int i = 0; i < ids.count(); ++i) {
@@ -252,7 +252,7 @@ static void s_shader_auto_reload(const char* changed_key)
 			CF_Shader old = { ids[i] };
 			cf_shader_swap_contents(old, fresh);
 			cf_destroy_shader_internal(fresh);
-			CF_Shader* blit = (CF_Shader*)s_draw->draw_shd_to_blit_shd.try_get(ids[i]);
+			CF_Shader* blit = (CF_Shader*)s_draw_app->draw_shd_to_blit_shd.try_get(ids[i]);
 			if (blit) {
 				CF_Shader fresh_blit = cf_make_draw_blit_shader_internal(path);
 				if (fresh_blit.id) {
@@ -639,15 +639,15 @@ void cf_unload_internal_shaders()
 
 void cf_destroy_shader(CF_Shader shader_handle)
 {
-	s_draw->shader_paths.remove(shader_handle.id);
+	s_draw_app->shader_paths.remove(shader_handle.id);
 	s_graphics_shader_paths.remove(shader_handle.id);
 
 	// Draw shaders automatically have blit shaders generated, so clean that up as well,
 	// if it exists. See `cf_make_draw_shader`.
-	CF_Shader* blit = (CF_Shader*)s_draw->draw_shd_to_blit_shd.try_get(shader_handle.id);
+	CF_Shader* blit = (CF_Shader*)s_draw_app->draw_shd_to_blit_shd.try_get(shader_handle.id);
 	if (blit) {
 		cf_destroy_shader(*blit);
-		s_draw->draw_shd_to_blit_shd.remove(shader_handle.id);
+		s_draw_app->draw_shd_to_blit_shd.remove(shader_handle.id);
 	}
 
 	// 3d shape shaders pair a hidden solid-variant sibling with the canonical handle. See
@@ -9,6 +9,9 @@
 #include <cute_c_runtime.h>
 
 #include <cute_math.h>
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_multithreading.h>
 
 // The stateless collision queries route to Box2D's freestanding geometry layer
 // (box2d/collision.h) -- no b2World or simulation state is involved anywhere in this file. CF shapes stay the API currency; where layouts are not
@@ -638,3 +641,290 @@ bool cf_cast_ray(CF_Ray A, const void* B, CF_ShapeType typeB, CF_Raycast* out)
 	}
 	return out->hit;
 }
+
+//--------------------------------------------------------------------------------------------------
+// AABB tree.
+
+// Box2D's dynamic tree leaves fattening to its broadphase, so the margin lives here along with
+// a dense list of live leaves for pair finding. Leaf ids are Box2D proxy ids.
+
+struct CF_AabbTreeLeaf
+{
+	CF_Aabb fat;
+	uint64_t udata;
+	int index; // Into CF_AabbTree::leaves, or -1 when the id is free.
+};
+
+struct CF_AabbTree
+{
+	b2DynamicTree tree;
+	float margin;
+	Array<CF_AabbTreeLeaf> info; // Indexed by leaf id.
+	Array<int> leaves;
+};
+
+CF_INLINE b2AABB s_b2(CF_Aabb bb) { b2AABB out; out.lowerBound = s_b2(bb.min); out.upperBound = s_b2(bb.max); return out; }
+
+static CF_Aabb s_fatten(const CF_AabbTree* tree, CF_Aabb bb)
+{
+	CF_V2 m = cf_v2(tree->margin, tree->margin);
+	return cf_make_aabb(cf_sub(bb.min, m), cf_add(bb.max, m));
+}
+
+CF_AabbTree* cf_make_aabb_tree(float margin)
+{
+	CF_AabbTree* tree = CF_NEW(CF_AabbTree);
+	tree->tree = b2DynamicTree_Create();
+	tree->margin = cf_max(margin, 0.0f);
+	return tree;
+}
+
+void cf_destroy_aabb_tree(CF_AabbTree* tree)
+{
+	if (!tree) return;
+	b2DynamicTree_Destroy(&tree->tree);
+	tree->~CF_AabbTree();
+	cf_free(tree);
+}
+
+int cf_aabb_tree_insert(CF_AabbTree* tree, CF_Aabb aabb, uint64_t udata)
+{
+	CF_Aabb fat = s_fatten(tree, aabb);
+	int leaf = b2DynamicTree_CreateProxy(&tree->tree, s_b2(fat), 1, udata);
+	while (tree->info.count() <= leaf) {
+		CF_AabbTreeLeaf free_leaf = { };
+		free_leaf.index = -1;
+		tree->info.add(free_leaf);
+	}
+	CF_AabbTreeLeaf* info = &tree->info[leaf];
+	info->fat = fat;
+	info->udata = udata;
+	info->index = tree->leaves.count();
+	tree->leaves.add(leaf);
+	return leaf;
+}
+
+void cf_aabb_tree_remove(CF_AabbTree* tree, int leaf)
+{
+	CF_ASSERT(leaf >= 0 && leaf < tree->info.count() && tree->info[leaf].index >= 0);
+	b2DynamicTree_DestroyProxy(&tree->tree, leaf);
+	int index = tree->info[leaf].index;
+	int last = tree->leaves.last();
+	tree->leaves.unordered_remove(index);
+	if (last != leaf) tree->info[last].index = index;
+	tree->info[leaf].index = -1;
+}
+
+bool cf_aabb_tree_move(CF_AabbTree* tree, int leaf, CF_Aabb aabb)
+{
+	CF_ASSERT(leaf >= 0 && leaf < tree->info.count() && tree->info[leaf].index >= 0);
+	CF_AabbTreeLeaf* info = &tree->info[leaf];
+	if (cf_contains_aabb(info->fat, aabb)) return false;
+	info->fat = s_fatten(tree, aabb);
+	b2DynamicTree_MoveProxy(&tree->tree, leaf, s_b2(info->fat));
+	return true;
+}
+
+CF_Aabb cf_aabb_tree_get_fat_aabb(const CF_AabbTree* tree, int leaf)
+{
+	CF_ASSERT(leaf >= 0 && leaf < tree->info.count() && tree->info[leaf].index >= 0);
+	return tree->info[leaf].fat;
+}
+
+uint64_t cf_aabb_tree_get_udata(const CF_AabbTree* tree, int leaf)
+{
+	CF_ASSERT(leaf >= 0 && leaf < tree->info.count() && tree->info[leaf].index >= 0);
+	return tree->info[leaf].udata;
+}
+
+int cf_aabb_tree_count(const CF_AabbTree* tree)
+{
+	return tree->leaves.count();
+}
+
+void cf_aabb_tree_rebuild(CF_AabbTree* tree)
+{
+	b2DynamicTree_Rebuild(&tree->tree, true);
+}
+
+struct CF_AabbTreeQuery
+{
+	CF_AabbTreeQueryFn* fn;
+	void* fn_udata;
+};
+
+static bool s_aabb_tree_query(int proxy_id, uint64_t user_data, void* context)
+{
+	CF_AabbTreeQuery* query = (CF_AabbTreeQuery*)context;
+	return query->fn(proxy_id, user_data, query->fn_udata);
+}
+
+void cf_aabb_tree_query_aabb(const CF_AabbTree* tree, CF_Aabb aabb, CF_AabbTreeQueryFn* fn, void* fn_udata)
+{
+	CF_AabbTreeQuery query = { fn, fn_udata };
+	b2DynamicTree_Query(&tree->tree, s_b2(aabb), UINT64_MAX, s_aabb_tree_query, &query);
+}
+
+struct CF_AabbTreeRaycast
+{
+	CF_Ray ray;
+	CF_AabbTreeRaycastFn* fn;
+	void* fn_udata;
+};
+
+// Box2D works in fractions of the ray's translation, CF in distances along the ray.
+static float s_aabb_tree_raycast(const b2RayCastInput* input, int proxy_id, uint64_t user_data, void* context)
+{
+	CF_AabbTreeRaycast* cast = (CF_AabbTreeRaycast*)context;
+	CF_Ray ray = cast->ray;
+	ray.t *= input->maxFraction;
+	float t = cast->fn(proxy_id, user_data, ray, cast->fn_udata);
+	if (t < 0) return -1.0f;
+	return t / cast->ray.t;
+}
+
+void cf_aabb_tree_raycast(const CF_AabbTree* tree, CF_Ray ray, CF_AabbTreeRaycastFn* fn, void* fn_udata)
+{
+	if (ray.t <= 0) return;
+	CF_AabbTreeRaycast cast = { ray, fn, fn_udata };
+	b2RayCastInput in = s_ray(ray);
+	b2DynamicTree_RayCast(&tree->tree, &in, UINT64_MAX, s_aabb_tree_raycast, &cast);
+}
+
+struct CF_AabbTreePairs
+{
+	const CF_AabbTree* tree;
+	int leaf;
+	int count;
+	CF_AabbTreePairFn* fn;
+	void* fn_udata;
+};
+
+static bool s_aabb_tree_pair(int proxy_id, uint64_t user_data, void* context)
+{
+	CF_AabbTreePairs* pairs = (CF_AabbTreePairs*)context;
+	// Both leaves of a pair find each other, only the lower id reports it.
+	if (proxy_id > pairs->leaf) {
+		pairs->fn(pairs->leaf, pairs->tree->info[pairs->leaf].udata, proxy_id, user_data, pairs->fn_udata);
+		pairs->count++;
+	}
+	return true;
+}
+
+int cf_aabb_tree_find_pairs(const CF_AabbTree* tree, CF_AabbTreePairFn* fn, void* fn_udata)
+{
+	CF_AabbTreePairs pairs = { tree, -1, 0, fn, fn_udata };
+	for (int i = 0; i < tree->leaves.count(); ++i) {
+		pairs.leaf = tree->leaves[i];
+		b2DynamicTree_Query(&tree->tree, s_b2(tree->info[pairs.leaf].fat), UINT64_MAX, s_aabb_tree_pair, &pairs);
+	}
+	return pairs.count;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Batched raycasts.
+
+static int s_shape_size(CF_ShapeType type)
+{
+	switch (type) {
+	case CF_SHAPE_TYPE_CIRCLE:  return (int)sizeof(CF_Circle);
+	case CF_SHAPE_TYPE_AABB:    return (int)sizeof(CF_Aabb);
+	case CF_SHAPE_TYPE_CAPSULE: return (int)sizeof(CF_Capsule);
+	case CF_SHAPE_TYPE_POLY:    return (int)sizeof(CF_Poly);
+	default:                    return 0;
+	}
+}
+
+// Cheap bounding box rejection ahead of the exact cast. Polygons would need their bounds computed
+// on every visit, so they always go straight to the exact cast.
+static bool s_may_hit(CF_Aabb segment, const void* shape, CF_ShapeType type)
+{
+	switch (type) {
+	case CF_SHAPE_TYPE_CIRCLE: {
+		const CF_Circle* c = (const CF_Circle*)shape;
+		v2 r = V2(c->r, c->r);
+		return cf_overlaps(segment, cf_make_aabb(c->p - r, c->p + r));
+	}
+	case CF_SHAPE_TYPE_AABB: return cf_overlaps(segment, *(const CF_Aabb*)shape);
+	case CF_SHAPE_TYPE_CAPSULE: {
+		const CF_Capsule* c = (const CF_Capsule*)shape;
+		v2 r = V2(c->r, c->r);
+		return cf_overlaps(segment, cf_make_aabb(cf_min(c->a, c->b) - r, cf_max(c->a, c->b) + r));
+	}
+	default: return true;
+	}
+}
+
+struct CF_CastRays
+{
+	const CF_AabbTree* tree;
+	const CF_Ray* rays;
+	const uint8_t* shapes;
+	CF_ShapeType type;
+	int stride;
+	int shape_count;
+	CF_RayHit* hits;
+};
+
+struct CF_CastRayLeaf
+{
+	const CF_CastRays* cast;
+	CF_RayHit* hit;
+};
+
+// The tree hands over the ray already clipped to the closest hit so far, and returning the new
+// distance clips it further.
+static float s_cast_ray_leaf(int leaf, uint64_t udata, CF_Ray ray, void* fn_udata)
+{
+	CF_UNUSED(leaf);
+	CF_CastRayLeaf* c = (CF_CastRayLeaf*)fn_udata;
+	CF_Raycast out;
+	if (!cf_cast_ray(ray, c->cast->shapes + (size_t)udata * c->cast->stride, c->cast->type, &out)) return -1.0f;
+	if (c->hit->index < 0 || out.t < c->hit->raycast.t) {
+		c->hit->index = (int)udata;
+		c->hit->raycast = out;
+	}
+	return out.t;
+}
+
+static void s_cast_rays_range(int begin, int end, void* udata)
+{
+	const CF_CastRays* cast = (const CF_CastRays*)udata;
+	for (int i = begin; i < end; ++i) {
+		CF_Ray ray = cast->rays[i];
+		CF_RayHit* hit = cast->hits + i;
+		CF_MEMSET(hit, 0, sizeof(*hit));
+		hit->index = -1;
+
+		if (cast->tree) {
+			CF_CastRayLeaf leaf = { cast, hit };
+			cf_aabb_tree_raycast(cast->tree, ray, s_cast_ray_leaf, &leaf);
+			continue;
+		}
+
+		// Every hit shortens the ray, so shapes behind it fail the bounds check and the cast gets cheaper.
+		for (int j = 0; j < cast->shape_count && ray.t > 0; ++j) {
+			const void* shape = cast->shapes + (size_t)j * cast->stride;
+			v2 end_point = ray.p + ray.d * ray.t;
+			if (!s_may_hit(cf_make_aabb(cf_min(ray.p, end_point), cf_max(ray.p, end_point)), shape, cast->type)) continue;
+			CF_Raycast out;
+			if (!cf_cast_ray(ray, shape, cast->type, &out)) continue;
+			if (hit->index >= 0 && out.t >= hit->raycast.t) continue;
+			hit->index = j;
+			hit->raycast = out;
+			ray.t = out.t;
+		}
+	}
+}
+
+void cf_cast_rays(const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, int shape_count, CF_RayHit* hits, CF_Threadpool* pool)
+{
+	CF_CastRays cast = { NULL, rays, (const uint8_t*)shapes, type, s_shape_size(type), shape_count, hits };
+	cf_parallel_for(pool, 0, ray_count, 16, s_cast_rays_range, &cast);
+}
+
+void cf_cast_rays_tree(const CF_AabbTree* tree, const CF_Ray* rays, int ray_count, const void* shapes, CF_ShapeType type, CF_RayHit* hits, CF_Threadpool* pool)
+{
+	CF_CastRays cast = { tree, rays, (const uint8_t*)shapes, type, s_shape_size(type), 0, hits };
+	cf_parallel_for(pool, 0, ray_count, 16, s_cast_rays_range, &cast);
+}
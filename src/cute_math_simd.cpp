@@ -0,0 +1,181 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include <cute_defines.h>
+#include <cute_c_runtime.h>
+#include <cute_math.h>
+
+#include <float.h>
+
+#include <internal/cute_simd_internal.h>
+
+// Batched collision kernels. Each kernel is written once against the thin wrappers in
+// cute_simd_internal.h. Whatever doesn't fill a whole register -- or everything, on platforms without
+// SIMD -- runs through scalar loops doing the exact same float operations in the same order, so every
+// lane gives the scalar answer bit for bit.
+
+#ifdef CF_SIMD_WIDTH
+
+static CF_INLINE int s_ctz(unsigned mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// Appends the lane index of every set bit in `mask`, lowest lane first.
+static CF_INLINE int s_push_hits(int mask, int base, int* hits, int hit_count)
+{
+	unsigned bits = (unsigned)mask;
+	while (bits) {
+		hits[hit_count++] = base + s_ctz(bits);
+		bits &= bits - 1;
+	}
+	return hit_count;
+}
+
+#endif // CF_SIMD_WIDTH
+
+int cf_circle_to_circles(CF_Circle A, CF_CircleSoA B, int* hits)
+{
+	// Same as cf_circle_to_circle: dot(d, d) < r * r.
+	int hit_count = 0;
+	int i = 0;
+#ifdef CF_SIMD_WIDTH
+	s_f ax = s_set(A.p.x), ay = s_set(A.p.y), ar = s_set(A.r);
+	for (; i + CF_SIMD_WIDTH <= B.count; i += CF_SIMD_WIDTH) {
+		s_f dx = s_sub(s_load(B.x + i), ax);
+		s_f dy = s_sub(s_load(B.y + i), ay);
+		s_f r = s_add(ar, s_load(B.r + i));
+		s_m hit = s_lt(s_add(s_mul(dx, dx), s_mul(dy, dy)), s_mul(r, r));
+		hit_count = s_push_hits(s_movemask(hit), i, hits, hit_count);
+	}
+#endif
+	for (; i < B.count; ++i) {
+		float dx = B.x[i] - A.p.x;
+		float dy = B.y[i] - A.p.y;
+		float r = A.r + B.r[i];
+		if (dx * dx + dy * dy < r * r) hits[hit_count++] = i;
+	}
+	return hit_count;
+}
+
+int cf_circle_to_aabbs(CF_Circle A, CF_AabbSoA B, int* hits)
+{
+	// Same as cf_circle_to_aabb: clamp the center into the box, then compare squared distance to r * r.
+	int hit_count = 0;
+	int i = 0;
+	float rr = A.r * A.r;
+#ifdef CF_SIMD_WIDTH
+	s_f px = s_set(A.p.x), py = s_set(A.p.y), vrr = s_set(rr);
+	for (; i + CF_SIMD_WIDTH <= B.count; i += CF_SIMD_WIDTH) {
+		s_f lx = s_max(s_load(B.min_x + i), s_min(px, s_load(B.max_x + i)));
+		s_f ly = s_max(s_load(B.min_y + i), s_min(py, s_load(B.max_y + i)));
+		s_f dx = s_sub(px, lx);
+		s_f dy = s_sub(py, ly);
+		s_m hit = s_lt(s_add(s_mul(dx, dx), s_mul(dy, dy)), vrr);
+		hit_count = s_push_hits(s_movemask(hit), i, hits, hit_count);
+	}
+#endif
+	for (; i < B.count; ++i) {
+		float dx = A.p.x - cf_max(B.min_x[i], cf_min(A.p.x, B.max_x[i]));
+		float dy = A.p.y - cf_max(B.min_y[i], cf_min(A.p.y, B.max_y[i]));
+		if (dx * dx + dy * dy < rr) hits[hit_count++] = i;
+	}
+	return hit_count;
+}
+
+int cf_aabb_to_aabbs(CF_Aabb A, CF_AabbSoA B, int* hits)
+{
+	// Same as cf_overlaps: separated when either box ends before the other begins on some axis.
+	int hit_count = 0;
+	int i = 0;
+#ifdef CF_SIMD_WIDTH
+	s_f a_min_x = s_set(A.min.x), a_min_y = s_set(A.min.y);
+	s_f a_max_x = s_set(A.max.x), a_max_y = s_set(A.max.y);
+	for (; i + CF_SIMD_WIDTH <= B.count; i += CF_SIMD_WIDTH) {
+		s_m d0 = s_lt(s_load(B.max_x + i), a_min_x);
+		s_m d1 = s_lt(a_max_x, s_load(B.min_x + i));
+		s_m d2 = s_lt(s_load(B.max_y + i), a_min_y);
+		s_m d3 = s_lt(a_max_y, s_load(B.min_y + i));
+		int separated = s_movemask(s_or(s_or(d0, d1), s_or(d2, d3)));
+		hit_count = s_push_hits(~separated & ((1 << CF_SIMD_WIDTH) - 1), i, hits, hit_count);
+	}
+#endif
+	for (; i < B.count; ++i) {
+		int d0 = B.max_x[i] < A.min.x;
+		int d1 = A.max.x < B.min_x[i];
+		int d2 = B.max_y[i] < A.min.y;
+		int d3 = A.max.y < B.min_y[i];
+		if (!(d0 | d1 | d2 | d3)) hits[hit_count++] = i;
+	}
+	return hit_count;
+}
+
+int cf_ray_to_circles(CF_Ray A, CF_CircleSoA B, int* hits, float* hit_t)
+{
+	// Mirrors cf_ray_to_circle (Box2D's b2RayCastCircle): project each center onto the ray, then step
+	// back by half the chord length to find the entry point along the ray.
+	float tx = A.d.x * A.t;
+	float ty = A.d.y * A.t;
+	float length = sqrtf(tx * tx + ty * ty);
+	if (length < FLT_EPSILON) return 0;
+	float inv_length = 1.0f / length;
+	float dx = inv_length * tx;
+	float dy = inv_length * ty;
+
+	int hit_count = 0;
+	int i = 0;
+#ifdef CF_SIMD_WIDTH
+	s_f ox = s_set(A.p.x), oy = s_set(A.p.y);
+	s_f vdx = s_set(dx), vdy = s_set(dy);
+	s_f vlength = s_set(length), vt = s_set(A.t), zero = s_set(0);
+	float t[CF_SIMD_WIDTH];
+	for (; i + CF_SIMD_WIDTH <= B.count; i += CF_SIMD_WIDTH) {
+		s_f sx = s_sub(ox, s_load(B.x + i));
+		s_f sy = s_sub(oy, s_load(B.y + i));
+		s_f proj = s_sub(zero, s_add(s_mul(sx, vdx), s_mul(sy, vdy)));
+		s_f cx = s_add(sx, s_mul(proj, vdx));
+		s_f cy = s_add(sy, s_mul(proj, vdy));
+		s_f cc = s_add(s_mul(cx, cx), s_mul(cy, cy));
+		s_f r = s_load(B.r + i);
+		s_f rr = s_mul(r, r);
+		s_f fraction = s_sub(proj, s_sqrt(s_max(s_sub(rr, cc), zero)));
+		s_m hit = s_and(s_and(s_le(cc, rr), s_le(zero, fraction)), s_le(fraction, vlength));
+		int mask = s_movemask(hit);
+		if (!mask) continue;
+		if (hit_t) {
+			s_store(t, s_mul(s_div(fraction, vlength), vt));
+			for (unsigned bits = (unsigned)mask; bits; bits &= bits - 1) {
+				hit_t[hit_count] = t[s_ctz(bits)];
+				hits[hit_count++] = i + s_ctz(bits);
+			}
+		} else {
+			hit_count = s_push_hits(mask, i, hits, hit_count);
+		}
+	}
+#endif
+	for (; i < B.count; ++i) {
+		float sx = A.p.x - B.x[i];
+		float sy = A.p.y - B.y[i];
+		float proj = 0 - (sx * dx + sy * dy);
+		float cx = sx + proj * dx;
+		float cy = sy + proj * dy;
+		float cc = cx * cx + cy * cy;
+		float rr = B.r[i] * B.r[i];
+		if (!(cc <= rr)) continue;
+		float fraction = proj - sqrtf(cf_max(rr - cc, 0.0f));
+		if (!(0 <= fraction && fraction <= length)) continue;
+		if (hit_t) hit_t[hit_count] = fraction / length * A.t;
+		hits[hit_count++] = i;
+	}
+	return hit_count;
+}
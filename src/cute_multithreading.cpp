@@ -7,8 +7,14 @@
 
 #include <cute_multithreading.h>
 #include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <cute_coroutine.h>
+#include <cute_array.h>
+
+#include <internal/cute_alloc_internal.h>
 
 #include <SDL3/SDL.h>
+#include <limits.h>
 
 #define CUTE_SYNC_IMPLEMENTATION
 #define CUTE_SYNC_SDL
@@ -203,6 +209,36 @@ CF_Result cf_atomic_ptr_cas(void** atomic, void* expected, void* value)
 	return result;
 }
 
+CF_AtomicInt64 cf_atomic64_zero()
+{
+	CF_AtomicInt64 result;
+	result.i = 0;
+	return result;
+}
+
+int64_t cf_atomic64_add(CF_AtomicInt64* atomic, int64_t addend)
+{
+	return cute_atomic64_add(atomic, addend);
+}
+
+int64_t cf_atomic64_set(CF_AtomicInt64* atomic, int64_t value)
+{
+	return cute_atomic64_set(atomic, value);
+}
+
+int64_t cf_atomic64_get(CF_AtomicInt64* atomic)
+{
+	return cute_atomic64_get(atomic);
+}
+
+CF_Result cf_atomic64_cas(CF_AtomicInt64* atomic, int64_t expected, int64_t value)
+{
+	CF_Result result;
+	result.code = cute_atomic64_cas(atomic, expected, value) ? CF_RESULT_SUCCESS : CF_RESULT_ERROR;
+	result.details = NULL;
+	return result;
+}
+
 CF_ReadWriteLock cf_make_rw_lock()
 {
 	return cute_rw_lock_create();
@@ -238,6 +274,11 @@ CF_Threadpool* cf_make_threadpool(int thread_count)
 	return cute_threadpool_create(thread_count, NULL);
 }
 
+int cf_threadpool_thread_count(CF_Threadpool* pool)
+{
+	return pool->thread_count;
+}
+
 void cf_threadpool_add_task(CF_Threadpool* pool, CF_TaskFn* task, void* param)
 {
 	cute_threadpool_add_task(pool, task, param);
@@ -253,7 +294,843 @@ void cf_threadpool_kick(CF_Threadpool* pool)
 	cute_threadpool_kick(pool);
 }
 
+static void s_release_idle_fibers(CF_Threadpool* pool);
+
 void cf_destroy_threadpool(CF_Threadpool* pool)
 {
 	cute_threadpool_destroy(pool);
+	s_release_idle_fibers(pool);
+}
+
+CF_JobCounter cf_make_job_counter()
+{
+	CF_JobCounter counter;
+	counter.i = 0;
+	return counter;
+}
+
+void cf_threadpool_add_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter)
+{
+	cute_threadpool_add_task_with_counter(pool, task, param, counter);
+}
+
+// Fiber jobs. Each one is a regular task that resumes a coroutine. When the coroutine yields
+// before finishing, the task re-adds itself and returns, freeing up the worker. A fiber waiting
+// on a counter is held by the pool until the counter reaches zero, rather than re-added right
+// away, so nothing spins on it. Coroutines are recycled through a free list per pool, as
+// creating one maps a fresh stack.
+
+#ifndef CF_FIBER_JOB_STACK_SIZE
+#	define CF_FIBER_JOB_STACK_SIZE (256 * 1024)
+#endif
+
+struct CF_FiberJob;
+
+struct CF_Fiber
+{
+	CF_Coroutine co;
+	CF_FiberJob* job;
+	CF_Fiber* next;
+};
+
+struct CF_FiberJob
+{
+	CF_TaskFn* task;
+	void* param;
+	CF_Threadpool* pool;
+	CF_JobCounter* counter;
+	CF_Fiber* fiber;
+	CF_JobCounter* wait_counter;
+	int tag_depth;
+};
+
+struct CF_FiberFreeList
+{
+	CF_Threadpool* pool;
+	CF_Fiber* fibers;
+	CF_FiberFreeList* next;
+};
+
+static CUTE_SYNC_THREAD_LOCAL CF_FiberJob* s_running_fiber_job;
+static CF_AtomicInt s_fiber_lock;
+static CF_FiberFreeList* s_fiber_free_lists;
+
+static void s_fiber_lock_acquire()
+{
+	while (cute_atomic_set(&s_fiber_lock, 1)) {
+		CUTE_SYNC_YIELD();
+	}
+}
+
+static void s_fiber_lock_release()
+{
+	cute_atomic_set(&s_fiber_lock, 0);
+}
+
+static void s_fiber_main(CF_Coroutine co)
+{
+	CF_Fiber* fiber = (CF_Fiber*)cf_coroutine_get_udata(co);
+	while (1) {
+		CF_FiberJob* job = fiber->job;
+		job->task(job->param);
+		// Clearing the job tells the resuming task this one finished, rather than suspended.
+		fiber->job = NULL;
+		cf_coroutine_yield(co);
+	}
+}
+
+// Call with the fiber lock held.
+static CF_FiberFreeList* s_find_free_fibers(CF_Threadpool* pool)
+{
+	CF_FiberFreeList* list = s_fiber_free_lists;
+	while (list && list->pool != pool) list = list->next;
+	return list;
+}
+
+static CF_Fiber* s_acquire_fiber(CF_Threadpool* pool)
+{
+	s_fiber_lock_acquire();
+	CF_FiberFreeList* list = s_find_free_fibers(pool);
+	CF_Fiber* fiber = list ? list->fibers : NULL;
+	if (fiber) list->fibers = fiber->next;
+	s_fiber_lock_release();
+	if (!fiber) {
+		fiber = (CF_Fiber*)cf_alloc(sizeof(CF_Fiber));
+		fiber->co = cf_make_coroutine(s_fiber_main, CF_FIBER_JOB_STACK_SIZE, fiber);
+	}
+	fiber->job = NULL;
+	fiber->next = NULL;
+	return fiber;
+}
+
+static void s_release_fiber(CF_Threadpool* pool, CF_Fiber* fiber)
+{
+	s_fiber_lock_acquire();
+	CF_FiberFreeList* list = s_find_free_fibers(pool);
+	if (!list) {
+		list = (CF_FiberFreeList*)cf_alloc(sizeof(CF_FiberFreeList));
+		list->pool = pool;
+		list->fibers = NULL;
+		list->next = s_fiber_free_lists;
+		s_fiber_free_lists = list;
+	}
+	fiber->next = list->fibers;
+	list->fibers = fiber;
+	s_fiber_lock_release();
+}
+
+// Frees the fibers of a destroyed pool. Other pools may still be running fiber jobs.
+static void s_release_idle_fibers(CF_Threadpool* pool)
+{
+	s_fiber_lock_acquire();
+	CF_FiberFreeList** link = &s_fiber_free_lists;
+	while (*link && (*link)->pool != pool) link = &(*link)->next;
+	CF_FiberFreeList* list = *link;
+	if (list) *link = list->next;
+	s_fiber_lock_release();
+	if (!list) return;
+	CF_Fiber* fiber = list->fibers;
+	cf_free(list);
+	while (fiber) {
+		CF_Fiber* next = fiber->next;
+		cf_destroy_coroutine(fiber->co);
+		cf_free(fiber);
+		fiber = next;
+	}
+}
+
+static void s_fiber_job_task(void* param)
+{
+	CF_FiberJob* job = (CF_FiberJob*)param;
+	if (!job->fiber) {
+		job->fiber = s_acquire_fiber(job->pool);
+		job->fiber->job = job;
+	}
+
+	CF_FiberJob* prev = s_running_fiber_job;
+	s_running_fiber_job = job;
+	job->tag_depth = cf_alloc_tag_depth();
+	cf_coroutine_resume(job->fiber->co);
+	s_running_fiber_job = prev;
+
+	// When suspended, the counter goes up before this task's own decrement, so it never reads
+	// zero in between.
+	if (!job->fiber->job) {
+		s_release_fiber(job->pool, job->fiber);
+		cf_free(job);
+	} else if (job->wait_counter) {
+		// Held by the pool until the counter reaches zero.
+		cute_threadpool_add_task_after(job->pool, s_fiber_job_task, job, job->counter, job->wait_counter);
+	} else {
+		// Try again once the tasks queued ahead of it have had a chance to run.
+		cute_threadpool_add_task_shared(job->pool, s_fiber_job_task, job, job->counter);
+	}
+}
+
+// Thread-local state doesn't follow a fiber to the thread that resumes it. The allocation tag
+// stack is the one a job is likely to have open, so catch scopes left open across a suspend.
+static void s_suspend_fiber(CF_FiberJob* job)
+{
+	CF_ASSERT(cf_alloc_tag_depth() == job->tag_depth && "CF_ALLOC_TAG_SCOPE must not span a wait in a fiber job.");
+	cf_coroutine_yield(job->fiber->co);
+}
+
+void cf_threadpool_add_fiber_job(CF_Threadpool* pool, CF_TaskFn* task, void* param, CF_JobCounter* counter)
+{
+	CF_FiberJob* job = (CF_FiberJob*)cf_alloc(sizeof(CF_FiberJob));
+	job->task = task;
+	job->param = param;
+	job->pool = pool;
+	job->counter = counter;
+	job->fiber = NULL;
+	job->wait_counter = NULL;
+	job->tag_depth = 0;
+	cute_threadpool_add_task_with_counter(pool, s_fiber_job_task, job, counter);
+}
+
+bool cf_fiber_job_yield()
+{
+	CF_FiberJob* job = s_running_fiber_job;
+	if (!job) return false;
+	s_suspend_fiber(job);
+	return true;
+}
+
+void cf_threadpool_wait_counter(CF_Threadpool* pool, CF_JobCounter* counter)
+{
+	// Read the thread-local once. After a yield this fiber may be running on another thread.
+	CF_FiberJob* job = s_running_fiber_job;
+	if (job) {
+		if (cf_atomic_get(counter) <= 0) return;
+		cute_threadpool_kick(pool);
+		// The pool only notices counters reaching zero for its own tasks. Waiting on another
+		// pool's counter falls back to re-checking each time around.
+		job->wait_counter = pool == job->pool ? counter : NULL;
+		while (cf_atomic_get(counter) > 0) {
+			s_suspend_fiber(job);
+		}
+		job->wait_counter = NULL;
+	} else {
+		cute_threadpool_wait_counter(pool, counter);
+	}
+}
+
+struct CF_ParallelForChunk
+{
+	CF_ParallelForFn* fn;
+	void* udata;
+	int begin;
+	int end;
+};
+
+static void s_parallel_for_chunk(void* param)
+{
+	CF_ParallelForChunk* chunk = (CF_ParallelForChunk*)param;
+	chunk->fn(chunk->begin, chunk->end, chunk->udata);
+}
+
+void cf_parallel_for(CF_Threadpool* pool, int begin, int end, int grain, CF_ParallelForFn* fn, void* udata)
+{
+	// Chunk math is done in 64 bits, ranges near INT_MAX would overflow otherwise. Every chunk
+	// bound lands back inside [begin, end], so it fits an int again.
+	int64_t count = (int64_t)end - begin;
+	if (count <= 0) return;
+	int64_t chunk_grain = grain;
+	if (chunk_grain <= 0) {
+		// A few chunks per core leaves slack for stealing when chunks take uneven time.
+		int64_t chunk_target = cf_core_count() * 4;
+		chunk_grain = (count + chunk_target - 1) / chunk_target;
+	}
+	if (!pool || count <= chunk_grain) {
+		fn(begin, end, udata);
+		return;
+	}
+
+	// A grain of 1 over the whole int range is more chunks than an int can count.
+	if ((count + chunk_grain - 1) / chunk_grain > INT_MAX) chunk_grain = (count + INT_MAX - 1) / INT_MAX;
+	int chunk_count = (int)((count + chunk_grain - 1) / chunk_grain);
+	CF_ParallelForChunk chunks_on_stack[64];
+	CF_ParallelForChunk* chunks = chunk_count <= 64 ? chunks_on_stack : (CF_ParallelForChunk*)cf_alloc(sizeof(CF_ParallelForChunk) * chunk_count);
+
+	// The calling thread takes the first chunk itself instead of handing it to the pool.
+	CF_JobCounter counter = cf_make_job_counter();
+	for (int i = 1; i < chunk_count; ++i) {
+		CF_ParallelForChunk* chunk = chunks + i;
+		int64_t chunk_begin = begin + i * chunk_grain;
+		chunk->fn = fn;
+		chunk->udata = udata;
+		chunk->begin = (int)chunk_begin;
+		chunk->end = (int)(chunk_begin + chunk_grain < end ? chunk_begin + chunk_grain : end);
+		cute_threadpool_add_task_with_counter(pool, s_parallel_for_chunk, chunk, &counter);
+	}
+	cute_threadpool_kick(pool);
+	fn(begin, (int)(begin + chunk_grain), udata);
+	cf_threadpool_wait_counter(pool, &counter);
+
+	if (chunks != chunks_on_stack) cf_free(chunks);
+}
+
+static int s_pow2_at_least(int n)
+{
+	int p = 2;
+	while (p < n) p <<= 1;
+	return p;
+}
+
+// Producer and consumer indices live on separate cache lines so the two threads don't
+// ping-pong one line back and forth. Each side also keeps a cached copy of the other side's
+// index, and only re-reads the shared one when the cached copy says full (or empty).
+struct CF_SPSCQueue
+{
+	long long tail;
+	long long cached_head;
+	char pad0[CUTE_SYNC_CACHELINE_SIZE - sizeof(long long) * 2];
+	long long head;
+	long long cached_tail;
+	char pad1[CUTE_SYNC_CACHELINE_SIZE - sizeof(long long) * 2];
+	int mask;
+	int element_size;
+	char* elements;
+};
+
+CF_SPSCQueue* cf_make_spsc_queue(int capacity, int element_size)
+{
+	CF_ASSERT(capacity > 0 && element_size > 0);
+	capacity = s_pow2_at_least(capacity);
+	CF_SPSCQueue* q = (CF_SPSCQueue*)cf_aligned_alloc(sizeof(CF_SPSCQueue), CUTE_SYNC_CACHELINE_SIZE);
+	CF_MEMSET(q, 0, sizeof(CF_SPSCQueue));
+	q->mask = capacity - 1;
+	q->element_size = element_size;
+	q->elements = (char*)cf_alloc((size_t)capacity * element_size);
+	return q;
+}
+
+void cf_destroy_spsc_queue(CF_SPSCQueue* q)
+{
+	if (!q) return;
+	cf_free(q->elements);
+	cf_aligned_free(q);
+}
+
+bool cf_spsc_queue_push(CF_SPSCQueue* q, const void* element)
+{
+	long long tail = q->tail;
+	if (tail - q->cached_head > q->mask) {
+		q->cached_head = cute_load_acquire64_internal(&q->head);
+		if (tail - q->cached_head > q->mask) return false;
+	}
+	CF_MEMCPY(q->elements + (tail & q->mask) * q->element_size, element, q->element_size);
+	cute_store_release64_internal(&q->tail, tail + 1);
+	return true;
+}
+
+bool cf_spsc_queue_pop(CF_SPSCQueue* q, void* element)
+{
+	long long head = q->head;
+	if (head == q->cached_tail) {
+		q->cached_tail = cute_load_acquire64_internal(&q->tail);
+		if (head == q->cached_tail) return false;
+	}
+	CF_MEMCPY(element, q->elements + (head & q->mask) * q->element_size, q->element_size);
+	cute_store_release64_internal(&q->head, head + 1);
+	return true;
+}
+
+int cf_spsc_queue_count(CF_SPSCQueue* q)
+{
+	long long head = cute_load_acquire64_internal(&q->head);
+	long long tail = cute_load_acquire64_internal(&q->tail);
+	return tail > head ? (int)(tail - head) : 0;
+}
+
+// Dmitry Vyukov's bounded MPMC queue. Each cell begins with a sequence number, followed by
+// the element itself. A cell at position `pos` is free to write when its sequence equals
+// `pos`, and holds an element ready to read when its sequence equals `pos + 1`.
+struct CF_MPMCQueue
+{
+	cute_atomic64_t enqueue_pos;
+	char pad0[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	cute_atomic64_t dequeue_pos;
+	char pad1[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	int mask;
+	int element_size;
+	int cell_size;
+	char* cells;
+};
+
+static CF_INLINE long long* s_mpmc_seq(CF_MPMCQueue* q, long long pos)
+{
+	return (long long*)(q->cells + (pos & q->mask) * q->cell_size);
+}
+
+CF_MPMCQueue* cf_make_mpmc_queue(int capacity, int element_size)
+{
+	CF_ASSERT(capacity > 0 && element_size > 0);
+	capacity = s_pow2_at_least(capacity);
+	CF_MPMCQueue* q = (CF_MPMCQueue*)cf_aligned_alloc(sizeof(CF_MPMCQueue), CUTE_SYNC_CACHELINE_SIZE);
+	CF_MEMSET(q, 0, sizeof(CF_MPMCQueue));
+	q->mask = capacity - 1;
+	q->element_size = element_size;
+	q->cell_size = (int)sizeof(long long) + ((element_size + 7) & ~7);
+	q->cells = (char*)cf_alloc((size_t)capacity * q->cell_size);
+	for (int i = 0; i < capacity; ++i) {
+		*s_mpmc_seq(q, i) = i;
+	}
+	return q;
+}
+
+void cf_destroy_mpmc_queue(CF_MPMCQueue* q)
+{
+	if (!q) return;
+	cf_free(q->cells);
+	cf_aligned_free(q);
+}
+
+bool cf_mpmc_queue_push(CF_MPMCQueue* q, const void* element)
+{
+	long long pos = cute_atomic64_get(&q->enqueue_pos);
+	long long* seq;
+	for (;;) {
+		seq = s_mpmc_seq(q, pos);
+		long long diff = cute_load_acquire64_internal(seq) - pos;
+		if (diff == 0) {
+			if (cute_atomic64_cas(&q->enqueue_pos, pos, pos + 1)) break;
+			pos = cute_atomic64_get(&q->enqueue_pos);
+		} else if (diff < 0) {
+			// The cell still holds an element from one lap ago.
+			return false;
+		} else {
+			pos = cute_atomic64_get(&q->enqueue_pos);
+		}
+	}
+	CF_MEMCPY(seq + 1, element, q->element_size);
+	cute_store_release64_internal(seq, pos + 1);
+	return true;
+}
+
+bool cf_mpmc_queue_pop(CF_MPMCQueue* q, void* element)
+{
+	long long pos = cute_atomic64_get(&q->dequeue_pos);
+	long long* seq;
+	for (;;) {
+		seq = s_mpmc_seq(q, pos);
+		long long diff = cute_load_acquire64_internal(seq) - (pos + 1);
+		if (diff == 0) {
+			if (cute_atomic64_cas(&q->dequeue_pos, pos, pos + 1)) break;
+			pos = cute_atomic64_get(&q->dequeue_pos);
+		} else if (diff < 0) {
+			return false;
+		} else {
+			pos = cute_atomic64_get(&q->dequeue_pos);
+		}
+	}
+	CF_MEMCPY(element, seq + 1, q->element_size);
+	// Mark the cell free for the producer one lap ahead.
+	cute_store_release64_internal(seq, pos + q->mask + 1);
+	return true;
+}
+
+// Dmitry Vyukov's intrusive MPSC queue. Producers swap themselves in as the new head with a
+// single exchange, then link the previous head to themselves. The consumer walks from the tail.
+// A stub node keeps the list non-empty, so producers never touch the tail.
+struct CF_MPSCQueue
+{
+	CF_MPSCNode* head;
+	char pad0[CUTE_SYNC_CACHELINE_SIZE - sizeof(CF_MPSCNode*)];
+	CF_MPSCNode* tail;
+	CF_MPSCNode stub;
+};
+
+CF_MPSCQueue* cf_make_mpsc_queue()
+{
+	CF_MPSCQueue* q = (CF_MPSCQueue*)cf_aligned_alloc(sizeof(CF_MPSCQueue), CUTE_SYNC_CACHELINE_SIZE);
+	CF_MEMSET(q, 0, sizeof(CF_MPSCQueue));
+	q->head = &q->stub;
+	q->tail = &q->stub;
+	return q;
+}
+
+void cf_destroy_mpsc_queue(CF_MPSCQueue* q)
+{
+	cf_aligned_free(q);
+}
+
+void cf_mpsc_queue_push(CF_MPSCQueue* q, CF_MPSCNode* node)
+{
+	cute_store_release_ptr_internal((void**)&node->next, NULL);
+	CF_MPSCNode* prev = (CF_MPSCNode*)cute_atomic_ptr_set((void**)&q->head, node);
+	// Between the exchange above and this store the list is briefly broken; pop sees that as empty.
+	cute_store_release_ptr_internal((void**)&prev->next, node);
+}
+
+CF_MPSCNode* cf_mpsc_queue_pop(CF_MPSCQueue* q)
+{
+	CF_MPSCNode* tail = q->tail;
+	CF_MPSCNode* next = (CF_MPSCNode*)cute_load_acquire_ptr_internal((void**)&tail->next);
+	if (tail == &q->stub) {
+		if (!next) return NULL;
+		q->tail = next;
+		tail = next;
+		next = (CF_MPSCNode*)cute_load_acquire_ptr_internal((void**)&next->next);
+	}
+	if (next) {
+		q->tail = next;
+		return tail;
+	}
+	CF_MPSCNode* head = (CF_MPSCNode*)cute_atomic_ptr_get((void**)&q->head);
+	if (tail != head) {
+		// A producer is mid-push.
+		return NULL;
+	}
+	// Last real node -- push the stub back behind it so the node can be handed out.
+	cf_mpsc_queue_push(q, &q->stub);
+	next = (CF_MPSCNode*)cute_load_acquire_ptr_internal((void**)&tail->next);
+	if (next) {
+		q->tail = next;
+		return tail;
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Concurrent pool, after Bonwick's magazine allocator. Each thread caches two magazines, arrays
+// of free elements: `loaded` serves allocs and frees, and `previous` is always either full or
+// empty, so a thread flipping between alloc and free at a magazine boundary just swaps the two
+// instead of going to the depot. The depot is a pair of lock-free stacks of full and empty
+// magazines; the lock is only taken to grow the pool.
+
+#define CF_POOL_MAGAZINE_SIZE 32
+#define CF_POOL_MAX_CACHES 64
+#define CF_POOL_MAGAZINES_PER_CHUNK 64
+#define CF_POOL_MAX_MAGAZINE_CHUNKS 1024
+#define CF_POOL_NIL 0xFFFFFFFFull
+
+struct CF_PoolMagazine
+{
+	long long next; // Index of the next magazine down a depot stack, read racily by poppers.
+	int index;
+	int count;
+	void* elements[CF_POOL_MAGAZINE_SIZE];
+};
+
+struct CF_PoolCache
+{
+	CF_PoolMagazine* loaded;
+	CF_PoolMagazine* previous;
+	long long allocs; // Written only by the owning thread, read racily by cf_concurrent_pool_stats.
+	long long frees;
+	char pad[CUTE_SYNC_CACHELINE_SIZE - sizeof(void*) * 2 - sizeof(long long) * 2];
+};
+
+struct CF_ConcurrentPool
+{
+	CF_PoolCache caches[CF_POOL_MAX_CACHES];
+	// Depot stack heads. The low 32 bits index the top magazine, the high 32 bits count pops, so
+	// a pop racing with a pop-then-push of the same magazine (ABA) fails its CAS.
+	cute_atomic64_t depot_full;
+	char pad0[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	cute_atomic64_t depot_empty;
+	char pad1[CUTE_SYNC_CACHELINE_SIZE - sizeof(cute_atomic64_t)];
+	cute_atomic64_t high_water_mark;
+	long long shared_allocs; // By threads without a cache, under the lock.
+	long long shared_frees;
+	cute_atomic_int_t lock; // Guards everything below.
+	int element_size;
+	int element_count;
+	int alignment;
+	int magazine_count;
+	void* free_list; // Elements freed by threads without a cache.
+	/* dyna */ char** blocks;
+	// Magazines live in fixed chunks that are never freed before the pool is, so a stale index
+	// read by a losing CAS still points at valid memory.
+	CF_PoolMagazine* chunks[CF_POOL_MAX_MAGAZINE_CHUNKS];
+};
+
+// Cache slots are handed out process-wide: slot i of every pool belongs to the same thread,
+// and a thread that exits passes its slots (magazines included) on to the next thread.
+static cute_atomic_int_t s_pool_slots_lock;
+static unsigned long long s_pool_slots_taken;
+
+struct CF_PoolThreadSlot
+{
+	int index = -1; // -1 not assigned yet, -2 none were left.
+	~CF_PoolThreadSlot()
+	{
+		if (index < 0) return;
+		while (cute_atomic_set(&s_pool_slots_lock, 1)) CUTE_SYNC_YIELD();
+		s_pool_slots_taken &= ~(1ull << index);
+		cute_atomic_set(&s_pool_slots_lock, 0);
+	}
+};
+
+static thread_local CF_PoolThreadSlot s_pool_thread_slot;
+
+static int s_pool_thread_index()
+{
+	int index = s_pool_thread_slot.index;
+	if (index != -1) return index;
+	index = -2;
+	while (cute_atomic_set(&s_pool_slots_lock, 1)) CUTE_SYNC_YIELD();
+	for (int i = 0; i < CF_POOL_MAX_CACHES; ++i) {
+		if (!(s_pool_slots_taken & (1ull << i))) {
+			s_pool_slots_taken |= 1ull << i;
+			index = i;
+			break;
+		}
+	}
+	cute_atomic_set(&s_pool_slots_lock, 0);
+	s_pool_thread_slot.index = index;
+	return index;
+}
+
+static void s_pool_lock(CF_ConcurrentPool* pool)
+{
+	while (cute_atomic_set(&pool->lock, 1)) CUTE_SYNC_YIELD();
+}
+
+static void s_pool_unlock(CF_ConcurrentPool* pool)
+{
+	cute_atomic_set(&pool->lock, 0);
+}
+
+static CF_PoolMagazine* s_pool_magazine(CF_ConcurrentPool* pool, unsigned long long index)
+{
+	return pool->chunks[index / CF_POOL_MAGAZINES_PER_CHUNK] + index % CF_POOL_MAGAZINES_PER_CHUNK;
+}
+
+static void s_depot_push(cute_atomic64_t* depot, CF_PoolMagazine* m)
+{
+	unsigned long long head = (unsigned long long)cute_atomic64_get(depot);
+	while (1) {
+		CUTE_SYNC_RELAXED_STORE(&m->next, (long long)(head & CF_POOL_NIL));
+		unsigned long long top = (head & ~CF_POOL_NIL) | (unsigned)m->index;
+		if (cute_atomic64_cas(depot, (long long)head, (long long)top)) return;
+		head = (unsigned long long)cute_atomic64_get(depot);
+	}
+}
+
+static CF_PoolMagazine* s_depot_pop(CF_ConcurrentPool* pool, cute_atomic64_t* depot)
+{
+	unsigned long long head = (unsigned long long)cute_atomic64_get(depot);
+	while (1) {
+		unsigned long long index = head & CF_POOL_NIL;
+		if (index == CF_POOL_NIL) return NULL;
+		CF_PoolMagazine* m = s_pool_magazine(pool, index);
+		unsigned long long next = (unsigned long long)CUTE_SYNC_RELAXED_LOAD(&m->next);
+		unsigned long long top = ((head & ~CF_POOL_NIL) + (1ull << 32)) | (next & CF_POOL_NIL);
+		if (cute_atomic64_cas(depot, (long long)head, (long long)top)) return m;
+		head = (unsigned long long)cute_atomic64_get(depot);
+	}
+}
+
+static long long s_pool_live(CF_ConcurrentPool* pool)
+{
+	long long live = CUTE_SYNC_RELAXED_LOAD(&pool->shared_allocs) - CUTE_SYNC_RELAXED_LOAD(&pool->shared_frees);
+	for (int i = 0; i < CF_POOL_MAX_CACHES; ++i) {
+		live += CUTE_SYNC_RELAXED_LOAD(&pool->caches[i].allocs) - CUTE_SYNC_RELAXED_LOAD(&pool->caches[i].frees);
+	}
+	return live;
+}
+
+static void s_pool_sample_high_water_mark(CF_ConcurrentPool* pool)
+{
+	long long live = s_pool_live(pool);
+	long long peak = cute_atomic64_get(&pool->high_water_mark);
+	while (live > peak && !cute_atomic64_cas(&pool->high_water_mark, peak, live)) {
+		peak = cute_atomic64_get(&pool->high_water_mark);
+	}
+}
+
+// Lock must be held. Returns NULL once every magazine index is in use.
+static CF_PoolMagazine* s_pool_new_magazine(CF_ConcurrentPool* pool)
+{
+	if (pool->magazine_count == CF_POOL_MAX_MAGAZINE_CHUNKS * CF_POOL_MAGAZINES_PER_CHUNK) return NULL;
+	int chunk = pool->magazine_count / CF_POOL_MAGAZINES_PER_CHUNK;
+	if (!pool->chunks[chunk]) {
+		pool->chunks[chunk] = (CF_PoolMagazine*)cf_alloc(sizeof(CF_PoolMagazine) * CF_POOL_MAGAZINES_PER_CHUNK);
+	}
+	CF_PoolMagazine* m = pool->chunks[chunk] + pool->magazine_count % CF_POOL_MAGAZINES_PER_CHUNK;
+	m->next = (long long)CF_POOL_NIL;
+	m->index = pool->magazine_count++;
+	m->count = 0;
+	return m;
+}
+
+// Lock must be held. Returns a non-empty magazine, pushing any extra ones made along the way
+// onto the full depot, or NULL if elements could only go to the shared free list.
+static CF_PoolMagazine* s_pool_grow(CF_ConcurrentPool* pool)
+{
+	// Elements freed by threads without a cache come back into circulation first.
+	if (pool->free_list) {
+		CF_PoolMagazine* m = s_depot_pop(pool, &pool->depot_empty);
+		if (!m) m = s_pool_new_magazine(pool);
+		if (!m) return NULL;
+		while (pool->free_list && m->count < CF_POOL_MAGAZINE_SIZE) {
+			m->elements[m->count++] = pool->free_list;
+			pool->free_list = *(void**)pool->free_list;
+		}
+		return m;
+	}
+
+	char* block = (char*)cf_aligned_alloc((size_t)pool->element_size * pool->element_count, pool->alignment);
+	apush(pool->blocks, block);
+	CF_PoolMagazine* result = NULL;
+	for (int i = pool->element_count - 1; i >= 0;) {
+		CF_PoolMagazine* m = s_depot_pop(pool, &pool->depot_empty);
+		if (!m) m = s_pool_new_magazine(pool);
+		if (!m) {
+			for (; i >= 0; --i) {
+				void* element = block + (size_t)pool->element_size * i;
+				*(void**)element = pool->free_list;
+				pool->free_list = element;
+			}
+			break;
+		}
+		// Filled back to front, so allocations walk forward through the block.
+		while (m->count < CF_POOL_MAGAZINE_SIZE && i >= 0) {
+			m->elements[m->count++] = block + (size_t)pool->element_size * i--;
+		}
+		if (!result) result = m;
+		else s_depot_push(&pool->depot_full, m);
+	}
+	return result;
+}
+
+static void* s_pool_alloc_shared(CF_ConcurrentPool* pool)
+{
+	s_pool_lock(pool);
+	if (!pool->free_list) {
+		CF_PoolMagazine* m = s_depot_pop(pool, &pool->depot_full);
+		if (!m) m = s_pool_grow(pool);
+		if (m) {
+			for (int i = 0; i < m->count; ++i) {
+				*(void**)m->elements[i] = pool->free_list;
+				pool->free_list = m->elements[i];
+			}
+			m->count = 0;
+			s_depot_push(&pool->depot_empty, m);
+		}
+	}
+	void* element = pool->free_list;
+	if (element) {
+		pool->free_list = *(void**)element;
+		CUTE_SYNC_RELAXED_STORE(&pool->shared_allocs, pool->shared_allocs + 1);
+	}
+	s_pool_unlock(pool);
+	s_pool_sample_high_water_mark(pool);
+	return element;
+}
+
+static void s_pool_free_shared(CF_ConcurrentPool* pool, void* element)
+{
+	s_pool_lock(pool);
+	*(void**)element = pool->free_list;
+	pool->free_list = element;
+	CUTE_SYNC_RELAXED_STORE(&pool->shared_frees, pool->shared_frees + 1);
+	s_pool_unlock(pool);
+}
+
+CF_ConcurrentPool* cf_make_concurrent_pool(int element_size, int element_count, int alignment)
+{
+	CF_ASSERT(element_count > 0);
+	element_size = element_size > (int)sizeof(void*) ? element_size : (int)sizeof(void*);
+	element_size = CF_ALIGN_FORWARD(element_size, alignment);
+	CF_ConcurrentPool* pool = (CF_ConcurrentPool*)cf_aligned_alloc(sizeof(CF_ConcurrentPool), CUTE_SYNC_CACHELINE_SIZE);
+	CF_MEMSET(pool, 0, sizeof(CF_ConcurrentPool));
+	pool->depot_full.i = (long long)CF_POOL_NIL;
+	pool->depot_empty.i = (long long)CF_POOL_NIL;
+	pool->element_size = element_size;
+	pool->element_count = element_count;
+	pool->alignment = alignment;
+	return pool;
+}
+
+void cf_destroy_concurrent_pool(CF_ConcurrentPool* pool)
+{
+	for (int i = 0; i < asize(pool->blocks); ++i) {
+		cf_aligned_free(pool->blocks[i]);
+	}
+	afree(pool->blocks);
+	for (int i = 0; i < CF_POOL_MAX_MAGAZINE_CHUNKS && pool->chunks[i]; ++i) {
+		cf_free(pool->chunks[i]);
+	}
+	cf_aligned_free(pool);
+}
+
+void* cf_concurrent_pool_alloc(CF_ConcurrentPool* pool)
+{
+	int index = s_pool_thread_index();
+	if (index < 0) return s_pool_alloc_shared(pool);
+	CF_PoolCache* c = pool->caches + index;
+	CF_PoolMagazine* m = c->loaded;
+	if (!m || !m->count) {
+		if (c->previous && c->previous->count) {
+			c->loaded = c->previous;
+			c->previous = m;
+		} else {
+			CF_PoolMagazine* full = s_depot_pop(pool, &pool->depot_full);
+			if (!full) {
+				s_pool_lock(pool);
+				// Another thread may have refilled the depot while this one waited on the lock.
+				full = s_depot_pop(pool, &pool->depot_full);
+				if (!full) full = s_pool_grow(pool);
+				s_pool_unlock(pool);
+				if (!full) return s_pool_alloc_shared(pool);
+			}
+			if (c->previous) s_depot_push(&pool->depot_empty, c->previous);
+			c->previous = m;
+			c->loaded = full;
+			s_pool_sample_high_water_mark(pool);
+		}
+		m = c->loaded;
+	}
+	CUTE_SYNC_RELAXED_STORE(&c->allocs, c->allocs + 1);
+	return m->elements[--m->count];
+}
+
+void cf_concurrent_pool_free(CF_ConcurrentPool* pool, void* element)
+{
+	int index = s_pool_thread_index();
+	if (index < 0) {
+		s_pool_free_shared(pool, element);
+		return;
+	}
+	CF_PoolCache* c = pool->caches + index;
+	CF_PoolMagazine* m = c->loaded;
+	if (!m || m->count == CF_POOL_MAGAZINE_SIZE) {
+		if (c->previous && !c->previous->count) {
+			c->loaded = c->previous;
+			c->previous = m;
+		} else {
+			CF_PoolMagazine* empty = s_depot_pop(pool, &pool->depot_empty);
+			if (!empty) {
+				s_pool_lock(pool);
+				empty = s_pool_new_magazine(pool);
+				s_pool_unlock(pool);
+				if (!empty) {
+					s_pool_free_shared(pool, element);
+					return;
+				}
+			}
+			if (c->previous) s_depot_push(&pool->depot_full, c->previous);
+			c->previous = m;
+			c->loaded = empty;
+		}
+		m = c->loaded;
+	}
+	CUTE_SYNC_RELAXED_STORE(&c->frees, c->frees + 1);
+	m->elements[m->count++] = element;
+}
+
+CF_MemoryPoolStats cf_concurrent_pool_stats(CF_ConcurrentPool* pool)
+{
+	CF_MemoryPoolStats stats;
+	s_pool_sample_high_water_mark(pool);
+	stats.live_elements = (int)s_pool_live(pool);
+	stats.high_water_mark = (int)cute_atomic64_get(&pool->high_water_mark);
+	s_pool_lock(pool);
+	stats.block_count = asize(pool->blocks);
+	s_pool_unlock(pool);
+	stats.elements_per_block = pool->element_count;
+	return stats;
 }
@@ -8,11 +8,24 @@
 #include <cute_networking.h>
 #include <cute_alloc.h>
 
+#include <internal/cute_alloc_internal.h>
+
 // This entire file makes no sense for web builds, since web doesn't allow UDP.
 #ifndef CF_EMSCRIPTEN
 
+// Everything cute_net allocates is tagged for the allocation tracker, and credited to the
+// cute_net function asking for it.
+static CF_NOINLINE void* s_net_alloc(size_t size)
+{
+	CF_ALLOC_TAG_SCOPE("networking");
+	void* prev = cf_alloc_set_callsite(CF_RETURN_ADDRESS());
+	void* ptr = cf_alloc(size);
+	cf_alloc_set_callsite(prev);
+	return ptr;
+}
+
 #define CUTE_NET_IMPLEMENTATION
-#define CN_ALLOC(size, ctx) cf_alloc(size)
+#define CN_ALLOC(size, ctx) s_net_alloc(size)
 #define CN_FREE(mem, ctx) cf_free(mem)
 #include <cute/cute_net.h>
 
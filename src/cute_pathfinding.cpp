@@ -0,0 +1,753 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include <cute_pathfinding.h>
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_math.h>
+#include <cute_priority_queue.h>
+#include <cute_time.h>
+
+#include <internal/cute_alloc_internal.h>
+
+using namespace Cute;
+
+// Cells are numbered `y * w + x`. Searches keep their per-cell state in flat arrays tagged with a
+// generation number, so starting a new search is just bumping the generation instead of clearing
+// every cell. The inner loops index these through `data()`, skipping `Array`'s bounds checks.
+//
+// The hierarchy for HPA* splits the grid into square clusters. Wherever a run of walkable cells
+// crosses the border between two clusters, a pair of abstract nodes is placed on either side of it,
+// joined by an edge of cost 1. Nodes within one cluster are joined by the cost of the shortest path
+// between them that stays inside the cluster. Searches run A* over this small graph, then fill in
+// each hop with an A* bounded to a single cluster.
+
+#define CF_PATH_SQRT2 1.41421356f
+
+struct CF_PathRect
+{
+	int x0, y0, x1, y1; // Inclusive.
+};
+
+struct CF_PathScratch;
+
+struct CF_PathGrid
+{
+	int w, h;
+	bool diagonals;
+	Array<uint8_t> blocked;
+
+	bool hierarchy_valid;
+	int cluster_size;
+	int clusters_w, clusters_h;
+	Array<int> node_cells;
+	Array<int> node_clusters;
+	Array<int> node_at;        // Abstract node of each cell, or -1.
+	Array<int> cluster_starts; // Nodes of cluster k are `cluster_nodes[cluster_starts[k]]` to `cluster_nodes[cluster_starts[k + 1]]`.
+	Array<int> cluster_nodes;
+	Array<int> edge_starts;    // Edges of node i are `edge_starts[i]` to `edge_starts[i + 1]`.
+	Array<int> edge_to;
+	Array<float> edge_costs;
+
+	// Idle search scratch, handed out to one search at a time and freed along with the grid.
+	mutable CF_AtomicInt scratch_lock;
+	mutable Array<CF_PathScratch*> scratch_free;
+};
+
+struct CF_PathLink
+{
+	int node;
+	float cost;
+};
+
+struct CF_PathScratch
+{
+	// Per cell.
+	Array<float> g;
+	Array<int> parent;
+	Array<uint32_t> stamp;
+	uint32_t generation = 0;
+	IndexedPriorityQueue<4> open;
+
+	// Per abstract node, plus virtual start and goal nodes at the end.
+	Array<float> ag;
+	Array<int> aparent;
+	Array<uint32_t> astamp;
+	uint32_t ageneration = 0;
+	IndexedPriorityQueue<4> aopen;
+	Array<CF_PathLink> start_links;
+	Array<CF_PathLink> goal_links;
+
+	Array<int> cells;
+	Array<int> segment;
+};
+
+// Scratch is recycled through its grid, so the per-cell arrays are sized once per grid and then only
+// ever see generation bumps, not reallocations or clears. A grid keeps as many as it has had searches
+// running at once.
+static CF_PathScratch* s_acquire_scratch(const CF_PathGrid* grid)
+{
+	while (cf_atomic_set(&grid->scratch_lock, 1)) {
+		cf_sleep(0);
+	}
+	CF_PathScratch* s = grid->scratch_free.count() ? grid->scratch_free.pop() : NULL;
+	cf_atomic_set(&grid->scratch_lock, 0);
+	return s ? s : CF_NEW(CF_PathScratch);
+}
+
+static void s_release_scratch(const CF_PathGrid* grid, CF_PathScratch* s)
+{
+	while (cf_atomic_set(&grid->scratch_lock, 1)) {
+		cf_sleep(0);
+	}
+	grid->scratch_free.add(s);
+	cf_atomic_set(&grid->scratch_lock, 0);
+}
+
+static const int s_dirs[8][2] = {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+	{ 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 },
+};
+
+// The two side directions each diagonal in `s_dirs` squeezes between.
+static const int s_sides[8][2] = {
+	{ 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 3 },
+	{ 0, 2 }, { 0, 3 }, { 1, 2 }, { 1, 3 },
+};
+
+static CF_INLINE bool s_walkable(const CF_PathGrid* grid, int x, int y)
+{
+	return x >= 0 && y >= 0 && x < grid->w && y < grid->h && !grid->blocked.data()[y * grid->w + x];
+}
+
+static CF_INLINE int s_sign(int x)
+{
+	return (x > 0) - (x < 0);
+}
+
+static CF_INLINE float s_octile(int ax, int ay, int bx, int by)
+{
+	int dx = cf_abs(ax - bx);
+	int dy = cf_abs(ay - by);
+	return (float)(dx + dy) + (CF_PATH_SQRT2 - 2.0f) * (float)cf_min(dx, dy);
+}
+
+static CF_INLINE float s_heuristic(const CF_PathGrid* grid, int ax, int ay, int bx, int by)
+{
+	if (grid->diagonals) return s_octile(ax, ay, bx, by);
+	return (float)(cf_abs(ax - bx) + cf_abs(ay - by));
+}
+
+static CF_INLINE bool s_in_rect(CF_PathRect r, int x, int y)
+{
+	return x >= r.x0 && y >= r.y0 && x <= r.x1 && y <= r.y1;
+}
+
+static CF_INLINE int s_cluster_of(const CF_PathGrid* grid, int x, int y)
+{
+	return (y / grid->cluster_size) * grid->clusters_w + x / grid->cluster_size;
+}
+
+static CF_PathRect s_cluster_rect(const CF_PathGrid* grid, int cluster)
+{
+	CF_PathRect r;
+	r.x0 = (cluster % grid->clusters_w) * grid->cluster_size;
+	r.y0 = (cluster / grid->clusters_w) * grid->cluster_size;
+	r.x1 = cf_min(r.x0 + grid->cluster_size, grid->w) - 1;
+	r.y1 = cf_min(r.y0 + grid->cluster_size, grid->h) - 1;
+	return r;
+}
+
+static void s_begin_search(const CF_PathGrid* grid, CF_PathScratch* s)
+{
+	int cell_count = grid->w * grid->h;
+	if (s->stamp.count() != cell_count) {
+		s->g.ensure_count(cell_count);
+		s->parent.ensure_count(cell_count);
+		s->stamp.ensure_count(cell_count);
+	}
+	if (++s->generation == 0) {
+		CF_MEMSET(s->stamp.data(), 0, sizeof(uint32_t) * cell_count);
+		s->generation = 1;
+	}
+}
+
+static CF_INLINE void s_visit(CF_PathScratch* s, int cell, float g, int parent)
+{
+	s->stamp.data()[cell] = s->generation;
+	s->g.data()[cell] = g;
+	s->parent.data()[cell] = parent;
+}
+
+static CF_INLINE bool s_visited(const CF_PathScratch* s, int cell)
+{
+	return s->stamp.data()[cell] == s->generation;
+}
+
+// Appends the cells from the search's start to `cell` onto `out`.
+static void s_trace(const CF_PathScratch* s, int cell, Array<int>* out)
+{
+	int first = out->count();
+	while (cell >= 0) {
+		out->add(cell);
+		cell = s->parent.data()[cell];
+	}
+	int* a = out->data() + first;
+	int* b = out->data() + out->count() - 1;
+	while (a < b) {
+		int t = *a; *a = *b; *b = t;
+		++a; --b;
+	}
+}
+
+// A* from `start` to `goal` that never leaves `rect`. With `goal` as -1 this is Dijkstra, visiting every
+// cell in `rect` reachable from `start`, and leaving their distances in `s->g`. Dijkstra can stop early
+// once `node_count` abstract nodes numbered `first_node` or above have their final distances.
+static bool s_search(const CF_PathGrid* grid, CF_PathScratch* s, int start, int goal, CF_PathRect rect, int first_node = 0, int node_count = 0)
+{
+	s_begin_search(grid, s);
+	int w = grid->w;
+	int gx = goal >= 0 ? goal % w : 0;
+	int gy = goal >= 0 ? goal / w : 0;
+	int dir_count = grid->diagonals ? 8 : 4;
+	s_visit(s, start, 0, -1);
+	s->open.push_or_decrease(start, 0);
+
+	int cell;
+	while (s->open.pop_min(&cell)) {
+		if (cell == goal || (node_count && grid->node_at.data()[cell] >= first_node && --node_count == 0)) {
+			s->open.clear();
+			return true;
+		}
+		int x = cell % w;
+		int y = cell / w;
+		float g = s->g.data()[cell];
+		bool open[8];
+		for (int i = 0; i < dir_count; ++i) {
+			int nx = x + s_dirs[i][0];
+			int ny = y + s_dirs[i][1];
+			open[i] = s_in_rect(rect, nx, ny) && s_walkable(grid, nx, ny);
+		}
+		for (int i = 0; i < dir_count; ++i) {
+			// Diagonals can't cut corners. Both sides of a diagonal inside `rect` are inside it too.
+			if (!open[i] || !open[s_sides[i][0]] || !open[s_sides[i][1]]) continue;
+			int nx = x + s_dirs[i][0];
+			int ny = y + s_dirs[i][1];
+			int next = ny * w + nx;
+			float ng = g + (i >= 4 ? CF_PATH_SQRT2 : 1.0f);
+			if (s_visited(s, next) && ng >= s->g.data()[next]) continue;
+			s_visit(s, next, ng, cell);
+			s->open.push_or_decrease(next, goal >= 0 ? ng + s_heuristic(grid, nx, ny, gx, gy) : ng);
+		}
+	}
+	return goal < 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Jump point search.
+
+// The variant of JPS that never cuts corners, so it finds the same paths as `s_search`. Jumps walk in
+// a straight line until they hit a wall, the goal, or a cell that a shortest path might turn at.
+
+static int s_jump_straight(const CF_PathGrid* grid, int x, int y, int dx, int dy, int gx, int gy)
+{
+	while (1) {
+		x += dx;
+		y += dy;
+		if (!s_walkable(grid, x, y)) return -1;
+		if (x == gx && y == gy) return y * grid->w + x;
+		if (dx) {
+			if ((s_walkable(grid, x, y - 1) && !s_walkable(grid, x - dx, y - 1)) || (s_walkable(grid, x, y + 1) && !s_walkable(grid, x - dx, y + 1))) {
+				return y * grid->w + x;
+			}
+		} else {
+			if ((s_walkable(grid, x - 1, y) && !s_walkable(grid, x - 1, y - dy)) || (s_walkable(grid, x + 1, y) && !s_walkable(grid, x + 1, y - dy))) {
+				return y * grid->w + x;
+			}
+		}
+	}
+}
+
+static int s_jump_diagonal(const CF_PathGrid* grid, int x, int y, int dx, int dy, int gx, int gy)
+{
+	while (1) {
+		if (!s_walkable(grid, x + dx, y) || !s_walkable(grid, x, y + dy)) return -1;
+		x += dx;
+		y += dy;
+		if (!s_walkable(grid, x, y)) return -1;
+		if (x == gx && y == gy) return y * grid->w + x;
+		if (s_jump_straight(grid, x, y, dx, 0, gx, gy) >= 0 || s_jump_straight(grid, x, y, 0, dy, gx, gy) >= 0) {
+			return y * grid->w + x;
+		}
+	}
+}
+
+static bool s_jps(const CF_PathGrid* grid, CF_PathScratch* s, int start, int goal)
+{
+	s_begin_search(grid, s);
+	int w = grid->w;
+	int gx = goal % w;
+	int gy = goal / w;
+	s_visit(s, start, 0, -1);
+	s->open.push_or_decrease(start, 0);
+
+	int cell;
+	while (s->open.pop_min(&cell)) {
+		if (cell == goal) {
+			s->open.clear();
+			return true;
+		}
+		int x = cell % w;
+		int y = cell / w;
+		float g = s->g.data()[cell];
+
+		// Prune directions by the direction we arrived from.
+		int dirs[8][2];
+		int dir_count = 0;
+		int parent = s->parent.data()[cell];
+		if (parent < 0) {
+			for (int i = 0; i < 8; ++i) {
+				dirs[i][0] = s_dirs[i][0];
+				dirs[i][1] = s_dirs[i][1];
+			}
+			dir_count = 8;
+		} else {
+			int dx = s_sign(x - parent % w);
+			int dy = s_sign(y - parent / w);
+			if (dx && dy) {
+				int d[3][2] = { { dx, 0 }, { 0, dy }, { dx, dy } };
+				for (int i = 0; i < 3; ++i) {
+					dirs[dir_count][0] = d[i][0];
+					dirs[dir_count][1] = d[i][1];
+					++dir_count;
+				}
+			} else {
+				// Sideways neighbors are always kept when moving straight, as walls can appear beside them without a forced neighbor.
+				int px = dy ? 1 : 0;
+				int py = dx ? 1 : 0;
+				int d[5][2] = { { dx, dy }, { dx + px, dy + py }, { dx - px, dy - py }, { px, py }, { -px, -py } };
+				for (int i = 0; i < 5; ++i) {
+					dirs[dir_count][0] = d[i][0];
+					dirs[dir_count][1] = d[i][1];
+					++dir_count;
+				}
+			}
+		}
+
+		for (int i = 0; i < dir_count; ++i) {
+			int dx = dirs[i][0];
+			int dy = dirs[i][1];
+			int next = dx && dy ? s_jump_diagonal(grid, x, y, dx, dy, gx, gy) : s_jump_straight(grid, x, y, dx, dy, gx, gy);
+			if (next < 0) continue;
+			int nx = next % w;
+			int ny = next / w;
+			float ng = g + s_octile(x, y, nx, ny);
+			if (s_visited(s, next) && ng >= s->g.data()[next]) continue;
+			s_visit(s, next, ng, cell);
+			s->open.push_or_decrease(next, ng + s_octile(nx, ny, gx, gy));
+		}
+	}
+	return false;
+}
+
+// Fills in the straight and diagonal runs between consecutive jump points.
+static void s_trace_jumps(const CF_PathGrid* grid, const CF_PathScratch* s, int goal, Array<int>* out, Array<int>* jumps)
+{
+	jumps->clear();
+	s_trace(s, goal, jumps);
+	int w = grid->w;
+	out->add((*jumps)[0]);
+	for (int i = 1; i < jumps->count(); ++i) {
+		int x = (*jumps)[i - 1] % w;
+		int y = (*jumps)[i - 1] / w;
+		int tx = (*jumps)[i] % w;
+		int ty = (*jumps)[i] / w;
+		int dx = s_sign(tx - x);
+		int dy = s_sign(ty - y);
+		while (x != tx || y != ty) {
+			x += dx;
+			y += dy;
+			out->add(y * w + x);
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Hierarchy.
+
+static int s_add_node(CF_PathGrid* grid, int x, int y)
+{
+	int cell = y * grid->w + x;
+	int node = grid->node_at[cell];
+	if (node < 0) {
+		node = grid->node_cells.count();
+		grid->node_at[cell] = node;
+		grid->node_cells.add(cell);
+		grid->node_clusters.add(s_cluster_of(grid, x, y));
+	}
+	return node;
+}
+
+struct CF_PathEdge
+{
+	int from, to;
+	float cost;
+};
+
+// Places nodes along one cluster border. `x, y` walks the near side of the border in steps of `sx, sy`,
+// and `ox, oy` points across it.
+static void s_add_entrances(CF_PathGrid* grid, Array<CF_PathEdge>* edges, int x, int y, int sx, int sy, int ox, int oy, int length)
+{
+	int run = 0;
+	for (int i = 0; i <= length; ++i) {
+		int ax = x + sx * i;
+		int ay = y + sy * i;
+		bool open = i < length && s_walkable(grid, ax, ay) && s_walkable(grid, ax + ox, ay + oy);
+		if (open) {
+			++run;
+			continue;
+		}
+		if (run) {
+			// Short openings get one crossing in the middle, long ones a crossing at each end.
+			int first = i - run;
+			int last = i - 1;
+			int picks[2] = { (first + last) / 2, last };
+			int pick_count = 1;
+			if (run >= 6) {
+				picks[0] = first;
+				pick_count = 2;
+			}
+			for (int j = 0; j < pick_count; ++j) {
+				int px = x + sx * picks[j];
+				int py = y + sy * picks[j];
+				int a = s_add_node(grid, px, py);
+				int b = s_add_node(grid, px + ox, py + oy);
+				edges->add({ a, b, 1.0f });
+				edges->add({ b, a, 1.0f });
+			}
+		}
+		run = 0;
+	}
+}
+
+// Counting sort of `keys` into `starts` (one more than `key_count` long) and `order`.
+static void s_bucket(const int* keys, int count, int key_count, Array<int>* starts, Array<int>* order)
+{
+	starts->ensure_count(key_count + 1);
+	order->ensure_count(count);
+	CF_MEMSET(starts->data(), 0, sizeof(int) * (key_count + 1));
+	for (int i = 0; i < count; ++i) (*starts)[keys[i]]++;
+	for (int k = 1; k <= key_count; ++k) (*starts)[k] += (*starts)[k - 1];
+	// Fill back to front, leaving starts[k] at the beginning of bucket k.
+	for (int i = count - 1; i >= 0; --i) (*order)[--(*starts)[keys[i]]] = i;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Searches.
+
+static bool s_hpa(const CF_PathGrid* grid, CF_PathScratch* s, int start, int goal, Array<int>* out)
+{
+	int w = grid->w;
+	int sx = start % w, sy = start / w;
+	int gx = goal % w, gy = goal / w;
+	int start_cluster = s_cluster_of(grid, sx, sy);
+	int goal_cluster = s_cluster_of(grid, gx, gy);
+
+	// Paths within a single cluster usually don't need the hierarchy at all.
+	if (start_cluster == goal_cluster && s_search(grid, s, start, goal, s_cluster_rect(grid, start_cluster))) {
+		s_trace(s, goal, out);
+		return true;
+	}
+
+	// Link the start and goal to the nodes of their clusters.
+	Array<CF_PathLink>* links[2] = { &s->start_links, &s->goal_links };
+	int ends[2] = { start, goal };
+	int clusters[2] = { start_cluster, goal_cluster };
+	for (int i = 0; i < 2; ++i) {
+		links[i]->clear();
+		int begin = grid->cluster_starts[clusters[i]];
+		int end = grid->cluster_starts[clusters[i] + 1];
+		s_search(grid, s, ends[i], -1, s_cluster_rect(grid, clusters[i]), 0, end - begin);
+		for (int j = begin; j < end; ++j) {
+			int node = grid->cluster_nodes[j];
+			int cell = grid->node_cells[node];
+			if (s_visited(s, cell)) links[i]->add({ node, s->g[cell] });
+		}
+		if (!links[i]->count()) return false;
+	}
+
+	// A* over the abstract graph, with virtual nodes for the start and goal.
+	int node_count = grid->node_cells.count();
+	int vstart = node_count;
+	int vgoal = node_count + 1;
+	if (s->astamp.count() != node_count + 2) {
+		s->ag.ensure_count(node_count + 2);
+		s->aparent.ensure_count(node_count + 2);
+		s->astamp.ensure_count(node_count + 2);
+	}
+	if (++s->ageneration == 0) {
+		CF_MEMSET(s->astamp.data(), 0, sizeof(uint32_t) * (node_count + 2));
+		s->ageneration = 1;
+	}
+	s->astamp[vstart] = s->ageneration;
+	s->ag[vstart] = 0;
+	s->aparent[vstart] = -1;
+	s->aopen.push_or_decrease(vstart, 0);
+
+	bool found = false;
+	int node;
+	while (s->aopen.pop_min(&node)) {
+		if (node == vgoal) {
+			found = true;
+			s->aopen.clear();
+			break;
+		}
+		float g = s->ag[node];
+		const CF_PathLink* link_ptr = NULL;
+		int link_count = 0;
+		int edge_begin = 0, edge_end = 0;
+		if (node == vstart) {
+			link_ptr = s->start_links.data();
+			link_count = s->start_links.count();
+		} else {
+			edge_begin = grid->edge_starts[node];
+			edge_end = grid->edge_starts[node + 1];
+			if (grid->node_clusters[node] == goal_cluster) {
+				link_ptr = s->goal_links.data();
+				link_count = s->goal_links.count();
+			}
+		}
+		int neighbor_count = (edge_end - edge_begin) + link_count;
+		for (int i = 0; i < neighbor_count; ++i) {
+			int next;
+			float cost;
+			if (i < edge_end - edge_begin) {
+				next = grid->edge_to[edge_begin + i];
+				cost = grid->edge_costs[edge_begin + i];
+			} else {
+				const CF_PathLink* link = link_ptr + (i - (edge_end - edge_begin));
+				if (node == vstart) {
+					next = link->node;
+				} else if (link->node == node) {
+					next = vgoal;
+				} else {
+					continue;
+				}
+				cost = link->cost;
+			}
+			float ng = g + cost;
+			if (s->astamp[next] == s->ageneration && ng >= s->ag[next]) continue;
+			s->astamp[next] = s->ageneration;
+			s->ag[next] = ng;
+			s->aparent[next] = node;
+			int cell = next == vgoal ? goal : grid->node_cells[next];
+			s->aopen.push_or_decrease(next, ng + s_heuristic(grid, cell % w, cell / w, gx, gy));
+		}
+	}
+	if (!found) return false;
+
+	// Walk the abstract path back into cells, then refine each hop within its cluster.
+	Array<int>& hops = s->segment;
+	hops.clear();
+	for (int n = s->aparent[vgoal]; n != vstart; n = s->aparent[n]) {
+		hops.add(grid->node_cells[n]);
+	}
+	hops.add(start);
+	hops.reverse();
+	hops.add(goal);
+	out->add(start);
+	for (int i = 1; i < hops.count(); ++i) {
+		int a = hops[i - 1];
+		int b = hops[i];
+		if (a == b) continue;
+		int cluster = s_cluster_of(grid, a % w, a / w);
+		if (cluster != s_cluster_of(grid, b % w, b / w)) {
+			// Crossing between clusters, always a single step.
+			out->add(b);
+			continue;
+		}
+		bool ok = s_search(grid, s, a, b, s_cluster_rect(grid, cluster));
+		CF_ASSERT(ok);
+		if (!ok) return false;
+		out->pop(); // The trace starts with `a` again.
+		s_trace(s, b, out);
+	}
+	return true;
+}
+
+static int s_find_path(const CF_PathGrid* grid, CF_PathScratch* s, CF_PathCell start, CF_PathCell goal, CF_PathAlgorithm algorithm, CF_PathCell* path, int capacity)
+{
+	if (!s_walkable(grid, start.x, start.y) || !s_walkable(grid, goal.x, goal.y)) return 0;
+	int w = grid->w;
+	int start_cell = start.y * w + start.x;
+	int goal_cell = goal.y * w + goal.x;
+	CF_PathRect all = { 0, 0, grid->w - 1, grid->h - 1 };
+	Array<int>& cells = s->cells;
+	cells.clear();
+
+	if (algorithm == CF_PATH_ALGORITHM_JPS && grid->diagonals) {
+		if (s_jps(grid, s, start_cell, goal_cell)) s_trace_jumps(grid, s, goal_cell, &cells, &s->segment);
+	} else if (algorithm == CF_PATH_ALGORITHM_HPA && grid->hierarchy_valid) {
+		if (!s_hpa(grid, s, start_cell, goal_cell, &cells)) cells.clear();
+	} else {
+		if (s_search(grid, s, start_cell, goal_cell, all)) s_trace(s, goal_cell, &cells);
+	}
+
+	int count = cells.count();
+	for (int i = 0; i < count && i < capacity; ++i) {
+		path[i].x = cells[i] % w;
+		path[i].y = cells[i] / w;
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Public API.
+
+CF_PathGrid* cf_make_path_grid(int w, int h)
+{
+	CF_ASSERT(w > 0 && h > 0);
+	CF_PathGrid* grid = CF_NEW(CF_PathGrid);
+	grid->w = w;
+	grid->h = h;
+	grid->diagonals = true;
+	grid->blocked.ensure_count(w * h);
+	grid->hierarchy_valid = false;
+	grid->cluster_size = 0;
+	grid->clusters_w = 0;
+	grid->clusters_h = 0;
+	grid->scratch_lock = cf_atomic_zero();
+	return grid;
+}
+
+void cf_destroy_path_grid(CF_PathGrid* grid)
+{
+	if (!grid) return;
+	for (int i = 0; i < grid->scratch_free.count(); ++i) {
+		CF_PathScratch* s = grid->scratch_free[i];
+		s->~CF_PathScratch();
+		CF_FREE(s);
+	}
+	grid->~CF_PathGrid();
+	CF_FREE(grid);
+}
+
+void cf_path_grid_set_blocked(CF_PathGrid* grid, int x, int y, bool blocked)
+{
+	if (x < 0 || y < 0 || x >= grid->w || y >= grid->h) return;
+	grid->blocked[y * grid->w + x] = blocked ? 1 : 0;
+	grid->hierarchy_valid = false;
+}
+
+bool cf_path_grid_is_blocked(const CF_PathGrid* grid, int x, int y)
+{
+	return !s_walkable(grid, x, y);
+}
+
+void cf_path_grid_set_diagonals(CF_PathGrid* grid, bool allow_diagonals)
+{
+	grid->diagonals = allow_diagonals;
+	grid->hierarchy_valid = false;
+}
+
+void cf_path_grid_build_hierarchy(CF_PathGrid* grid, int cluster_size)
+{
+	CF_ASSERT(cluster_size > 1);
+	int w = grid->w;
+	int h = grid->h;
+	int c = cluster_size;
+	grid->cluster_size = c;
+	grid->clusters_w = (w + c - 1) / c;
+	grid->clusters_h = (h + c - 1) / c;
+	int cluster_count = grid->clusters_w * grid->clusters_h;
+	grid->node_cells.clear();
+	grid->node_clusters.clear();
+	grid->node_at.ensure_count(w * h);
+	for (int i = 0; i < w * h; ++i) grid->node_at[i] = -1;
+
+	// Transitions across each vertical border, then each horizontal one.
+	Array<CF_PathEdge> edges;
+	for (int cy = 0; cy < grid->clusters_h; ++cy) {
+		for (int cx = 0; cx + 1 < grid->clusters_w; ++cx) {
+			int y0 = cy * c;
+			s_add_entrances(grid, &edges, (cx + 1) * c - 1, y0, 0, 1, 1, 0, cf_min(c, h - y0));
+		}
+	}
+	for (int cy = 0; cy + 1 < grid->clusters_h; ++cy) {
+		for (int cx = 0; cx < grid->clusters_w; ++cx) {
+			int x0 = cx * c;
+			s_add_entrances(grid, &edges, x0, (cy + 1) * c - 1, 1, 0, 0, 1, cf_min(c, w - x0));
+		}
+	}
+	int node_count = grid->node_cells.count();
+	s_bucket(grid->node_clusters.data(), node_count, cluster_count, &grid->cluster_starts, &grid->cluster_nodes);
+
+	// Shortest paths between the nodes of each cluster, staying inside the cluster. Nodes are sorted within
+	// each cluster, and paths are the same both ways, so each search only looks for the nodes after it.
+	CF_PathScratch s;
+	for (int k = 0; k < cluster_count; ++k) {
+		CF_PathRect rect = s_cluster_rect(grid, k);
+		int begin = grid->cluster_starts[k];
+		int end = grid->cluster_starts[k + 1];
+		for (int i = begin; i + 1 < end; ++i) {
+			int from = grid->cluster_nodes[i];
+			s_search(grid, &s, grid->node_cells[from], -1, rect, from + 1, end - i - 1);
+			for (int j = i + 1; j < end; ++j) {
+				int to = grid->cluster_nodes[j];
+				int cell = grid->node_cells[to];
+				if (!s_visited(&s, cell)) continue;
+				edges.add({ from, to, s.g[cell] });
+				edges.add({ to, from, s.g[cell] });
+			}
+		}
+	}
+
+	// Pack the edges by node.
+	Array<int> keys;
+	Array<int> order;
+	keys.ensure_count(edges.count());
+	for (int i = 0; i < edges.count(); ++i) keys[i] = edges[i].from;
+	s_bucket(keys.data(), edges.count(), node_count, &grid->edge_starts, &order);
+	grid->edge_to.ensure_count(edges.count());
+	grid->edge_costs.ensure_count(edges.count());
+	for (int i = 0; i < edges.count(); ++i) {
+		grid->edge_to[i] = edges[order[i]].to;
+		grid->edge_costs[i] = edges[order[i]].cost;
+	}
+	grid->hierarchy_valid = true;
+}
+
+int cf_path_grid_find_path(const CF_PathGrid* grid, CF_PathCell start, CF_PathCell goal, CF_PathAlgorithm algorithm, CF_PathCell* path, int capacity)
+{
+	CF_PathScratch* s = s_acquire_scratch(grid);
+	int count = s_find_path(grid, s, start, goal, algorithm, path, capacity);
+	s_release_scratch(grid, s);
+	return count;
+}
+
+struct CF_PathBatch
+{
+	const CF_PathGrid* grid;
+	CF_PathRequest* requests;
+};
+
+static void s_find_path_range(int begin, int end, void* udata)
+{
+	CF_PathBatch* batch = (CF_PathBatch*)udata;
+	CF_PathScratch* s = s_acquire_scratch(batch->grid);
+	for (int i = begin; i < end; ++i) {
+		CF_PathRequest* r = batch->requests + i;
+		r->count = s_find_path(batch->grid, s, r->start, r->goal, r->algorithm, r->path, r->capacity);
+	}
+	s_release_scratch(batch->grid, s);
+}
+
+void cf_path_grid_find_paths(const CF_PathGrid* grid, CF_PathRequest* requests, int count, CF_Threadpool* pool)
+{
+	CF_PathBatch batch = { grid, requests };
+	cf_parallel_for(pool, 0, count, 8, s_find_path_range, &batch);
+}
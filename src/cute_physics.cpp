@@ -8,23 +8,36 @@
 #include <cute_physics.h>
 #include <cute_draw.h>
 #include <cute_draw3d.h>
+#include <cute_app.h>
 #include <cute_color.h>
 #include <cute_alloc.h>
 #include <cute_time.h>
 #include <cute_c_runtime.h>
+#include <cute_array.h>
+
+#include <internal/cute_alloc_internal.h>
+#include <internal/cute_physics_internal.h>
+#include <internal/cute_simd_internal.h>
 
 #include <box3d/collision.h>
 #include <box3d/math_functions.h>
 
+#include <float.h>
 #include <stdio.h>
 
 //--------------------------------------------------------------------------------------------------
 // Allocator + assert wiring, called once from cf_make_app so every Box2D allocation flows
-// through CF's allocator (Box2D asks for aligned memory for its SIMD solver data).
+// through CF's allocator (Box2D asks for aligned memory for its SIMD solver data). It all shows
+// up under the "physics" tag in the allocation tracker, credited to the Box2D/Box3D code calling
+// the allocator rather than to these wrappers.
 
 static void* s_b2_alloc(unsigned int size, int alignment)
 {
-	return cf_aligned_alloc((size_t)size, alignment);
+	CF_ALLOC_TAG_SCOPE("physics");
+	void* prev = cf_alloc_set_callsite(CF_RETURN_ADDRESS());
+	void* ptr = cf_aligned_alloc((size_t)size, alignment);
+	cf_alloc_set_callsite(prev);
+	return ptr;
 }
 
 static void s_b2_free(void* mem)
@@ -41,7 +54,11 @@ static int s_b2_assert(const char* condition, const char* file_name, int line_nu
 // Box3D spells the same allocator contract with int32 sizes.
 static void* s_b3_alloc(int32_t size, int32_t alignment)
 {
-	return cf_aligned_alloc((size_t)size, alignment);
+	CF_ALLOC_TAG_SCOPE("physics");
+	void* prev = cf_alloc_set_callsite(CF_RETURN_ADDRESS());
+	void* ptr = cf_aligned_alloc((size_t)size, alignment);
+	cf_alloc_set_callsite(prev);
+	return ptr;
 }
 
 static int s_b3_assert(const char* condition, const char* file_name, int line_number)
@@ -79,6 +96,7 @@ b2Polygon cf_poly_to_b2(const CF_Poly* poly, float radius)
 // current 2d camera, layer and blend state like any other cf_draw_* call.
 
 static float s_thickness = 0.1f;
+static float s_lod_size = 0; // Solid shapes narrower than this draw as boxes, in world units. Zero is off.
 
 static CF_Color s_color(b2HexColor hex, float scale)
 {
@@ -88,6 +106,21 @@ static CF_Color s_color(b2HexColor hex, float scale)
 	return cf_make_color_rgb_f(r * scale, g * scale, b * scale);
 }
 
+bool cf_physics_lod_box(CF_Aabb bounds, float lod_size)
+{
+	return cf_max(cf_width(bounds), cf_height(bounds)) < lod_size;
+}
+
+// Draws a shape's bounds as a filled box when it's too small on screen to make out.
+static bool s_draw_lod_box(CF_Aabb bb, b2HexColor color)
+{
+	if (!cf_physics_lod_box(bb, s_lod_size)) return false;
+	cf_draw_push_color(s_color(color, 1.0f));
+	cf_draw_box_fill(bb, 0);
+	cf_draw_pop_color();
+	return true;
+}
+
 static void s_draw_polygon(const b2Vec2* vertices, int count, b2HexColor color, void* context)
 {
 	CF_UNUSED(context);
@@ -101,6 +134,7 @@ static void s_draw_solid_polygon(b2Transform xf, const b2Vec2* vertices, int cou
 	CF_UNUSED(context);
 	CF_V2 points[B2_MAX_POLYGON_VERTICES];
 	for (int i = 0; i < count; ++i) points[i] = cf_b2_to_v2(b2TransformPoint(xf, vertices[i]));
+	if (s_draw_lod_box(cf_expand_aabb_f(cf_make_aabb_verts(points, count), radius), color)) return;
 	cf_draw_push_color(s_color(color, 1.0f));
 	// Box2D's rounding radius maps straight onto the draw API's chubbiness.
 	cf_draw_polygon_fill(points, count, radius);
@@ -119,6 +153,7 @@ static void s_draw_solid_circle(b2Transform xf, float radius, b2HexColor color,
 {
 	CF_UNUSED(context);
 	CF_V2 center = cf_b2_to_v2(xf.p);
+	if (s_draw_lod_box(cf_make_aabb_center_half_extents(center, cf_v2(radius, radius)), color)) return;
 	cf_draw_push_color(s_color(color, 1.0f));
 	cf_draw_circle_fill2(center, radius);
 	cf_draw_pop_color();
@@ -134,6 +169,8 @@ static void s_draw_solid_circle(b2Transform xf, float radius, b2HexColor color,
 static void s_draw_solid_capsule(b2Vec2 p1, b2Vec2 p2, float radius, b2HexColor color, void* context)
 {
 	CF_UNUSED(context);
+	CF_Aabb bb = cf_make_aabb(cf_min(cf_b2_to_v2(p1), cf_b2_to_v2(p2)), cf_max(cf_b2_to_v2(p1), cf_b2_to_v2(p2)));
+	if (s_draw_lod_box(cf_expand_aabb_f(bb, radius), color)) return;
 	cf_draw_push_color(s_color(color, 1.0f));
 	cf_draw_capsule_fill2(cf_b2_to_v2(p1), cf_b2_to_v2(p2), radius);
 	cf_draw_pop_color();
@@ -178,9 +215,25 @@ static void s_draw_string(b2Vec2 p, const char* s, b2HexColor color, void* conte
 	cf_draw_pop_color();
 }
 
+// What the current 2d camera sees, in world space. All four screen corners are unprojected since
+// the camera may be rotated.
+static CF_Aabb s_camera_bounds()
+{
+	float w = (float)cf_app_get_width();
+	float h = (float)cf_app_get_height();
+	CF_V2 corners[4] = {
+		cf_screen_to_world(cf_v2(0, 0)),
+		cf_screen_to_world(cf_v2(w, 0)),
+		cf_screen_to_world(cf_v2(0, h)),
+		cf_screen_to_world(cf_v2(w, h)),
+	};
+	return cf_make_aabb_verts(corners, 4);
+}
+
 b2DebugDraw cf_physics_debug_draw_defaults(float thickness)
 {
 	s_thickness = thickness;
+	s_lod_size = 0;
 	b2DebugDraw draw = b2DefaultDebugDraw();
 	draw.DrawPolygonFcn = s_draw_polygon;
 	draw.DrawSolidPolygonFcn = s_draw_solid_polygon;
@@ -195,13 +248,31 @@ b2DebugDraw cf_physics_debug_draw_defaults(float thickness)
 	return draw;
 }
 
-void cf_physics_draw(b2WorldId world, float thickness)
+b2DebugDraw cf_physics_debug_draw_view(float thickness, CF_Aabb view, float lod_size)
 {
 	b2DebugDraw draw = cf_physics_debug_draw_defaults(thickness);
 	draw.drawJoints = true;
+	// Box2D queries its broadphase with these bounds, so off-screen shapes cost nothing.
+	draw.drawingBounds = cf_aabb_to_b2(cf_expand_aabb_f(view, thickness));
+	draw.useDrawingBounds = true;
+	s_lod_size = lod_size;
+	return draw;
+}
+
+void cf_physics_draw(b2WorldId world, float thickness)
+{
+	b2DebugDraw draw = cf_physics_debug_draw_view(thickness, s_camera_bounds(), 0);
 	b2World_Draw(world, &draw);
 }
 
+void cf_physics_draw_lod(b2WorldId world, float thickness, float lod_pixels)
+{
+	float world_per_pixel = cf_len(cf_sub(cf_screen_to_world(cf_v2(1, 0)), cf_screen_to_world(cf_v2(0, 0))));
+	b2DebugDraw draw = cf_physics_debug_draw_view(thickness, s_camera_bounds(), lod_pixels * world_per_pixel);
+	b2World_Draw(world, &draw);
+	s_lod_size = 0;
+}
+
 //--------------------------------------------------------------------------------------------------
 // Stepping.
 
@@ -219,6 +290,271 @@ void cf_physics_step3(b3WorldId world, int substep_count)
 	b3World_Step(world, dt, substep_count);
 }
 
+//--------------------------------------------------------------------------------------------------
+// Task system: Box2D hands each parallel piece of a step to enqueueTask as a range of items, and
+// later calls finishTask on whatever enqueueTask returned. Each range is split into one
+// job per worker at most, all tracked by one counter. Box2D indexes per-worker scratch memory by
+// the worker index, so chunks of one task get distinct indices below the world's workerCount.
+// Tasks that run alongside each other (the solver's per-worker tasks, the broadphase rebuild)
+// ignore the index.
+
+// Box2D caps a world's workers at 64.
+#define CF_PHYSICS_MAX_WORKERS 64
+
+struct CF_PhysicsTaskChunk
+{
+	b2TaskCallback* fn;
+	void* task_context;
+	int begin;
+	int end;
+	uint32_t worker_index;
+};
+
+struct CF_PhysicsTask
+{
+	CF_JobCounter counter;
+	int chunk_count;
+	CF_PhysicsTaskChunk chunks[1];
+};
+
+static int s_worker_count(CF_Threadpool* pool)
+{
+	// The stepping thread runs jobs while it waits in finishTask, so it counts as a worker.
+	return cf_min(cf_threadpool_thread_count(pool) + 1, CF_PHYSICS_MAX_WORKERS);
+}
+
+static void s_run_task_chunk(void* param)
+{
+	CF_PhysicsTaskChunk* chunk = (CF_PhysicsTaskChunk*)param;
+	chunk->fn(chunk->begin, chunk->end, chunk->worker_index, chunk->task_context);
+}
+
+static void* s_enqueue_task(b2TaskCallback* fn, int item_count, int min_range, void* task_context, void* user_context)
+{
+	if (item_count <= 0) return NULL;
+	CF_Threadpool* pool = (CF_Threadpool*)user_context;
+	min_range = cf_max(min_range, 1);
+	int chunk_count = cf_min(s_worker_count(pool), (item_count + min_range - 1) / min_range);
+
+	CF_PhysicsTask* task;
+	{
+		CF_ALLOC_TAG_SCOPE("physics");
+		task = (CF_PhysicsTask*)cf_alloc(sizeof(CF_PhysicsTask) + sizeof(CF_PhysicsTaskChunk) * (chunk_count - 1));
+	}
+	task->counter = cf_make_job_counter();
+	task->chunk_count = chunk_count;
+	for (int i = 0; i < chunk_count; ++i) {
+		CF_PhysicsTaskChunk* chunk = task->chunks + i;
+		chunk->fn = fn;
+		chunk->task_context = task_context;
+		chunk->begin = (int)((int64_t)item_count * i / chunk_count);
+		chunk->end = (int)((int64_t)item_count * (i + 1) / chunk_count);
+		chunk->worker_index = (uint32_t)i;
+		cf_threadpool_add_job(pool, s_run_task_chunk, chunk, &task->counter);
+	}
+
+	// Start right away: some tasks (like the broadphase rebuild) overlap with the rest of the
+	// step, and are only finished much later.
+	cf_threadpool_kick(pool);
+	return task;
+}
+
+static void s_finish_task(void* user_task, void* user_context)
+{
+	// Helps run the pool's jobs until this task's are done.
+	CF_PhysicsTask* task = (CF_PhysicsTask*)user_task;
+	cf_threadpool_wait_counter((CF_Threadpool*)user_context, &task->counter);
+	cf_free(task);
+}
+
+b2WorldDef cf_physics_world_def()
+{
+	return b2DefaultWorldDef();
+}
+
+b2WorldDef cf_physics_world_def_threadpool(CF_Threadpool* pool)
+{
+	b2WorldDef def = cf_physics_world_def();
+	if (pool && cf_threadpool_thread_count(pool) > 0) {
+		def.workerCount = s_worker_count(pool);
+		def.enqueueTask = s_enqueue_task;
+		def.finishTask = s_finish_task;
+		def.userTaskContext = pool;
+	}
+	return def;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Render interpolation. Transforms are kept as structure of arrays -- x, y, cos, sin -- so a tick's
+// previous transforms are four memcpy's, and interpolation runs a register of bodies at a time.
+
+struct CF_PhysicsTransforms
+{
+	b2WorldId world;
+	Cute::Array<b2BodyId> bodies;
+	Cute::Array<int> slots; // Body id index -> index into `bodies`, or -1.
+	Cute::Array<float> prev[4];
+	Cute::Array<float> curr[4];
+	Cute::Array<CF_Transform> interpolated;
+};
+
+static_assert(sizeof(CF_Transform) == sizeof(float) * 4, "Interpolation stores transforms as {s, c, x, y} floats.");
+
+static int s_transform_slot(const CF_PhysicsTransforms* transforms, b2BodyId body)
+{
+	if (body.index1 >= transforms->slots.count()) return -1;
+	int slot = transforms->slots.data()[body.index1];
+	if (slot < 0) return -1;
+	b2BodyId tracked = transforms->bodies.data()[slot];
+	return B2_ID_EQUALS(tracked, body) ? slot : -1;
+}
+
+CF_PhysicsTransforms* cf_make_physics_transforms(b2WorldId world)
+{
+	CF_PhysicsTransforms* transforms = CF_NEW(CF_PhysicsTransforms);
+	transforms->world = world;
+	return transforms;
+}
+
+void cf_destroy_physics_transforms(CF_PhysicsTransforms* transforms)
+{
+	if (!transforms) return;
+	transforms->~CF_PhysicsTransforms();
+	CF_FREE(transforms);
+}
+
+int cf_physics_transforms_add(CF_PhysicsTransforms* transforms, b2BodyId body)
+{
+	int slot = s_transform_slot(transforms, body);
+	if (slot >= 0) return slot;
+	b2WorldId world = b2Body_GetWorld(body);
+	CF_ASSERT(world.index1 == transforms->world.index1 && world.generation == transforms->world.generation);
+
+	b2Transform tf = b2Body_GetTransform(body);
+	float values[4] = { tf.p.x, tf.p.y, tf.q.c, tf.q.s };
+	slot = transforms->bodies.count();
+	transforms->bodies.add(body);
+	for (int i = 0; i < 4; ++i) {
+		transforms->prev[i].add(values[i]);
+		transforms->curr[i].add(values[i]);
+	}
+
+	int old_count = transforms->slots.count();
+	if (body.index1 >= old_count) {
+		transforms->slots.ensure_count(body.index1 + 1);
+		for (int i = old_count; i < transforms->slots.count(); ++i) transforms->slots[i] = -1;
+	}
+	transforms->slots[body.index1] = slot;
+	return slot;
+}
+
+void cf_physics_transforms_remove(CF_PhysicsTransforms* transforms, b2BodyId body)
+{
+	int slot = s_transform_slot(transforms, body);
+	if (slot < 0) return;
+	transforms->slots[body.index1] = -1;
+
+	// Swap the last body into the hole.
+	int last = transforms->bodies.count() - 1;
+	if (slot != last) {
+		b2BodyId moved = transforms->bodies[last];
+		transforms->bodies[slot] = moved;
+		transforms->slots[moved.index1] = slot;
+		for (int i = 0; i < 4; ++i) {
+			transforms->prev[i][slot] = transforms->prev[i][last];
+			transforms->curr[i][slot] = transforms->curr[i][last];
+		}
+	}
+	transforms->bodies.pop();
+	for (int i = 0; i < 4; ++i) {
+		transforms->prev[i].pop();
+		transforms->curr[i].pop();
+	}
+}
+
+int cf_physics_transforms_count(const CF_PhysicsTransforms* transforms)
+{
+	return transforms->bodies.count();
+}
+
+const b2BodyId* cf_physics_transforms_bodies(const CF_PhysicsTransforms* transforms)
+{
+	return transforms->bodies.data();
+}
+
+void cf_physics_transforms_update(CF_PhysicsTransforms* transforms)
+{
+	int count = transforms->bodies.count();
+	if (!count) return;
+	for (int i = 0; i < 4; ++i) {
+		CF_MEMCPY(transforms->prev[i].data(), transforms->curr[i].data(), sizeof(float) * count);
+	}
+
+	// Only bodies that moved this step have an event. Events for untracked bodies are skipped.
+	float* x = transforms->curr[0].data();
+	float* y = transforms->curr[1].data();
+	float* c = transforms->curr[2].data();
+	float* s = transforms->curr[3].data();
+	b2BodyEvents events = b2World_GetBodyEvents(transforms->world);
+	for (int i = 0; i < events.moveCount; ++i) {
+		const b2BodyMoveEvent* e = events.moveEvents + i;
+		int slot = s_transform_slot(transforms, e->bodyId);
+		if (slot < 0) continue;
+		x[slot] = e->transform.p.x;
+		y[slot] = e->transform.p.y;
+		c[slot] = e->transform.q.c;
+		s[slot] = e->transform.q.s;
+	}
+}
+
+const CF_Transform* cf_physics_transforms_interpolate(CF_PhysicsTransforms* transforms, float alpha)
+{
+	int count = transforms->bodies.count();
+	transforms->interpolated.ensure_count(count);
+	if (!count) return transforms->interpolated.data();
+	const float* x0 = transforms->prev[0].data();
+	const float* y0 = transforms->prev[1].data();
+	const float* c0 = transforms->prev[2].data();
+	const float* s0 = transforms->prev[3].data();
+	const float* x1 = transforms->curr[0].data();
+	const float* y1 = transforms->curr[1].data();
+	const float* c1 = transforms->curr[2].data();
+	const float* s1 = transforms->curr[3].data();
+	float* out = (float*)transforms->interpolated.data();
+
+	// Lerp positions, and nlerp rotations. Weighting both ends lands exactly on them at 0 and 1.
+	// A body that turned half a revolution in one tick can blend to a zero-length rotation;
+	// clamping the length keeps that from making NaNs.
+	int i = 0;
+#ifdef CF_SIMD_WIDTH
+	s_f a = s_set(alpha);
+	s_f b = s_set(1.0f - alpha);
+	s_f min_len = s_set(FLT_MIN);
+	for (; i + CF_SIMD_WIDTH <= count; i += CF_SIMD_WIDTH) {
+		s_f x = s_add(s_mul(b, s_load(x0 + i)), s_mul(a, s_load(x1 + i)));
+		s_f y = s_add(s_mul(b, s_load(y0 + i)), s_mul(a, s_load(y1 + i)));
+		s_f c = s_add(s_mul(b, s_load(c0 + i)), s_mul(a, s_load(c1 + i)));
+		s_f s = s_add(s_mul(b, s_load(s0 + i)), s_mul(a, s_load(s1 + i)));
+		s_f len = s_max(s_sqrt(s_add(s_mul(c, c), s_mul(s, s))), min_len);
+		s_store_interleave4(out + i * 4, s_div(s, len), s_div(c, len), x, y);
+	}
+#endif
+	float beta = 1.0f - alpha;
+	for (; i < count; ++i) {
+		float x = beta * x0[i] + alpha * x1[i];
+		float y = beta * y0[i] + alpha * y1[i];
+		float c = beta * c0[i] + alpha * c1[i];
+		float s = beta * s0[i] + alpha * s1[i];
+		float len = sqrtf(c * c + s * s);
+		len = len > FLT_MIN ? len : FLT_MIN;
+		out[i * 4 + 0] = s / len;
+		out[i * 4 + 1] = c / len;
+		out[i * 4 + 2] = x;
+		out[i * 4 + 3] = y;
+	}
+	return transforms->interpolated.data();
+}
+
 //--------------------------------------------------------------------------------------------------
 // 3d debug draw: b3DebugDraw callbacks routed into the draw3d API. Box3D bakes each shape
 // into a user drawable once (via world-creation callbacks), so spheres and capsules store
@@ -226,6 +562,14 @@ void cf_physics_step3(b3WorldId world, int substep_count)
 
 static float s_thickness3 = 0.02f;
 
+// The camera shapes are culled against, captured from the draw3d stacks by cf_physics_draw3 and
+// cf_physics_draw3_lod. Positions here are in the physics world's space, before the draw3d transform
+// stack. Plain cf_physics_debug_draw3_defaults leaves culling off and draws everything.
+static bool s_cull3 = false;
+static CF_Frustum s_frustum3;
+static CF_V3 s_eye3;
+static float s_lod_distance3 = 0; // Shapes farther than this draw as boxes. Zero is off.
+
 static CF_Color s_color3(b3HexColor hex, float scale, float alpha)
 {
 	float r = (float)((hex >> 16) & 0xFF) * (1.0f / 255.0f);
@@ -244,6 +588,7 @@ struct CF_B3DebugShape
 	CF_V3 box_half_extents;
 	CF_V3* segments; // Wireframe segment pairs for hulls/meshes/bounds; NULL for primitives.
 	int segment_vert_count;
+	CF_Aabb3 bounds; // In the shape's local space, for culling.
 };
 
 static void s_add_segment(CF_V3* segments, int* count, CF_V3 a, CF_V3 b)
@@ -280,28 +625,34 @@ static void* s_create_debug_shape(const b3DebugShape* debug_shape, void* udata)
 	switch (debug_shape->type) {
 	case b3_sphereShape:
 		shape->sphere = *debug_shape->sphere;
+		shape->bounds = cf_make_aabb3_center(cf_b3_to_v3(shape->sphere.center), cf_v3(shape->sphere.radius));
 		break;
 
 	case b3_capsuleShape:
+	{
 		shape->capsule = *debug_shape->capsule;
-		break;
+		CF_V3 a = cf_b3_to_v3(shape->capsule.center1), b = cf_b3_to_v3(shape->capsule.center2);
+		CF_V3 r = cf_v3(shape->capsule.radius);
+		shape->bounds = cf_make_aabb3(cf_sub_v3(cf_min_v3(a, b), r), cf_add_v3(cf_max_v3(a, b), r));
+	}	break;
 
 	case b3_hullShape:
 	{
 		const b3HullData* hull = debug_shape->hull;
 		const b3Vec3* points = b3GetHullPoints(hull);
 		const b3HullHalfEdge* edges = b3GetHullEdges(hull);
+		CF_V3 lo = cf_b3_to_v3(points[0]), hi = lo;
+		for (int i = 1; i < hull->vertexCount; ++i) {
+			lo = cf_min_v3(lo, cf_b3_to_v3(points[i]));
+			hi = cf_max_v3(hi, cf_b3_to_v3(points[i]));
+		}
+		shape->bounds = cf_make_aabb3(lo, hi);
 
 		// The b3MakeBoxHull family is by far the most common hull: 8 points that are
 		// exactly the corners of their own local bounds. Those get draw3d's solid cube;
 		// general hulls fall back to wireframe below (draw3d's shader-free solids are a
 		// fixed set of built-ins, and an arbitrary hull is not one of them).
 		if (hull->vertexCount == 8) {
-			CF_V3 lo = cf_b3_to_v3(points[0]), hi = lo;
-			for (int i = 1; i < 8; ++i) {
-				lo = cf_min_v3(lo, cf_b3_to_v3(points[i]));
-				hi = cf_max_v3(hi, cf_b3_to_v3(points[i]));
-			}
 			CF_V3 extent = cf_sub_v3(hi, lo);
 			float epsilon = 1e-4f * (extent.x + extent.y + extent.z + 1.0f);
 			bool is_box = true;
@@ -339,6 +690,7 @@ static void* s_create_debug_shape(const b3DebugShape* debug_shape, void* udata)
 		CF_V3 scale = cf_b3_to_v3(mesh->scale);
 		shape->segments = (CF_V3*)cf_alloc(sizeof(CF_V3) * 6 * (size_t)mesh->data->triangleCount);
 		int n = 0;
+		CF_V3 lo = cf_v3(FLT_MAX), hi = cf_v3(-FLT_MAX);
 		for (int i = 0; i < mesh->data->triangleCount; ++i) {
 			CF_V3 a = cf_mul_v3(cf_b3_to_v3(verts[tris[i].index1]), scale);
 			CF_V3 b = cf_mul_v3(cf_b3_to_v3(verts[tris[i].index2]), scale);
@@ -346,17 +698,26 @@ static void* s_create_debug_shape(const b3DebugShape* debug_shape, void* udata)
 			s_add_segment(shape->segments, &n, a, b);
 			s_add_segment(shape->segments, &n, b, c);
 			s_add_segment(shape->segments, &n, c, a);
+			lo = cf_min_v3(lo, cf_min_v3(a, cf_min_v3(b, c)));
+			hi = cf_max_v3(hi, cf_max_v3(a, cf_max_v3(b, c)));
 		}
 		shape->segment_vert_count = n;
+		shape->bounds = cf_make_aabb3(lo, hi);
 	}	break;
 
 	case b3_heightShape:
-		shape->segments = s_wire_box(b3ComputeHeightFieldAABB(debug_shape->heightField, b3Transform_identity), &shape->segment_vert_count);
-		break;
+	{
+		b3AABB bb = b3ComputeHeightFieldAABB(debug_shape->heightField, b3Transform_identity);
+		shape->segments = s_wire_box(bb, &shape->segment_vert_count);
+		shape->bounds = cf_b3_to_aabb3(bb);
+	}	break;
 
 	case b3_compoundShape:
-		shape->segments = s_wire_box(b3ComputeCompoundAABB(debug_shape->compound, b3Transform_identity), &shape->segment_vert_count);
-		break;
+	{
+		b3AABB bb = b3ComputeCompoundAABB(debug_shape->compound, b3Transform_identity);
+		shape->segments = s_wire_box(bb, &shape->segment_vert_count);
+		shape->bounds = cf_b3_to_aabb3(bb);
+	}	break;
 
 	default: break;
 	}
@@ -378,9 +739,25 @@ static bool s_draw3_shape(void* user_shape, b3WorldTransform transform, b3HexCol
 	CF_UNUSED(context);
 	CF_B3DebugShape* shape = (CF_B3DebugShape*)user_shape;
 	if (!shape) return true;
+
+	// Cull against the camera frustum, and draw far away shapes as their bounds.
+	CF_V3 p = cf_b3_to_v3(transform.p);
+	CF_Quat q = cf_b3_to_quat(transform.q);
+	if (s_cull3) {
+		CF_Aabb3 bounds = cf_transform_aabb3(cf_m4_from_trs(p, q, cf_v3(1.0f)), shape->bounds);
+		CF_PhysicsCull3 cull = cf_physics_cull3(&s_frustum3, s_eye3, s_lod_distance3, bounds);
+		if (cull == CF_PHYSICS_CULL3_HIDDEN) return true;
+		if (cull == CF_PHYSICS_CULL3_BOX) {
+			cf_draw3d_push_color(s_color3(color, 1.0f, 1.0f));
+			cf_draw3d_cube(cf_center_aabb3(bounds), cf_half_extents_aabb3(bounds));
+			cf_draw3d_pop_color();
+			return true;
+		}
+	}
+
 	cf_draw3d_push();
-	cf_draw3d_translate(cf_b3_to_v3(transform.p));
-	cf_draw3d_rotate(cf_b3_to_quat(transform.q));
+	cf_draw3d_translate(p);
+	cf_draw3d_rotate(q);
 	cf_draw3d_push_color(s_color3(color, 1.0f, 1.0f));
 	switch (shape->type) {
 	case b3_sphereShape:
@@ -480,7 +857,7 @@ static void s_draw3_string(b3Pos p, const char* s, b3HexColor color, void* conte
 	cf_draw_pop_color();
 }
 
-b3WorldDef cf_physics_world_def3(void)
+b3WorldDef cf_physics_world_def3()
 {
 	b3WorldDef def = b3DefaultWorldDef();
 	def.createDebugShape = s_create_debug_shape;
@@ -488,9 +865,20 @@ b3WorldDef cf_physics_world_def3(void)
 	return def;
 }
 
+CF_PhysicsCull3 cf_physics_cull3(const CF_Frustum* frustum, CF_V3 eye, float lod_distance, CF_Aabb3 bounds)
+{
+	if (!cf_frustum_test_aabb3(frustum, bounds)) return CF_PHYSICS_CULL3_HIDDEN;
+	if (lod_distance > 0 && cf_len_sq_v3(cf_sub_v3(cf_center_aabb3(bounds), eye)) > lod_distance * lod_distance) {
+		return CF_PHYSICS_CULL3_BOX;
+	}
+	return CF_PHYSICS_CULL3_FULL;
+}
+
 b3DebugDraw cf_physics_debug_draw3_defaults(float thickness)
 {
 	s_thickness3 = thickness;
+	s_cull3 = false;
+	s_lod_distance3 = 0;
 	b3DebugDraw draw = b3DefaultDebugDraw();
 	draw.DrawShapeFcn = s_draw3_shape;
 	draw.DrawSegmentFcn = s_draw3_segment;
@@ -505,9 +893,32 @@ b3DebugDraw cf_physics_debug_draw3_defaults(float thickness)
 	return draw;
 }
 
+// Captures the current draw3d camera for s_draw3_shape to cull against.
+static void s_capture_camera3()
+{
+	CF_M4x4 view = cf_mul_m4(cf_draw3d_peek_view(), cf_draw3d_peek_transform());
+	s_frustum3 = cf_frustum_from_m4(cf_mul_m4(cf_draw3d_peek_projection(), view));
+	CF_M4x4 camera = cf_m4_invert(view);
+	s_eye3 = cf_v3(camera.elements[12], camera.elements[13], camera.elements[14]);
+	s_cull3 = true;
+}
+
 void cf_physics_draw3(b3WorldId world, float thickness)
 {
 	b3DebugDraw draw = cf_physics_debug_draw3_defaults(thickness);
 	draw.drawJoints = true;
+	s_capture_camera3();
 	b3World_Draw(world, &draw, UINT64_MAX); // All category bits: draw everything.
+	s_cull3 = false;
+}
+
+void cf_physics_draw3_lod(b3WorldId world, float thickness, float lod_distance)
+{
+	b3DebugDraw draw = cf_physics_debug_draw3_defaults(thickness);
+	draw.drawJoints = true;
+	s_capture_camera3();
+	s_lod_distance3 = lod_distance;
+	b3World_Draw(world, &draw, UINT64_MAX);
+	s_cull3 = false;
+	s_lod_distance3 = 0;
 }
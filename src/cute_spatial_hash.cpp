@@ -0,0 +1,187 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include <cute_spatial_hash.h>
+#include <cute_alloc.h>
+#include <cute_array.h>
+
+#include <internal/cute_alloc_internal.h>
+
+using namespace Cute;
+
+// Every cell a box touches gets an entry pointing back at the box. Entries are bucketed by a hash
+// of their cell's coordinates with a counting sort, so all entries of a bucket sit next to each
+// other in one flat array -- `starts[b]` to `starts[b + 1]`. Distinct cells may share a bucket --
+// even two cells of the same box -- so each entry remembers its own cell, and queries skip entries
+// filed under some other cell.
+
+struct CF_SpatialHashItem
+{
+	CF_Aabb box;
+	int id;
+	int x0, y0, x1, y1; // Inclusive cell range.
+};
+
+struct CF_SpatialHashEntry
+{
+	int item; // Index into `items`.
+	int x, y; // The cell this entry was filed under.
+};
+
+struct CF_SpatialHash
+{
+	float inv_cell_size;
+	Array<CF_SpatialHashItem> items;
+	Array<int> starts;
+	Array<CF_SpatialHashEntry> entries; // Sorted by bucket.
+	int bucket_mask;
+};
+
+static CF_INLINE int s_cell(const CF_SpatialHash* hash, float x)
+{
+	return (int)cf_floor(x * hash->inv_cell_size);
+}
+
+static CF_INLINE int s_bucket(const CF_SpatialHash* hash, int x, int y)
+{
+	return (int)(((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u)) & hash->bucket_mask;
+}
+
+CF_SpatialHash* cf_make_spatial_hash(float cell_size)
+{
+	CF_ASSERT(cell_size > 0);
+	CF_SpatialHash* hash = CF_NEW(CF_SpatialHash);
+	hash->inv_cell_size = 1.0f / cell_size;
+	hash->bucket_mask = 0;
+	hash->starts.add(0);
+	hash->starts.add(0);
+	return hash;
+}
+
+void cf_destroy_spatial_hash(CF_SpatialHash* hash)
+{
+	if (!hash) return;
+	hash->~CF_SpatialHash();
+	CF_FREE(hash);
+}
+
+void cf_spatial_hash_clear(CF_SpatialHash* hash)
+{
+	hash->items.clear();
+	cf_spatial_hash_build(hash);
+}
+
+void cf_spatial_hash_add(CF_SpatialHash* hash, CF_Aabb aabb, int id)
+{
+	CF_SpatialHashItem item;
+	item.box = aabb;
+	item.id = id;
+	item.x0 = s_cell(hash, aabb.min.x);
+	item.y0 = s_cell(hash, aabb.min.y);
+	item.x1 = s_cell(hash, aabb.max.x);
+	item.y1 = s_cell(hash, aabb.max.y);
+	hash->items.add(item);
+}
+
+void cf_spatial_hash_build(CF_SpatialHash* hash)
+{
+	int item_count = hash->items.count();
+	const CF_SpatialHashItem* items = hash->items.data();
+	int entry_count = 0;
+	for (int i = 0; i < item_count; ++i) {
+		entry_count += (items[i].x1 - items[i].x0 + 1) * (items[i].y1 - items[i].y0 + 1);
+	}
+
+	// Around two buckets per entry keeps unrelated cells from sharing buckets too often.
+	int bucket_count = 16;
+	while (bucket_count < entry_count * 2) bucket_count *= 2;
+	hash->bucket_mask = bucket_count - 1;
+	hash->starts.set_count(bucket_count + 1);
+	hash->entries.set_count(entry_count);
+	int* starts = hash->starts.data();
+	CF_SpatialHashEntry* entries = hash->entries.data();
+	CF_MEMSET(starts, 0, sizeof(int) * (bucket_count + 1));
+
+	// Count entries per bucket, then prefix sum so starts[b] is the end of bucket b.
+	for (int i = 0; i < item_count; ++i) {
+		for (int y = items[i].y0; y <= items[i].y1; ++y) {
+			for (int x = items[i].x0; x <= items[i].x1; ++x) {
+				starts[s_bucket(hash, x, y)]++;
+			}
+		}
+	}
+	for (int b = 1; b <= bucket_count; ++b) {
+		starts[b] += starts[b - 1];
+	}
+
+	// Fill each bucket back to front, leaving starts[b] at the beginning of bucket b.
+	for (int i = item_count - 1; i >= 0; --i) {
+		for (int y = items[i].y1; y >= items[i].y0; --y) {
+			for (int x = items[i].x1; x >= items[i].x0; --x) {
+				CF_SpatialHashEntry& entry = entries[--starts[s_bucket(hash, x, y)]];
+				entry.item = i;
+				entry.x = x;
+				entry.y = y;
+			}
+		}
+	}
+}
+
+int cf_spatial_hash_count(const CF_SpatialHash* hash)
+{
+	return hash->items.count();
+}
+
+int cf_spatial_hash_query(const CF_SpatialHash* hash, CF_Aabb aabb, int* ids, int capacity)
+{
+	const CF_SpatialHashItem* items = hash->items.data();
+	const int* starts = hash->starts.data();
+	const CF_SpatialHashEntry* entries = hash->entries.data();
+	int qx0 = s_cell(hash, aabb.min.x);
+	int qy0 = s_cell(hash, aabb.min.y);
+	int qx1 = s_cell(hash, aabb.max.x);
+	int qy1 = s_cell(hash, aabb.max.y);
+	int count = 0;
+	for (int y = qy0; y <= qy1; ++y) {
+		for (int x = qx0; x <= qx1; ++x) {
+			int b = s_bucket(hash, x, y);
+			for (int e = starts[b]; e < starts[b + 1]; ++e) {
+				if (entries[e].x != x || entries[e].y != y) continue;
+				const CF_SpatialHashItem* item = items + entries[e].item;
+				// A box spanning several cells of the query is only reported from the first one they share.
+				if (x != cf_max(item->x0, qx0) || y != cf_max(item->y0, qy0)) continue;
+				if (!cf_overlaps(item->box, aabb)) continue;
+				if (count < capacity) ids[count] = item->id;
+				++count;
+			}
+		}
+	}
+	return count;
+}
+
+struct CF_SpatialHashBatch
+{
+	const CF_SpatialHash* hash;
+	const CF_Aabb* queries;
+	int* ids;
+	int capacity;
+	int* counts;
+};
+
+static void s_query_range(int begin, int end, void* udata)
+{
+	CF_SpatialHashBatch* batch = (CF_SpatialHashBatch*)udata;
+	for (int i = begin; i < end; ++i) {
+		batch->counts[i] = cf_spatial_hash_query(batch->hash, batch->queries[i], batch->ids + (size_t)i * batch->capacity, batch->capacity);
+	}
+}
+
+void cf_spatial_hash_query_batch(const CF_SpatialHash* hash, const CF_Aabb* queries, int query_count, int* ids, int capacity, int* counts, CF_Threadpool* pool)
+{
+	CF_SpatialHashBatch batch = { hash, queries, ids, capacity, counts };
+	cf_parallel_for(pool, 0, query_count, 64, s_query_range, &batch);
+}
@@ -18,4 +18,27 @@
 #	define CF_REALLOC(ptr, size) cf_realloc(ptr, size)
 #endif
 
+// Releases every thread's frame arenas (see cf_frame_alloc). Called by cf_destroy_app once no
+// other thread can be allocating; a thread that calls cf_frame_alloc afterwards gets fresh ones.
+void cf_destroy_frame_arenas();
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#	define CF_RETURN_ADDRESS() _ReturnAddress()
+#	define CF_NOINLINE __declspec(noinline)
+#else
+#	define CF_RETURN_ADDRESS() __builtin_return_address(0)
+#	define CF_NOINLINE __attribute__((noinline))
+#endif
+
+// Makes the allocation tracker's callsite report credit allocations to `callsite` instead of the
+// function calling cf_alloc, until set back. Returns the previous value to restore afterwards.
+// Allocator wrappers pass their own CF_RETURN_ADDRESS(), and are CF_NOINLINE so that really is
+// their caller.
+void* cf_alloc_set_callsite(void* callsite);
+
+// Depth of the calling thread's allocation tag stack (see cf_alloc_tag_push). Fiber jobs check
+// it around a suspend, since a tag scope left open would be popped on whichever thread resumes.
+int cf_alloc_tag_depth();
+
 #endif // CF_ALLOC_INTERNAL_H
@@ -15,8 +15,31 @@
 #include <cute_graphics.h>
 
 #include <float.h>
+#include <atomic>
 
-extern struct CF_Draw* s_draw;
+// The app's draw state: the renderer plus every resource shared by all threads (atlas cache,
+// baked paths, draw lists, custom shapes). Recording code running on a CF_DrawRecorder reads
+// shared resources through here rather than s_draw.
+extern struct CF_Draw* s_draw_app;
+
+// The calling thread's recorder between cf_draw_recorder_begin/end, otherwise NULL.
+extern thread_local struct CF_Draw* s_draw_recorder;
+
+// How many threads are between cf_draw_recorder_begin/end. Relaxed is enough: a thread only
+// needs to see its own begin, and any other thread's s_draw_recorder is NULL either way.
+extern std::atomic<int> s_draw_recording;
+
+// The draw state cf_draw_* records into on the calling thread: the recorder's own between
+// cf_draw_recorder_begin/end, otherwise the app's. The thread-local is only looked up while a
+// recorder is recording, so without recorders this is a plain load and a branch. Functions
+// run once per shape read it into a local rather than going through it per field.
+CF_INLINE struct CF_Draw* cf_draw_current()
+{
+	if (s_draw_recording.load(std::memory_order_relaxed) == 0) return s_draw_app;
+	struct CF_Draw* recorder = s_draw_recorder;
+	return recorder ? recorder : s_draw_app;
+}
+#define s_draw (cf_draw_current())
 
 // Dash pattern for strokes (cf_draw_push_dash), all in world units. on == 0 means solid.
 struct CF_DrawDash { float on, off, phase; };
@@ -111,6 +134,54 @@ struct BatchGeometry
 	             // GPU to recover world space per-pixel for SDF evaluation.
 };
 
+// Compact encoding of a BatchGeometry in the per-flush stream (CF_Draw::pending_stream).
+// Each record is a CF_GeomHeader followed by only the blocks the geometry actually uses, in
+// this order: box corners, the leading non-zero shape points, then the dash, effects, CSG,
+// user params, corner colors, tri colors and tri attributes blocks, each only when its flag
+// is set. Dashes and effects are stored only when they draw something. Cameras live in a
+// deduped palette (CF_Draw::pending_mvps) instead of in every record. A plain sprite encodes
+// to 80 bytes. See cf_encode_geom / cf_decode_geom in cute_draw.cpp.
+enum : uint16_t
+{
+	GEOM_FLAG_TEXT           = 1 << 0,
+	GEOM_FLAG_SPRITE         = 1 << 1,
+	GEOM_FLAG_FILL           = 1 << 2,
+	GEOM_FLAG_CSG_OPERAND    = 1 << 3,
+	GEOM_FLAG_BOX            = 1 << 4, // CF_V2[4]
+	GEOM_FLAG_DASH           = 1 << 5, // CF_DrawDash
+	GEOM_FLAG_FX             = 1 << 6, // CF_DrawEffects
+	GEOM_FLAG_CSG            = 1 << 7, // int csg_op, float csg_k
+	GEOM_FLAG_USER_PARAMS    = 1 << 8, // CF_Color
+	GEOM_FLAG_CORNER_COLORS  = 1 << 9, // CF_Color[4], text_colors
+	GEOM_FLAG_TRI_COLORS     = 1 << 10, // CF_Color[3]
+	GEOM_FLAG_TRI_ATTRIBUTES = 1 << 11, // CF_Color[3]
+};
+
+struct CF_GeomHeader
+{
+	uint8_t type;        // BatchGeometryType.
+	uint8_t blend;       // CF_DrawBlend.
+	uint8_t shape_count; // Shape points stored; the rest decode as zero.
+	uint8_t unused;
+	uint16_t flags;      // GEOM_FLAG_*.
+	uint16_t size;       // Whole record in bytes, header included. Always a multiple of 4.
+	int n;
+	uint32_t mvp;        // Index into CF_Draw::pending_mvps.
+	CF_Color color;
+	float alpha;
+	float radius;
+	float stroke;
+	float aa;
+};
+
+// One 4-byte unit of the encoded stream. The empty constructor keeps Array::set_count from
+// zeroing space the encoder is about to overwrite.
+struct CF_GeomWord
+{
+	uint32_t bits;
+	CF_GeomWord() { }
+};
+
 // The atlas cache's opaque per-entry `udata` carries an index back into the
 // unified geometry stream (CF_Command::geoms). Atlas uvs come back via the callback.
 #define ATLAS_CACHE_ASSERT CF_ASSERT
@@ -137,7 +208,7 @@ struct CF_DrawPathData
 	CF_V2 box_max;
 };
 
-// Per-flush sprite/text atlas record, parallel to CF_Draw::pending_geoms. Filled by the
+// Per-flush sprite/text atlas record, one per geometry in CF_Draw::pending_stream. Filled by the
 // atlas_cache callbacks; texture_id stays 0 for shapes.
 struct CF_PendingUV
 {
@@ -185,6 +256,33 @@ struct CF_TileV4 { float x, y, z, w; };
 // Inclusive tile bounds covering a pixel-space AABB. Returns false when fully outside the grid.
 CF_API bool CF_CALL cf_tile_range(float min_x, float min_y, float max_x, float max_y, int tiles_x, int tiles_y, int* x0, int* y0, int* x1, int* y1);
 
+// Appends `g` as one record to `stream`, adding its mvp to `mvps` unless it matches the last one.
+// Returns the record's size in bytes.
+CF_API int CF_CALL cf_encode_geom(const BatchGeometry& g, Cute::Array<CF_M3x2>* mvps, Cute::Array<CF_GeomWord>* stream);
+
+// Decodes the record at `p` into `g`, returning the next record. Everything the encoder left out
+// comes back zeroed.
+CF_API const uint8_t* CF_CALL cf_decode_geom(const uint8_t* p, const CF_M3x2* mvps, BatchGeometry* g);
+
+// Command sort entry: `key` orders by layer, then by id (age), as one unsigned compare.
+// `index` is the command's slot in CF_Draw::cmds, so sorting keys never moves commands.
+struct CF_CmdKey
+{
+	uint64_t key;
+	int index;
+};
+
+CF_INLINE uint64_t cf_cmd_sort_key(int layer, int id)
+{
+	return ((uint64_t)((uint32_t)layer ^ 0x80000000u) << 32) | (uint64_t)(uint32_t)id;
+}
+
+// Stable LSD radix sort of `keys` by key, 8 bits per pass, skipping passes where every key
+// has the same digit. `scratch` holds `count` entries and serves as the other ping-pong
+// buffer. Returns whichever of the two ends up sorted. Input already in order returns `keys`
+// after a single O(n) check.
+CF_API CF_CmdKey* CF_CALL cf_sort_cmd_keys(CF_CmdKey* keys, CF_CmdKey* scratch, int count);
+
 // Runtime toggles for tests, samples, and perf comparison. The setters force a path;
 // cf_draw_set_tiled_auto restores the default per-batch heuristics (tiled only when
 // opaque-cover culling looks profitable; GPU binning for big-footprint batches).
@@ -198,8 +296,13 @@ CF_API void CF_CALL cf_draw_set_tiled_auto();
 CF_API void CF_CALL cf_draw_set_tiled_list_budget(uint64_t entries);
 
 // Returns and resets per-interval counters: batches drawn via the tile walk, batches
-// drawn via the instanced path, and bytes uploaded. Call once per frame for stats.
-CF_API void CF_CALL cf_draw_tiled_stats(int* tiled_batches, int* instanced_batches, uint64_t* upload_bytes);
+// drawn via the instanced path, bytes uploaded, and drawables culled on the CPU for lying
+// entirely outside their canvas, viewport, and scissor. Call once per frame for stats.
+CF_API void CF_CALL cf_draw_tiled_stats(int* tiled_batches, int* instanced_batches, uint64_t* upload_bytes, int* culled);
+
+// Returns and resets per-interval counters: geometries collated into the flush stream and the
+// bytes they encoded to (see CF_GeomHeader).
+CF_API void CF_CALL cf_draw_stream_stats(int* geoms, uint64_t* bytes);
 
 struct CF_DrawUniform
 {
@@ -313,7 +416,10 @@ struct CF_Draw
 		cmd.shader = shaders.last();
 		return cmd;
 	}
-	int cmd_index = 0;
+	int cmd_index = 0; // Slot in cmds of the command being processed.
+	Cute::Array<CF_CmdKey> cmd_keys;     // cf_render_layers_to's sort keys and
+	Cute::Array<CF_CmdKey> cmd_keys_tmp; // ping-pong scratch.
+	Cute::Array<int> cmd_order;          // cmds slots in render order.
 	int draw_item_order = 0;
 	Cute::Array<CF_Command> cmds;
 	CF_V2 atlas_dims = cf_v2(2048, 2048);
@@ -367,7 +473,6 @@ struct CF_Draw
 	Cute::Array<CF_Color> tri_attributes1 = { cf_make_color_hex(0) };
 	Cute::Array<CF_Color> tri_attributes2 = { cf_make_color_hex(0) };
 	Cute::Array<CF_Shader> shaders;
-	Cute::Array<CF_V2> temp;
 	Cute::Array<float> font_sizes = { 18 };
 	Cute::Array<const char*> fonts = { sintern("Calibri") };
 	Cute::Array<int> blurs = { 0 };
@@ -405,12 +510,13 @@ struct CF_Draw
 	bool need_flush = false;
 	bool has_drawn_something = false;
 
-	// All geometry for the current flush run in paint order, with a parallel per-entry
-	// uv record for sprites/text (filled by the atlas callbacks; texture_id 0 for
-	// shapes). After the flush the stream renders in paint order, splitting into a new
-	// draw wherever the bound atlas texture changes -- paint order holds across atlas
-	// textures.
-	Cute::Array<BatchGeometry> pending_geoms;
+	// All geometry for the current flush run in paint order, encoded as CF_GeomHeader
+	// records, with a parallel per-geometry uv record for sprites/text (filled by the atlas
+	// callbacks; texture_id 0 for shapes) and the records' deduped cameras. After the flush
+	// the stream renders in paint order, splitting into a new draw wherever the bound atlas
+	// texture changes -- paint order holds across atlas textures.
+	Cute::Array<CF_GeomWord> pending_stream;
+	Cute::Array<CF_M3x2> pending_mvps;
 	Cute::Array<CF_PendingUV> pending_uvs;
 	CF_Texture white_texture = { 0 }; // Bound as u_image for shape-only draws.
 
@@ -440,10 +546,29 @@ struct CF_Draw
 	int tiled_batch_count = 0;
 	int instanced_batch_count = 0;
 	uint64_t tiled_upload_bytes = 0;
+	int culled_count = 0;
+	Cute::Array<int> cull_remap; // Per-command scratch: source geometry -> stream index, -1 when culled.
+	int stream_geom_count = 0;      // Geometries encoded into pending_stream.
+	uint64_t stream_bytes = 0;      // Bytes those geometries encoded to.
 
 	// Samplers for filter mode (backend-specific, stored as void* for cross-platform compatibility)
 	void* sampler_nearest = NULL;
 	void* sampler_linear = NULL;
+
+	// Draw recorders (cf_make_draw_recorder), in creation order -- the order their commands
+	// merge into `cmds` at cf_render_layers_to. Only used on s_draw_app.
+	Cute::Array<struct CF_DrawRecorderData*> recorders;
+	// Non-NULL when this CF_Draw is a recorder's recording state rather than the app's.
+	struct CF_DrawRecorderData* recorder = NULL;
+};
+
+// Per-thread recording state for cf_make_draw_recorder. `draw` only uses its recording half:
+// state stacks, camera, uniform arena, and commands.
+struct CF_DrawRecorderData
+{
+	CF_Draw draw;
+	CF_Draw* prev = NULL; // The thread's s_draw_recorder before cf_draw_recorder_begin.
+	bool recording = false;
 };
 
 // Retained draw list contents: deep copies of recorded commands (list-local
@@ -458,6 +583,10 @@ struct CF_DrawListData
 void cf_make_draw();
 void cf_destroy_draw();
 
+// Clears every pushed draw parameter back to its default. Called at the end of each frame on the
+// app's draw state, and at cf_draw_recorder_begin on a recorder's.
+void cf_draw_reset_state(CF_Draw* draw);
+
 // 3d mesh submission layer (cute_draw3d.cpp). Made/destroyed inside cf_make_draw and
 // cf_destroy_draw; cf_draw3d_process renders one mesh command from s_process_command after
 // pending 2d geometry has flushed; cf_draw3d_free_cmd releases a command's mesh payload.
@@ -0,0 +1,15 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_ECS_INTERNAL_H
+#define CF_ECS_INTERNAL_H
+
+// Destroys every entity and frees all registered components, entity types, systems and archetypes.
+// Called by cf_destroy_app. The ECS starts over empty if it's used again afterwards.
+void cf_destroy_ecs();
+
+#endif // CF_ECS_INTERNAL_H
@@ -0,0 +1,35 @@
+/*
+	Cute Framework
+	Copyright (C) 2026 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_PHYSICS_INTERNAL_H
+#define CF_PHYSICS_INTERNAL_H
+
+#include <cute_physics.h>
+#include <cute_math.h>
+#include <cute_math3d.h>
+
+// Pure helpers behind cf_physics_draw* culling and LOD, unit-tested in test/test_physics.cpp.
+// CF_API so the tests still link when CF builds as a shared library.
+
+// cf_physics_debug_draw_defaults, plus joints, with Box2D's broadphase query limited to `view`
+// and solid shapes narrower than `lod_size` drawn as boxes (zero is off). `view` is in world units.
+CF_API b2DebugDraw CF_CALL cf_physics_debug_draw_view(float thickness, CF_Aabb view, float lod_size);
+
+// True when a solid shape with these world bounds should draw as its filled bounds instead.
+CF_API bool CF_CALL cf_physics_lod_box(CF_Aabb bounds, float lod_size);
+
+enum CF_PhysicsCull3
+{
+	CF_PHYSICS_CULL3_HIDDEN, // Outside the frustum, skipped.
+	CF_PHYSICS_CULL3_BOX,    // Beyond the LOD distance, drawn as a solid cube of its bounds.
+	CF_PHYSICS_CULL3_FULL,   // Drawn as the shape itself.
+};
+
+// How a 3d shape with these world bounds draws from `eye`. An `lod_distance` of zero is off.
+CF_API CF_PhysicsCull3 CF_CALL cf_physics_cull3(const CF_Frustum* frustum, CF_V3 eye, float lod_distance, CF_Aabb3 bounds);
+
+#endif // CF_PHYSICS_INTERNAL_H
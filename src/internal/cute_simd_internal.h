@@ -0,0 +1,120 @@
+/*
+	Cute Framework
+	Copyright (C) 2024 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#ifndef CF_SIMD_INTERNAL_H
+#define CF_SIMD_INTERNAL_H
+
+#include <cute_defines.h>
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+// Thin wrappers over AVX (8 lanes), SSE2 or NEON (4 lanes), picked by what the compiler targets.
+// CF_SIMD_WIDTH is left undefined on platforms without SIMD, and callers fall back to scalar loops.
+// Only plain mul/add/sub/min/max/div/sqrt are wrapped, all of which are exactly rounded in every ISA
+// here, so a kernel doing the same operations in the same order as its scalar loop matches it bit for
+// bit (as long as the compiler isn't told to fuse multiply-adds, e.g. -ffp-contract=fast with FMA).
+
+#if defined(__AVX__)
+#	include <immintrin.h>
+#	define CF_SIMD_WIDTH 8
+typedef __m256 s_f;
+typedef __m256 s_m;
+static CF_INLINE s_f s_load(const float* p) { return _mm256_loadu_ps(p); }
+static CF_INLINE void s_store(float* p, s_f a) { _mm256_storeu_ps(p, a); }
+static CF_INLINE s_f s_set(float a) { return _mm256_set1_ps(a); }
+static CF_INLINE s_f s_add(s_f a, s_f b) { return _mm256_add_ps(a, b); }
+static CF_INLINE s_f s_sub(s_f a, s_f b) { return _mm256_sub_ps(a, b); }
+static CF_INLINE s_f s_mul(s_f a, s_f b) { return _mm256_mul_ps(a, b); }
+static CF_INLINE s_f s_div(s_f a, s_f b) { return _mm256_div_ps(a, b); }
+static CF_INLINE s_f s_sqrt(s_f a) { return _mm256_sqrt_ps(a); }
+static CF_INLINE s_f s_min(s_f a, s_f b) { return _mm256_min_ps(a, b); }
+static CF_INLINE s_f s_max(s_f a, s_f b) { return _mm256_max_ps(a, b); }
+static CF_INLINE s_m s_lt(s_f a, s_f b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static CF_INLINE s_m s_le(s_f a, s_f b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static CF_INLINE s_m s_and(s_m a, s_m b) { return _mm256_and_ps(a, b); }
+static CF_INLINE s_m s_or(s_m a, s_m b) { return _mm256_or_ps(a, b); }
+static CF_INLINE int s_movemask(s_m a) { return _mm256_movemask_ps(a); }
+// Stores lane i of a, b, c and d to out[i * 4 + 0..3], e.g. SoA columns out to an array of 4-float structs.
+static CF_INLINE void s_store_interleave4(float* out, s_f a, s_f b, s_f c, s_f d)
+{
+	// In-lane 4x4 transposes of both 128-bit halves, then the halves are put back in lane order.
+	s_f t0 = _mm256_unpacklo_ps(a, b), t1 = _mm256_unpacklo_ps(c, d);
+	s_f t2 = _mm256_unpackhi_ps(a, b), t3 = _mm256_unpackhi_ps(c, d);
+	s_f r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	s_f r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	s_f r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	s_f r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	_mm256_storeu_ps(out, _mm256_permute2f128_ps(r0, r1, 0x20));
+	_mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(r2, r3, 0x20));
+	_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(r0, r1, 0x31));
+	_mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(r2, r3, 0x31));
+}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define CF_SIMD_WIDTH 4
+typedef __m128 s_f;
+typedef __m128 s_m;
+static CF_INLINE s_f s_load(const float* p) { return _mm_loadu_ps(p); }
+static CF_INLINE void s_store(float* p, s_f a) { _mm_storeu_ps(p, a); }
+static CF_INLINE s_f s_set(float a) { return _mm_set1_ps(a); }
+static CF_INLINE s_f s_add(s_f a, s_f b) { return _mm_add_ps(a, b); }
+static CF_INLINE s_f s_sub(s_f a, s_f b) { return _mm_sub_ps(a, b); }
+static CF_INLINE s_f s_mul(s_f a, s_f b) { return _mm_mul_ps(a, b); }
+static CF_INLINE s_f s_div(s_f a, s_f b) { return _mm_div_ps(a, b); }
+static CF_INLINE s_f s_sqrt(s_f a) { return _mm_sqrt_ps(a); }
+static CF_INLINE s_f s_min(s_f a, s_f b) { return _mm_min_ps(a, b); }
+static CF_INLINE s_f s_max(s_f a, s_f b) { return _mm_max_ps(a, b); }
+static CF_INLINE s_m s_lt(s_f a, s_f b) { return _mm_cmplt_ps(a, b); }
+static CF_INLINE s_m s_le(s_f a, s_f b) { return _mm_cmple_ps(a, b); }
+static CF_INLINE s_m s_and(s_m a, s_m b) { return _mm_and_ps(a, b); }
+static CF_INLINE s_m s_or(s_m a, s_m b) { return _mm_or_ps(a, b); }
+static CF_INLINE int s_movemask(s_m a) { return _mm_movemask_ps(a); }
+static CF_INLINE void s_store_interleave4(float* out, s_f a, s_f b, s_f c, s_f d)
+{
+	s_f t0 = _mm_unpacklo_ps(a, b), t1 = _mm_unpacklo_ps(c, d);
+	s_f t2 = _mm_unpackhi_ps(a, b), t3 = _mm_unpackhi_ps(c, d);
+	_mm_storeu_ps(out, _mm_movelh_ps(t0, t1));
+	_mm_storeu_ps(out + 4, _mm_movehl_ps(t1, t0));
+	_mm_storeu_ps(out + 8, _mm_movelh_ps(t2, t3));
+	_mm_storeu_ps(out + 12, _mm_movehl_ps(t3, t2));
+}
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#	include <arm_neon.h>
+#	define CF_SIMD_WIDTH 4
+typedef float32x4_t s_f;
+typedef uint32x4_t s_m;
+static CF_INLINE s_f s_load(const float* p) { return vld1q_f32(p); }
+static CF_INLINE void s_store(float* p, s_f a) { vst1q_f32(p, a); }
+static CF_INLINE s_f s_set(float a) { return vdupq_n_f32(a); }
+static CF_INLINE s_f s_add(s_f a, s_f b) { return vaddq_f32(a, b); }
+static CF_INLINE s_f s_sub(s_f a, s_f b) { return vsubq_f32(a, b); }
+static CF_INLINE s_f s_mul(s_f a, s_f b) { return vmulq_f32(a, b); }
+static CF_INLINE s_f s_div(s_f a, s_f b) { return vdivq_f32(a, b); }
+static CF_INLINE s_f s_sqrt(s_f a) { return vsqrtq_f32(a); }
+static CF_INLINE s_f s_min(s_f a, s_f b) { return vminq_f32(a, b); }
+static CF_INLINE s_f s_max(s_f a, s_f b) { return vmaxq_f32(a, b); }
+static CF_INLINE s_m s_lt(s_f a, s_f b) { return vcltq_f32(a, b); }
+static CF_INLINE s_m s_le(s_f a, s_f b) { return vcleq_f32(a, b); }
+static CF_INLINE s_m s_and(s_m a, s_m b) { return vandq_u32(a, b); }
+static CF_INLINE s_m s_or(s_m a, s_m b) { return vorrq_u32(a, b); }
+static CF_INLINE int s_movemask(s_m a)
+{
+	static const uint32_t bits[4] = { 1, 2, 4, 8 };
+	return (int)vaddvq_u32(vandq_u32(a, vld1q_u32(bits)));
+}
+static CF_INLINE void s_store_interleave4(float* out, s_f a, s_f b, s_f c, s_f d)
+{
+	float32x4x4_t v = { { a, b, c, d } };
+	vst4q_f32(out, v);
+}
+#endif
+
+#endif // CF_SIMD_INTERNAL_H
@@ -55,11 +55,15 @@ TEST_SUITE(test_texture_types);
 TEST_SUITE(test_shadow_sampling);
 TEST_SUITE(test_instancing);
 TEST_SUITE(test_draw3d);
+TEST_SUITE(test_ecs);
 TEST_SUITE(test_uniform_arrays);
 TEST_SUITE(test_math);
 TEST_SUITE(test_math3d);
 TEST_SUITE(test_model);
 TEST_SUITE(test_physics);
+TEST_SUITE(test_spatial_hash);
+TEST_SUITE(test_pathfinding);
+TEST_SUITE(test_multithreading);
 extern "C" {
 TEST_SUITE(test_math_c);
 TEST_SUITE(test_math3d_c);
@@ -128,6 +132,7 @@ int main(int argc, char* argv[])
 	RUN_TRACED(test_shadow_sampling);
 	RUN_TRACED(test_instancing);
 	RUN_TRACED(test_draw3d);
+	RUN_TRACED(test_ecs);
 	RUN_TRACED(test_uniform_arrays);
 	RUN_TRACED(test_math);
 	RUN_TRACED(test_math_c);
@@ -135,6 +140,9 @@ int main(int argc, char* argv[])
 	RUN_TRACED(test_math3d_c);
 	RUN_TRACED(test_model);
 	RUN_TRACED(test_physics);
+	RUN_TRACED(test_spatial_hash);
+	RUN_TRACED(test_pathfinding);
+	RUN_TRACED(test_multithreading);
 	// test_ckit calls sintern_nuke(), which invalidates every interned pointer a live
 	// engine holds as map keys (cf_sinuke's documented contract: not while an app
 	// exists). Kill the shared app first; the next GPU suite boots a fresh one whose
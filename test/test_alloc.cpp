@@ -81,10 +81,561 @@ TEST_CASE(test_allocator_forwards_udata)
 	return true;
 }
 
+//--------------------------------------------------------------------------------------------------
+// Block arenas hand oversized allocations a block of their own, and free them LIFO like any other.
+
+TEST_CASE(test_arena_oversized)
+{
+	CF_Arena arena = cf_make_arena(16, 256);
+	char* a = (char*)cf_arena_alloc(&arena, 100);
+	char* big = (char*)cf_arena_alloc(&arena, 1000);
+	REQUIRE(a && big);
+	REQUIRE(!((uintptr_t)big & 15));
+	CF_MEMSET(big, 0xAB, 1000);
+	char* b = (char*)cf_arena_alloc(&arena, 100);
+	REQUIRE(b);
+	REQUIRE(big[999] == (char)0xAB);
+
+	// Reuse after reset: the small cached block gets traded for one that fits a bigger request.
+	cf_arena_reset(&arena);
+	REQUIRE(cf_arena_alloc(&arena, 100) == a);
+	char* bigger = (char*)cf_arena_alloc(&arena, 4000);
+	REQUIRE(bigger);
+	CF_MEMSET(bigger, 0, 4000);
+	cf_arena_free(&arena, 4000);
+	REQUIRE(cf_arena_alloc(&arena, 4000) == bigger);
+
+	cf_arena_reset(&arena);
+	cf_arena_decommit(&arena);
+	REQUIRE(asize(arena.blocks) == 1);
+	cf_destroy_arena(&arena);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Virtual arenas reserve address space and commit on demand; everything lands contiguously.
+
+TEST_CASE(test_virtual_arena)
+{
+	CF_Arena arena = cf_make_virtual_arena(16, (size_t)64 * CF_MB);
+	if (!arena.base) {
+		// No virtual memory on this platform, the arena fell back to chained blocks.
+		cf_destroy_arena(&arena);
+		return true;
+	}
+
+	char* first = (char*)cf_arena_alloc(&arena, 10);
+	REQUIRE(first == arena.base);
+	char* prev = first;
+	for (int i = 0; i < 1000; ++i) {
+		char* p = (char*)cf_arena_alloc(&arena, 24);
+		REQUIRE(p == prev + (i == 0 ? 16 : 32));
+		CF_MEMSET(p, i, 24);
+		prev = p;
+	}
+
+	// A single allocation far larger than the commit step.
+	char* big = (char*)cf_arena_alloc(&arena, 16 * CF_MB);
+	REQUIRE(big == prev + 32);
+	big[0] = 1;
+	big[16 * CF_MB - 1] = 2;
+	REQUIRE(arena.end - arena.base >= 16 * CF_MB);
+
+	// LIFO free rewinds the bump pointer.
+	cf_arena_free(&arena, 16 * CF_MB);
+	REQUIRE(cf_arena_alloc(&arena, 64) == big);
+
+	// Reset keeps pages committed, decommit releases them, and the arena is still usable after.
+	cf_arena_reset(&arena);
+	char* committed = arena.end;
+	REQUIRE(cf_arena_alloc(&arena, 10) == first);
+	cf_arena_decommit(&arena);
+	REQUIRE(arena.end < committed);
+	char* again = (char*)cf_arena_alloc(&arena, 8 * CF_MB);
+	REQUIRE(again);
+	again[8 * CF_MB - 1] = 3;
+
+	// Running out of reserved space fails cleanly instead of crashing.
+	REQUIRE(cf_arena_alloc(&arena, 60 * CF_MB) == NULL);
+	REQUIRE(cf_arena_alloc(&arena, CF_MB) != NULL);
+
+	cf_destroy_arena(&arena);
+	REQUIRE(arena.base == NULL);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Frame allocations reset when the frame advances; double-buffered ones survive one extra frame.
+
+static int s_frame_alloc_thread(void* udata)
+{
+	// Every thread gets its own arena, so each allocation here is contiguous with the last.
+	int* ok = (int*)udata;
+	char* prev = (char*)cf_frame_alloc(16);
+	for (int i = 0; i < 10000; ++i) {
+		char* p = (char*)cf_frame_alloc(16);
+		if (p != prev + 16) *ok = 0;
+		CF_MEMSET(p, i, 16);
+		prev = p;
+	}
+	return 0;
+}
+
+TEST_CASE(test_frame_alloc)
+{
+	cf_frame_alloc_advance();
+	int* a = (int*)cf_frame_alloc(sizeof(int) * 100);
+	REQUIRE(a);
+	REQUIRE(!((uintptr_t)a & 15));
+	for (int i = 0; i < 100; ++i) a[i] = i;
+
+	// A new frame hands the same memory out again.
+	cf_frame_alloc_advance();
+	int* b = (int*)cf_frame_alloc(sizeof(int) * 100);
+	REQUIRE(b == a);
+
+	// Double-buffered memory from this frame is untouched by next frame's allocations.
+	int* d0 = (int*)cf_frame_alloc_double_buffered(sizeof(int) * 100);
+	for (int i = 0; i < 100; ++i) d0[i] = i;
+	cf_frame_alloc_advance();
+	int* d1 = (int*)cf_frame_alloc_double_buffered(sizeof(int) * 100);
+	REQUIRE(d1 != d0);
+	for (int i = 0; i < 100; ++i) d1[i] = -1;
+	for (int i = 0; i < 100; ++i) REQUIRE(d0[i] == i);
+	cf_frame_alloc_advance();
+	REQUIRE(cf_frame_alloc_double_buffered(sizeof(int) * 100) == d0);
+
+	// Big allocations are fine too.
+	char* big = (char*)cf_frame_alloc(32 * CF_MB);
+	REQUIRE(big);
+	big[32 * CF_MB - 1] = 1;
+
+	int ok[4] = { 1, 1, 1, 1 };
+	CF_Thread* threads[4];
+	for (int i = 0; i < 4; ++i) threads[i] = cf_thread_create(s_frame_alloc_thread, "frame_alloc", ok + i);
+	for (int i = 0; i < 4; ++i) cf_thread_wait(threads[i]);
+	for (int i = 0; i < 4; ++i) REQUIRE(ok[i]);
+	cf_frame_alloc_advance();
+
+	return true;
+}
+
+TEST_CASE(test_memory_pool_stats)
+{
+	CF_MemoryPool* pool = cf_make_memory_pool(16, 4, 8);
+	void* elements[6];
+	for (int i = 0; i < 6; ++i) elements[i] = cf_memory_pool_alloc(pool);
+	CF_MemoryPoolStats stats = cf_memory_pool_stats(pool);
+	REQUIRE(stats.live_elements == 6);
+	REQUIRE(stats.high_water_mark == 6);
+	REQUIRE(stats.elements_per_block == 4);
+	REQUIRE(stats.block_count == 2);
+
+	for (int i = 0; i < 6; ++i) cf_memory_pool_free(pool, elements[i]);
+	elements[0] = cf_memory_pool_alloc(pool);
+	stats = cf_memory_pool_stats(pool);
+	REQUIRE(stats.live_elements == 1);
+	REQUIRE(stats.high_water_mark == 6);
+	cf_memory_pool_free(pool, elements[0]);
+
+	cf_destroy_memory_pool(pool);
+	return true;
+}
+
+static int s_find_alloc_tag(const char* name)
+{
+	for (int i = 0; i < cf_alloc_tracking_tag_count(); ++i) {
+		if (!CF_STRCMP(cf_alloc_tracking_tag_stats(i).name, name)) return i;
+	}
+	return -1;
+}
+
+static int s_alloc_tracking_thread(void* udata)
+{
+	// Frees are credited to the tag the memory was allocated under, whichever thread frees it.
+	CF_ALLOC_TAG_SCOPE("test_tracking_thread");
+	cf_free(udata);
+	return 0;
+}
+
+TEST_CASE(test_alloc_tracking)
+{
+	cf_alloc_tracking_enable(true);
+
+	void* a;
+	void* b;
+	void* c;
+	{
+		CF_ALLOC_TAG_SCOPE("test_tracking");
+		a = cf_alloc(100);
+		b = cf_calloc(50, 4);
+		{
+			CF_ALLOC_TAG_SCOPE("test_tracking_inner");
+			c = cf_aligned_alloc(64, 32);
+		}
+	}
+	int tag = s_find_alloc_tag("test_tracking");
+	int inner = s_find_alloc_tag("test_tracking_inner");
+	REQUIRE(tag > 0);
+	REQUIRE(inner > 0);
+	CF_AllocTagStats stats = cf_alloc_tracking_tag_stats(tag);
+	REQUIRE(stats.live_bytes == 300);
+	REQUIRE(stats.live_count == 2);
+	REQUIRE(cf_alloc_tracking_tag_stats(inner).live_count == 1);
+
+	cf_free(a);
+	void* old_b = b;
+	{
+		CF_ALLOC_TAG_SCOPE("test_tracking");
+		b = cf_realloc(b, 1000);
+	}
+	// Only a realloc that moved the block counts as an allocation.
+	int moved = b != old_b;
+	stats = cf_alloc_tracking_tag_stats(tag);
+	REQUIRE(stats.live_bytes == 1000);
+	REQUIRE(stats.live_count == 1);
+	REQUIRE(stats.peak_bytes == 1000);
+	REQUIRE(stats.total_allocs == 2 + moved);
+
+	cf_alloc_tracking_advance_frame();
+	stats = cf_alloc_tracking_tag_stats(tag);
+	REQUIRE(stats.frame_allocs == 2 + moved);
+	REQUIRE(stats.frame_bytes == 300 + (moved ? 1000 : 0));
+	cf_alloc_tracking_advance_frame();
+	REQUIRE(cf_alloc_tracking_tag_stats(tag).frame_allocs == 0);
+
+	CF_Thread* thread = cf_thread_create(s_alloc_tracking_thread, "alloc_tracking", b);
+	cf_thread_wait(thread);
+	REQUIRE(cf_alloc_tracking_tag_stats(tag).live_count == 0);
+	REQUIRE(cf_alloc_tracking_tag_stats(tag).live_bytes == 0);
+	cf_aligned_free(c);
+	REQUIRE(cf_alloc_tracking_tag_stats(inner).live_bytes == 0);
+	REQUIRE(cf_alloc_tracking_totals().peak_bytes >= 1064);
+
+	CF_AllocCallsite callsites[4];
+	int callsite_count = cf_alloc_tracking_top_callsites(callsites, 4);
+	REQUIRE(callsite_count > 0);
+	for (int i = 1; i < callsite_count; ++i) REQUIRE(callsites[i - 1].bytes >= callsites[i].bytes);
+
+	char* json = cf_alloc_tracking_to_json(4);
+	REQUIRE(CF_STRSTR(json, "\"name\":\"test_tracking\",\"live_bytes\":0,\"peak_bytes\":1000"));
+	REQUIRE(CF_STRSTR(json, "\"callsites\":[{"));
+	sfree(json);
+
+	// Memory from before tracking was enabled is simply not found when freed.
+	cf_alloc_tracking_disable();
+	void* untracked = cf_alloc(16);
+	cf_alloc_tracking_enable(false);
+	cf_free(untracked);
+	REQUIRE(cf_alloc_tracking_totals().live_count == 0);
+	REQUIRE(cf_alloc_tracking_top_callsites(callsites, 4) == 0);
+	cf_alloc_tracking_disable();
+	return true;
+}
+
+static void* s_failing_realloc(void* ptr, size_t size, void* udata)
+{
+	CF_UNUSED(ptr);
+	CF_UNUSED(size);
+	CF_UNUSED(udata);
+	return NULL;
+}
+
+// Pretends every resize fits in place. Only used to shrink.
+static void* s_in_place_realloc(void* ptr, size_t size, void* udata)
+{
+	CF_UNUSED(size);
+	CF_UNUSED(udata);
+	return ptr;
+}
+
+// A failed realloc leaves the original block alive, so it must stay tracked. One that resizes in
+// place is not another allocation.
+TEST_CASE(test_alloc_tracking_realloc)
+{
+	CF_Allocator allocator = { };
+	allocator.alloc_fn = s_test_alloc;
+	allocator.free_fn = s_test_free;
+	allocator.calloc_fn = s_test_calloc;
+	allocator.realloc_fn = s_failing_realloc;
+	cf_allocator_override(allocator);
+	AllocatorRestoreGuard restore_guard;
+	cf_alloc_tracking_enable(false);
+
+	void* p;
+	{
+		CF_ALLOC_TAG_SCOPE("test_failed_realloc");
+		p = cf_alloc(100);
+		REQUIRE(cf_realloc(p, 1000) == NULL);
+	}
+	int tag = s_find_alloc_tag("test_failed_realloc");
+	CF_AllocTagStats stats = cf_alloc_tracking_tag_stats(tag);
+	REQUIRE(stats.live_bytes == 100);
+	REQUIRE(stats.live_count == 1);
+	REQUIRE(stats.total_allocs == 1);
+	REQUIRE(cf_alloc_tracking_totals().live_count == 1);
+
+	// Resizing in place changes the live bytes, but isn't another allocation.
+	allocator.realloc_fn = s_in_place_realloc;
+	cf_allocator_override(allocator);
+	{
+		CF_ALLOC_TAG_SCOPE("test_failed_realloc");
+		REQUIRE(cf_realloc(p, 50) == p);
+	}
+	stats = cf_alloc_tracking_tag_stats(tag);
+	REQUIRE(stats.live_bytes == 50);
+	REQUIRE(stats.live_count == 1);
+	REQUIRE(stats.total_allocs == 1);
+
+	cf_free(p);
+	REQUIRE(cf_alloc_tracking_tag_stats(tag).live_count == 0);
+	REQUIRE(cf_alloc_tracking_totals().live_count == 0);
+	cf_alloc_tracking_disable();
+	return true;
+}
+
+struct SlabThread
+{
+	CF_Allocator slab;
+	void** mine;  // Allocated and stamped by this thread.
+	void** theirs; // Allocated by another thread, freed by this one.
+	int count;
+	int index;
+	int ok;
+};
+
+static int s_slab_alloc_thread(void* udata)
+{
+	SlabThread* t = (SlabThread*)udata;
+	for (int i = 0; i < t->count; ++i) {
+		int size = 8 + (i * 37) % 500;
+		int* p = (int*)t->slab.alloc_fn(size, t->slab.udata);
+		p[0] = t->index;
+		p[1] = i;
+		t->mine[i] = p;
+	}
+	return 0;
+}
+
+static int s_slab_free_thread(void* udata)
+{
+	SlabThread* t = (SlabThread*)udata;
+	for (int i = 0; i < t->count; ++i) {
+		int* p = (int*)t->theirs[i];
+		if (p[1] != i) t->ok = 0;
+		t->slab.free_fn(p, t->slab.udata);
+	}
+	return 0;
+}
+
+TEST_CASE(test_slab_allocator)
+{
+	// Used through the function pointers directly, rather than installed, as everything the test
+	// harness already allocated came from the default allocator.
+	CF_Allocator slab = cf_slab_allocator();
+	CF_AlignedAllocator slab_aligned = cf_slab_aligned_allocator();
+
+	// Every size up to and past the largest class can be written in full, and neighbours don't overlap.
+	const int count = 600;
+	char* ptrs[count];
+	for (int i = 0; i < count; ++i) {
+		int size = i * 61;
+		ptrs[i] = (char*)slab.alloc_fn(size, slab.udata);
+		REQUIRE(ptrs[i]);
+		REQUIRE(!((uintptr_t)ptrs[i] & 15));
+		CF_MEMSET(ptrs[i], i & 0xFF, size);
+	}
+	for (int i = 0; i < count; ++i) {
+		int size = i * 61;
+		for (int j = 0; j < size; j += 61) REQUIRE((unsigned char)ptrs[i][j] == (i & 0xFF));
+		slab.free_fn(ptrs[i], slab.udata);
+	}
+
+	// Aligned allocations come straight out of a suitable size class.
+	for (int alignment = 16; alignment <= 256; alignment *= 2) {
+		for (int size = 1; size < 50000; size = size * 3 + 1) {
+			void* p = slab_aligned.aligned_alloc_fn(size, alignment, slab_aligned.udata);
+			REQUIRE(!((uintptr_t)p & (alignment - 1)));
+			CF_MEMSET(p, 0xCD, size);
+			slab_aligned.aligned_free_fn(p, slab_aligned.udata);
+		}
+	}
+
+	// Realloc keeps the contents, across size classes and into large allocations.
+	int* a = NULL;
+	for (int n = 1; n <= 100000; n *= 2) {
+		a = (int*)slab.realloc_fn(a, sizeof(int) * n, slab.udata);
+		for (int i = n / 2; i < n; ++i) a[i] = i;
+		for (int i = 0; i < n; ++i) REQUIRE(a[i] == i);
+	}
+	a = (int*)slab.realloc_fn(a, sizeof(int) * 10, slab.udata);
+	for (int i = 0; i < 10; ++i) REQUIRE(a[i] == i);
+	slab.free_fn(a, slab.udata);
+
+	int* z = (int*)slab.calloc_fn(sizeof(int), 1000, slab.udata);
+	for (int i = 0; i < 1000; ++i) REQUIRE(z[i] == 0);
+	slab.free_fn(z, slab.udata);
+
+	// Each thread frees what its neighbour allocated.
+	const int threads = 4;
+	const int per_thread = 20000;
+	void** elements = (void**)cf_alloc(sizeof(void*) * threads * per_thread);
+	SlabThread t[threads];
+	CF_Thread* handles[threads];
+	for (int i = 0; i < threads; ++i) {
+		t[i] = { slab, elements + i * per_thread, elements + ((i + 1) % threads) * per_thread, per_thread, i, 1 };
+		handles[i] = cf_thread_create(s_slab_alloc_thread, "slab alloc", t + i);
+	}
+	for (int i = 0; i < threads; ++i) cf_thread_wait(handles[i]);
+	for (int i = 0; i < threads; ++i) handles[i] = cf_thread_create(s_slab_free_thread, "slab free", t + i);
+	for (int i = 0; i < threads; ++i) cf_thread_wait(handles[i]);
+	for (int i = 0; i < threads; ++i) REQUIRE(t[i].ok);
+	cf_free(elements);
+
+	return true;
+}
+
+// An allocation trace is a list of operations on numbered allocations. Traces can be loaded from
+// a file named by the CF_ALLOC_TRACE environment variable, one operation per line:
+//
+//     a <id> <size>    allocate
+//     r <id> <size>    realloc
+//     f <id>           free
+//
+// (capture one by installing a CF_Allocator that logs before forwarding to the default). Without
+// one, a synthetic trace stands in: dynamic arrays doubling, short-lived strings and map churn.
+struct AllocOp
+{
+	char op;
+	int id;
+	int size;
+};
+
+static Array<AllocOp> s_synthetic_alloc_trace()
+{
+	Array<AllocOp> ops;
+	CF_Rnd rnd = cf_rnd_seed(7);
+	int next_id = 0;
+	Array<int> live;
+	for (int frame = 0; frame < 200; ++frame) {
+		// A few arrays grow by doubling, then most are thrown away.
+		for (int i = 0; i < 20; ++i) {
+			int id = next_id++;
+			ops.add({ 'a', id, 16 });
+			int grow = (int)cf_rnd_range_int(&rnd, 1, 10);
+			for (int g = 1; g <= grow; ++g) ops.add({ 'r', id, 16 << g });
+			if (cf_rnd_range_int(&rnd, 0, 9) == 0) live.add(id);
+			else ops.add({ 'f', id, 0 });
+		}
+		// Formatted strings, freed right away.
+		for (int i = 0; i < 200; ++i) {
+			int id = next_id++;
+			ops.add({ 'a', id, (int)cf_rnd_range_int(&rnd, 8, 200) });
+			ops.add({ 'f', id, 0 });
+		}
+		// Map nodes and such that live a while.
+		for (int i = 0; i < 100; ++i) {
+			int id = next_id++;
+			ops.add({ 'a', id, (int)cf_rnd_range_int(&rnd, 16, 1024) });
+			live.add(id);
+		}
+		while (live.count() > 2000) {
+			int i = (int)cf_rnd_range_int(&rnd, 0, live.count() - 1);
+			ops.add({ 'f', live[i], 0 });
+			live.unordered_remove(i);
+		}
+	}
+	for (int i = 0; i < live.count(); ++i) ops.add({ 'f', live[i], 0 });
+	return ops;
+}
+
+static Array<AllocOp> s_load_alloc_trace(const char* path)
+{
+	Array<AllocOp> ops;
+	FILE* fp = fopen(path, "r");
+	if (!fp) return ops;
+	AllocOp op = { };
+	char c;
+	while (fscanf(fp, " %c %d", &c, &op.id) == 2) {
+		op.op = c;
+		op.size = 0;
+		if (c != 'f' && fscanf(fp, "%d", &op.size) != 1) break;
+		ops.add(op);
+	}
+	fclose(fp);
+	return ops;
+}
+
+struct AllocReplay
+{
+	CF_Allocator allocator;
+	const Array<AllocOp>* ops;
+	int id_count;
+};
+
+static int s_replay_alloc_trace(void* udata)
+{
+	AllocReplay* r = (AllocReplay*)udata;
+	CF_Allocator a = r->allocator;
+	void** ptrs = (void**)calloc(r->id_count, sizeof(void*));
+	for (int i = 0; i < r->ops->count(); ++i) {
+		const AllocOp& op = (*r->ops)[i];
+		switch (op.op) {
+		case 'a': ptrs[op.id] = a.alloc_fn(op.size, a.udata); *(char*)ptrs[op.id] = 1; break;
+		case 'r': ptrs[op.id] = a.realloc_fn(ptrs[op.id], op.size, a.udata); break;
+		case 'f': a.free_fn(ptrs[op.id], a.udata); ptrs[op.id] = NULL; break;
+		}
+	}
+	for (int i = 0; i < r->id_count; ++i) if (ptrs[i]) a.free_fn(ptrs[i], a.udata);
+	free(ptrs);
+	return 0;
+}
+
+// Not an assertion test -- replays an allocation trace on 1 and 4 threads through the default
+// allocator and the slab allocator. Prints millions of operations per second.
+TEST_CASE(test_slab_allocator_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const char* path = getenv("CF_ALLOC_TRACE");
+	Array<AllocOp> ops = path ? s_load_alloc_trace(path) : s_synthetic_alloc_trace();
+	int id_count = 0;
+	for (int i = 0; i < ops.count(); ++i) id_count = ops[i].id + 1 > id_count ? ops[i].id + 1 : id_count;
+
+	// Plain libc, as the default allocator does.
+	CF_Allocator allocators[2] = { { }, cf_slab_allocator() };
+	allocators[0].alloc_fn = [](size_t size, void*) { return malloc(size); };
+	allocators[0].free_fn = [](void* ptr, void*) { free(ptr); };
+	allocators[0].realloc_fn = [](void* ptr, size_t size, void*) { return realloc(ptr, size); };
+	for (int thread_count = 1; thread_count <= 4; thread_count *= 4) {
+		double rate[2];
+		for (int k = 0; k < 2; ++k) {
+			AllocReplay replay = { allocators[k], &ops, id_count };
+			CF_Thread* threads[4];
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			for (int t = 0; t < thread_count; ++t) threads[t] = cf_thread_create(s_replay_alloc_trace, "alloc replay", &replay);
+			for (int t = 0; t < thread_count; ++t) cf_thread_wait(threads[t]);
+			double seconds = cf_get_ticks() / (double)cf_get_tick_frequency() - t0;
+			rate[k] = (double)ops.count() * thread_count / seconds / 1000000.0;
+		}
+		printf("[bench] %s trace, %d ops, %d thread(s): malloc %.2f M ops/s, slab %.2f M ops/s\n", path ? path : "synthetic", ops.count(), thread_count, rate[0], rate[1]);
+	}
+	return true;
+}
+
 //--------------------------------------------------------------------------------------------------
 // Test suite.
 
 TEST_SUITE(test_alloc)
 {
 	RUN_TEST_CASE(test_allocator_forwards_udata);
+	RUN_TEST_CASE(test_arena_oversized);
+	RUN_TEST_CASE(test_virtual_arena);
+	RUN_TEST_CASE(test_frame_alloc);
+	RUN_TEST_CASE(test_memory_pool_stats);
+	RUN_TEST_CASE(test_alloc_tracking);
+	RUN_TEST_CASE(test_alloc_tracking_realloc);
+	RUN_TEST_CASE(test_slab_allocator);
+	RUN_TEST_CASE(test_slab_allocator_bench);
 }
@@ -12,6 +12,9 @@
 #include <internal/cute_draw_internal.h>
 #include <internal/cute_app_internal.h>
 
+#include <algorithm>
+#include <limits.h>
+
 using namespace Cute;
 
 // -------------------------------------------------------------------------------------------------
@@ -36,8 +39,204 @@ TEST_CASE(test_tile_range_basics)
 	return true;
 }
 
+// Flush stream records (cf_encode_geom / cf_decode_geom). A compact geometry leaves every
+// optional block out, a full one carries all of them at full float precision. Either way the
+// geometry must come back bit for bit.
+static BatchGeometry s_stream_geom(BatchGeometryType type, bool full, float seed)
+{
+	BatchGeometry g;
+	CF_MEMSET(&g, 0, sizeof(g));
+	g.type = type;
+	g.color = cf_make_color_rgba_f(2.5f, 0.1f + seed, 1.0f / 3.0f, 0.75f); // HDR channels survive.
+	g.n = 5;
+	for (int i = 0; i < 4; ++i) g.shape[i] = cf_v2(seed + i * 0.3f, -seed - i * 1.7f);
+	g.alpha = 0.5f;
+	g.radius = 3.25f;
+	g.stroke = 1.0f / 7.0f;
+	g.aa = 1.5f;
+	g.blend = CF_DRAW_BLEND_ADD;
+	g.fill = true;
+	g.mvp = cf_make_transform_TSR(cf_v2(seed, full ? 3.0f : 2.0f), cf_v2(0.01f, 0.02f), seed);
+	// Glyphs always carry their corner colors.
+	bool corner_colors = type == BATCH_GEOMETRY_TYPE_GLYPH;
+	if (full) {
+		for (int i = 0; i < 4; ++i) g.box[i] = cf_v2(-10.0f - i, 20.0f + seed);
+		for (int i = 4; i < 8; ++i) g.shape[i] = cf_v2(i * 1e-7f, i * 1e7f);
+		g.dash = { 4.0f, 2.5f, 0.125f };
+		g.fx.outline = cf_make_color_rgba_f(0.1f, 0.2f, 0.3f, 0.4f);
+		g.fx.outline_width = 2.0f;
+		g.fx.glow = cf_make_color_rgba_f(4.0f, 0.5f, 0.25f, 1.0f);
+		g.fx.glow_radius = 6.0f;
+		g.csg_operand = true;
+		g.csg_op = 2;
+		g.csg_k = 0.75f;
+		g.user_params = cf_make_color_rgba_f(1e-3f, -2.0f, 3e5f, 0.5f);
+		if (type == BATCH_GEOMETRY_TYPE_SPRITE) {
+			g.is_sprite = true;
+			g.is_text = true;
+			corner_colors = true;
+		} else if (!corner_colors) {
+			g.use_tri_colors = true;
+			g.use_tri_attributes = true;
+			for (int i = 0; i < 3; ++i) {
+				g.tri_colors[i] = cf_make_color_rgba_f(0.1f * i, 1.5f, seed, 1.0f);
+				g.tri_attributes[i] = cf_make_color_rgba_f(-1.0f, 0.2f * i, 7.0f, seed);
+			}
+		}
+	}
+	if (corner_colors) {
+		for (int i = 0; i < 4; ++i) g.text_colors[i] = cf_make_color_rgba_f(0.25f * i, 0.5f, 2.0f, 1.0f);
+	}
+	return g;
+}
+
+static bool s_same_geom(const BatchGeometry& a, const BatchGeometry& b)
+{
+	#define CF_SAME(field) (CF_MEMCMP(&a.field, &b.field, sizeof(a.field)) == 0)
+	return CF_SAME(type) && CF_SAME(color) && CF_SAME(box) && CF_SAME(n) && CF_SAME(shape) && CF_SAME(alpha) &&
+		CF_SAME(radius) && CF_SAME(stroke) && CF_SAME(aa) && CF_SAME(dash) && CF_SAME(fx) && CF_SAME(is_text) &&
+		CF_SAME(is_sprite) && CF_SAME(fill) && CF_SAME(use_tri_colors) && CF_SAME(use_tri_attributes) &&
+		CF_SAME(csg_operand) && CF_SAME(csg_op) && CF_SAME(csg_k) && CF_SAME(blend) && CF_SAME(user_params) &&
+		CF_SAME(tri_colors) && CF_SAME(tri_attributes) && CF_SAME(mvp);
+	#undef CF_SAME
+}
+
+TEST_CASE(test_geom_stream_round_trip)
+{
+	Array<BatchGeometry> geoms;
+	for (int type = BATCH_GEOMETRY_TYPE_TRI; type <= BATCH_GEOMETRY_TYPE_GLYPH; ++type) {
+		geoms.add(s_stream_geom((BatchGeometryType)type, false, (float)type));
+		geoms.add(s_stream_geom((BatchGeometryType)type, true, (float)type));
+		// Same camera twice in a row shares one palette entry.
+		geoms.add(s_stream_geom((BatchGeometryType)type, true, (float)type));
+	}
+
+	Array<CF_M3x2> mvps;
+	Array<CF_GeomWord> stream;
+	Array<int> sizes;
+	int total = 0;
+	for (int i = 0; i < geoms.count(); ++i) {
+		sizes.add(cf_encode_geom(geoms[i], &mvps, &stream));
+		REQUIRE(sizes.last() % 4 == 0);
+		total += sizes.last();
+	}
+	REQUIRE(stream.count() * 4 == total);
+	REQUIRE(mvps.count() == geoms.count() / 3 * 2);
+
+	const uint8_t* p = (const uint8_t*)stream.data();
+	for (int i = 0; i < geoms.count(); ++i) {
+		BatchGeometry g;
+		CF_MEMSET(&g, 0xCD, sizeof(g)); // Anything left out must come back zeroed, not stale.
+		const uint8_t* next = cf_decode_geom(p, mvps.data(), &g);
+		REQUIRE(next - p == sizes[i]);
+		REQUIRE(s_same_geom(g, geoms[i]));
+		p = next;
+	}
+
+	// Compact records only pay for what they use: a plain sprite is a header and four points.
+	REQUIRE(sizes[BATCH_GEOMETRY_TYPE_SPRITE * 3] == (int)(sizeof(CF_GeomHeader) + 4 * sizeof(CF_V2)));
+	for (int type = BATCH_GEOMETRY_TYPE_TRI; type <= BATCH_GEOMETRY_TYPE_GLYPH; ++type) {
+		REQUIRE(sizes[type * 3] < sizes[type * 3 + 1]);
+	}
+	return true;
+}
+
+// Command ordering (cf_render_layers_to): the radix sort must match a stable (layer, id) sort.
+TEST_CASE(test_cmd_sort_keys)
+{
+	const int n = 5000;
+	Array<CF_CmdKey> keys;
+	Array<CF_CmdKey> scratch;
+	Array<CF_CmdKey> expect;
+	keys.set_count(n);
+	scratch.set_count(n);
+	uint64_t rnd = 0x9E3779B97F4A7C15ull;
+	auto next = [&]() { rnd ^= rnd << 13; rnd ^= rnd >> 7; rnd ^= rnd << 17; return rnd; };
+
+	// Already in order: returned in place.
+	for (int i = 0; i < n; ++i) {
+		keys[i].key = cf_cmd_sort_key(i / 100 - 20, i);
+		keys[i].index = i;
+	}
+	REQUIRE(cf_sort_cmd_keys(keys.data(), scratch.data(), n) == keys.data());
+
+	// Shuffled ids across negative and positive layers, with duplicate keys to check stability.
+	for (int i = 0; i < n; ++i) {
+		int layer = (int)(next() % 64) - 32;
+		int id = (int)(next() % (n / 2));
+		keys[i].key = cf_cmd_sort_key(layer, id);
+		keys[i].index = i;
+	}
+	expect = keys;
+	std::stable_sort(expect.begin(), expect.end(), [](const CF_CmdKey& a, const CF_CmdKey& b) { return a.key < b.key; });
+	CF_CmdKey* sorted = cf_sort_cmd_keys(keys.data(), scratch.data(), n);
+	for (int i = 0; i < n; ++i) {
+		REQUIRE(sorted[i].key == expect[i].key);
+		REQUIRE(sorted[i].index == expect[i].index);
+	}
+
+	// Layer compares signed, then id.
+	REQUIRE(cf_cmd_sort_key(-1, 100) < cf_cmd_sort_key(0, 0));
+	REQUIRE(cf_cmd_sort_key(3, 1) < cf_cmd_sort_key(3, 2));
+	REQUIRE(cf_cmd_sort_key(INT_MIN, INT_MAX) < cf_cmd_sort_key(INT_MAX, 0));
+
+	return true;
+}
+
+// Not an assertion test -- a benchmark of command ordering. Sorts 100k commands spread over 64
+// layers the old way (std::stable_sort of the CF_Command structs) and through the radix sorted
+// keys, plus the presorted single-layer case. Prints milliseconds; always passes.
+TEST_CASE(test_cmd_sort_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
 
+	const int n = 100000;
+	const int runs = 10;
+	Array<CF_Command> source;
+	source.set_count(n);
+	uint64_t rnd = 0x9E3779B97F4A7C15ull;
+	for (int i = 0; i < n; ++i) {
+		rnd ^= rnd << 13; rnd ^= rnd >> 7; rnd ^= rnd << 17;
+		source[i].id = i;
+		source[i].layer = (int)(rnd % 64);
+	}
 
+	Array<CF_Command> cmds;
+	Array<CF_CmdKey> keys;
+	Array<CF_CmdKey> scratch;
+	Array<int> order;
+	keys.set_count(n);
+	scratch.set_count(n);
+	order.set_count(n);
+	double freq = (double)cf_get_tick_frequency();
+	for (int single_layer = 0; single_layer <= 1; ++single_layer) {
+		if (single_layer) for (int i = 0; i < n; ++i) source[i].layer = 0;
+		double struct_s = 0, key_s = 0;
+		for (int r = 0; r < runs; ++r) {
+			cmds = source;
+			uint64_t t0 = cf_get_ticks();
+			std::stable_sort(cmds.begin(), cmds.end(), [](const CF_Command& a, const CF_Command& b) {
+				if (a.layer == b.layer) return a.id < b.id;
+				else return a.layer < b.layer;
+			});
+			uint64_t t1 = cf_get_ticks();
+			for (int i = 0; i < n; ++i) {
+				keys[i].key = cf_cmd_sort_key(source[i].layer, source[i].id);
+				keys[i].index = i;
+			}
+			CF_CmdKey* sorted = cf_sort_cmd_keys(keys.data(), scratch.data(), n);
+			for (int i = 0; i < n; ++i) order[i] = sorted[i].index;
+			uint64_t t2 = cf_get_ticks();
+			struct_s += (t1 - t0) / freq;
+			key_s += (t2 - t1) / freq;
+			for (int i = 0; i < n; ++i) REQUIRE(cmds[i].id == source[order[i]].id);
+		}
+		printf("[bench] %d commands, %s: std::stable_sort of commands %.3f ms, radix keys + order %.3f ms\n",
+			n, single_layer ? "1 layer (presorted)" : "64 layers", struct_s * 1000.0 / runs, key_s * 1000.0 / runs);
+	}
+	return true;
+}
 
 // -------------------------------------------------------------------------------------------------
 // Mesh path vs tiled path pixel diff.
@@ -1051,10 +1250,10 @@ TEST_CASE(test_draw_tiled_budget_fallback)
 
 	// Under the default budget the forced-tiled path takes the batch...
 	int tiled0, instanced0;
-	cf_draw_tiled_stats(&tiled0, &instanced0, NULL);
+	cf_draw_tiled_stats(&tiled0, &instanced0, NULL, NULL);
 	REQUIRE(s_readback(s_scene_over_budget, 1, w, h, a));
 	int tiled1, instanced1;
-	cf_draw_tiled_stats(&tiled1, &instanced1, NULL);
+	cf_draw_tiled_stats(&tiled1, &instanced1, NULL, NULL);
 	REQUIRE(tiled1 >= 1);
 
 	// ...and over budget it must fall back to instanced with identical pixels.
@@ -1062,7 +1261,7 @@ TEST_CASE(test_draw_tiled_budget_fallback)
 	REQUIRE(s_readback(s_scene_over_budget, 1, w, h, b));
 	cf_draw_set_tiled_list_budget(8 * 1024 * 1024);
 	int tiled2, instanced2;
-	cf_draw_tiled_stats(&tiled2, &instanced2, NULL);
+	cf_draw_tiled_stats(&tiled2, &instanced2, NULL, NULL);
 	REQUIRE(tiled2 == 0);
 	REQUIRE(instanced2 >= 1);
 	REQUIRE(s_diff_ok(a, b, w * h, "budget-fallback tiled-vs-instanced"));
@@ -1073,6 +1272,73 @@ TEST_CASE(test_draw_tiled_budget_fallback)
 	return true;
 }
 
+// -------------------------------------------------------------------------------------------------
+// Geometry entirely outside the canvas or the scissor is culled on the CPU before the atlas and
+// the upload. Anything that still reaches the visible area -- here a glow spilling back in from
+// past the edge -- must survive.
+
+static CF_Sprite s_cull_sprite;
+
+static void s_scene_culling()
+{
+	cf_draw_push_color(cf_make_color_rgba_f(1, 0, 0, 1));
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(-20, -20), cf_v2(20, 20)), 0);
+	for (int i = 0; i < 10; ++i) {
+		float x = 5000.0f + i * 50.0f;
+		cf_draw_quad_fill(cf_make_aabb(cf_v2(x, -20), cf_v2(x + 40, 20)), 0);
+	}
+	cf_draw_pop_color();
+	for (int i = 0; i < 5; ++i) {
+		s_cull_sprite.transform.p = cf_v2(0, -4000.0f - i * 40.0f);
+		cf_draw_sprite(&s_cull_sprite);
+	}
+
+	// Left half only: the green box is on the canvas but outside the scissor.
+	CF_Rect scissor = { 0, 0, 320, 480 };
+	cf_draw_push_scissor(scissor);
+	cf_draw_push_color(cf_make_color_rgba_f(0, 0, 1, 1));
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(-220, -20), cf_v2(-180, 20)), 0);
+	cf_draw_pop_color();
+	cf_draw_push_color(cf_make_color_rgba_f(0, 1, 0, 1));
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(180, -20), cf_v2(220, 20)), 0);
+	cf_draw_pop_color();
+	cf_draw_pop_scissor();
+
+	// Just past the right edge, but its glow reaches back onto the canvas.
+	cf_draw_push_glow(cf_make_color_rgb_f(1, 0, 1), 40.0f);
+	cf_draw_push_color(cf_make_color_rgba_f(1, 1, 1, 1));
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(330, 100), cf_v2(360, 140)), 0);
+	cf_draw_pop_color();
+	cf_draw_pop_glow();
+}
+
+TEST_CASE(test_draw_view_culling)
+{
+	if (!test_make_app(640, 480)) return true; // Headless CI: no display/GPU.
+
+	CF_Pixel solid[64];
+	for (int i = 0; i < 64; ++i) solid[i] = cf_make_pixel_rgba(200, 40, 220, 255);
+	s_cull_sprite = cf_make_easy_sprite_from_pixels(solid, 8, 8);
+
+	int w = 640, h = 480;
+	CF_Pixel* a = (CF_Pixel*)cf_alloc(w * h * sizeof(CF_Pixel));
+	for (int mode = 0; mode <= 1; ++mode) {
+		cf_draw_tiled_stats(NULL, NULL, NULL, NULL);
+		REQUIRE(s_readback(s_scene_culling, mode, w, h, a));
+		int culled;
+		cf_draw_tiled_stats(NULL, NULL, NULL, &culled);
+		REQUIRE(culled == 10 + 5 + 1);
+		REQUIRE(s_px_near(s_probe(a, w, h, 0), 255, 0, 0, 255, 3));
+		REQUIRE(s_px_near(s_probe(a, w, h, -200), 0, 0, 255, 255, 3));
+		REQUIRE(s_px_near(s_probe(a, w, h, 200), 0, 0, 0, 0, 3)); // Scissored away.
+	}
+
+	cf_free(a);
+	cf_easy_sprite_unload(&s_cull_sprite);
+	test_destroy_app();
+	return true;
+}
+
 TEST_CASE(test_draw_shape_groups)
 {
 	if (!test_make_app(640, 480)) return true; // Headless CI: no display/GPU.
@@ -1801,6 +2067,94 @@ TEST_CASE(test_draw_lists)
 	return true;
 }
 
+// Each recorder job draws a box over the shared spot at x = 0 in its own color, so the merge
+// order decides which one ends up on top. Recorder 0 also draws at x = -100 on layer 1, over
+// recorder 3's box on layer 0.
+static CF_DrawRecorder s_recorders[4];
+
+static void s_record_job(void* udata)
+{
+	int i = (int)(uintptr_t)udata;
+	cf_draw_recorder_begin(s_recorders[i]);
+	CF_Color colors[4] = { cf_color_yellow(), cf_color_red(), cf_color_green(), cf_color_blue() };
+	cf_draw_push_color(colors[i]);
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(-10, -10), cf_v2(10, 10)), 0);
+	if (i == 0) {
+		cf_draw_push_layer(1);
+		cf_draw_quad_fill(cf_make_aabb(cf_v2(-110, -10), cf_v2(-90, 10)), 0);
+		cf_draw_pop_layer();
+	} else if (i == 3) {
+		cf_draw_quad_fill(cf_make_aabb(cf_v2(-110, -10), cf_v2(-90, 10)), 0);
+	}
+	// Plenty of shapes per job so recording threads actually overlap.
+	for (int j = 0; j < 2000; ++j) {
+		cf_draw_circle_fill2(cf_v2(100.0f + i * 40.0f, (float)(j % 100) - 50.0f), 3.0f);
+	}
+	cf_draw_pop_color();
+	cf_draw_recorder_end();
+}
+
+static CF_Threadpool* s_record_pool;
+static void s_scene_recorders()
+{
+	// The main thread's draws come first within a layer, under every recorder.
+	cf_draw_push_color(cf_make_color_rgba_f(1, 1, 1, 1));
+	cf_draw_quad_fill(cf_make_aabb(cf_v2(-10, -10), cf_v2(10, 10)), 0);
+	cf_draw_pop_color();
+	for (int i = 3; i >= 0; --i) {
+		cf_threadpool_add_task(s_record_pool, s_record_job, (void*)(uintptr_t)i);
+	}
+	cf_threadpool_kick_and_wait(s_record_pool);
+}
+
+TEST_CASE(test_draw_recorders)
+{
+	if (!test_make_app(640, 480)) return true; // Headless CI: no display/GPU.
+
+	s_record_pool = cf_make_threadpool(4);
+	for (int i = 0; i < 4; ++i) s_recorders[i] = cf_make_draw_recorder();
+
+	int w = 640, h = 480;
+	CF_Pixel* a = (CF_Pixel*)cf_alloc(w * h * sizeof(CF_Pixel));
+	CF_Pixel* b = (CF_Pixel*)cf_alloc(w * h * sizeof(CF_Pixel));
+
+	REQUIRE(s_readback(s_scene_recorders, 0, w, h, a));
+	REQUIRE(s_px_near(s_probe(a, w, h, 0), 0, 0, 255, 255, 3));    // Last recorder on top.
+	REQUIRE(s_px_near(s_probe(a, w, h, -100), 255, 255, 0, 255, 3)); // Recorder 0's layer 1 box over recorder 3.
+	REQUIRE(s_px_near(s_probe(a, w, h, 220), 0, 0, 255, 255, 3));  // Recorder 3's circles.
+
+	// Same pixels every time, however the jobs were scheduled.
+	for (int k = 0; k < 4; ++k) {
+		REQUIRE(s_readback(s_scene_recorders, 0, w, h, b));
+		REQUIRE(CF_MEMCMP(a, b, w * h * sizeof(CF_Pixel)) == 0);
+	}
+
+	// Every recording starts from default state, even when the last one left things pushed.
+	cf_draw_recorder_begin(s_recorders[0]);
+	cf_draw_push_blend(CF_DRAW_BLEND_ADD);
+	cf_draw_push_dash(4, 2, 0);
+	cf_draw_push_outline(cf_color_red(), 2);
+	cf_draw_push_glow(cf_color_blue(), 8);
+	cf_draw_push_sprite_edge(CF_SPRITE_EDGE_HARD);
+	cf_draw_push_filter(CF_DRAW_FILTER_NEAREST);
+	cf_draw_push_tri_colors(cf_color_red(), cf_color_green(), cf_color_blue());
+	cf_draw_recorder_end();
+	cf_draw_recorder_begin(s_recorders[0]);
+	CF_Draw* draw = s_draw;
+	bool reset = draw->blends.count() == 1 && draw->dashes.count() == 1 && draw->outlines.count() == 1
+		&& draw->outline_widths.count() == 1 && draw->glows.count() == 1 && draw->glow_radii.count() == 1
+		&& draw->sprite_edges.count() == 1 && draw->filter_modes.count() == 1 && draw->tri_colors0.count() == 1;
+	cf_draw_recorder_end();
+	REQUIRE(reset);
+
+	for (int i = 0; i < 4; ++i) cf_destroy_draw_recorder(s_recorders[i]);
+	cf_destroy_threadpool(s_record_pool);
+	cf_free(a);
+	cf_free(b);
+	test_destroy_app();
+	return true;
+}
+
 TEST_CASE(test_draw_text_curves)
 {
 	if (!test_make_app(640, 480)) return true; // Headless CI: no display/GPU.
@@ -1946,6 +2300,58 @@ TEST_CASE(test_draw_atlas_repack_gpu_copies)
 #endif // CF_STATIC
 }
 
+// Not an assertion test -- a benchmark of the flush stream encoding (CF_GeomHeader). Records
+// 100k sprites per frame and prints record time, flush time, and the stream's bytes against
+// what the same geometry costs as full BatchGeometry structs. Always passes.
+TEST_CASE(test_draw_stream_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+	if (!test_make_app(640, 480)) return true; // Headless CI: no display/GPU.
+
+	CF_Pixel solid[64];
+	for (int i = 0; i < 64; ++i) solid[i] = cf_make_pixel_rgba(200, 40, 220, 255);
+	CF_Sprite sprite = cf_make_easy_sprite_from_pixels(solid, 8, 8);
+	CF_Canvas canvas = cf_make_canvas(cf_canvas_defaults(640, 480));
+
+	const int FRAMES = 20;
+	const int SPRITES = 100000;
+	double record_s = 0, flush_s = 0;
+	int geoms = 0;
+	uint64_t bytes = 0;
+	for (int frame = 0; frame < FRAMES + 2; ++frame) {
+		cf_app_update(NULL);
+		double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		for (int i = 0; i < SPRITES; ++i) {
+			sprite.transform.p = cf_v2((float)(i % 600) - 300.0f, (float)((i / 600) % 440) - 220.0f);
+			cf_draw_sprite(&sprite);
+		}
+		double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		cf_draw_stream_stats(NULL, NULL);
+		cf_render_to(canvas, true);
+		cf_app_draw_onto_screen(false);
+		cf_gpu_sync();
+		double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		int frame_geoms;
+		uint64_t frame_bytes;
+		cf_draw_stream_stats(&frame_geoms, &frame_bytes);
+		if (frame < 2) continue; // Warm up the atlas and buffers outside the timed window.
+		record_s += t1 - t0;
+		flush_s += t2 - t1;
+		geoms = frame_geoms;
+		bytes = frame_bytes;
+	}
+	printf("[bench] %d sprites: record %.2f ms, flush %.2f ms, stream %.2f MB (%.1f B/geom) vs %.2f MB as BatchGeometry (%d B)\n",
+		SPRITES, record_s * 1000.0 / FRAMES, flush_s * 1000.0 / FRAMES,
+		bytes / (1024.0 * 1024.0), geoms ? (double)bytes / geoms : 0.0,
+		(double)geoms * sizeof(BatchGeometry) / (1024.0 * 1024.0), (int)sizeof(BatchGeometry));
+
+	cf_easy_sprite_unload(&sprite);
+	cf_destroy_canvas(canvas);
+	test_destroy_app();
+	return true;
+}
+
 TEST_SUITE(test_draw_tiled)
 {
 	// CF_TEST_ONLY=<case name> runs a single case, useful when isolating one scene.
@@ -1955,6 +2361,9 @@ TEST_SUITE(test_draw_tiled)
 	const char* only = getenv("CF_TEST_ONLY");
 #define RUN_TEST_CASE_IF(t) do { if (!only || CF_STRCMP(only, #t) == 0) { RUN_TEST_CASE(t); } } while (0)
 	RUN_TEST_CASE_IF(test_tile_range_basics);
+	RUN_TEST_CASE_IF(test_cmd_sort_keys);
+	RUN_TEST_CASE_IF(test_geom_stream_round_trip);
+	RUN_TEST_CASE_IF(test_cmd_sort_bench);
 	RUN_TEST_CASE_IF(test_tiled_matches_mesh);
 	RUN_TEST_CASE_IF(test_draw_custom_shader);
 	RUN_TEST_CASE_IF(test_draw_multi_atlas_interleave);
@@ -1969,6 +2378,7 @@ TEST_SUITE(test_draw_tiled)
 	RUN_TEST_CASE_IF(test_draw_custom_shapes_advanced);
 	RUN_TEST_CASE_IF(test_draw_shape_groups);
 	RUN_TEST_CASE_IF(test_draw_tiled_budget_fallback);
+	RUN_TEST_CASE_IF(test_draw_view_culling);
 	RUN_TEST_CASE_IF(test_draw_text_curves);
 	RUN_TEST_CASE_IF(test_draw_blend_modes);
 	RUN_TEST_CASE_IF(test_draw_paths);
@@ -1977,4 +2387,6 @@ TEST_SUITE(test_draw_tiled)
 	RUN_TEST_CASE_IF(test_draw_atlas_repack_gpu_copies);
 	RUN_TEST_CASE_IF(test_draw_canvas_blit_preserves_earlier_shapes);
 	RUN_TEST_CASE_IF(test_draw_lists);
+	RUN_TEST_CASE_IF(test_draw_recorders);
+	RUN_TEST_CASE_IF(test_draw_stream_bench);
 }
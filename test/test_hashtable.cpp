@@ -167,7 +167,163 @@ TEST_CASE(test_hashtable_has)
     return true;
 }
 
+// Deleting and re-inserting many keys exercises deleted slots, probing across full groups, and
+// rebuilding the slot table in place once deleted slots pile up.
+TEST_CASE(test_hashtable_churn)
+{
+	CF_MAP(int) h = NULL;
+	REQUIRE(map_get(h, 1) == 0);
+	REQUIRE(map_get_or(h, 1, -1) == -1);
+
+	const int N = 2000;
+	for (int round = 0; round < 8; ++round) {
+		for (int i = 0; i < N; ++i) map_set(h, (uint64_t)i * 16 + round, i);
+		REQUIRE(map_size(h) == N);
+		for (int i = 0; i < N; i += 2) REQUIRE(map_del(h, (uint64_t)i * 16 + round));
+		REQUIRE(map_size(h) == N / 2);
+		for (int i = 0; i < N; ++i) {
+			uint64_t key = (uint64_t)i * 16 + round;
+			REQUIRE(map_has(h, key) == (i & 1));
+			REQUIRE(map_get_or(h, key, -1) == ((i & 1) ? i : -1));
+		}
+		// Values stay parallel to keys, and indices stay stable through swaps.
+		map_swap(h, 0, map_size(h) - 1);
+		for (int i = 0; i < map_size(h); ++i) {
+			REQUIRE(map_get(h, map_keys(h)[i]) == h[i]);
+			REQUIRE((uint64_t)h[i] * 16 + round == map_keys(h)[i]);
+		}
+		map_clear(h);
+		REQUIRE(!map_has(h, 1 * 16 + round));
+	}
+	map_free(h);
+	return true;
+}
+
+// The slot table this map used before control bytes: one 16 byte slot per hash slot, probed
+// linearly one at a time, with a per-slot count of keys hashing there. Kept only as the baseline
+// for the benchmark below.
+struct LegacyMap
+{
+	struct Slot { uint64_t h; int item_index; int base_count; };
+	Array<uint64_t> keys;
+	Array<int> items;
+	Slot* slots = NULL;
+	int slot_capacity = 0;
+
+	static uint64_t hash(uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		x ^= (x >> 31);
+		return x ? x : 1ull;
+	}
+
+	int find(uint64_t key) const
+	{
+		if (!slot_capacity) return -1;
+		uint64_t h = hash(key);
+		int mask = slot_capacity - 1;
+		int base = (int)(h & mask), slot = base;
+		int remaining = slots[base].base_count;
+		while (remaining > 0) {
+			int item = slots[slot].item_index;
+			if (item >= 0 && (int)(slots[slot].h & mask) == base) {
+				--remaining;
+				if (slots[slot].h == h && keys[item] == key) return item;
+			}
+			slot = (slot + 1) & mask;
+		}
+		return -1;
+	}
+
+	void place(uint64_t h, int idx)
+	{
+		int mask = slot_capacity - 1;
+		int base = (int)(h & mask), slot = base;
+		while (slots[slot].item_index >= 0) slot = (slot + 1) & mask;
+		slots[slot].h = h;
+		slots[slot].item_index = idx;
+		++slots[base].base_count;
+	}
+
+	void insert(uint64_t key, int val)
+	{
+		int idx = find(key);
+		if (idx >= 0) { items[idx] = val; return; }
+		if ((keys.count() + 1) * 2 > slot_capacity) {
+			cf_free(slots);
+			slot_capacity = slot_capacity ? slot_capacity * 2 : 32;
+			slots = (Slot*)cf_alloc(sizeof(Slot) * slot_capacity);
+			for (int i = 0; i < slot_capacity; ++i) slots[i] = { 0, -1, 0 };
+			for (int i = 0; i < keys.count(); ++i) place(hash(keys[i]), i);
+		}
+		keys.add(key);
+		items.add(val);
+		place(hash(key), keys.count() - 1);
+	}
+
+	~LegacyMap() { cf_free(slots); }
+};
+
+static volatile int s_bench_sink;
+
+static uint64_t s_bench_key(uint64_t i)
+{
+	i = (i ^ (i >> 33)) * 0xff51afd7ed558ccdull;
+	return i ^ (i >> 29);
+}
+
+// Not an assertion test -- insert-heavy, hit and miss lookups on 1k/100k/10M random keys, the
+// control byte map against the legacy slot table. Prints nanoseconds per operation. The 10M
+// case needs about 1 GB of memory.
+TEST_CASE(test_hashtable_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	int sizes[3] = { 1000, 100000, 10000000 };
+	for (int si = 0; si < 3; ++si) {
+		int n = sizes[si];
+		// Run small maps many times so each measurement covers at least ~10M operations.
+		int reps = 10000000 / n;
+		double ns[2][3];
+		int sink = 0;
+		for (int impl = 0; impl < 2; ++impl) {
+			double insert_s = 0, hit_s = 0, miss_s = 0;
+			for (int r = 0; r < reps; ++r) {
+				CF_MAP(int) m = NULL;
+				LegacyMap legacy;
+				double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+				if (impl == 0) for (int i = 0; i < n; ++i) map_set(m, s_bench_key(i), i);
+				else for (int i = 0; i < n; ++i) legacy.insert(s_bench_key(i), i);
+				double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+				if (impl == 0) for (int i = 0; i < n; ++i) sink += map_get(m, s_bench_key(i));
+				else for (int i = 0; i < n; ++i) sink += legacy.items[legacy.find(s_bench_key(i))];
+				double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+				if (impl == 0) for (int i = 0; i < n; ++i) sink += map_get(m, s_bench_key(i + n));
+				else for (int i = 0; i < n; ++i) sink += legacy.find(s_bench_key(i + n));
+				double t3 = cf_get_ticks() / (double)cf_get_tick_frequency();
+				insert_s += t1 - t0;
+				hit_s += t2 - t1;
+				miss_s += t3 - t2;
+				map_free(m);
+			}
+			double ops = (double)n * reps / 1e9;
+			ns[impl][0] = insert_s / ops;
+			ns[impl][1] = hit_s / ops;
+			ns[impl][2] = miss_s / ops;
+		}
+		s_bench_sink = sink;
+		printf("[bench] map %8d keys, ns/op (control bytes vs legacy): insert %.1f vs %.1f, hit %.1f vs %.1f, miss %.1f vs %.1f\n",
+			n, ns[0][0], ns[1][0], ns[0][1], ns[1][1], ns[0][2], ns[1][2]);
+	}
+	return true;
+}
+
 TEST_SUITE(test_hashtable)
 {
 	RUN_TEST_CASE(test_hashtable_macros);
+	RUN_TEST_CASE(test_hashtable_churn);
+	RUN_TEST_CASE(test_hashtable_bench);
 }
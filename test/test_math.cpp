@@ -92,6 +92,338 @@ TEST_CASE(test_mod_floored_cpp) {
 	return true;
 }
 
+static CF_Aabb s_random_box(CF_Rnd* rnd, float world, float max_size)
+{
+	CF_V2 p = cf_v2(cf_rnd_range_float(rnd, 0, world), cf_rnd_range_float(rnd, 0, world));
+	return cf_make_aabb(p, cf_add(p, cf_v2(cf_rnd_range_float(rnd, 1, max_size), cf_rnd_range_float(rnd, 1, max_size))));
+}
+
+static bool s_collect_leaf(int leaf, uint64_t udata, void* fn_udata)
+{
+	CF_UNUSED(leaf);
+	((Array<int>*)fn_udata)->add((int)udata);
+	return true;
+}
+
+struct TreeRaycast
+{
+	const CF_Aabb* boxes;
+	int closest;
+	float t;
+};
+
+static float s_raycast_leaf(int leaf, uint64_t udata, CF_Ray ray, void* fn_udata)
+{
+	CF_UNUSED(leaf);
+	TreeRaycast* cast = (TreeRaycast*)fn_udata;
+	CF_Raycast hit = cf_ray_to_aabb(ray, cast->boxes[udata]);
+	if (!hit.hit) return -1.0f;
+	cast->closest = (int)udata;
+	cast->t = hit.t;
+	return hit.t;
+}
+
+static void s_count_pair(int leaf_a, uint64_t udata_a, int leaf_b, uint64_t udata_b, void* fn_udata)
+{
+	CF_UNUSED(udata_a); CF_UNUSED(udata_b);
+	if (leaf_a < leaf_b) ++*(int*)fn_udata;
+}
+
+static int s_sort_ints(const void* a, const void* b) { return *(const int*)a - *(const int*)b; }
+
+TEST_CASE(test_aabb_tree) {
+	const int N = 2000;
+	CF_Rnd rnd = cf_rnd_seed(7);
+	CF_AabbTree* tree = cf_make_aabb_tree(2.0f);
+	Array<CF_Aabb> boxes;
+	Array<int> leaves;
+	for (int i = 0; i < N; ++i) {
+		boxes.add(s_random_box(&rnd, 1000, 20));
+		leaves.add(cf_aabb_tree_insert(tree, boxes[i], (uint64_t)i));
+	}
+	REQUIRE(cf_aabb_tree_count(tree) == N);
+	REQUIRE(cf_aabb_tree_get_udata(tree, leaves[10]) == 10);
+	REQUIRE(cf_contains_aabb(cf_aabb_tree_get_fat_aabb(tree, leaves[10]), boxes[10]));
+
+	// Small moves stay within the fattened box, big ones re-insert.
+	CF_Aabb nudged = cf_make_aabb(cf_add(boxes[0].min, cf_v2(1, 1)), cf_add(boxes[0].max, cf_v2(1, 1)));
+	REQUIRE(!cf_aabb_tree_move(tree, leaves[0], nudged));
+	boxes[0] = cf_make_aabb(cf_add(boxes[0].min, cf_v2(50, 0)), cf_add(boxes[0].max, cf_v2(50, 0)));
+	REQUIRE(cf_aabb_tree_move(tree, leaves[0], boxes[0]));
+
+	for (int i = 1; i < N; i += 2) {
+		cf_aabb_tree_remove(tree, leaves[i]);
+		leaves[i] = -1;
+	}
+	REQUIRE(cf_aabb_tree_count(tree) == N / 2);
+	cf_aabb_tree_rebuild(tree);
+
+	// Queries match brute force over the fattened boxes.
+	for (int q = 0; q < 50; ++q) {
+		CF_Aabb box = s_random_box(&rnd, 1000, 100);
+		Array<int> found;
+		cf_aabb_tree_query_aabb(tree, box, s_collect_leaf, &found);
+		Array<int> expected;
+		for (int i = 0; i < N; ++i) {
+			if (leaves[i] >= 0 && cf_overlaps(cf_aabb_tree_get_fat_aabb(tree, leaves[i]), box)) expected.add(i);
+		}
+		REQUIRE(found.count() == expected.count());
+		if (found.count()) qsort(found.data(), found.count(), sizeof(int), s_sort_ints);
+		for (int i = 0; i < found.count(); ++i) REQUIRE(found[i] == expected[i]);
+	}
+
+	// Raycasts find the closest box.
+	for (int q = 0; q < 50; ++q) {
+		CF_Ray ray;
+		ray.p = cf_v2(cf_rnd_range_float(&rnd, 0, 1000), -10);
+		ray.d = cf_norm(cf_v2(cf_rnd_range_float(&rnd, -0.5f, 0.5f), 1));
+		ray.t = 2000;
+		TreeRaycast cast = { boxes.data(), -1, 0 };
+		cf_aabb_tree_raycast(tree, ray, s_raycast_leaf, &cast);
+		int closest = -1;
+		float closest_t = ray.t;
+		for (int i = 0; i < N; ++i) {
+			if (leaves[i] < 0) continue;
+			CF_Raycast hit = cf_ray_to_aabb(ray, boxes[i]);
+			if (hit.hit && hit.t < closest_t) { closest = i; closest_t = hit.t; }
+		}
+		REQUIRE(cast.closest == closest);
+		if (closest >= 0) REQUIRE(cf_abs(cast.t - closest_t) < 1.0e-3f);
+	}
+
+	// Pairs match brute force.
+	int pairs = 0;
+	int found_pairs = cf_aabb_tree_find_pairs(tree, s_count_pair, &pairs);
+	REQUIRE(found_pairs == pairs);
+	int expected_pairs = 0;
+	for (int i = 0; i < N; ++i) {
+		if (leaves[i] < 0) continue;
+		for (int j = i + 1; j < N; ++j) {
+			if (leaves[j] < 0) continue;
+			expected_pairs += cf_overlaps(cf_aabb_tree_get_fat_aabb(tree, leaves[i]), cf_aabb_tree_get_fat_aabb(tree, leaves[j]));
+		}
+	}
+	REQUIRE(found_pairs == expected_pairs);
+
+	cf_destroy_aabb_tree(tree);
+	return true;
+}
+
+static void s_noop_pair(int leaf_a, uint64_t udata_a, int leaf_b, uint64_t udata_b, void* fn_udata)
+{
+	CF_UNUSED(leaf_a); CF_UNUSED(udata_a); CF_UNUSED(leaf_b); CF_UNUSED(udata_b); CF_UNUSED(fn_udata);
+}
+
+TEST_CASE(test_aabb_tree_bench) {
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int N = 50000;
+	CF_Rnd rnd = cf_rnd_seed(3);
+	Array<CF_Aabb> boxes;
+	for (int i = 0; i < N; ++i) boxes.add(s_random_box(&rnd, 10000, 20));
+
+	double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	int brute_pairs = 0;
+	for (int i = 0; i < N; ++i) {
+		for (int j = i + 1; j < N; ++j) brute_pairs += cf_overlaps(boxes[i], boxes[j]);
+	}
+	double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	CF_AabbTree* tree = cf_make_aabb_tree(0);
+	for (int i = 0; i < N; ++i) cf_aabb_tree_insert(tree, boxes[i], (uint64_t)i);
+	double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	int tree_pairs = cf_aabb_tree_find_pairs(tree, s_noop_pair, NULL);
+	double t3 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	cf_destroy_aabb_tree(tree);
+
+	REQUIRE(tree_pairs == brute_pairs);
+	printf("[bench] aabb tree %d boxes, %d pairs: brute force %.2f ms, tree build %.2f ms + find pairs %.2f ms\n", N, tree_pairs, (t1 - t0) * 1000.0, (t2 - t1) * 1000.0, (t3 - t2) * 1000.0);
+	return true;
+}
+
+// Brute force reference: the closest hit over every shape, with the full length ray.
+static CF_RayHit s_closest_hit(CF_Ray ray, const void* shapes, CF_ShapeType type, int stride, int count)
+{
+	CF_RayHit best = { -1 };
+	for (int i = 0; i < count; ++i) {
+		CF_Raycast cast;
+		if (!cf_cast_ray(ray, (const char*)shapes + i * stride, type, &cast)) continue;
+		if (best.index < 0 || cast.t < best.raycast.t) {
+			best.index = i;
+			best.raycast = cast;
+		}
+	}
+	return best;
+}
+
+static bool s_same_hit(CF_RayHit a, CF_RayHit b)
+{
+	if (a.index < 0 || b.index < 0) return a.index == b.index && !a.raycast.hit && !b.raycast.hit;
+	// Clipped rays can round differently, so two shapes hit at almost the same spot may swap places.
+	return cf_abs(a.raycast.t - b.raycast.t) < 1.0e-3f && (a.index == b.index || cf_abs(a.raycast.t - b.raycast.t) < 1.0e-5f);
+}
+
+TEST_CASE(test_cast_rays) {
+	const int N = 500;
+	const int R = 300;
+	CF_Rnd rnd = cf_rnd_seed(13);
+	Array<CF_Circle> circles;
+	Array<CF_Aabb> boxes;
+	CF_AabbTree* circle_tree = cf_make_aabb_tree(0);
+	CF_AabbTree* box_tree = cf_make_aabb_tree(1.0f);
+	for (int i = 0; i < N; ++i) {
+		circles.add(cf_make_circle(cf_v2(cf_rnd_range_float(&rnd, 0, 1000), cf_rnd_range_float(&rnd, 0, 1000)), cf_rnd_range_float(&rnd, 2, 15)));
+		boxes.add(s_random_box(&rnd, 1000, 30));
+		CF_V2 r = cf_v2(circles[i].r, circles[i].r);
+		cf_aabb_tree_insert(circle_tree, cf_make_aabb(cf_sub(circles[i].p, r), cf_add(circles[i].p, r)), (uint64_t)i);
+		cf_aabb_tree_insert(box_tree, boxes[i], (uint64_t)i);
+	}
+	Array<CF_Ray> rays;
+	for (int i = 0; i < R; ++i) {
+		CF_Ray ray;
+		ray.p = cf_v2(cf_rnd_range_float(&rnd, -100, 1100), cf_rnd_range_float(&rnd, -100, 1100));
+		float a = cf_rnd_range_float(&rnd, 0, 2 * CF_PI);
+		ray.d = cf_v2(cf_cos(a), cf_sin(a));
+		ray.t = cf_rnd_range_float(&rnd, 0, 800);
+		rays.add(ray);
+	}
+
+	Array<CF_RayHit> hits;
+	hits.ensure_count(R);
+	CF_Threadpool* pool = cf_make_threadpool(4);
+	int hit_count = 0;
+	bool ok = true;
+	for (int pass = 0; pass < 2; ++pass) {
+		CF_Threadpool* p = pass ? pool : NULL;
+		cf_cast_rays(rays.data(), R, circles.data(), CF_SHAPE_TYPE_CIRCLE, N, hits.data(), p);
+		for (int i = 0; i < R; ++i) {
+			ok = ok && s_same_hit(hits[i], s_closest_hit(rays[i], circles.data(), CF_SHAPE_TYPE_CIRCLE, sizeof(CF_Circle), N));
+			hit_count += hits[i].index >= 0;
+		}
+		cf_cast_rays(rays.data(), R, boxes.data(), CF_SHAPE_TYPE_AABB, N, hits.data(), p);
+		for (int i = 0; i < R; ++i) ok = ok && s_same_hit(hits[i], s_closest_hit(rays[i], boxes.data(), CF_SHAPE_TYPE_AABB, sizeof(CF_Aabb), N));
+		cf_cast_rays_tree(circle_tree, rays.data(), R, circles.data(), CF_SHAPE_TYPE_CIRCLE, hits.data(), p);
+		for (int i = 0; i < R; ++i) ok = ok && s_same_hit(hits[i], s_closest_hit(rays[i], circles.data(), CF_SHAPE_TYPE_CIRCLE, sizeof(CF_Circle), N));
+		cf_cast_rays_tree(box_tree, rays.data(), R, boxes.data(), CF_SHAPE_TYPE_AABB, hits.data(), p);
+		for (int i = 0; i < R; ++i) ok = ok && s_same_hit(hits[i], s_closest_hit(rays[i], boxes.data(), CF_SHAPE_TYPE_AABB, sizeof(CF_Aabb), N));
+	}
+	REQUIRE(ok);
+	// Make sure the test means something: plenty of rays hit, and plenty miss.
+	REQUIRE(hit_count > R / 4 && hit_count < 2 * R - R / 4);
+
+	cf_destroy_threadpool(pool);
+	cf_destroy_aabb_tree(circle_tree);
+	cf_destroy_aabb_tree(box_tree);
+	return true;
+}
+
+// Integer coordinates half the time, so exact touching (which doesn't count as a hit) gets tested too.
+static float s_random_coord(CF_Rnd* rnd, float lo, float hi)
+{
+	float x = cf_rnd_range_float(rnd, lo, hi);
+	return cf_rnd_range_int(rnd, 0, 1) ? cf_floor(x) : x;
+}
+
+TEST_CASE(test_collision_batch) {
+	// Not a multiple of any SIMD width, so the scalar tail runs as well.
+	const int N = 1003;
+	CF_Rnd rnd = cf_rnd_seed(5);
+	Array<float> cx, cy, cr, min_x, min_y, max_x, max_y;
+	for (int i = 0; i < N; ++i) {
+		cx.add(s_random_coord(&rnd, -50, 50));
+		cy.add(s_random_coord(&rnd, -50, 50));
+		cr.add(s_random_coord(&rnd, 1, 8));
+		min_x.add(s_random_coord(&rnd, -50, 50));
+		min_y.add(s_random_coord(&rnd, -50, 50));
+		max_x.add(min_x[i] + s_random_coord(&rnd, 0, 10));
+		max_y.add(min_y[i] + s_random_coord(&rnd, 0, 10));
+	}
+	CF_CircleSoA circles = { cx.data(), cy.data(), cr.data(), N };
+	CF_AabbSoA boxes = { min_x.data(), min_y.data(), max_x.data(), max_y.data(), N };
+
+	Array<int> hits, expected;
+	Array<float> hit_t;
+	hits.ensure_count(N);
+	hit_t.ensure_count(N);
+	bool ok = true;
+	for (int q = 0; q < 100; ++q) {
+		CF_Circle c = cf_make_circle(cf_v2(s_random_coord(&rnd, -50, 50), s_random_coord(&rnd, -50, 50)), s_random_coord(&rnd, 0, 10));
+		CF_V2 p = cf_v2(s_random_coord(&rnd, -50, 50), s_random_coord(&rnd, -50, 50));
+		CF_Aabb bb = cf_make_aabb(p, cf_add(p, cf_v2(s_random_coord(&rnd, 0, 10), s_random_coord(&rnd, 0, 10))));
+
+		int count = cf_circle_to_circles(c, circles, hits.data());
+		expected.clear();
+		for (int i = 0; i < N; ++i) if (cf_circle_to_circle(c, cf_make_circle(cf_v2(cx[i], cy[i]), cr[i]))) expected.add(i);
+		ok = ok && count == expected.count() && CF_MEMCMP(hits.data(), expected.data(), sizeof(int) * count) == 0;
+
+		count = cf_circle_to_aabbs(c, boxes, hits.data());
+		expected.clear();
+		for (int i = 0; i < N; ++i) if (cf_circle_to_aabb(c, cf_make_aabb(cf_v2(min_x[i], min_y[i]), cf_v2(max_x[i], max_y[i])))) expected.add(i);
+		ok = ok && count == expected.count() && CF_MEMCMP(hits.data(), expected.data(), sizeof(int) * count) == 0;
+
+		count = cf_aabb_to_aabbs(bb, boxes, hits.data());
+		expected.clear();
+		for (int i = 0; i < N; ++i) if (cf_aabb_to_aabb(bb, cf_make_aabb(cf_v2(min_x[i], min_y[i]), cf_v2(max_x[i], max_y[i])))) expected.add(i);
+		ok = ok && count == expected.count() && CF_MEMCMP(hits.data(), expected.data(), sizeof(int) * count) == 0;
+
+		// Rays start outside every circle they should hit; starting inside doesn't count as a hit.
+		CF_Ray ray;
+		ray.p = cf_v2(-60.0f, cf_rnd_range_float(&rnd, -50, 50));
+		ray.d = cf_norm(cf_v2(1.0f, cf_rnd_range_float(&rnd, -0.5f, 0.5f)));
+		ray.t = cf_rnd_range_float(&rnd, 10, 150);
+		count = cf_ray_to_circles(ray, circles, hits.data(), hit_t.data());
+		expected.clear();
+		for (int i = 0, j = 0; i < N; ++i) {
+			CF_Raycast cast = cf_ray_to_circle(ray, cf_make_circle(cf_v2(cx[i], cy[i]), cr[i]));
+			if (!cast.hit) continue;
+			expected.add(i);
+			ok = ok && j < count && cf_abs(hit_t[j] - cast.t) < 1.0e-3f;
+			++j;
+		}
+		ok = ok && count == expected.count() && CF_MEMCMP(hits.data(), expected.data(), sizeof(int) * count) == 0;
+		REQUIRE(cf_ray_to_circles(ray, circles, hits.data(), NULL) == count);
+	}
+	REQUIRE(ok);
+
+	// Empty input.
+	CF_CircleSoA none = { NULL, NULL, NULL, 0 };
+	REQUIRE(cf_circle_to_circles(cf_make_circle(cf_v2(0, 0), 1), none, hits.data()) == 0);
+	return true;
+}
+
+TEST_CASE(test_collision_batch_bench) {
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int N = 4096;
+	CF_Rnd rnd = cf_rnd_seed(9);
+	Array<float> x, y, r;
+	Array<CF_Circle> aos;
+	for (int i = 0; i < N; ++i) {
+		x.add(cf_rnd_range_float(&rnd, 0, 2000));
+		y.add(cf_rnd_range_float(&rnd, 0, 2000));
+		r.add(cf_rnd_range_float(&rnd, 1, 10));
+		aos.add(cf_make_circle(cf_v2(x[i], y[i]), r[i]));
+	}
+	CF_CircleSoA circles = { x.data(), y.data(), r.data(), N };
+	Array<int> hits;
+	hits.ensure_count(N);
+
+	double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	int scalar_hits = 0;
+	for (int i = 0; i < N; ++i) {
+		for (int j = 0; j < N; ++j) scalar_hits += cf_circle_to_circle(aos[i], aos[j]);
+	}
+	double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	int batch_hits = 0;
+	for (int i = 0; i < N; ++i) batch_hits += cf_circle_to_circles(aos[i], circles, hits.data());
+	double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+
+	REQUIRE(scalar_hits == batch_hits);
+	printf("[bench] %d x %d circle tests: cf_circle_to_circle %.2f ms, cf_circle_to_circles %.2f ms\n", N, N, (t1 - t0) * 1000.0, (t2 - t1) * 1000.0);
+	return true;
+}
+
 TEST_SUITE(test_math) {
 	RUN_TEST_CASE(test_make_translation_v2);
 	RUN_TEST_CASE(test_make_translation_floats);
@@ -100,4 +432,9 @@ TEST_SUITE(test_math) {
 	RUN_TEST_CASE(test_atan2_360_v2);
 	RUN_TEST_CASE(test_atan2_360_sincos);
 	RUN_TEST_CASE(test_mod_floored_cpp);
+	RUN_TEST_CASE(test_aabb_tree);
+	RUN_TEST_CASE(test_aabb_tree_bench);
+	RUN_TEST_CASE(test_cast_rays);
+	RUN_TEST_CASE(test_collision_batch);
+	RUN_TEST_CASE(test_collision_batch_bench);
 }
@@ -0,0 +1,1001 @@
+/*
+	Cute Framework
+	Copyright (C) 2026 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include "test_harness.h"
+
+#include <cute.h>
+using namespace Cute;
+
+//--------------------------------------------------------------------------------------------------
+// Threadpool.
+
+static CF_AtomicInt s_task_sum;
+
+static void s_add_task(void* param)
+{
+	cf_atomic_add(&s_task_sum, (int)(uintptr_t)param);
+}
+
+static CF_Threadpool* s_nested_pool;
+
+static void s_spawn_task(void* param)
+{
+	CF_UNUSED(param);
+	// Added from a worker thread, so these go onto the worker's own deque.
+	for (int i = 0; i < 16; ++i) {
+		cf_threadpool_add_task(s_nested_pool, s_add_task, (void*)(uintptr_t)1);
+	}
+}
+
+TEST_CASE(test_threadpool_runs_all_tasks)
+{
+	for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+		CF_Threadpool* pool = cf_make_threadpool(thread_count);
+		REQUIRE(pool);
+		// Several rounds, enough tasks to force the internal deques to grow.
+		for (int round = 0; round < 4; ++round) {
+			s_task_sum = cf_atomic_zero();
+			for (int i = 0; i < 5000; ++i) {
+				cf_threadpool_add_task(pool, s_add_task, (void*)(uintptr_t)1);
+			}
+			cf_threadpool_kick_and_wait(pool);
+			REQUIRE(cf_atomic_get(&s_task_sum) == 5000);
+		}
+		cf_destroy_threadpool(pool);
+	}
+	return true;
+}
+
+TEST_CASE(test_threadpool_nested_tasks)
+{
+	s_nested_pool = cf_make_threadpool(4);
+	REQUIRE(s_nested_pool);
+	s_task_sum = cf_atomic_zero();
+	for (int i = 0; i < 256; ++i) {
+		cf_threadpool_add_task(s_nested_pool, s_spawn_task, NULL);
+	}
+	cf_threadpool_kick_and_wait(s_nested_pool);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 256 * 16);
+	cf_destroy_threadpool(s_nested_pool);
+	s_nested_pool = NULL;
+	return true;
+}
+
+static void s_sum_range(int begin, int end, void* udata)
+{
+	CF_UNUSED(udata);
+	int sum = 0;
+	for (int i = begin; i < end; ++i) sum += i;
+	cf_atomic_add(&s_task_sum, sum);
+}
+
+static CF_Threadpool* s_parallel_pool;
+
+// Counts the items of each chunk, and flags chunks that are empty, backwards, or bigger than a grain.
+static CF_AtomicInt s_chunk_bad;
+static CF_AtomicInt s_chunk_ends_at_max;
+
+static void s_check_range(int begin, int end, void* udata)
+{
+	int grain = (int)(intptr_t)udata;
+	if (begin >= end || (int64_t)end - begin > grain) cf_atomic_set(&s_chunk_bad, 1);
+	if (end == INT_MAX) cf_atomic_add(&s_chunk_ends_at_max, 1);
+	if ((int64_t)end - begin <= 1000) cf_atomic_add(&s_task_sum, end - begin);
+}
+
+static void s_nested_parallel_for(int begin, int end, void* udata)
+{
+	CF_UNUSED(udata);
+	for (int i = begin; i < end; ++i) {
+		cf_parallel_for(s_parallel_pool, 0, 100, 7, s_sum_range, NULL);
+	}
+}
+
+TEST_CASE(test_parallel_for)
+{
+	s_parallel_pool = cf_make_threadpool(4);
+	REQUIRE(s_parallel_pool);
+
+	// Automatic grain, an explicit grain that doesn't evenly divide the range, and a range
+	// smaller than one grain.
+	int grains[3] = { 0, 37, 100000 };
+	for (int i = 0; i < 3; ++i) {
+		s_task_sum = cf_atomic_zero();
+		cf_parallel_for(s_parallel_pool, 0, 10000, grains[i], s_sum_range, NULL);
+		REQUIRE(cf_atomic_get(&s_task_sum) == 10000 * 9999 / 2);
+	}
+
+	// Parallel loops nested within parallel loops.
+	s_task_sum = cf_atomic_zero();
+	cf_parallel_for(s_parallel_pool, 0, 50, 3, s_nested_parallel_for, NULL);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 50 * (100 * 99 / 2));
+
+	// Ranges up against INT_MAX, where the chunk math used to overflow.
+	s_task_sum = cf_atomic_zero();
+	s_chunk_bad = cf_atomic_zero();
+	s_chunk_ends_at_max = cf_atomic_zero();
+	cf_parallel_for(s_parallel_pool, INT_MAX - 1000, INT_MAX, 7, s_check_range, (void*)(intptr_t)7);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 1000);
+	REQUIRE(cf_atomic_get(&s_chunk_bad) == 0);
+	REQUIRE(cf_atomic_get(&s_chunk_ends_at_max) == 1);
+	s_chunk_ends_at_max = cf_atomic_zero();
+	cf_parallel_for(s_parallel_pool, INT_MIN, INT_MAX, 1 << 28, s_check_range, (void*)(intptr_t)(1 << 28));
+	REQUIRE(cf_atomic_get(&s_chunk_bad) == 0);
+	REQUIRE(cf_atomic_get(&s_chunk_ends_at_max) == 1);
+
+	// No pool runs inline.
+	s_task_sum = cf_atomic_zero();
+	cf_parallel_for(NULL, 10, 20, 1, s_sum_range, NULL);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 145);
+
+	cf_destroy_threadpool(s_parallel_pool);
+	s_parallel_pool = NULL;
+	return true;
+}
+
+static void s_parent_job(void* param)
+{
+	CF_UNUSED(param);
+	// Waiting from within a job runs other jobs instead of blocking the worker.
+	CF_JobCounter children = cf_make_job_counter();
+	for (int i = 0; i < 10; ++i) {
+		cf_threadpool_add_job(s_parallel_pool, s_add_task, (void*)(uintptr_t)1, &children);
+	}
+	cf_threadpool_wait_counter(s_parallel_pool, &children);
+}
+
+TEST_CASE(test_job_counters)
+{
+	s_parallel_pool = cf_make_threadpool(4);
+	REQUIRE(s_parallel_pool);
+	s_task_sum = cf_atomic_zero();
+
+	CF_JobCounter parents = cf_make_job_counter();
+	for (int i = 0; i < 20; ++i) {
+		cf_threadpool_add_job(s_parallel_pool, s_parent_job, NULL, &parents);
+	}
+	REQUIRE(cf_atomic_get(&parents) > 0);
+	cf_threadpool_wait_counter(s_parallel_pool, &parents);
+	REQUIRE(cf_atomic_get(&parents) == 0);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 200);
+
+	cf_destroy_threadpool(s_parallel_pool);
+	s_parallel_pool = NULL;
+	return true;
+}
+
+static CF_Threadpool* s_fiber_pool;
+static CF_AtomicInt s_io_done;
+
+static void s_fiber_child(void* param)
+{
+	CF_UNUSED(param);
+	CF_JobCounter leaves = cf_make_job_counter();
+	for (int i = 0; i < 4; ++i) {
+		cf_threadpool_add_job(s_fiber_pool, s_add_task, (void*)(uintptr_t)1, &leaves);
+	}
+	cf_threadpool_wait_counter(s_fiber_pool, &leaves);
+}
+
+static void s_fiber_parent(void* param)
+{
+	CF_UNUSED(param);
+	CF_JobCounter children = cf_make_job_counter();
+	for (int i = 0; i < 16; ++i) {
+		cf_threadpool_add_fiber_job(s_fiber_pool, s_fiber_child, NULL, &children);
+	}
+	cf_threadpool_wait_counter(s_fiber_pool, &children);
+}
+
+static void s_fiber_poll_io(void* param)
+{
+	CF_UNUSED(param);
+	while (!cf_atomic_get(&s_io_done)) {
+		cf_fiber_job_yield();
+	}
+	cf_atomic_add(&s_task_sum, 1000);
+}
+
+static void s_finish_io(void* param)
+{
+	CF_UNUSED(param);
+	cf_atomic_set(&s_io_done, 1);
+}
+
+TEST_CASE(test_fiber_jobs)
+{
+	REQUIRE(!cf_fiber_job_yield());
+
+	// A single worker is the interesting case: everything only completes if suspended fibers
+	// really do hand the worker over to the jobs queued behind them.
+	for (int thread_count = 1; thread_count <= 4; thread_count *= 4) {
+		s_fiber_pool = cf_make_threadpool(thread_count);
+		REQUIRE(s_fiber_pool);
+		for (int round = 0; round < 4; ++round) {
+			s_task_sum = cf_atomic_zero();
+			s_io_done = cf_atomic_zero();
+			CF_JobCounter counter = cf_make_job_counter();
+			cf_threadpool_add_fiber_job(s_fiber_pool, s_fiber_poll_io, NULL, &counter);
+			for (int i = 0; i < 32; ++i) {
+				cf_threadpool_add_fiber_job(s_fiber_pool, s_fiber_parent, NULL, &counter);
+			}
+			cf_threadpool_add_job(s_fiber_pool, s_finish_io, NULL, &counter);
+			cf_threadpool_wait_counter(s_fiber_pool, &counter);
+			REQUIRE(cf_atomic_get(&counter) == 0);
+			REQUIRE(cf_atomic_get(&s_task_sum) == 32 * 16 * 4 + 1000);
+		}
+		cf_destroy_threadpool(s_fiber_pool);
+	}
+	s_fiber_pool = NULL;
+	return true;
+}
+
+static CF_JobCounter s_slow_counter;
+
+static void s_slow_job(void* param)
+{
+	CF_UNUSED(param);
+	cf_sleep(20);
+	cf_atomic_add(&s_task_sum, 1);
+}
+
+static void s_fiber_wait_slow(void* param)
+{
+	CF_UNUSED(param);
+	cf_threadpool_wait_counter(s_fiber_pool, &s_slow_counter);
+	if (cf_atomic_get(&s_slow_counter) == 0) cf_atomic_add(&s_task_sum, 10);
+}
+
+TEST_CASE(test_fiber_jobs_held)
+{
+	// Fibers waiting on a slow job are held by the pool until it finishes. Another pool coming
+	// and going in the meantime must leave this pool's fibers alone.
+	s_fiber_pool = cf_make_threadpool(2);
+	REQUIRE(s_fiber_pool);
+	s_task_sum = cf_atomic_zero();
+	s_slow_counter = cf_make_job_counter();
+	CF_JobCounter counter = cf_make_job_counter();
+	cf_threadpool_add_job(s_fiber_pool, s_slow_job, NULL, &s_slow_counter);
+	for (int i = 0; i < 8; ++i) {
+		cf_threadpool_add_fiber_job(s_fiber_pool, s_fiber_wait_slow, NULL, &counter);
+	}
+	cf_threadpool_kick(s_fiber_pool);
+
+	CF_Threadpool* other = cf_make_threadpool(1);
+	REQUIRE(other);
+	CF_JobCounter other_counter = cf_make_job_counter();
+	for (int i = 0; i < 4; ++i) {
+		cf_threadpool_add_fiber_job(other, s_add_task, (void*)(uintptr_t)100, &other_counter);
+	}
+	cf_threadpool_wait_counter(other, &other_counter);
+	cf_destroy_threadpool(other);
+
+	cf_threadpool_wait_counter(s_fiber_pool, &counter);
+	REQUIRE(cf_atomic_get(&counter) == 0);
+	REQUIRE(cf_atomic_get(&s_task_sum) == 1 + 8 * 10 + 4 * 100);
+	cf_destroy_threadpool(s_fiber_pool);
+	s_fiber_pool = NULL;
+	return true;
+}
+
+// The pre-work-stealing pool, kept here as the baseline for the benchmark: one task stack
+// guarded by one mutex, popped once per task by every worker.
+struct LockedPool
+{
+	struct Task { CF_TaskFn* fn; void* param; };
+	Array<Task> tasks;
+	CF_Mutex mutex;
+	CF_Semaphore sem;
+	CF_AtomicInt running;
+	CF_AtomicInt in_flight;
+	Array<CF_Thread*> threads;
+};
+
+static bool s_locked_pool_pop(LockedPool* pool, LockedPool::Task* task)
+{
+	cf_mutex_lock(&pool->mutex);
+	bool popped = pool->tasks.count() > 0;
+	if (popped) {
+		*task = pool->tasks.pop();
+		cf_atomic_add(&pool->in_flight, 1);
+	}
+	cf_mutex_unlock(&pool->mutex);
+	return popped;
+}
+
+static int s_locked_pool_worker(void* udata)
+{
+	LockedPool* pool = (LockedPool*)udata;
+	while (cf_atomic_get(&pool->running)) {
+		cf_sem_wait(&pool->sem);
+		LockedPool::Task task;
+		while (s_locked_pool_pop(pool, &task)) {
+			task.fn(task.param);
+			cf_atomic_add(&pool->in_flight, -1);
+		}
+	}
+	return 0;
+}
+
+static void s_locked_pool_run(LockedPool* pool)
+{
+	for (int i = 0; i < pool->threads.count(); ++i) cf_sem_post(&pool->sem);
+	LockedPool::Task task;
+	while (s_locked_pool_pop(pool, &task)) {
+		task.fn(task.param);
+		cf_atomic_add(&pool->in_flight, -1);
+	}
+	for (;;) {
+		cf_mutex_lock(&pool->mutex);
+		bool done = pool->tasks.count() == 0 && cf_atomic_get(&pool->in_flight) == 0;
+		cf_mutex_unlock(&pool->mutex);
+		if (done) break;
+	}
+}
+
+static void s_tiny_task(void* param)
+{
+	volatile int* x = (volatile int*)param;
+	*x = *x + 1;
+}
+
+// Not an assertion test -- a contention benchmark of 1M tiny tasks on 2/4/8/16 workers, the
+// work-stealing CF_Threadpool against the old mutex-guarded task stack. Prints milliseconds.
+TEST_CASE(test_threadpool_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int TASKS = 1000000;
+	static int scratch[TASKS];
+	for (int thread_count = 2; thread_count <= 16; thread_count *= 2) {
+		LockedPool locked;
+		locked.mutex = cf_make_mutex();
+		locked.sem = cf_make_sem(0);
+		locked.running = cf_atomic_zero();
+		locked.in_flight = cf_atomic_zero();
+		cf_atomic_set(&locked.running, 1);
+		for (int i = 0; i < thread_count; ++i) {
+			locked.threads.add(cf_thread_create(s_locked_pool_worker, "locked pool", &locked));
+		}
+		double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		for (int i = 0; i < TASKS; ++i) locked.tasks.add({ s_tiny_task, scratch + i });
+		s_locked_pool_run(&locked);
+		double locked_ms = (cf_get_ticks() / (double)cf_get_tick_frequency() - t0) * 1000.0;
+		cf_atomic_set(&locked.running, 0);
+		for (int i = 0; i < thread_count; ++i) cf_sem_post(&locked.sem);
+		for (int i = 0; i < thread_count; ++i) cf_thread_wait(locked.threads[i]);
+		cf_destroy_sem(&locked.sem);
+		cf_destroy_mutex(&locked.mutex);
+
+		CF_Threadpool* pool = cf_make_threadpool(thread_count);
+		t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		for (int i = 0; i < TASKS; ++i) cf_threadpool_add_task(pool, s_tiny_task, scratch + i);
+		cf_threadpool_kick_and_wait(pool);
+		double pool_ms = (cf_get_ticks() / (double)cf_get_tick_frequency() - t0) * 1000.0;
+		cf_destroy_threadpool(pool);
+
+		printf("[bench] threadpool %2d workers, %d tasks: locked stack %.3f ms, work stealing %.3f ms\n",
+			thread_count, TASKS, locked_ms, pool_ms);
+	}
+	return true;
+}
+
+static bool s_bench_use_fibers;
+
+static void s_bench_leaf(void* param)
+{
+	volatile int* x = (volatile int*)param;
+	for (int i = 0; i < 64; ++i) *x = *x + i;
+}
+
+static void s_bench_fan_out(void* param)
+{
+	CF_UNUSED(param);
+	int scratch[32];
+	CF_JobCounter leaves = cf_make_job_counter();
+	for (int i = 0; i < 32; ++i) {
+		cf_threadpool_add_job(s_fiber_pool, s_bench_leaf, scratch + i, &leaves);
+	}
+	cf_threadpool_wait_counter(s_fiber_pool, &leaves);
+}
+
+static void s_bench_fan_out_root(void* param)
+{
+	CF_UNUSED(param);
+	CF_JobCounter children = cf_make_job_counter();
+	for (int i = 0; i < 64; ++i) {
+		if (s_bench_use_fibers) cf_threadpool_add_fiber_job(s_fiber_pool, s_bench_fan_out, NULL, &children);
+		else cf_threadpool_add_job(s_fiber_pool, s_bench_fan_out, NULL, &children);
+	}
+	cf_threadpool_wait_counter(s_fiber_pool, &children);
+}
+
+// Not an assertion test -- two levels of fan-out/fan-in (64 roots x 64 children x 32 leaves),
+// with the waiting jobs as regular jobs (the waiter helps on its own stack) and as fiber jobs
+// (the waiter is suspended). Prints milliseconds.
+TEST_CASE(test_fiber_job_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	for (int thread_count = 2; thread_count <= 16; thread_count *= 2) {
+		s_fiber_pool = cf_make_threadpool(thread_count);
+		double ms[2];
+		for (int fibers = 0; fibers < 2; ++fibers) {
+			s_bench_use_fibers = fibers == 1;
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			CF_JobCounter roots = cf_make_job_counter();
+			for (int i = 0; i < 64; ++i) {
+				if (s_bench_use_fibers) cf_threadpool_add_fiber_job(s_fiber_pool, s_bench_fan_out_root, NULL, &roots);
+				else cf_threadpool_add_job(s_fiber_pool, s_bench_fan_out_root, NULL, &roots);
+			}
+			cf_threadpool_wait_counter(s_fiber_pool, &roots);
+			ms[fibers] = (cf_get_ticks() / (double)cf_get_tick_frequency() - t0) * 1000.0;
+		}
+		cf_destroy_threadpool(s_fiber_pool);
+		s_fiber_pool = NULL;
+		printf("[bench] fan-out/fan-in %2d workers: regular jobs %.3f ms, fiber jobs %.3f ms\n", thread_count, ms[0], ms[1]);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Atomics and lock-free queues.
+// The stress tests below are most useful when built with -fsanitize=thread.
+
+TEST_CASE(test_atomic64)
+{
+	CF_AtomicInt64 a = cf_atomic64_zero();
+	const int64_t big = 0x100000000LL;
+	REQUIRE(cf_atomic64_add(&a, big) == 0);
+	REQUIRE(cf_atomic64_add(&a, big) == big);
+	REQUIRE(cf_atomic64_get(&a) == big * 2);
+	REQUIRE(cf_atomic64_set(&a, -1) == big * 2);
+	REQUIRE(is_error(cf_atomic64_cas(&a, 0, 5)));
+	REQUIRE(cf_atomic64_get(&a) == -1);
+	REQUIRE(!is_error(cf_atomic64_cas(&a, -1, 5)));
+	REQUIRE(cf_atomic64_get(&a) == 5);
+	return true;
+}
+
+static const int QUEUE_ITEMS = 200000;
+static const int QUEUE_PRODUCERS = 4;
+
+static int s_spsc_producer(void* udata)
+{
+	CF_SPSCQueue* q = (CF_SPSCQueue*)udata;
+	for (int i = 0; i < QUEUE_ITEMS; ++i) {
+		while (!cf_spsc_queue_push(q, &i)) cf_sleep(0);
+	}
+	return 0;
+}
+
+TEST_CASE(test_spsc_queue)
+{
+	// A small capacity so the producer constantly runs into a full queue.
+	CF_SPSCQueue* q = cf_make_spsc_queue(60, sizeof(int));
+	int x = 0;
+	REQUIRE(!cf_spsc_queue_pop(q, &x));
+	for (int i = 0; i < 64; ++i) REQUIRE(cf_spsc_queue_push(q, &i));
+	REQUIRE(!cf_spsc_queue_push(q, &x));
+	REQUIRE(cf_spsc_queue_count(q) == 64);
+	for (int i = 0; i < 64; ++i) {
+		REQUIRE(cf_spsc_queue_pop(q, &x));
+		REQUIRE(x == i);
+	}
+
+	CF_Thread* producer = cf_thread_create(s_spsc_producer, "spsc producer", q);
+	for (int i = 0; i < QUEUE_ITEMS; ++i) {
+		while (!cf_spsc_queue_pop(q, &x)) cf_sleep(0);
+		REQUIRE(x == i);
+	}
+	cf_thread_wait(producer);
+	REQUIRE(cf_spsc_queue_count(q) == 0);
+	cf_destroy_spsc_queue(q);
+	return true;
+}
+
+static CF_MPMCQueue* s_mpmc;
+static CF_AtomicInt64 s_mpmc_sum;
+static CF_AtomicInt s_mpmc_popped;
+
+static int s_mpmc_producer(void* udata)
+{
+	CF_UNUSED(udata);
+	for (int i = 1; i <= QUEUE_ITEMS; ++i) {
+		int64_t value = i;
+		while (!cf_mpmc_queue_push(s_mpmc, &value)) cf_sleep(0);
+	}
+	return 0;
+}
+
+static int s_mpmc_consumer(void* udata)
+{
+	CF_UNUSED(udata);
+	int64_t value;
+	while (cf_atomic_get(&s_mpmc_popped) < QUEUE_ITEMS * QUEUE_PRODUCERS) {
+		if (cf_mpmc_queue_pop(s_mpmc, &value)) {
+			cf_atomic64_add(&s_mpmc_sum, value);
+			cf_atomic_add(&s_mpmc_popped, 1);
+		} else {
+			cf_sleep(0);
+		}
+	}
+	return 0;
+}
+
+TEST_CASE(test_mpmc_queue)
+{
+	s_mpmc = cf_make_mpmc_queue(256, sizeof(int64_t));
+	int64_t x = 0;
+	REQUIRE(!cf_mpmc_queue_pop(s_mpmc, &x));
+	for (int64_t i = 0; i < 256; ++i) REQUIRE(cf_mpmc_queue_push(s_mpmc, &i));
+	REQUIRE(!cf_mpmc_queue_push(s_mpmc, &x));
+	for (int64_t i = 0; i < 256; ++i) {
+		REQUIRE(cf_mpmc_queue_pop(s_mpmc, &x));
+		REQUIRE(x == i);
+	}
+
+	s_mpmc_sum = cf_atomic64_zero();
+	s_mpmc_popped = cf_atomic_zero();
+	CF_Thread* threads[QUEUE_PRODUCERS * 2];
+	for (int i = 0; i < QUEUE_PRODUCERS; ++i) {
+		threads[i] = cf_thread_create(s_mpmc_producer, "mpmc producer", NULL);
+		threads[QUEUE_PRODUCERS + i] = cf_thread_create(s_mpmc_consumer, "mpmc consumer", NULL);
+	}
+	for (int i = 0; i < QUEUE_PRODUCERS * 2; ++i) cf_thread_wait(threads[i]);
+	REQUIRE(cf_atomic64_get(&s_mpmc_sum) == (int64_t)QUEUE_PRODUCERS * QUEUE_ITEMS * (QUEUE_ITEMS + 1) / 2);
+	REQUIRE(!cf_mpmc_queue_pop(s_mpmc, &x));
+	cf_destroy_mpmc_queue(s_mpmc);
+	s_mpmc = NULL;
+	return true;
+}
+
+struct MPSCItem
+{
+	CF_MPSCNode node;
+	int producer;
+	int index;
+};
+
+static CF_MPSCQueue* s_mpsc;
+
+static int s_mpsc_producer(void* udata)
+{
+	MPSCItem* items = (MPSCItem*)udata;
+	for (int i = 0; i < QUEUE_ITEMS; ++i) {
+		cf_mpsc_queue_push(s_mpsc, &items[i].node);
+	}
+	return 0;
+}
+
+TEST_CASE(test_mpsc_queue)
+{
+	s_mpsc = cf_make_mpsc_queue();
+	REQUIRE(cf_mpsc_queue_pop(s_mpsc) == NULL);
+
+	MPSCItem* items = (MPSCItem*)cf_alloc(sizeof(MPSCItem) * QUEUE_ITEMS * QUEUE_PRODUCERS);
+	for (int p = 0; p < QUEUE_PRODUCERS; ++p) {
+		for (int i = 0; i < QUEUE_ITEMS; ++i) {
+			items[p * QUEUE_ITEMS + i].producer = p;
+			items[p * QUEUE_ITEMS + i].index = i;
+		}
+	}
+	CF_Thread* threads[QUEUE_PRODUCERS];
+	for (int p = 0; p < QUEUE_PRODUCERS; ++p) {
+		threads[p] = cf_thread_create(s_mpsc_producer, "mpsc producer", items + p * QUEUE_ITEMS);
+	}
+
+	// Items from any single producer must come out in the order that producer pushed them.
+	int next_index[QUEUE_PRODUCERS] = { };
+	int popped = 0;
+	while (popped < QUEUE_ITEMS * QUEUE_PRODUCERS) {
+		CF_MPSCNode* node = cf_mpsc_queue_pop(s_mpsc);
+		if (!node) {
+			cf_sleep(0);
+			continue;
+		}
+		MPSCItem* item = (MPSCItem*)((char*)node - offsetof(MPSCItem, node));
+		REQUIRE(item->index == next_index[item->producer]);
+		next_index[item->producer]++;
+		popped++;
+	}
+	for (int p = 0; p < QUEUE_PRODUCERS; ++p) cf_thread_wait(threads[p]);
+	REQUIRE(cf_mpsc_queue_pop(s_mpsc) == NULL);
+
+	cf_free(items);
+	cf_destroy_mpsc_queue(s_mpsc);
+	s_mpsc = NULL;
+	return true;
+}
+
+// Baseline for the queue benchmark: a Cute::Array ring guarded by a mutex.
+struct LockedQueue
+{
+	Array<int64_t> ring;
+	int head = 0;
+	int count = 0;
+	CF_Mutex mutex;
+};
+
+static bool s_locked_queue_push(LockedQueue* q, int64_t value)
+{
+	cf_mutex_lock(&q->mutex);
+	bool pushed = q->count < q->ring.count();
+	if (pushed) {
+		q->ring[(q->head + q->count) % q->ring.count()] = value;
+		q->count++;
+	}
+	cf_mutex_unlock(&q->mutex);
+	return pushed;
+}
+
+static bool s_locked_queue_pop(LockedQueue* q, int64_t* value)
+{
+	cf_mutex_lock(&q->mutex);
+	bool popped = q->count > 0;
+	if (popped) {
+		*value = q->ring[q->head];
+		q->head = (q->head + 1) % q->ring.count();
+		q->count--;
+	}
+	cf_mutex_unlock(&q->mutex);
+	return popped;
+}
+
+struct QueueBench
+{
+	int kind; // 0 locked, 1 spsc, 2 mpmc
+	LockedQueue* locked;
+	CF_SPSCQueue* spsc;
+	CF_MPMCQueue* mpmc;
+	int items;
+};
+
+static bool s_bench_push(QueueBench* b, int64_t value)
+{
+	if (b->kind == 0) return s_locked_queue_push(b->locked, value);
+	if (b->kind == 1) return cf_spsc_queue_push(b->spsc, &value);
+	return cf_mpmc_queue_push(b->mpmc, &value);
+}
+
+static bool s_bench_pop(QueueBench* b, int64_t* value)
+{
+	if (b->kind == 0) return s_locked_queue_pop(b->locked, value);
+	if (b->kind == 1) return cf_spsc_queue_pop(b->spsc, value);
+	return cf_mpmc_queue_pop(b->mpmc, value);
+}
+
+static int s_bench_producer(void* udata)
+{
+	QueueBench* b = (QueueBench*)udata;
+	for (int i = 0; i < b->items; ++i) {
+		while (!s_bench_push(b, i)) { }
+	}
+	return 0;
+}
+
+static int s_bench_consumer(void* udata)
+{
+	QueueBench* b = (QueueBench*)udata;
+	int64_t value;
+	for (int i = 0; i < b->items; ++i) {
+		while (!s_bench_pop(b, &value)) { }
+	}
+	return 0;
+}
+
+// Not an assertion test -- throughput of 4M elements through one producer and one consumer
+// thread, and through 4 producers and 4 consumers, for the lock-free queues against a mutex
+// guarded ring. Prints millions of elements per second.
+TEST_CASE(test_queue_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int ITEMS = 4000000;
+	const char* names[3] = { "mutex + Array", "spsc", "mpmc" };
+	for (int pairs = 1; pairs <= 4; pairs *= 4) {
+		for (int kind = 0; kind < 3; ++kind) {
+			if (kind == 1 && pairs > 1) continue;
+			LockedQueue locked;
+			locked.mutex = cf_make_mutex();
+			locked.ring.ensure_count(1024);
+			QueueBench b = { kind, &locked, cf_make_spsc_queue(1024, sizeof(int64_t)), cf_make_mpmc_queue(1024, sizeof(int64_t)), ITEMS / pairs };
+
+			CF_Thread* threads[8];
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			for (int i = 0; i < pairs; ++i) {
+				threads[i * 2] = cf_thread_create(s_bench_producer, "bench producer", &b);
+				threads[i * 2 + 1] = cf_thread_create(s_bench_consumer, "bench consumer", &b);
+			}
+			for (int i = 0; i < pairs * 2; ++i) cf_thread_wait(threads[i]);
+			double seconds = cf_get_ticks() / (double)cf_get_tick_frequency() - t0;
+
+			cf_destroy_spsc_queue(b.spsc);
+			cf_destroy_mpmc_queue(b.mpmc);
+			cf_destroy_mutex(&locked.mutex);
+			printf("[bench] queue %d producer(s) / %d consumer(s), %-13s: %.2f M elements/s\n",
+				pairs, pairs, names[kind], ITEMS / seconds / 1000000.0);
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Concurrent pool.
+
+static const int POOL_THREADS = 4;
+static const int POOL_ITEMS = 5000;
+
+struct PoolWorker
+{
+	CF_ConcurrentPool* pool;
+	int index;
+	void** elements; // POOL_ITEMS per thread.
+	void** others;   // Another thread's elements, freed by this one.
+};
+
+static int s_pool_alloc_worker(void* udata)
+{
+	PoolWorker* w = (PoolWorker*)udata;
+	for (int i = 0; i < POOL_ITEMS; ++i) {
+		int* element = (int*)cf_concurrent_pool_alloc(w->pool);
+		element[0] = w->index;
+		element[1] = i;
+		w->elements[i] = element;
+	}
+	return 0;
+}
+
+static int s_pool_free_worker(void* udata)
+{
+	PoolWorker* w = (PoolWorker*)udata;
+	for (int i = 0; i < POOL_ITEMS; ++i) {
+		cf_concurrent_pool_free(w->pool, w->others[i]);
+	}
+	// Churn across magazine boundaries after the cross-thread frees.
+	void* held[100];
+	for (int round = 0; round < 50; ++round) {
+		for (int i = 0; i < 100; ++i) held[i] = cf_concurrent_pool_alloc(w->pool);
+		for (int i = 0; i < 100; ++i) cf_concurrent_pool_free(w->pool, held[i]);
+	}
+	return 0;
+}
+
+static int s_compare_pointers(const void* a, const void* b)
+{
+	uintptr_t x = *(const uintptr_t*)a, y = *(const uintptr_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+TEST_CASE(test_concurrent_pool)
+{
+	CF_ConcurrentPool* pool = cf_make_concurrent_pool(sizeof(int) * 2, 256, 8);
+	void** elements = (void**)cf_alloc(sizeof(void*) * POOL_ITEMS * POOL_THREADS);
+	PoolWorker workers[POOL_THREADS];
+	CF_Thread* threads[POOL_THREADS];
+	for (int t = 0; t < POOL_THREADS; ++t) {
+		workers[t] = { pool, t, elements + t * POOL_ITEMS, elements + ((t + 1) % POOL_THREADS) * POOL_ITEMS };
+		threads[t] = cf_thread_create(s_pool_alloc_worker, "pool alloc", workers + t);
+	}
+	for (int t = 0; t < POOL_THREADS; ++t) cf_thread_wait(threads[t]);
+
+	// No element was handed out twice, and nobody scribbled over anyone else's.
+	for (int t = 0; t < POOL_THREADS; ++t) {
+		for (int i = 0; i < POOL_ITEMS; ++i) {
+			int* element = (int*)workers[t].elements[i];
+			REQUIRE(element[0] == t && element[1] == i);
+		}
+	}
+	qsort(elements, POOL_ITEMS * POOL_THREADS, sizeof(void*), s_compare_pointers);
+	for (int i = 1; i < POOL_ITEMS * POOL_THREADS; ++i) {
+		REQUIRE(elements[i - 1] != elements[i]);
+	}
+
+	CF_MemoryPoolStats stats = cf_concurrent_pool_stats(pool);
+	REQUIRE(stats.live_elements == POOL_ITEMS * POOL_THREADS);
+	REQUIRE(stats.high_water_mark == POOL_ITEMS * POOL_THREADS);
+	REQUIRE(stats.elements_per_block == 256);
+	REQUIRE(stats.block_count * 256 >= POOL_ITEMS * POOL_THREADS);
+
+	// Each thread frees the elements another thread allocated.
+	for (int t = 0; t < POOL_THREADS; ++t) {
+		threads[t] = cf_thread_create(s_pool_free_worker, "pool free", workers + t);
+	}
+	for (int t = 0; t < POOL_THREADS; ++t) cf_thread_wait(threads[t]);
+
+	stats = cf_concurrent_pool_stats(pool);
+	REQUIRE(stats.live_elements == 0);
+	REQUIRE(stats.high_water_mark == POOL_ITEMS * POOL_THREADS);
+
+	cf_free(elements);
+	cf_destroy_concurrent_pool(pool);
+	return true;
+}
+
+struct PoolBench
+{
+	bool concurrent;
+	CF_ConcurrentPool* pool;
+	CF_MemoryPool* locked_pool;
+	CF_Mutex* mutex;
+	int iters;
+};
+
+static int s_pool_bench_worker(void* udata)
+{
+	PoolBench* b = (PoolBench*)udata;
+	void* held[64];
+	for (int i = 0; i < b->iters; ++i) {
+		if (b->concurrent) {
+			for (int j = 0; j < 64; ++j) held[j] = cf_concurrent_pool_alloc(b->pool);
+			for (int j = 0; j < 64; ++j) cf_concurrent_pool_free(b->pool, held[j]);
+		} else {
+			for (int j = 0; j < 64; ++j) {
+				cf_mutex_lock(b->mutex);
+				held[j] = cf_memory_pool_alloc(b->locked_pool);
+				cf_mutex_unlock(b->mutex);
+			}
+			for (int j = 0; j < 64; ++j) {
+				cf_mutex_lock(b->mutex);
+				cf_memory_pool_free(b->locked_pool, held[j]);
+				cf_mutex_unlock(b->mutex);
+			}
+		}
+	}
+	return 0;
+}
+
+// Not an assertion test -- bursts of 64 allocs then 64 frees on 1 and 4 threads, for the
+// concurrent pool against a CF_MemoryPool behind a mutex. Prints millions of alloc/free pairs
+// per second.
+TEST_CASE(test_concurrent_pool_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int ITERS = 40000;
+	for (int thread_count = 1; thread_count <= 4; thread_count *= 4) {
+		double rate[2];
+		for (int concurrent = 0; concurrent < 2; ++concurrent) {
+			CF_Mutex mutex = cf_make_mutex();
+			PoolBench b = { concurrent != 0, cf_make_concurrent_pool(64, 1024, 16), cf_make_memory_pool(64, 1024, 16), &mutex, ITERS };
+			CF_Thread* threads[4];
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			for (int t = 0; t < thread_count; ++t) threads[t] = cf_thread_create(s_pool_bench_worker, "pool bench", &b);
+			for (int t = 0; t < thread_count; ++t) cf_thread_wait(threads[t]);
+			double seconds = cf_get_ticks() / (double)cf_get_tick_frequency() - t0;
+			rate[concurrent] = (double)ITERS * 64 * thread_count / seconds / 1000000.0;
+			cf_destroy_concurrent_pool(b.pool);
+			cf_destroy_memory_pool(b.locked_pool);
+			cf_destroy_mutex(&mutex);
+		}
+		printf("[bench] pool %d thread(s): memory pool behind a mutex %.2f M/s, concurrent pool %.2f M/s\n", thread_count, rate[0], rate[1]);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// String interning.
+
+static const int INTERN_THREADS = 8;
+static const int INTERN_STRINGS = 5000;
+static const char* s_interned[INTERN_THREADS][INTERN_STRINGS];
+
+static int s_intern_worker(void* udata)
+{
+	int t = (int)(uintptr_t)udata;
+	char buf[64];
+	// Each thread walks the same strings in a different order, so inserts of the same string race.
+	for (int i = 0; i < INTERN_STRINGS; ++i) {
+		int k = (i * 7 + t * 131) % INTERN_STRINGS;
+		snprintf(buf, sizeof(buf), "test_sintern_threads_%d", k);
+		s_interned[t][k] = sintern_range(buf, buf + CF_STRLEN(buf));
+	}
+	return 0;
+}
+
+TEST_CASE(test_sintern_threads)
+{
+	CF_Thread* threads[INTERN_THREADS];
+	for (int t = 0; t < INTERN_THREADS; ++t) {
+		threads[t] = cf_thread_create(s_intern_worker, "intern", (void*)(uintptr_t)t);
+	}
+	for (int t = 0; t < INTERN_THREADS; ++t) cf_thread_wait(threads[t]);
+
+	char buf[64];
+	for (int i = 0; i < INTERN_STRINGS; ++i) {
+		for (int t = 1; t < INTERN_THREADS; ++t) {
+			REQUIRE(s_interned[t][i] == s_interned[0][i]);
+		}
+		snprintf(buf, sizeof(buf), "test_sintern_threads_%d", i);
+		REQUIRE(sintern(buf) == s_interned[0][i]);
+		REQUIRE(silen(s_interned[0][i]) == (int)CF_STRLEN(buf));
+	}
+	return true;
+}
+
+struct InternBench
+{
+	const char** keys;
+	int key_count;
+	int iters;
+	CF_Mutex* mutex;
+};
+
+static int s_intern_bench_worker(void* udata)
+{
+	InternBench* b = (InternBench*)udata;
+	for (int i = 0; i < b->iters; ++i) {
+		const char* key = b->keys[i % b->key_count];
+		if (b->mutex) cf_mutex_lock(b->mutex);
+		sintern_range(key, key + CF_STRLEN(key));
+		if (b->mutex) cf_mutex_unlock(b->mutex);
+	}
+	return 0;
+}
+
+// Not an assertion test -- 1/2/4/8 threads repeatedly interning 1024 already-interned keys
+// (the common case for draw, font and JSON lookups), each thread serialized behind one mutex
+// against the lock-free lookups. Prints millions of interns per second.
+TEST_CASE(test_sintern_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const int KEYS = 1024;
+	const char** keys = (const char**)cf_alloc(sizeof(char*) * KEYS);
+	char buf[64];
+	for (int i = 0; i < KEYS; ++i) {
+		snprintf(buf, sizeof(buf), "test_sintern_bench_key_%d", i);
+		keys[i] = sintern(buf);
+	}
+
+	CF_Mutex mutex = cf_make_mutex();
+	for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+		double rate[2];
+		for (int lock_free = 0; lock_free < 2; ++lock_free) {
+			InternBench b = { keys, KEYS, 1000000, lock_free ? NULL : &mutex };
+			CF_Thread* threads[8];
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			for (int i = 0; i < thread_count; ++i) threads[i] = cf_thread_create(s_intern_bench_worker, "intern bench", &b);
+			for (int i = 0; i < thread_count; ++i) cf_thread_wait(threads[i]);
+			double seconds = cf_get_ticks() / (double)cf_get_tick_frequency() - t0;
+			rate[lock_free] = (double)b.iters * thread_count / seconds / 1000000.0;
+		}
+		printf("[bench] sintern %d thread(s): behind a mutex %.2f M/s, lock-free lookups %.2f M/s\n", thread_count, rate[0], rate[1]);
+	}
+	cf_destroy_mutex(&mutex);
+	cf_free(keys);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Test suite.
+
+TEST_SUITE(test_multithreading)
+{
+	RUN_TEST_CASE(test_threadpool_runs_all_tasks);
+	RUN_TEST_CASE(test_threadpool_nested_tasks);
+	RUN_TEST_CASE(test_parallel_for);
+	RUN_TEST_CASE(test_job_counters);
+	RUN_TEST_CASE(test_fiber_jobs);
+	RUN_TEST_CASE(test_fiber_jobs_held);
+	RUN_TEST_CASE(test_threadpool_bench);
+	RUN_TEST_CASE(test_fiber_job_bench);
+	RUN_TEST_CASE(test_atomic64);
+	RUN_TEST_CASE(test_spsc_queue);
+	RUN_TEST_CASE(test_mpmc_queue);
+	RUN_TEST_CASE(test_mpsc_queue);
+	RUN_TEST_CASE(test_queue_bench);
+	RUN_TEST_CASE(test_concurrent_pool);
+	RUN_TEST_CASE(test_concurrent_pool_bench);
+	RUN_TEST_CASE(test_sintern_threads);
+	RUN_TEST_CASE(test_sintern_bench);
+}
@@ -0,0 +1,336 @@
+/*
+	Cute Framework
+	Copyright (C) 2026 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include "test_harness.h"
+
+#include <cute.h>
+#include <cute_priority_queue.h>
+using namespace Cute;
+
+static PathGrid* s_random_grid(CF_Rnd* rnd, int w, int h, float density)
+{
+	PathGrid* grid = make_path_grid(w, h);
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) {
+			if (cf_rnd_float(rnd) < density) path_grid_set_blocked(grid, x, y, true);
+		}
+	}
+	return grid;
+}
+
+static PathCell s_random_open_cell(CF_Rnd* rnd, const PathGrid* grid, int w, int h)
+{
+	while (1) {
+		PathCell c = { cf_rnd_range_int(rnd, 0, w - 1), cf_rnd_range_int(rnd, 0, h - 1) };
+		if (!path_grid_is_blocked(grid, c.x, c.y)) return c;
+	}
+}
+
+// Checks every step is to a walkable neighbor without cutting corners, and returns the path's length,
+// or -1 if the path is broken.
+static float s_path_cost(const PathGrid* grid, const PathCell* path, int count, PathCell start, PathCell goal, bool diagonals)
+{
+	if (path[0].x != start.x || path[0].y != start.y) return -1;
+	if (path[count - 1].x != goal.x || path[count - 1].y != goal.y) return -1;
+	float cost = 0;
+	for (int i = 0; i < count; ++i) {
+		if (path_grid_is_blocked(grid, path[i].x, path[i].y)) return -1;
+		if (!i) continue;
+		int dx = path[i].x - path[i - 1].x;
+		int dy = path[i].y - path[i - 1].y;
+		if (cf_abs(dx) > 1 || cf_abs(dy) > 1 || (!dx && !dy)) return -1;
+		if (dx && dy) {
+			if (!diagonals) return -1;
+			if (path_grid_is_blocked(grid, path[i - 1].x + dx, path[i - 1].y) || path_grid_is_blocked(grid, path[i - 1].x, path[i - 1].y + dy)) return -1;
+			cost += 1.41421356f;
+		} else {
+			cost += 1.0f;
+		}
+	}
+	return cost;
+}
+
+/* A hand-made maze with a single way through. */
+TEST_CASE(test_path_maze)
+{
+	// Row 0 is the top line of the picture. The only way past the wall on the left is the gap at (2, 6).
+	const char* maze[] = {
+		"..#.......",
+		"..#.####..",
+		"..#....#..",
+		"..####.#..",
+		"..#....#..",
+		"..#.####..",
+		"........#.",
+	};
+	int w = 10, h = CF_ARRAY_SIZE(maze);
+	PathGrid* grid = make_path_grid(w, h);
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) {
+			path_grid_set_blocked(grid, x, y, maze[y][x] == '#');
+		}
+	}
+	REQUIRE(path_grid_is_blocked(grid, 2, 0));
+	REQUIRE(!path_grid_is_blocked(grid, 2, 6));
+	REQUIRE(path_grid_is_blocked(grid, -1, 0));
+	REQUIRE(path_grid_is_blocked(grid, 0, h));
+
+	PathCell path[128];
+	PathCell start = { 0, 0 };
+	PathCell goal = { 9, 0 };
+	PathAlgorithm algorithms[] = { PATH_ALGORITHM_ASTAR, PATH_ALGORITHM_JPS, PATH_ALGORITHM_HPA };
+	for (int i = 0; i < CF_ARRAY_SIZE(algorithms); ++i) {
+		for (int diagonals = 0; diagonals < 2; ++diagonals) {
+			path_grid_set_diagonals(grid, diagonals);
+			path_grid_build_hierarchy(grid, 4);
+			int count = path_grid_find_path(grid, start, goal, algorithms[i], path, CF_ARRAY_SIZE(path));
+			REQUIRE(count > 0);
+			REQUIRE(s_path_cost(grid, path, count, start, goal, diagonals) > 0);
+			bool through_gap = false;
+			for (int j = 0; j < count; ++j) through_gap |= path[j].x == 2 && path[j].y == 6;
+			REQUIRE(through_gap);
+
+			// Walled in.
+			path_grid_set_blocked(grid, 2, 6, true);
+			path_grid_build_hierarchy(grid, 4);
+			REQUIRE(path_grid_find_path(grid, start, goal, algorithms[i], path, CF_ARRAY_SIZE(path)) == 0);
+			path_grid_set_blocked(grid, 2, 6, false);
+		}
+	}
+
+	// Blocked or outside endpoints, a path to itself, and too small an output array.
+	REQUIRE(path_grid_find_path(grid, start, { 2, 0 }, PATH_ALGORITHM_ASTAR, path, CF_ARRAY_SIZE(path)) == 0);
+	REQUIRE(path_grid_find_path(grid, start, { -3, 0 }, PATH_ALGORITHM_ASTAR, path, CF_ARRAY_SIZE(path)) == 0);
+	REQUIRE(path_grid_find_path(grid, start, start, PATH_ALGORITHM_JPS, path, CF_ARRAY_SIZE(path)) == 1);
+	REQUIRE(path[0].x == start.x && path[0].y == start.y);
+	int count = path_grid_find_path(grid, start, goal, PATH_ALGORITHM_ASTAR, path, CF_ARRAY_SIZE(path));
+	PathCell short_path[4];
+	REQUIRE(path_grid_find_path(grid, start, goal, PATH_ALGORITHM_ASTAR, short_path, CF_ARRAY_SIZE(short_path)) == count);
+	REQUIRE(CF_MEMCMP(short_path, path, sizeof(short_path)) == 0);
+
+	destroy_path_grid(grid);
+	return true;
+}
+
+/* JPS matches A* path lengths exactly, and HPA* finds a path whenever one exists. */
+TEST_CASE(test_path_algorithms_agree)
+{
+	CF_Rnd rnd = cf_rnd_seed(5);
+	PathCell astar[4096], jps[4096], hpa[4096];
+	bool ok = true;
+	for (int map = 0; map < 8; ++map) {
+		int w = 40 + map * 7;
+		int h = 30 + map * 5;
+		bool diagonals = map != 3;
+		PathGrid* grid = s_random_grid(&rnd, w, h, 0.1f + 0.04f * map);
+		path_grid_set_diagonals(grid, diagonals);
+		path_grid_build_hierarchy(grid, 4 + map);
+		for (int i = 0; i < 100; ++i) {
+			PathCell start = s_random_open_cell(&rnd, grid, w, h);
+			PathCell goal = s_random_open_cell(&rnd, grid, w, h);
+			int astar_count = path_grid_find_path(grid, start, goal, PATH_ALGORITHM_ASTAR, astar, CF_ARRAY_SIZE(astar));
+			int jps_count = path_grid_find_path(grid, start, goal, PATH_ALGORITHM_JPS, jps, CF_ARRAY_SIZE(jps));
+			int hpa_count = path_grid_find_path(grid, start, goal, PATH_ALGORITHM_HPA, hpa, CF_ARRAY_SIZE(hpa));
+			ok = ok && !astar_count == !jps_count && !astar_count == !hpa_count;
+			if (!ok || !astar_count) continue;
+			float astar_cost = s_path_cost(grid, astar, astar_count, start, goal, diagonals);
+			float jps_cost = s_path_cost(grid, jps, jps_count, start, goal, diagonals);
+			float hpa_cost = s_path_cost(grid, hpa, hpa_count, start, goal, diagonals);
+			ok = ok && astar_cost >= 0 && jps_cost >= 0 && hpa_cost >= 0;
+			ok = ok && cf_abs(astar_cost - jps_cost) < 1.0e-3f;
+			ok = ok && hpa_cost > astar_cost - 1.0e-3f;
+		}
+		destroy_path_grid(grid);
+	}
+	REQUIRE(ok);
+	return true;
+}
+
+/* Batched requests give the same results with and without a threadpool. */
+TEST_CASE(test_path_batch)
+{
+	CF_Rnd rnd = cf_rnd_seed(9);
+	int w = 96, h = 64;
+	PathGrid* grid = s_random_grid(&rnd, w, h, 0.25f);
+	path_grid_build_hierarchy(grid, 16);
+
+	const int N = 300;
+	const int CAP = 256;
+	Array<PathRequest> requests;
+	Array<PathCell> cells, cells_mt;
+	cells.ensure_count(N * CAP);
+	cells_mt.ensure_count(N * CAP);
+	for (int i = 0; i < N; ++i) {
+		PathRequest r = { };
+		r.start = s_random_open_cell(&rnd, grid, w, h);
+		r.goal = s_random_open_cell(&rnd, grid, w, h);
+		r.algorithm = (PathAlgorithm)(i % 3);
+		r.path = cells.data() + i * CAP;
+		r.capacity = CAP;
+		requests.add(r);
+	}
+	path_grid_find_paths(grid, requests.data(), N, NULL);
+	Array<PathRequest> requests_mt = requests;
+	for (int i = 0; i < N; ++i) requests_mt[i].path = cells_mt.data() + i * CAP;
+	CF_Threadpool* pool = cf_make_threadpool(4);
+	path_grid_find_paths(grid, requests_mt.data(), N, pool);
+	cf_destroy_threadpool(pool);
+
+	bool ok = true;
+	PathCell path[CAP];
+	for (int i = 0; i < N; ++i) {
+		const PathRequest& r = requests[i];
+		int count = path_grid_find_path(grid, r.start, r.goal, r.algorithm, path, CAP);
+		ok = ok && r.count == count && requests_mt[i].count == count;
+		int n = cf_min(count, CAP);
+		ok = ok && CF_MEMCMP(r.path, path, sizeof(PathCell) * n) == 0;
+		ok = ok && CF_MEMCMP(requests_mt[i].path, path, sizeof(PathCell) * n) == 0;
+	}
+	REQUIRE(ok);
+
+	destroy_path_grid(grid);
+	return true;
+}
+
+/* Search scratch belongs to the grid, and goes away with it. */
+TEST_CASE(test_path_scratch_freed)
+{
+	cf_alloc_tracking_enable(false);
+	int live_count = cf_alloc_tracking_totals().live_count;
+
+	CF_Rnd rnd = cf_rnd_seed(3);
+	PathGrid* grid = s_random_grid(&rnd, 128, 128, 0.2f);
+	PathCell path[512];
+	for (int i = 0; i < 8; ++i) {
+		PathCell a = s_random_open_cell(&rnd, grid, 128, 128);
+		PathCell b = s_random_open_cell(&rnd, grid, 128, 128);
+		path_grid_find_path(grid, a, b, CF_PATH_ALGORITHM_ASTAR, path, 512);
+	}
+	destroy_path_grid(grid);
+
+	REQUIRE(cf_alloc_tracking_totals().live_count == live_count);
+	cf_alloc_tracking_disable();
+	return true;
+}
+
+/* The indexed heap pops in cost order and lowers costs in place. */
+TEST_CASE(test_indexed_priority_queue)
+{
+	CF_Rnd rnd = cf_rnd_seed(13);
+	IndexedPriorityQueue<4> q;
+	Array<float> costs; // Reference, with -1 for ids not in the queue.
+	costs.ensure_count(500);
+	for (int i = 0; i < costs.count(); ++i) costs[i] = -1;
+
+	bool ok = true;
+	for (int step = 0; step < 20000; ++step) {
+		if (cf_rnd_range_int(&rnd, 0, 2)) {
+			int id = cf_rnd_range_int(&rnd, 0, costs.count() - 1);
+			float cost = cf_rnd_range_float(&rnd, 0, 100);
+			bool expect = costs[id] < 0 || cost < costs[id];
+			ok = ok && q.push_or_decrease(id, cost) == expect;
+			if (expect) costs[id] = cost;
+		} else {
+			int id;
+			float cost;
+			bool expect = q.count() > 0;
+			ok = ok && q.pop_min(&id, &cost) == expect;
+			if (!expect) continue;
+			ok = ok && costs[id] == cost;
+			for (int i = 0; i < costs.count(); ++i) {
+				ok = ok && (costs[i] < 0 || costs[i] >= cost);
+			}
+			costs[id] = -1;
+		}
+	}
+	int count = 0;
+	for (int i = 0; i < costs.count(); ++i) {
+		ok = ok && q.contains(i) == (costs[i] >= 0);
+		if (costs[i] >= 0) {
+			ok = ok && q.cost(i) == costs[i];
+			++count;
+		}
+	}
+	ok = ok && q.count() == count;
+	q.clear();
+	ok = ok && q.count() == 0 && !q.contains(0) && !q.pop_min();
+	REQUIRE(ok);
+
+	PriorityQueue<int> pq;
+	float pq_costs[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+	for (int i = 0; i < CF_ARRAY_SIZE(pq_costs); ++i) pq.push_min(i, pq_costs[i]);
+	float last = -1;
+	int value;
+	float cost;
+	while (pq.pop_min(&value, &cost)) {
+		REQUIRE(cost >= last);
+		REQUIRE(pq_costs[value] == cost);
+		last = cost;
+	}
+	return true;
+}
+
+TEST_CASE(test_path_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	// A big cave-like map, with agents crossing it.
+	const int W = 1024, H = 1024, N = 200;
+	CF_Rnd rnd = cf_rnd_seed(21);
+	PathGrid* grid = s_random_grid(&rnd, W, H, 0.3f);
+	double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	path_grid_build_hierarchy(grid, 32);
+	double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+
+	Array<PathRequest> requests;
+	Array<PathCell> cells;
+	const int CAP = 4096;
+	cells.ensure_count(N * CAP);
+	for (int i = 0; i < N; ++i) {
+		PathRequest r = { };
+		r.start = s_random_open_cell(&rnd, grid, W, H);
+		r.goal = s_random_open_cell(&rnd, grid, W, H);
+		r.path = cells.data() + i * CAP;
+		r.capacity = CAP;
+		requests.add(r);
+	}
+
+	double times[3];
+	int found[3];
+	for (int a = 0; a < 3; ++a) {
+		for (int i = 0; i < N; ++i) requests[i].algorithm = (PathAlgorithm)a;
+		double start = cf_get_ticks() / (double)cf_get_tick_frequency();
+		path_grid_find_paths(grid, requests.data(), N, NULL);
+		times[a] = cf_get_ticks() / (double)cf_get_tick_frequency() - start;
+		found[a] = 0;
+		for (int i = 0; i < N; ++i) found[a] += requests[i].count > 0;
+	}
+	CF_Threadpool* pool = cf_make_threadpool(4);
+	double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	path_grid_find_paths(grid, requests.data(), N, pool);
+	double t3 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	cf_destroy_threadpool(pool);
+	destroy_path_grid(grid);
+
+	REQUIRE(found[0] == found[1] && found[0] == found[2]);
+	printf("[bench] %d paths on a %dx%d grid: A* %.2f ms, JPS %.2f ms, HPA* %.2f ms (hierarchy build %.2f ms), HPA* with threadpool %.2f ms\n", N, W, H, times[0] * 1000.0, times[1] * 1000.0, times[2] * 1000.0, (t1 - t0) * 1000.0, (t3 - t2) * 1000.0);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Test suite.
+
+TEST_SUITE(test_pathfinding)
+{
+	RUN_TEST_CASE(test_path_maze);
+	RUN_TEST_CASE(test_path_algorithms_agree);
+	RUN_TEST_CASE(test_path_batch);
+	RUN_TEST_CASE(test_path_scratch_freed);
+	RUN_TEST_CASE(test_indexed_priority_queue);
+	RUN_TEST_CASE(test_path_bench);
+}
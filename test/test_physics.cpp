@@ -8,6 +8,7 @@
 #include "test_harness.h"
 
 #include <cute.h>
+#include <internal/cute_physics_internal.h>
 
 // Smoke tests for the vendored physics engines: worlds create, bodies fall under gravity,
 // and the interop converters round-trip. Pure CPU -- no app or GPU (the allocators wire
@@ -45,6 +46,126 @@ TEST_CASE(test_physics_world_2d)
 	return true;
 }
 
+// A pyramid of boxes on a static ground, `rows` boxes along the bottom.
+static b2WorldId s_make_pyramid(CF_Threadpool* pool, int rows, Cute::Array<b2BodyId>* bodies)
+{
+	b2WorldDef def = cf_physics_world_def_threadpool(pool);
+	def.gravity.y = -10.0f;
+	b2WorldId world = b2CreateWorld(&def);
+
+	b2BodyDef ground_def = b2DefaultBodyDef();
+	b2BodyId ground = b2CreateBody(world, &ground_def);
+	b2ShapeDef ground_shape = b2DefaultShapeDef();
+	b2Segment segment = { { -(float)rows - 10.0f, 0.0f }, { (float)rows + 10.0f, 0.0f } };
+	b2CreateSegmentShape(ground, &ground_shape, &segment);
+
+	b2ShapeDef shape_def = b2DefaultShapeDef();
+	b2Polygon box = b2MakeBox(0.5f, 0.5f);
+	for (int i = 0; i < rows; ++i) {
+		for (int j = i; j < rows; ++j) {
+			b2BodyDef body_def = b2DefaultBodyDef();
+			body_def.type = b2_dynamicBody;
+			body_def.position.x = (j - i * 0.5f) - rows * 0.5f;
+			body_def.position.y = 0.5f + i;
+			b2BodyId body = b2CreateBody(world, &body_def);
+			b2CreatePolygonShape(body, &shape_def, &box);
+			bodies->add(body);
+		}
+	}
+	return world;
+}
+
+TEST_CASE(test_physics_world_threadpool)
+{
+	// Box2D steps deterministically regardless of worker count, so a world stepped across the
+	// pool must land every body exactly where the single-threaded world does.
+	CF_Threadpool* pool = cf_make_threadpool(3);
+	Cute::Array<b2BodyId> serial_bodies, pooled_bodies;
+	b2WorldId serial = s_make_pyramid(NULL, 20, &serial_bodies);
+	b2WorldId pooled = s_make_pyramid(pool, 20, &pooled_bodies);
+	for (int i = 0; i < 60; ++i) {
+		b2World_Step(serial, 1.0f / 60.0f, 4);
+		b2World_Step(pooled, 1.0f / 60.0f, 4);
+	}
+	REQUIRE(serial_bodies.count() == pooled_bodies.count());
+	for (int i = 0; i < serial_bodies.count(); ++i) {
+		b2Vec2 a = b2Body_GetPosition(serial_bodies[i]);
+		b2Vec2 b = b2Body_GetPosition(pooled_bodies[i]);
+		REQUIRE(a.x == b.x && a.y == b.y);
+	}
+	b2DestroyWorld(serial);
+	b2DestroyWorld(pooled);
+	cf_destroy_threadpool(pool);
+
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	// Stepping a ~10k body pyramid (141 boxes along the bottom) on 1 to 16 workers.
+	for (int workers = 1; workers <= 16; workers *= 2) {
+		pool = workers > 1 ? cf_make_threadpool(workers - 1) : NULL;
+		Cute::Array<b2BodyId> bodies;
+		b2WorldId world = s_make_pyramid(pool, 141, &bodies);
+		const int steps = 120;
+		double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		for (int i = 0; i < steps; ++i) b2World_Step(world, 1.0f / 60.0f, 4);
+		double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+		printf("[bench] physics pyramid, %d bodies, %2d workers: %.3f ms/step\n", bodies.count(), workers, (t1 - t0) * 1000.0 / steps);
+		b2DestroyWorld(world);
+		if (pool) cf_destroy_threadpool(pool);
+	}
+	return true;
+}
+
+TEST_CASE(test_physics_transforms)
+{
+	Cute::Array<b2BodyId> bodies;
+	b2WorldId world = s_make_pyramid(NULL, 10, &bodies);
+	CF_PhysicsTransforms* transforms = cf_make_physics_transforms(world);
+	for (int i = 0; i < bodies.count(); ++i) {
+		REQUIRE(cf_physics_transforms_add(transforms, bodies[i]) == i);
+	}
+	REQUIRE(cf_physics_transforms_add(transforms, bodies[3]) == 3);
+
+	// Knock the pyramid over so bodies move and spin, then check interpolation against Box2D.
+	b2Body_SetLinearVelocity(bodies[0], { 20.0f, 5.0f });
+	b2Body_SetAngularVelocity(bodies[0], 10.0f);
+	Cute::Array<b2Transform> before;
+	for (int step = 0; step < 30; ++step) {
+		before.clear();
+		for (int i = 0; i < bodies.count(); ++i) before.add(b2Body_GetTransform(bodies[i]));
+		b2World_Step(world, 1.0f / 60.0f, 4);
+		cf_physics_transforms_update(transforms);
+
+		const CF_Transform* tf = cf_physics_transforms_interpolate(transforms, 0.0f);
+		for (int i = 0; i < bodies.count(); ++i) {
+			REQUIRE(tf[i].p.x == before[i].p.x && tf[i].p.y == before[i].p.y);
+		}
+		tf = cf_physics_transforms_interpolate(transforms, 1.0f);
+		for (int i = 0; i < bodies.count(); ++i) {
+			b2Transform after = b2Body_GetTransform(bodies[i]);
+			REQUIRE(tf[i].p.x == after.p.x && tf[i].p.y == after.p.y);
+			REQUIRE(cf_abs(tf[i].r.c - after.q.c) < 1e-5f && cf_abs(tf[i].r.s - after.q.s) < 1e-5f);
+		}
+		tf = cf_physics_transforms_interpolate(transforms, 0.5f);
+		for (int i = 0; i < bodies.count(); ++i) {
+			b2Vec2 mid = b2Lerp(before[i].p, b2Body_GetPosition(bodies[i]), 0.5f);
+			REQUIRE(cf_abs(tf[i].p.x - mid.x) < 1e-5f && cf_abs(tf[i].p.y - mid.y) < 1e-5f);
+			REQUIRE(cf_abs(tf[i].r.c * tf[i].r.c + tf[i].r.s * tf[i].r.s - 1.0f) < 1e-5f);
+		}
+	}
+
+	// Removing swaps the last body in.
+	b2BodyId last = bodies[bodies.count() - 1];
+	cf_physics_transforms_remove(transforms, bodies[2]);
+	REQUIRE(cf_physics_transforms_count(transforms) == bodies.count() - 1);
+	REQUIRE(B2_ID_EQUALS(cf_physics_transforms_bodies(transforms)[2], last));
+	REQUIRE(cf_physics_transforms_add(transforms, bodies[2]) == bodies.count() - 1);
+
+	cf_destroy_physics_transforms(transforms);
+	b2DestroyWorld(world);
+	return true;
+}
+
 TEST_CASE(test_physics_world_3d)
 {
 	// cf_physics_world_def3 wires CF's debug-shape bake callbacks; creating shapes and
@@ -108,9 +229,83 @@ TEST_CASE(test_physics_interop)
 	return true;
 }
 
+static void s_count_solid_polygon(b2Transform xf, const b2Vec2* vertices, int count, float radius, b2HexColor color, void* context)
+{
+	CF_UNUSED(xf); CF_UNUSED(vertices); CF_UNUSED(count); CF_UNUSED(radius); CF_UNUSED(color);
+	++*(int*)context;
+}
+
+TEST_CASE(test_physics_draw_culling)
+{
+	// 2d: one box in view and two far off to the sides. The plain defaults hand Box2D no bounds, so
+	// every shape comes through; the view-bounded draw cf_physics_draw uses only reports the one.
+	b2WorldDef def = b2DefaultWorldDef();
+	b2WorldId world = b2CreateWorld(&def);
+	b2ShapeDef shape_def = b2DefaultShapeDef();
+	b2Polygon box = b2MakeBox(0.5f, 0.5f);
+	float xs[] = { 0.0f, -50.0f, 50.0f };
+	for (int i = 0; i < 3; ++i) {
+		b2BodyDef body_def = b2DefaultBodyDef();
+		body_def.position.x = xs[i];
+		b2CreatePolygonShape(b2CreateBody(world, &body_def), &shape_def, &box);
+	}
+
+	int drawn = 0;
+	b2DebugDraw draw = cf_physics_debug_draw_defaults(0.1f);
+	REQUIRE(!draw.useDrawingBounds);
+	draw.DrawSolidPolygonFcn = s_count_solid_polygon;
+	draw.context = &drawn;
+	b2World_Draw(world, &draw);
+	REQUIRE(drawn == 3);
+
+	drawn = 0;
+	draw = cf_physics_debug_draw_view(0.1f, cf_make_aabb(cf_v2(-10, -10), cf_v2(10, 10)), 0);
+	draw.DrawSolidPolygonFcn = s_count_solid_polygon;
+	draw.context = &drawn;
+	b2World_Draw(world, &draw);
+	REQUIRE(drawn == 1);
+	cf_physics_debug_draw_defaults(0.1f);
+	b2DestroyWorld(world);
+
+	// 2d LOD: shapes narrower than the LOD size in both axes become boxes. Zero turns it off.
+	REQUIRE(cf_physics_lod_box(cf_make_aabb(cf_v2(0, 0), cf_v2(0.5f, 0.2f)), 1.0f));
+	REQUIRE(!cf_physics_lod_box(cf_make_aabb(cf_v2(0, 0), cf_v2(0.5f, 2.0f)), 1.0f));
+	REQUIRE(!cf_physics_lod_box(cf_make_aabb(cf_v2(0, 0), cf_v2(0.5f, 0.2f)), 0));
+
+	// 3d: a camera at z = 10 looking down -z at the origin, built the way cf_physics_draw3 reads
+	// the draw3d stacks.
+	CF_V3 eye = cf_v3(0, 0, 10);
+	CF_M4x4 view = cf_look_at(eye, cf_v3(0, 0, 0), cf_v3(0, 1, 0));
+	CF_Frustum frustum = cf_frustum_from_m4(cf_mul_m4(cf_perspective(CF_PI * 0.5f, 1.0f, 0.1f, 100.0f), view));
+	CF_Aabb3 center = cf_make_aabb3_center(cf_v3(0, 0, 0), cf_v3(0.5f));
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, center) == CF_PHYSICS_CULL3_FULL);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, cf_make_aabb3_center(cf_v3(0, 0, 20), cf_v3(0.5f))) == CF_PHYSICS_CULL3_HIDDEN);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, cf_make_aabb3_center(cf_v3(50, 0, 0), cf_v3(0.5f))) == CF_PHYSICS_CULL3_HIDDEN);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, cf_make_aabb3_center(cf_v3(0, 0, -200), cf_v3(0.5f))) == CF_PHYSICS_CULL3_HIDDEN);
+
+	// 3d LOD: the box 10 units away is within 20 but beyond 5. Culling still wins over LOD.
+	REQUIRE(cf_physics_cull3(&frustum, eye, 20.0f, center) == CF_PHYSICS_CULL3_FULL);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 5.0f, center) == CF_PHYSICS_CULL3_BOX);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 5.0f, cf_make_aabb3_center(cf_v3(50, 0, 0), cf_v3(0.5f))) == CF_PHYSICS_CULL3_HIDDEN);
+
+	// A long thin shape behind the camera still draws when rotated into view: s_draw3_shape culls
+	// the transformed bounds, not the local ones.
+	CF_Aabb3 rod = cf_make_aabb3_center(cf_v3(0, 0, 0), cf_v3(20.0f, 0.1f, 0.1f));
+	CF_V3 behind = cf_v3(0, 0, 15);
+	CF_Quat turn = cf_quat_from_axis_angle(cf_v3(0, 1, 0), CF_PI * 0.5f);
+	CF_Aabb3 flat = cf_transform_aabb3(cf_m4_from_trs(behind, cf_quat_identity(), cf_v3(1.0f)), rod);
+	CF_Aabb3 turned = cf_transform_aabb3(cf_m4_from_trs(behind, turn, cf_v3(1.0f)), rod);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, flat) == CF_PHYSICS_CULL3_HIDDEN);
+	REQUIRE(cf_physics_cull3(&frustum, eye, 0, turned) == CF_PHYSICS_CULL3_FULL);
+	return true;
+}
+
 TEST_SUITE(test_physics)
 {
 	RUN_TEST_CASE(test_physics_world_2d);
+	RUN_TEST_CASE(test_physics_world_threadpool);
+	RUN_TEST_CASE(test_physics_transforms);
 	RUN_TEST_CASE(test_physics_world_3d);
 	RUN_TEST_CASE(test_physics_interop);
+	RUN_TEST_CASE(test_physics_draw_culling);
 }
@@ -0,0 +1,227 @@
+/*
+	Cute Framework
+	Copyright (C) 2026 Randy Gaul https://randygaul.github.io/
+
+	This software is dual-licensed with zlib or Unlicense, check LICENSE.txt for more info
+*/
+
+#include "test_harness.h"
+
+#include <cute.h>
+using namespace Cute;
+
+static CF_Aabb s_random_box(CF_Rnd* rnd, float world, float max_size)
+{
+	v2 p = V2(cf_rnd_range_float(rnd, -world, world), cf_rnd_range_float(rnd, -world, world));
+	v2 e = V2(cf_rnd_range_float(rnd, 0, max_size), cf_rnd_range_float(rnd, 0, max_size));
+	return cf_make_aabb(p, p + e);
+}
+
+static int s_brute_force(const Array<CF_Aabb>& boxes, CF_Aabb q, Array<int>* found)
+{
+	found->clear();
+	for (int i = 0; i < boxes.count(); ++i) {
+		if (cf_overlaps(boxes[i], q)) found->add(i);
+	}
+	return found->count();
+}
+
+static int s_cmp_int(const void* a, const void* b)
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+// Sorts both lists and checks they match, which also catches duplicates.
+static bool s_same_ids(int* ids, int count, Array<int>& expected)
+{
+	if (count != expected.count()) return false;
+	if (!count) return true;
+	qsort(ids, count, sizeof(int), s_cmp_int);
+	qsort(expected.data(), count, sizeof(int), s_cmp_int);
+	return CF_MEMCMP(ids, expected.data(), sizeof(int) * count) == 0;
+}
+
+/* Compare queries against brute force, with boxes spanning many cells and negative coordinates. */
+TEST_CASE(test_spatial_hash_query)
+{
+	CF_Rnd rnd = cf_rnd_seed(7);
+	SpatialHash* hash = make_spatial_hash(4.0f);
+
+	Array<CF_Aabb> boxes;
+	for (int i = 0; i < 2000; ++i) boxes.add(s_random_box(&rnd, 100.0f, i % 10 ? 3.0f : 20.0f));
+
+	Array<int> expected;
+	int ids[2048];
+	for (int frame = 0; frame < 3; ++frame) {
+		// Everything moves each frame, and the hash is rebuilt from scratch.
+		spatial_hash_clear(hash);
+		REQUIRE(spatial_hash_count(hash) == 0);
+		REQUIRE(spatial_hash_query(hash, cf_make_aabb(V2(-1000, -1000), V2(1000, 1000)), ids, 0) == 0);
+		for (int i = 0; i < boxes.count(); ++i) {
+			boxes[i] = cf_make_aabb(boxes[i].min + V2(1.5f, -0.5f), boxes[i].max + V2(1.5f, -0.5f));
+			spatial_hash_add(hash, boxes[i], i);
+		}
+		spatial_hash_build(hash);
+		REQUIRE(spatial_hash_count(hash) == boxes.count());
+
+		bool ok = true;
+		for (int i = 0; i < 200; ++i) {
+			CF_Aabb q = s_random_box(&rnd, 110.0f, 15.0f);
+			int count = spatial_hash_query(hash, q, ids, CF_ARRAY_SIZE(ids));
+			s_brute_force(boxes, q, &expected);
+			ok = ok && s_same_ids(ids, count, expected);
+		}
+		REQUIRE(ok);
+	}
+
+	// Everything at once, then with too little room for the results.
+	CF_Aabb all = cf_make_aabb(V2(-1000, -1000), V2(1000, 1000));
+	REQUIRE(spatial_hash_query(hash, all, ids, CF_ARRAY_SIZE(ids)) == boxes.count());
+	REQUIRE(spatial_hash_query(hash, all, ids, 10) == boxes.count());
+
+	destroy_spatial_hash(hash);
+	return true;
+}
+
+/* Cells of one box that land in the same bucket still report the box once. */
+TEST_CASE(test_spatial_hash_bucket_collisions)
+{
+	SpatialHash* hash = make_spatial_hash(1.0f);
+	int ids[64];
+
+	// Eight cells over sixteen buckets, where two of the box's own cells collide.
+	CF_Aabb box = cf_make_aabb(V2(0.1f, 0.1f), V2(1.9f, 3.9f));
+	spatial_hash_add(hash, box, 7);
+	spatial_hash_build(hash);
+	REQUIRE(spatial_hash_query(hash, box, ids, CF_ARRAY_SIZE(ids)) == 1);
+	REQUIRE(ids[0] == 7);
+
+	// A few boxes spanning thousands of cells each, so buckets are shared all over the place.
+	spatial_hash_clear(hash);
+	Array<CF_Aabb> boxes;
+	for (int i = 0; i < 4; ++i) {
+		boxes.add(cf_make_aabb(V2(-40.0f + i * 7.5f, -30.0f), V2(20.0f + i * 3.0f, 35.5f - i * 4.0f)));
+		spatial_hash_add(hash, boxes[i], i);
+	}
+	spatial_hash_build(hash);
+	Array<int> expected;
+	CF_Rnd rnd = cf_rnd_seed(5);
+	bool ok = true;
+	for (int i = 0; i < 200; ++i) {
+		CF_Aabb q = s_random_box(&rnd, 50.0f, 40.0f);
+		int count = spatial_hash_query(hash, q, ids, CF_ARRAY_SIZE(ids));
+		s_brute_force(boxes, q, &expected);
+		ok = ok && s_same_ids(ids, count, expected);
+	}
+	REQUIRE(ok);
+
+	destroy_spatial_hash(hash);
+	return true;
+}
+
+/* Batched queries give the same results with and without a threadpool. */
+TEST_CASE(test_spatial_hash_batch)
+{
+	CF_Rnd rnd = cf_rnd_seed(11);
+	SpatialHash* hash = make_spatial_hash(2.0f);
+	Array<CF_Aabb> boxes;
+	for (int i = 0; i < 5000; ++i) {
+		boxes.add(s_random_box(&rnd, 200.0f, 2.0f));
+		spatial_hash_add(hash, boxes[i], i);
+	}
+	spatial_hash_build(hash);
+
+	const int Q = 3000;
+	const int CAP = 32;
+	Array<CF_Aabb> queries;
+	for (int i = 0; i < Q; ++i) queries.add(s_random_box(&rnd, 200.0f, 6.0f));
+	Array<int> ids, counts, ids_mt, counts_mt;
+	ids.ensure_count(Q * CAP);
+	counts.ensure_count(Q);
+	ids_mt.ensure_count(Q * CAP);
+	counts_mt.ensure_count(Q);
+
+	spatial_hash_query_batch(hash, queries.data(), Q, ids.data(), CAP, counts.data(), NULL);
+	CF_Threadpool* pool = cf_make_threadpool(4);
+	spatial_hash_query_batch(hash, queries.data(), Q, ids_mt.data(), CAP, counts_mt.data(), pool);
+	cf_destroy_threadpool(pool);
+
+	Array<int> expected;
+	bool ok = true;
+	for (int i = 0; i < Q; ++i) {
+		ok = ok && counts[i] == counts_mt[i] && counts[i] <= CAP;
+		s_brute_force(boxes, queries[i], &expected);
+		ok = ok && s_same_ids(ids.data() + i * CAP, counts[i], expected);
+		s_brute_force(boxes, queries[i], &expected);
+		ok = ok && s_same_ids(ids_mt.data() + i * CAP, counts_mt[i], expected);
+	}
+	REQUIRE(ok);
+
+	destroy_spatial_hash(hash);
+	return true;
+}
+
+TEST_CASE(test_spatial_hash_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	// Lots of bullet-sized colliders, each one checking what it touches.
+	const int N = 20000;
+	const int FRAMES = 5;
+	const int CAP = 64;
+	CF_Rnd rnd = cf_rnd_seed(3);
+	Array<CF_Aabb> boxes;
+	for (int i = 0; i < N; ++i) boxes.add(s_random_box(&rnd, 1000.0f, 8.0f));
+	Array<int> ids, counts;
+	ids.ensure_count(N * CAP);
+	counts.ensure_count(N);
+
+	// Brute force is slow enough that a single frame makes the point.
+	int brute_hits = 0;
+	double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	for (int i = 0; i < N; ++i) {
+		for (int j = 0; j < N; ++j) {
+			brute_hits += cf_overlaps(boxes[i], boxes[j]);
+		}
+	}
+	double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+
+	SpatialHash* hash = make_spatial_hash(8.0f);
+	int hash_hits = 0;
+	for (int frame = 0; frame < FRAMES; ++frame) {
+		spatial_hash_clear(hash);
+		for (int i = 0; i < N; ++i) spatial_hash_add(hash, boxes[i], i);
+		spatial_hash_build(hash);
+		spatial_hash_query_batch(hash, boxes.data(), N, ids.data(), CAP, counts.data(), NULL);
+		for (int i = 0; i < N; ++i) hash_hits += counts[i];
+	}
+	double t2 = cf_get_ticks() / (double)cf_get_tick_frequency();
+
+	CF_Threadpool* pool = cf_make_threadpool(4);
+	for (int frame = 0; frame < FRAMES; ++frame) {
+		spatial_hash_clear(hash);
+		for (int i = 0; i < N; ++i) spatial_hash_add(hash, boxes[i], i);
+		spatial_hash_build(hash);
+		spatial_hash_query_batch(hash, boxes.data(), N, ids.data(), CAP, counts.data(), pool);
+	}
+	double t3 = cf_get_ticks() / (double)cf_get_tick_frequency();
+	cf_destroy_threadpool(pool);
+	destroy_spatial_hash(hash);
+
+	REQUIRE(brute_hits * FRAMES == hash_hits);
+	double scale = 1000.0 / FRAMES;
+	printf("[bench] spatial hash %d boxes vs each other, per frame: brute force %.2f ms, build + batch query %.2f ms, with threadpool %.2f ms\n", N, (t1 - t0) * 1000.0, (t2 - t1) * scale, (t3 - t2) * scale);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Test suite.
+
+TEST_SUITE(test_spatial_hash)
+{
+	RUN_TEST_CASE(test_spatial_hash_query);
+	RUN_TEST_CASE(test_spatial_hash_bucket_collisions);
+	RUN_TEST_CASE(test_spatial_hash_batch);
+	RUN_TEST_CASE(test_spatial_hash_bench);
+}
@@ -298,6 +298,97 @@ TEST_CASE(test_split_for_memleaks)
 	return true;
 }
 
+/* cf_hash_bytes is wyhash; check it against the reference vectors and the string/array shortforms. */
+TEST_CASE(test_hash_bytes)
+{
+	// Reference wyhash (final 4) outputs, each hashed with its index as the seed.
+	const char* inputs[7] = {
+		"",
+		"a",
+		"abc",
+		"message digest",
+		"abcdefghijklmnopqrstuvwxyz",
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+		"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+	};
+	uint64_t expected[7] = {
+		0x93228a4de0eec5a2ull,
+		0xc5bac3db178713c4ull,
+		0xa97f2f7b1d9b3314ull,
+		0x786d1f1df3801df4ull,
+		0xdca5a8138ad37c87ull,
+		0xb9e734f117cfaf70ull,
+		0x6cc5eab49a92d617ull,
+	};
+	for (int i = 0; i < 7; ++i) {
+		REQUIRE(cf_hash_bytes_seeded(inputs[i], CF_STRLEN(inputs[i]), (uint64_t)i) == expected[i]);
+	}
+
+	char* s = NULL;
+	sset(s, "The quick brown fox jumps over the lazy dog");
+	REQUIRE(shash(s) == cf_hash_bytes(s, CF_STRLEN(s)));
+	REQUIRE(cf_hash_bytes(s, CF_STRLEN(s)) != cf_hash_bytes_seeded(s, CF_STRLEN(s), 1));
+	sfree(s);
+
+	int* a = NULL;
+	for (int i = 0; i < 100; ++i) apush(a, i);
+	REQUIRE(ahash(a) == cf_hash_bytes(a, sizeof(int) * 100));
+	a[50] = -1;
+	REQUIRE(ahash(a) != cf_hash_bytes(a, sizeof(int) * 99));
+	afree(a);
+
+	// Every length around the short-input and 48 byte stride boundaries reads only its own bytes.
+	uint8_t buf[128];
+	for (int i = 0; i < 128; ++i) buf[i] = (uint8_t)(i * 7 + 1);
+	for (int len = 0; len <= 112; ++len) {
+		uint64_t h = cf_hash_bytes(buf + 8, len);
+		buf[7] ^= 0xFF; buf[8 + len] ^= 0xFF;
+		REQUIRE(cf_hash_bytes(buf + 8, len) == h);
+		buf[7] ^= 0xFF; buf[8 + len] ^= 0xFF;
+		if (len) {
+			buf[8 + len - 1] ^= 1;
+			REQUIRE(cf_hash_bytes(buf + 8, len) != h);
+			buf[8 + len - 1] ^= 1;
+		}
+	}
+
+	return true;
+}
+
+/* Not an assertion test -- hashing throughput from 16 bytes to 16MB, cf_hash_bytes against FNV-1a. */
+TEST_CASE(test_hash_bytes_bench)
+{
+	const char* bench = getenv("CF_BENCH");
+	if (!bench || *bench != '1') return true;
+
+	const size_t max_size = 16 * 1024 * 1024;
+	uint8_t* data = (uint8_t*)cf_alloc(max_size);
+	for (size_t i = 0; i < max_size; ++i) data[i] = (uint8_t)(i * 2654435761u >> 13);
+
+	uint64_t sink = 0;
+	for (size_t size = 16; size <= max_size; size *= 16) {
+		// Hash roughly 256MB per measurement so small inputs get enough iterations to time.
+		size_t iters = (256 * 1024 * 1024) / size;
+		double gbps[2];
+		for (int impl = 0; impl < 2; ++impl) {
+			double t0 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			for (size_t i = 0; i < iters; ++i) {
+				// Vary the start so short inputs aren't a single cached value.
+				const uint8_t* p = data + ((i * 64) & (max_size / 2 - 1));
+				if (size > max_size / 2) p = data;
+				sink += impl == 0 ? cf_hash_bytes(p, size) : cf_fnv1a(p, (int)size);
+			}
+			double t1 = cf_get_ticks() / (double)cf_get_tick_frequency();
+			gbps[impl] = (double)size * iters / (t1 - t0) / 1e9;
+		}
+		printf("[bench] hash %9d bytes: cf_hash_bytes %6.2f GB/s, fnv1a %6.2f GB/s\n", (int)size, gbps[0], gbps[1]);
+	}
+	printf("[bench] (checksum %llx)\n", (unsigned long long)sink);
+
+	cf_free(data);
+	return true;
+}
+
 TEST_SUITE(test_string)
 {
 	RUN_TEST_CASE(test_array_macros_simple);
@@ -307,4 +398,6 @@ TEST_SUITE(test_string)
 	RUN_TEST_CASE(test_string_interning);
 	RUN_TEST_CASE(test_dictionary_and_interning);
 	RUN_TEST_CASE(test_split_for_memleaks);
+	RUN_TEST_CASE(test_hash_bytes);
+	RUN_TEST_CASE(test_hash_bytes_bench);
 }